@@ -0,0 +1,351 @@
+#include "host.h"
+#include "regexpr.h"
+
+#include <time.h>
+#include <unistd.h>
+
+// Micro-benchmark of the two regex engines, on the in-memory host:
+//
+//   bench_regex [-n passes] [-r runs] [-f filter] > regex.json
+//
+// The regular expressions are compiled with re_compile() and matched with
+// re_simulate(), the glob expressions of the search arguments are set with
+// regexpr_set() and matched with regexpr_match(). Both run over a generated
+// corpus of keys and values shaped like those of presets: parameter keys,
+// indexed names, preset names and file paths.
+//
+// Each benchmark reports the compile latency, the matching throughput in ns
+// per byte and matches per second, and the allocations made through the host.
+// The times are the minimum over the runs. A last pass over the corpus, with
+// the profiling of re_simulate() on, gives the work behind the times of the
+// regular expressions: states per byte, early rejections and capture set
+// copies per string. The JSON output has a fixed key
+// order and no timestamp, so that two runs can be compared with a diff or a
+// script, e.g. before and after a change of re_simul_state_wc().
+
+// ========  DEFINES  ========
+
+#define BENCH_SCHEMA      2
+#define BENCH_CORPUS_CNT  2048
+#define BENCH_STR_MAX     96
+#define BENCH_RE_MAX      254     // As in dict_recurse_new()
+#define BENCH_COMPILE_CNT 2000
+
+// ========  STRUCTURES  ========
+
+typedef enum _bench_engine {
+
+  BENCH_REGEX,    // re_compile() and re_simulate()
+  BENCH_GLOB      // regexpr_set() and regexpr_match()
+
+} e_bench_engine;
+
+//******************************************************************************
+//  A benchmark: an expression to compile then match over the corpus
+//
+typedef struct _bench {
+
+  const char*    name;      // Unique, used by the filter and to compare runs
+  const char*    kind;      // literal, prefix, suffix, contains, class, alternation, capture
+  e_bench_engine engine;
+  const char*    search_s;
+  const char*    replace_s; // For BENCH_REGEX only, or NULL
+
+} t_bench;
+
+//******************************************************************************
+//  The results of a benchmark
+//
+typedef struct _bench_res {
+
+  double  compile_ns;       // Per compilation
+  t_int64 compile_allocs;   // Per compilation
+  double  match_ns;         // Per pass over the corpus
+  t_int64 match_allocs;     // Per pass over the corpus
+  t_int32 match_cnt;        // Per pass over the corpus
+
+  t_re_profile profile;     // One pass over the corpus, for BENCH_REGEX only
+
+} t_bench_res;
+
+// ========  BENCHMARKS  ========
+
+static const t_bench g_benches[] = {
+
+  { "re_literal",       "literal",     BENCH_REGEX, "track_gain", NULL },
+  { "re_prefix",        "prefix",      BENCH_REGEX, "track.*", NULL },
+  { "re_suffix",        "suffix",      BENCH_REGEX, ".*_gain", NULL },
+  { "re_contains",      "contains",    BENCH_REGEX, ".*gain.*", NULL },
+  { "re_class",         "class",       BENCH_REGEX, "/a+_/d+_/a+", NULL },
+  { "re_altern_4",      "alternation", BENCH_REGEX, "(gain|pan|mute|solo)", NULL },
+  { "re_altern_8",      "alternation", BENCH_REGEX, ".*_/d+_(gain|pan|mute|solo|level|freq|reso|attack)", NULL },
+  { "re_altern_nested", "alternation", BENCH_REGEX, "(track|bus|(send|return)_(a|b))_.*(gain|pan)", NULL },
+  { "re_capture_1",     "capture",     BENCH_REGEX, "track_(.*)", "tr_/0" },
+  { "re_capture_2",     "capture",     BENCH_REGEX, "(/a+)_(/d+)_.*", "/1_/0" },
+  { "re_capture_path",  "capture",     BENCH_REGEX, "//Presets//(/a+)//(.*)/.json", "/1:/0" },
+
+  { "glob_literal",     "literal",     BENCH_GLOB,  "track_gain", NULL },
+  { "glob_prefix",      "prefix",      BENCH_GLOB,  "track*", NULL },
+  { "glob_suffix",      "suffix",      BENCH_GLOB,  "*_gain", NULL },
+  { "glob_contains",    "contains",    BENCH_GLOB,  "*gain*", NULL },
+  { "glob_anchored",    "literal",     BENCH_GLOB,  "$track_gain$", NULL },
+  { "glob_all",         "contains",    BENCH_GLOB,  "*", NULL },
+};
+
+#define BENCH_CNT ((t_int32)(sizeof(g_benches) / sizeof(g_benches[0])))
+
+// ========  CORPUS  ========
+
+static char      g_corpus_s[BENCH_CORPUS_CNT][BENCH_STR_MAX];
+static t_symbol* g_corpus_sym[BENCH_CORPUS_CNT];
+static t_int64   g_corpus_bytes = 0;
+
+static t_uint32 g_seed = 0x5EED1234;
+
+static t_uint32 _bench_rand(t_uint32 n) {
+
+  g_seed = g_seed * 1664525 + 1013904223;
+  return (g_seed >> 8) % n;
+}
+
+//******************************************************************************
+//  Fill the corpus: the generator is seeded, so it is the same on every run
+//
+static void _bench_corpus(void) {
+
+  static const char* const owner[] = { "track", "bus", "send_a", "send_b", "return_a", "lfo", "env", "osc" };
+  static const char* const param[] = { "gain", "pan", "mute", "solo", "level", "freq", "reso", "attack", "release", "name" };
+  static const char* const word[] = { "Warm", "Pad", "Bright", "Lead", "Deep", "Bass", "Soft", "Keys", "Wide", "Strings" };
+  static const char* const folder[] = { "Factory", "User", "Live", "Studio" };
+
+  for (t_int32 ind = 0; ind < BENCH_CORPUS_CNT; ind++) {
+
+    char* str = g_corpus_s[ind];
+    const char* own = owner[_bench_rand(8)];
+    const char* par = param[_bench_rand(10)];
+
+    switch (_bench_rand(8)) {
+
+    // Parameter keys:  track_gain
+    case 0: case 1: case 2:
+      snprintf(str, BENCH_STR_MAX, "%s_%s", own, par); break;
+
+    // Indexed keys:  lfo_12_freq
+    case 3: case 4:
+      snprintf(str, BENCH_STR_MAX, "%s_%u_%s", own, _bench_rand(64), par); break;
+
+    // Short keys and values:  gain, 0.75
+    case 5:
+      if (_bench_rand(2)) { snprintf(str, BENCH_STR_MAX, "%s", par); }
+      else { snprintf(str, BENCH_STR_MAX, "0.%u", _bench_rand(1000)); }
+      break;
+
+    // Preset names:  Warm Pad 03
+    case 6:
+      snprintf(str, BENCH_STR_MAX, "%s %s %02u", word[_bench_rand(10)], word[_bench_rand(10)], _bench_rand(100)); break;
+
+    // File paths:  /Presets/User/Deep Bass 07.json
+    default:
+      snprintf(str, BENCH_STR_MAX, "/Presets/%s/%s %s %02u.json", folder[_bench_rand(4)],
+        word[_bench_rand(10)], word[_bench_rand(10)], _bench_rand(100));
+      break;
+    }
+
+    g_corpus_sym[ind] = gensym(str);
+    g_corpus_bytes += (t_int64)strlen(str);
+  }
+}
+
+// ========  MEASURES  ========
+
+static double _bench_now_ns(void) {
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static t_int64 _bench_allocs(void) {
+
+  t_host_mem mem;
+  host_mem(&mem);
+  return mem.alloc_cnt;
+}
+
+//******************************************************************************
+//  Compile an expression with the engine of the benchmark
+//
+static t_bool _bench_compile(const t_bench* bench, t_regexp2* re2, t_regexpr* glob, t_symbol* search_sym) {
+
+  if (bench->engine == BENCH_REGEX) {
+    re_compile(re2, bench->search_s, bench->replace_s);
+    return (re2->err == ERR_NONE);
+  }
+  else {
+    return (regexpr_set(glob, search_sym) == ERR_NONE);
+  }
+}
+
+//******************************************************************************
+//  One pass of the engine of the benchmark over the corpus
+//
+static t_int32 _bench_match(const t_bench* bench, t_regexp2* re2, t_regexpr* glob) {
+
+  t_int32 match_cnt = 0;
+
+  if (bench->engine == BENCH_REGEX) {
+    for (t_int32 ind = 0; ind < BENCH_CORPUS_CNT; ind++) {
+      if (re_simulate(re2, g_corpus_s[ind])) { match_cnt++; }
+    }
+  }
+  else {
+    for (t_int32 ind = 0; ind < BENCH_CORPUS_CNT; ind++) {
+      if (regexpr_match(glob, g_corpus_sym[ind])) { match_cnt++; }
+    }
+  }
+
+  return match_cnt;
+}
+
+//******************************************************************************
+//  Run a benchmark: the times are the minimum over the runs
+//
+static t_bool _bench_run(const t_bench* bench, t_bench_res* res, t_int32 pass_cnt, t_int32 run_cnt) {
+
+  t_regexp2* re2 = re_new(BENCH_RE_MAX);
+  t_regexpr* glob = regexpr_new();
+  t_symbol* search_sym = gensym(bench->search_s);
+  t_bool is_ok = (re2 && glob);
+
+  res->compile_ns = 0;
+  res->match_ns = 0;
+
+  // Warm up, and check that the expression compiles
+  if (is_ok) { is_ok = _bench_compile(bench, re2, glob, search_sym); }
+  if (is_ok) { res->match_cnt = _bench_match(bench, re2, glob); }
+
+  for (t_int32 run = 0; is_ok && (run < run_cnt); run++) {
+
+    t_int64 allocs = _bench_allocs();
+    double time_ns = _bench_now_ns();
+    for (t_int32 cnt = 0; cnt < BENCH_COMPILE_CNT; cnt++) { _bench_compile(bench, re2, glob, search_sym); }
+    time_ns = (_bench_now_ns() - time_ns) / BENCH_COMPILE_CNT;
+    res->compile_allocs = (_bench_allocs() - allocs) / BENCH_COMPILE_CNT;
+    if ((run == 0) || (time_ns < res->compile_ns)) { res->compile_ns = time_ns; }
+
+    allocs = _bench_allocs();
+    time_ns = _bench_now_ns();
+    for (t_int32 cnt = 0; cnt < pass_cnt; cnt++) { _bench_match(bench, re2, glob); }
+    time_ns = (_bench_now_ns() - time_ns) / pass_cnt;
+    res->match_allocs = (_bench_allocs() - allocs) / pass_cnt;
+    if ((run == 0) || (time_ns < res->match_ns)) { res->match_ns = time_ns; }
+  }
+
+  // Count the work of one pass, apart from the timed ones
+  if (is_ok && (bench->engine == BENCH_REGEX)) {
+    re_profile_set(re2, true);
+    _bench_match(bench, re2, glob);
+    res->profile = re2->profile;
+  }
+
+  if (re2) { re_free(&re2); }
+  if (glob) { regexpr_free(glob); }
+  return is_ok;
+}
+
+// ========  OUTPUT  ========
+
+//******************************************************************************
+//  Print a string as a JSON string: the expressions hold no control characters
+//
+static void _bench_json_str(const char* str) {
+
+  putchar('"');
+  for (; *str; str++) {
+    if ((*str == '"') || (*str == '\\')) { putchar('\\'); }
+    putchar(*str);
+  }
+  putchar('"');
+}
+
+static void _bench_json_res(const t_bench* bench, const t_bench_res* res, t_bool is_ok, t_bool is_last) {
+
+  printf("    { \"name\": ");
+  _bench_json_str(bench->name);
+  printf(", \"engine\": \"%s\", \"kind\": \"%s\",\n      \"search\": ", (bench->engine == BENCH_REGEX) ? "regex" : "glob", bench->kind);
+  _bench_json_str(bench->search_s);
+  printf(", \"replace\": ");
+  if (bench->replace_s) { _bench_json_str(bench->replace_s); } else { printf("null"); }
+  printf(",\n");
+
+  if (is_ok) {
+    printf("      \"compile_ns\": %.1f, \"compile_allocs\": %lld,\n", res->compile_ns, (long long)res->compile_allocs);
+    printf("      \"ns_per_byte\": %.3f, \"matches_per_s\": %.0f, \"match_cnt\": %d, \"match_allocs\": %lld",
+      res->match_ns / (double)g_corpus_bytes, (res->match_ns > 0) ? (res->match_cnt * 1e9 / res->match_ns) : 0.0,
+      res->match_cnt, (long long)res->match_allocs);
+    if (bench->engine == BENCH_REGEX) {
+      const t_re_profile* prof = &res->profile;
+      printf(",\n      \"states_per_byte\": %.3f, \"rejected_early\": %.3f, \"capt_copies_per_string\": %.3f }",
+        prof->byte_cnt ? (double)prof->active_cnt / prof->byte_cnt : 0.0,
+        prof->sim_cnt ? (double)prof->exit_cnt / prof->sim_cnt : 0.0,
+        prof->sim_cnt ? (double)prof->capt_copy_cnt / prof->sim_cnt : 0.0);
+    }
+    else { printf(" }"); }
+  }
+  else {
+    printf("      \"error\": \"compile\" }");
+  }
+
+  printf(is_last ? "\n" : ",\n");
+}
+
+// ========  MAIN  ========
+
+int main(int argc, char** argv) {
+
+  t_int32 pass_cnt = 50;
+  t_int32 run_cnt = 5;
+  const char* filter_s = NULL;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "n:r:f:h")) != -1) {
+    switch (opt) {
+    case 'n': pass_cnt = MAX(1, atoi(optarg)); break;
+    case 'r': run_cnt = MAX(1, atoi(optarg)); break;
+    case 'f': filter_s = optarg; break;
+    default:
+      fprintf(stderr, "Usage:  %s [-n passes] [-r runs] [-f filter]\n", argv[0]);
+      return (opt == 'h') ? 0 : 1;
+    }
+  }
+
+  // The warnings of the engines would break the JSON output: the expressions
+  // are valid, so an error post is a regression of the engine to look at
+  host_set_quiet(true);
+  re_set_object(NULL);
+
+  _bench_corpus();
+
+  // Select the benchmarks first, to know the last one
+  t_int32 sel_arr[BENCH_CNT];
+  t_int32 sel_cnt = 0;
+  for (t_int32 ind = 0; ind < BENCH_CNT; ind++) {
+    if (!filter_s || strstr(g_benches[ind].name, filter_s)) { sel_arr[sel_cnt++] = ind; }
+  }
+
+  printf("{\n  \"schema\": %d,\n  \"benchmark\": \"regex\",\n", BENCH_SCHEMA);
+  printf("  \"corpus\": { \"strings\": %d, \"bytes\": %lld },\n", BENCH_CORPUS_CNT, (long long)g_corpus_bytes);
+  printf("  \"passes\": %d,\n  \"runs\": %d,\n  \"compiles\": %d,\n", pass_cnt, run_cnt, BENCH_COMPILE_CNT);
+  printf("  \"results\": [\n");
+
+  t_int32 fail_cnt = 0;
+  for (t_int32 ind = 0; ind < sel_cnt; ind++) {
+    t_bench_res res;
+    t_bool is_ok = _bench_run(&g_benches[sel_arr[ind]], &res, pass_cnt, run_cnt);
+    if (!is_ok) { fail_cnt++; }
+    _bench_json_res(&g_benches[sel_arr[ind]], &res, is_ok, ind == sel_cnt - 1);
+  }
+
+  printf("  ]\n}\n");
+  return fail_cnt ? 1 : 0;
+}
@@ -0,0 +1,435 @@
+#include "host.h"
+
+#include <time.h>
+#include <unistd.h>
+
+// Benchmark of the commands of y.dict.recurse on generated dictionaries, on
+// the in-memory host:
+//
+//   bench_traverse [-n nodes] [-r runs] [-s shape] [-f filter] [-a "threads 4"] > traverse.json
+//
+// Each command is sent as a message to an instance, so that the whole path is
+// timed: parsing, _dict_recurse_begin_cmd(), the traversal and
+// _dict_recurse_end_cmd(). One command of each t_command is run on each shape
+// of dictionary:
+//
+//   wide       Groups of 1000 entries under the root
+//   deep       Chains of 128 nested dictionaries
+//   array      Arrays of numbers, symbols and dictionaries
+//   numeric    Wide, with numbers for almost all the values
+//   skewed     Small dictionaries, with keys drawn from a Zipf distribution
+//
+// The dictionary is generated again before each run, outside of the time, so
+// that the editing commands always start from the same state. The generators
+// are seeded: two runs with the same options process the same dictionaries.
+//
+// Each result holds the size of the dictionary, the time per command, the
+// nodes per second, and the peak of the memory allocated through the host
+// during the command. The times are
+// the minimum over the runs. As with bench_regex, the JSON output has a fixed
+// key order and no timestamp. Async and slice are kept off, as the commands
+// are timed synchronously: the other attributes can be set with -a.
+
+void ext_main(void* r);
+
+// ========  DEFINES  ========
+
+#define BENCH_SCHEMA     1
+#define BENCH_WIDE_CNT   1000   // Entries per group of the wide shapes
+#define BENCH_DEEP_CNT   128    // Levels of the chains of the deep shape
+#define BENCH_SKEW_CNT   8      // Entries per dictionary of the skewed shape
+#define BENCH_VOCAB_CNT  512    // Keys of the skewed shape
+#define BENCH_ATTR_MAX   16
+
+// ========  STRUCTURES  ========
+
+//******************************************************************************
+//  A generator: fills the root dictionary with about nodes_max nodes
+//
+typedef struct _bench_gen {
+
+  t_dictionary* root;
+  t_int64 nodes;        // Entries and array elements created
+  t_int64 nodes_max;
+  t_bool  is_numeric;   // Numbers for almost all the values
+
+} t_bench_gen;
+
+typedef void (*t_bench_fill)(t_bench_gen* gen);
+
+typedef struct _bench_shape {
+
+  const char*  name;
+  t_bench_fill fill_fct;
+  t_bool       is_numeric;
+
+} t_bench_shape;
+
+//******************************************************************************
+//  A command: its name in the results, and the message sent to the instance.
+//  The dictionary is "bench", the dictionary of the replacements "bench_repl".
+//
+typedef struct _bench_cmd {
+
+  const char* name;
+  const char* msg;
+
+} t_bench_cmd;
+
+//******************************************************************************
+//  The results of a command on a shape
+//
+typedef struct _bench_res {
+
+  double  cmd_ns;       // Per command
+  t_int64 dict_bytes;   // Bytes allocated for the generated dictionary
+  t_int64 mem_peak;     // Peak of the bytes allocated during the command
+  t_int64 allocs;       // Allocations during the command
+
+} t_bench_res;
+
+// ========  COMMANDS  ========
+
+static const t_bench_cmd g_cmds[] = {
+
+  { "all",                         "all bench" },
+  { "find_key_in",                 "find key_in bench gain" },
+  { "find_key",                    "find key bench gain" },
+  { "find_value",                  "find value bench Warm" },
+  { "find_entry",                  "find entry bench name Warm" },
+  { "find_dict_cont_entry",        "find dict_cont_entry bench name Warm" },
+  { "find_number",                 "find number bench range 0 10" },
+  { "replace_key",                 "replace key bench gain level" },
+  { "replace_value",               "replace value bench Warm Cold" },
+  { "replace_entry",               "replace entry bench name Warm name Cold" },
+  { "replace_dict_cont_entry",     "replace dict_cont_entry bench name Warm bench_repl" },
+  { "replace_value_from_dict",     "replace value_from_dict bench pan bench_repl" },
+  { "replace_number",              "replace number bench range 0 10 5" },
+  { "append_in_dict_cont_entry",   "append in_dict_cont_entry bench name Warm tag new" },
+  { "append_in_dict_cont_entry_d", "append in_dict_cont_entry_d bench name Warm sub bench_repl" },
+  { "append_in_dict_from_key",     "append in_dict_from_key bench pan sub bench_repl" },
+  { "delete_key",                  "delete key bench mute" },
+  { "delete_value",                "delete value bench Warm" },
+  { "delete_entry",                "delete entry bench name Warm" },
+  { "delete_dict_cont_entry",      "delete dict_cont_entry bench name Warm" },
+  { "delete_number",               "delete number bench range 0 10" },
+  { "batch",                       NULL },    // The operations of g_batch_s, from a temporary file
+};
+
+#define BENCH_CMD_CNT ((t_int32)(sizeof(g_cmds) / sizeof(g_cmds[0])))
+
+static const char* const g_batch_s =
+  "find key gain\n"
+  "replace value Warm Cold\n"
+  "replace number range 0 10 5\n"
+  "delete key mute\n";
+
+// ========  GENERATORS  ========
+
+static const char* const g_keys[] = { "name", "gain", "pan", "mute", "solo", "level", "freq", "reso", "attack", "release" };
+static const char* const g_words[] = { "Warm", "Pad", "Bright", "Lead", "Deep", "Bass", "Soft", "Keys", "Wide", "Strings" };
+
+#define BENCH_KEY_CNT  ((t_int32)(sizeof(g_keys) / sizeof(g_keys[0])))
+#define BENCH_WORD_CNT ((t_int32)(sizeof(g_words) / sizeof(g_words[0])))
+
+static t_uint32 g_seed;
+
+static t_uint32 _bench_rand(t_uint32 n) {
+
+  g_seed = g_seed * 1664525 + 1013904223;
+  return (g_seed >> 8) % n;
+}
+
+static t_symbol* _bench_sym(const char* fmt, t_int32 ind) {
+
+  char str[32];
+  snprintf(str, sizeof(str), fmt, ind);
+  return gensym(str);
+}
+
+//******************************************************************************
+//  Set a value for a key: names are symbols, the other keys numbers
+//
+static void _bench_value(t_bench_gen* gen, t_symbol* key, t_atom* value) {
+
+  if ((key == gensym("name")) && !(gen->is_numeric && _bench_rand(10))) {
+    atom_setsym(value, gensym(g_words[_bench_rand(BENCH_WORD_CNT)]));
+  }
+  else if (_bench_rand(2)) { atom_setlong(value, (t_atom_long)_bench_rand(128)); }
+  else { atom_setfloat(value, _bench_rand(1000) / 100.0); }
+}
+
+static void _bench_leaf(t_bench_gen* gen, t_dictionary* dict, t_symbol* key) {
+
+  t_atom value;
+  _bench_value(gen, key, &value);
+  dictionary_appendatom(dict, key, &value);
+  gen->nodes++;
+}
+
+//******************************************************************************
+//  A dictionary of parameters: the keys of g_keys first, then numbered keys
+//
+static t_dictionary* _bench_params(t_bench_gen* gen, t_int32 cnt) {
+
+  t_dictionary* dict = dictionary_new();
+  for (t_int32 ind = 0; ind < cnt; ind++) {
+    _bench_leaf(gen, dict, (ind < BENCH_KEY_CNT) ? gensym(g_keys[ind]) : _bench_sym("p_%d", ind));
+  }
+  return dict;
+}
+
+static void _bench_fill_wide(t_bench_gen* gen) {
+
+  for (t_int32 ind = 0; gen->nodes < gen->nodes_max; ind++) {
+    t_int32 cnt = (t_int32)MIN(BENCH_WIDE_CNT, gen->nodes_max - gen->nodes);
+    dictionary_appenddictionary(gen->root, _bench_sym("group_%d", ind), (t_object*)_bench_params(gen, cnt));
+    gen->nodes++;
+  }
+}
+
+//******************************************************************************
+//  Chains of dictionaries, each level holding a few parameters and the next level
+//
+static void _bench_fill_deep(t_bench_gen* gen) {
+
+  for (t_int32 ind = 0; gen->nodes < gen->nodes_max; ind++) {
+
+    t_dictionary* parent = gen->root;
+    t_symbol* key = _bench_sym("chain_%d", ind);
+
+    for (t_int32 depth = 0; (depth < BENCH_DEEP_CNT) && (gen->nodes < gen->nodes_max); depth++) {
+      t_dictionary* dict = _bench_params(gen, 4);
+      dictionary_appenddictionary(parent, key, (t_object*)dict);
+      gen->nodes++;
+      parent = dict;
+      key = gensym("child");
+    }
+  }
+}
+
+//******************************************************************************
+//  Dictionaries holding an array of numbers, an array of names, and an array
+//  of dictionaries of parameters
+//
+static void _bench_fill_array(t_bench_gen* gen) {
+
+  t_atom atom_arr[32];
+
+  for (t_int32 ind = 0; gen->nodes < gen->nodes_max; ind++) {
+
+    t_dictionary* dict = dictionary_new();
+
+    for (t_int32 elem = 0; elem < 32; elem++) { _bench_value(gen, gensym("gain"), atom_arr + elem); }
+    dictionary_appendatomarray(dict, gensym("values"), (t_object*)atomarray_new(32, atom_arr));
+
+    for (t_int32 elem = 0; elem < 16; elem++) { _bench_value(gen, gensym("name"), atom_arr + elem); }
+    dictionary_appendatomarray(dict, gensym("names"), (t_object*)atomarray_new(16, atom_arr));
+
+    for (t_int32 elem = 0; elem < 4; elem++) { atom_setobj(atom_arr + elem, _bench_params(gen, 4)); }
+    dictionary_appendatomarray(dict, gensym("items"), (t_object*)atomarray_new(4, atom_arr));
+
+    gen->nodes += 3 + 32 + 16 + 4;
+
+    dictionary_appenddictionary(gen->root, _bench_sym("track_%d", ind), (t_object*)dict);
+    gen->nodes++;
+  }
+}
+
+//******************************************************************************
+//  Small dictionaries, with keys of a large vocabulary drawn from a Zipf
+//  distribution: a few keys are everywhere, most are rare
+//
+static t_int32 _bench_zipf(void) {
+
+  static double cdf[BENCH_VOCAB_CNT];
+
+  if (cdf[BENCH_VOCAB_CNT - 1] == 0) {
+    double sum = 0;
+    for (t_int32 ind = 0; ind < BENCH_VOCAB_CNT; ind++) { sum += 1.0 / (ind + 1); cdf[ind] = sum; }
+    for (t_int32 ind = 0; ind < BENCH_VOCAB_CNT; ind++) { cdf[ind] /= sum; }
+  }
+
+  double rnd = _bench_rand(1 << 20) / (double)(1 << 20);
+  t_int32 ind = 0;
+  while ((ind < BENCH_VOCAB_CNT - 1) && (cdf[ind] < rnd)) { ind++; }
+  return ind;
+}
+
+static void _bench_fill_skewed(t_bench_gen* gen) {
+
+  for (t_int32 ind = 0; gen->nodes < gen->nodes_max; ind++) {
+
+    t_dictionary* dict = dictionary_new();
+
+    for (t_int32 entry = 0; entry < BENCH_SKEW_CNT; entry++) {
+      t_int32 voc = _bench_zipf();
+      t_symbol* key = (voc < BENCH_KEY_CNT) ? gensym(g_keys[voc]) : _bench_sym("k_%d", voc);
+      if (!dictionary_hasentry(dict, key)) { _bench_leaf(gen, dict, key); }
+    }
+
+    dictionary_appenddictionary(gen->root, _bench_sym("node_%d", ind), (t_object*)dict);
+    gen->nodes++;
+  }
+}
+
+static const t_bench_shape g_shapes[] = {
+
+  { "wide",    _bench_fill_wide,   false },
+  { "deep",    _bench_fill_deep,   false },
+  { "array",   _bench_fill_array,  false },
+  { "numeric", _bench_fill_wide,   true },
+  { "skewed",  _bench_fill_skewed, false },
+};
+
+#define BENCH_SHAPE_CNT ((t_int32)(sizeof(g_shapes) / sizeof(g_shapes[0])))
+
+//******************************************************************************
+//  Generate the dictionary of a shape, and register it as "bench"
+//
+static t_dictionary* _bench_generate(const t_bench_shape* shape, t_int64 nodes_max, t_int64* nodes) {
+
+  t_bench_gen gen = { dictionary_new(), 0, nodes_max, shape->is_numeric };
+  t_symbol* name = gensym("bench");
+
+  g_seed = 0x5EED1234;
+  shape->fill_fct(&gen);
+
+  dictobj_register(gen.root, &name);
+  *nodes = gen.nodes;
+  return gen.root;
+}
+
+// ========  MEASURES  ========
+
+static double _bench_now_ns(void) {
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+//******************************************************************************
+//  Run a command on a shape: the times are the minimum over the runs
+//
+static void _bench_run(void* x, const t_bench_shape* shape, const t_bench_cmd* cmd, const char* batch_msg,
+  t_int64 nodes_max, t_int32 run_cnt, t_bench_res* res, t_int64* nodes) {
+
+  const char* msg = cmd->msg ? cmd->msg : batch_msg;
+
+  for (t_int32 run = 0; run < run_cnt; run++) {
+
+    t_host_mem mem_gen, mem_beg, mem_end;
+    host_mem(&mem_gen);
+
+    t_dictionary* dict = _bench_generate(shape, nodes_max, nodes);
+
+    host_mem_reset();
+    host_mem(&mem_beg);
+    res->dict_bytes = mem_beg.bytes - mem_gen.bytes;
+
+    double time_ns = _bench_now_ns();
+    host_send(x, msg);
+    time_ns = _bench_now_ns() - time_ns;
+
+    host_mem(&mem_end);
+
+    if ((run == 0) || (time_ns < res->cmd_ns)) { res->cmd_ns = time_ns; }
+    if ((run == 0) || (mem_end.bytes_peak - mem_beg.bytes > res->mem_peak)) { res->mem_peak = mem_end.bytes_peak - mem_beg.bytes; }
+    res->allocs = mem_end.alloc_cnt - mem_beg.alloc_cnt;
+
+    object_free(dict);    // NB: Unregisters it
+  }
+}
+
+// ========  MAIN  ========
+
+int main(int argc, char** argv) {
+
+  t_int64 nodes_max = 100000;
+  t_int32 run_cnt = 3;
+  const char* shape_s = NULL;
+  const char* filter_s = NULL;
+  const char* attr_arr[BENCH_ATTR_MAX];
+  t_int32 attr_cnt = 0;
+  t_bool is_verbose = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "n:r:s:f:a:vh")) != -1) {
+    switch (opt) {
+    case 'n': nodes_max = MAX(1, atoll(optarg)); break;
+    case 'r': run_cnt = MAX(1, atoi(optarg)); break;
+    case 's': shape_s = optarg; break;
+    case 'f': filter_s = optarg; break;
+    case 'a': if (attr_cnt < BENCH_ATTR_MAX) { attr_arr[attr_cnt++] = optarg; } break;
+    case 'v': is_verbose = true; break;
+    default:
+      fprintf(stderr, "Usage:  %s [-n nodes] [-r runs] [-s shape] [-f filter] [-a \"attribute value\"] [-v]\n", argv[0]);
+      return (opt == 'h') ? 0 : 1;
+    }
+  }
+
+  // The posts would break the JSON output: -v shows them, to check the commands
+  host_set_quiet(!is_verbose);
+
+  void* x = host_new((method)ext_main);
+  if (!x) { fprintf(stderr, "Unable to create the object.\n"); return 1; }
+
+  for (t_int32 ind = 0; ind < attr_cnt; ind++) { host_send(x, attr_arr[ind]); }
+  host_send(x, "async 0");
+  host_send(x, "slice 0");
+
+  // The dictionary of the replacements
+  t_symbol* repl_name = gensym("bench_repl");
+  t_dictionary* repl_dict = host_dict_parse("{ gain: 0.5, pan: 0.25, name: Cold }");
+  dictobj_register(repl_dict, &repl_name);
+
+  // The operations of the batch
+  char batch_file_s[] = "/tmp/bench_traverse_XXXXXX";
+  int batch_fd = mkstemp(batch_file_s);
+  if ((batch_fd < 0) || (write(batch_fd, g_batch_s, strlen(g_batch_s)) != (ssize_t)strlen(g_batch_s))) {
+    fprintf(stderr, "Unable to write the batch file.\n");
+    return 1;
+  }
+  close(batch_fd);
+
+  char batch_msg[64 + sizeof(batch_file_s)];
+  snprintf(batch_msg, sizeof(batch_msg), "batch bench %s", batch_file_s);
+
+  printf("{\n  \"schema\": %d,\n  \"benchmark\": \"traverse\",\n", BENCH_SCHEMA);
+  printf("  \"nodes_max\": %lld,\n  \"runs\": %d,\n  \"attributes\": [", (long long)nodes_max, run_cnt);
+  for (t_int32 ind = 0; ind < attr_cnt; ind++) { printf(ind ? ", \"%s\"" : "\"%s\"", attr_arr[ind]); }
+  printf("],\n  \"results\": [\n");
+
+  t_bool is_first = true;
+
+  for (t_int32 shape_ind = 0; shape_ind < BENCH_SHAPE_CNT; shape_ind++) {
+
+    const t_bench_shape* shape = g_shapes + shape_ind;
+    if (shape_s && strcmp(shape->name, shape_s)) { continue; }
+
+    for (t_int32 cmd_ind = 0; cmd_ind < BENCH_CMD_CNT; cmd_ind++) {
+
+      const t_bench_cmd* cmd = g_cmds + cmd_ind;
+      if (filter_s && !strstr(cmd->name, filter_s)) { continue; }
+
+      t_bench_res res = { 0, 0, 0, 0 };
+      t_int64 nodes = 0;
+      _bench_run(x, shape, cmd, batch_msg, nodes_max, run_cnt, &res, &nodes);
+
+      printf(is_first ? "" : ",\n");
+      printf("    { \"shape\": \"%s\", \"command\": \"%s\", \"nodes\": %lld, \"dict_bytes\": %lld,\n",
+        shape->name, cmd->name, (long long)nodes, (long long)res.dict_bytes);
+      printf("      \"cmd_ms\": %.3f, \"nodes_per_s\": %.0f, \"mem_peak\": %lld, \"allocs\": %lld }",
+        res.cmd_ns / 1e6, (res.cmd_ns > 0) ? (nodes * 1e9 / res.cmd_ns) : 0.0, (long long)res.mem_peak, (long long)res.allocs);
+      is_first = false;
+    }
+  }
+
+  printf("\n  ]\n}\n");
+
+  unlink(batch_file_s);
+  object_free(repl_dict);
+  host_free(x);
+  return 0;
+}
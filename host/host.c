@@ -0,0 +1,1878 @@
+#include "host.h"
+#include "ext_hashtab.h"
+#include "ext_path.h"
+#include "ext_sysfile.h"
+#include "ext_systhread.h"
+
+#include <ctype.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+// The in-memory host keeps the observable behavior of Max which the sources
+// rely on: dictionaries keep the order of their keys, a registered dictionary
+// notifies the objects attached to it when it is freed, qelems and clocks run
+// on the main thread, when host_run_queue() is called. Dictionaries and hash
+// tables are indexed by symbol pointer, so that lookups cost what they cost in
+// Max and the benchmarks measure the sources rather than the host.
+
+// ========  DEFINES  ========
+
+#define HOST_SYM_SLOTS 65536    // Buckets of the symbol table
+#define HOST_HEADER    16       // Size of the header of each allocation, keeping the alignment
+
+// ========  ENUM  ========
+
+//******************************************************************************
+//  The kinds of objects, in the header of each one
+//
+typedef enum _host_kind {
+
+  HOST_FREED,
+  HOST_INSTANCE,
+  HOST_DICT,
+  HOST_ARRAY,
+  HOST_HASHTAB,
+  HOST_OUTLET,
+  HOST_QELEM,
+  HOST_CLOCK
+
+} t_host_kind;
+
+// ========  STRUCTURES  ========
+
+typedef struct _host_symbol {
+
+  t_symbol             sym;
+  struct _host_symbol* next;
+
+} t_host_symbol;
+
+//******************************************************************************
+//  Open addressing index of an array of entries starting with their key.
+//  A removed entry keeps its place with a NULL key, until the array is compacted.
+//
+typedef struct _host_index {
+
+  t_int32* slot_arr;    // The index of each entry plus 1, 0 for an empty slot
+  t_int32  slot_max;    // A power of 2
+
+} t_host_index;
+
+struct _dictionary {
+
+  t_object            ob;
+  t_dictionary_entry* entry_arr;
+  t_int32             entry_cnt;    // The entries used, the removed ones included
+  t_int32             entry_max;
+  t_int32             dead_cnt;     // The entries removed
+  t_host_index        index;
+  t_symbol*           name;         // The registered name, or NULL
+  t_int32             retain_cnt;
+};
+
+struct _atomarray {
+
+  t_object ob;
+  t_atom*  atom_arr;
+  t_int32  atom_cnt;
+  t_int32  atom_max;
+  long     flags;
+};
+
+typedef struct _hashtab_entry {
+
+  t_symbol* key;
+  t_object* value;
+  long      flags;
+
+} t_hashtab_entry;
+
+struct _hashtab {
+
+  t_object         ob;
+  t_hashtab_entry* entry_arr;
+  t_int32          entry_cnt;    // The entries used, the removed ones included
+  t_int32          entry_max;
+  t_int32          dead_cnt;     // The entries removed
+  t_host_index     index;
+};
+
+typedef struct _host_method {
+
+  char   name[64];
+  method fct;
+  long   type;
+
+} t_host_method;
+
+typedef struct _host_attr {
+
+  char             name[64];
+  t_host_attr_type type;
+  long             offset;
+  long             size;
+  long             cnt_offset;  // For a variable size attribute
+  long             cnt_max;
+  double           min;
+  double           max;
+
+} t_host_attr;
+
+struct _class {
+
+  char           name[64];
+  method         new_fct;
+  method         free_fct;
+  long           size;
+  t_host_method* method_arr;
+  t_int32        method_cnt;
+  t_int32        method_max;
+  t_host_attr*   attr_arr;
+  t_int32        attr_cnt;
+  t_int32        attr_max;
+};
+
+typedef struct _host_outlet {
+
+  t_object ob;
+  void*    owner;
+  t_int32  order;    // In the order of creation, the first one being the rightmost
+
+} t_host_outlet;
+
+typedef struct _host_qelem {
+
+  t_object ob;
+  void*    owner;
+  method   fct;
+  t_bool   is_set;
+
+} t_host_qelem;
+
+struct _clock {
+
+  t_object ob;
+  void*    owner;
+  method   fct;
+  t_bool   is_set;
+};
+
+//******************************************************************************
+//  A pending call, run by host_run_queue()
+//
+typedef struct _host_task {
+
+  t_object*          target;    // The qelem or clock, or NULL for a deferred call
+  void*              owner;
+  method             fct;
+  t_symbol*          sym;
+  short              argc;
+  t_atom*            argv;
+  double             when;
+  struct _host_task* next;
+
+} t_host_task;
+
+typedef struct _host_attach {
+
+  void* listener;
+  void* registered;
+
+} t_host_attach;
+
+// ========  GLOBALS  ========
+
+static t_host_symbol* host_sym_arr[HOST_SYM_SLOTS];
+static pthread_mutex_t host_sym_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static t_int64 host_alloc_cnt = 0;
+static t_int64 host_bytes = 0;
+static t_int64 host_bytes_peak = 0;
+
+static pthread_mutex_t host_post_mutex = PTHREAD_MUTEX_INITIALIZER;
+static t_bool host_is_quiet = false;
+
+static t_class* host_class = NULL;
+
+static t_dictionary** host_reg_arr = NULL;
+static t_int32 host_reg_cnt = 0;
+static t_int32 host_reg_max = 0;
+
+static t_host_attach* host_attach_arr = NULL;
+static t_int32 host_attach_cnt = 0;
+static t_int32 host_attach_max = 0;
+static pthread_mutex_t host_attach_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static t_host_outlet** host_outlet_arr = NULL;
+static t_int32 host_outlet_cnt = 0;
+static t_int32 host_outlet_max = 0;
+
+static t_host_task* host_task_first = NULL;
+static pthread_mutex_t host_task_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_t host_main_thread;
+static t_bool host_has_main = false;
+
+// ====  HOST_ALLOC  ====
+
+//******************************************************************************
+//  Allocate memory, counted in the statistics of host_mem(). The size is kept
+//  in a header before the block.
+//
+static void* _host_alloc(long size, t_bool is_clear) {
+
+  char* block = is_clear ? calloc(1, HOST_HEADER + size) : malloc(HOST_HEADER + size);
+  if (!block) { return NULL; }
+
+  *(t_int64*)block = size;
+  __atomic_add_fetch(&host_alloc_cnt, 1, __ATOMIC_RELAXED);
+
+  t_int64 bytes = __atomic_add_fetch(&host_bytes, size, __ATOMIC_RELAXED);
+  t_int64 peak = __atomic_load_n(&host_bytes_peak, __ATOMIC_RELAXED);
+  while ((bytes > peak) && !__atomic_compare_exchange_n(&host_bytes_peak, &peak, bytes, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) { }
+
+  return block + HOST_HEADER;
+}
+
+static void* _host_resize(void* ptr, long size) {
+
+  if (!ptr) { return _host_alloc(size, false); }
+
+  char* block = (char*)ptr - HOST_HEADER;
+  t_int64 size_old = *(t_int64*)block;
+
+  block = realloc(block, HOST_HEADER + size);
+  if (!block) { return NULL; }
+
+  *(t_int64*)block = size;
+
+  t_int64 bytes = __atomic_add_fetch(&host_bytes, size - size_old, __ATOMIC_RELAXED);
+  t_int64 peak = __atomic_load_n(&host_bytes_peak, __ATOMIC_RELAXED);
+  while ((bytes > peak) && !__atomic_compare_exchange_n(&host_bytes_peak, &peak, bytes, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) { }
+
+  return block + HOST_HEADER;
+}
+
+static void _host_free(void* ptr) {
+
+  if (!ptr) { return; }
+
+  char* block = (char*)ptr - HOST_HEADER;
+  __atomic_sub_fetch(&host_bytes, *(t_int64*)block, __ATOMIC_RELAXED);
+  free(block);
+}
+
+//******************************************************************************
+//  Grow an array to hold one more element.
+//
+//  @return true on success.
+//
+static t_bool _host_grow(void** arr, t_int32 cnt, t_int32* max, long size) {
+
+  if (cnt < *max) { return true; }
+
+  t_int32 max_new = *max ? 2 * *max : 8;
+  void* arr_new = *arr ? _host_resize(*arr, max_new * size) : _host_alloc(max_new * size, false);
+  if (!arr_new) { return false; }
+
+  *arr = arr_new;
+  *max = max_new;
+  return true;
+}
+
+// ====  SYSMEM  ====
+
+t_ptr sysmem_newptr(long size) { return (t_ptr)_host_alloc(size, false); }
+
+t_ptr sysmem_newptrclear(long size) { return (t_ptr)_host_alloc(size, true); }
+
+t_ptr sysmem_resizeptr(void* ptr, long size) { return (t_ptr)_host_resize(ptr, size); }
+
+void sysmem_freeptr(void* ptr) { _host_free(ptr); }
+
+void sysmem_copyptr(const void* src, void* dst, long bytes) { memmove(dst, src, bytes); }
+
+//******************************************************************************
+//  Get the statistics of the memory allocated through the host.
+//
+void host_mem(t_host_mem* mem) {
+
+  mem->alloc_cnt = __atomic_load_n(&host_alloc_cnt, __ATOMIC_RELAXED);
+  mem->bytes = __atomic_load_n(&host_bytes, __ATOMIC_RELAXED);
+  mem->bytes_peak = __atomic_load_n(&host_bytes_peak, __ATOMIC_RELAXED);
+}
+
+//******************************************************************************
+//  Reset the number of allocations, and the peak to the bytes currently allocated.
+//
+void host_mem_reset(void) {
+
+  __atomic_store_n(&host_alloc_cnt, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&host_bytes_peak, __atomic_load_n(&host_bytes, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+}
+
+// ====  SYMBOLS AND ATOMS  ====
+
+t_symbol* gensym(const char* s) {
+
+  t_uint32 hash = 5381;
+  for (const char* c = s; *c; c++) { hash = hash * 33 + (unsigned char)*c; }
+  hash &= HOST_SYM_SLOTS - 1;
+
+  pthread_mutex_lock(&host_sym_mutex);
+
+  t_host_symbol* node = host_sym_arr[hash];
+  while (node && strcmp(node->sym.s_name, s)) { node = node->next; }
+
+  // Symbols are never freed, and not counted as allocations of the sources
+  if (!node) {
+    node = (t_host_symbol*)calloc(1, sizeof(t_host_symbol));
+    node->sym.s_name = strdup(s);
+    node->next = host_sym_arr[hash];
+    host_sym_arr[hash] = node;
+  }
+
+  pthread_mutex_unlock(&host_sym_mutex);
+
+  return &node->sym;
+}
+
+t_max_err atom_setsym(t_atom* a, t_symbol* s) { a->a_type = A_SYM; a->a_w.w_sym = s; return MAX_ERR_NONE; }
+
+t_max_err atom_setlong(t_atom* a, t_atom_long l) { a->a_type = A_LONG; a->a_w.w_long = l; return MAX_ERR_NONE; }
+
+t_max_err atom_setfloat(t_atom* a, double f) { a->a_type = A_FLOAT; a->a_w.w_float = f; return MAX_ERR_NONE; }
+
+t_max_err atom_setobj(t_atom* a, void* o) { a->a_type = A_OBJ; a->a_w.w_obj = (t_object*)o; return MAX_ERR_NONE; }
+
+t_symbol* atom_getsym(const t_atom* a) { return (a && (a->a_type == A_SYM)) ? a->a_w.w_sym : gensym(""); }
+
+t_atom_long atom_getlong(const t_atom* a) {
+
+  if (!a) { return 0; }
+  if (a->a_type == A_LONG) { return a->a_w.w_long; }
+  if (a->a_type == A_FLOAT) { return (t_atom_long)a->a_w.w_float; }
+  return 0;
+}
+
+t_atom_float atom_getfloat(const t_atom* a) {
+
+  if (!a) { return 0; }
+  if (a->a_type == A_FLOAT) { return a->a_w.w_float; }
+  if (a->a_type == A_LONG) { return (t_atom_float)a->a_w.w_long; }
+  return 0;
+}
+
+void* atom_getobj(const t_atom* a) { return (a && (a->a_type == A_OBJ)) ? a->a_w.w_obj : NULL; }
+
+long atom_gettype(const t_atom* a) { return a ? a->a_type : A_NOTHING; }
+
+//******************************************************************************
+//  Set an atom from a word: an int, a float, or a symbol.
+//
+static void _host_atom_parse(t_atom* a, const char* word, t_bool is_quoted) {
+
+  char* end = NULL;
+
+  if (!is_quoted && *word) {
+    long long l = strtoll(word, &end, 10);
+    if (!*end) { atom_setlong(a, (t_atom_long)l); return; }
+
+    double f = strtod(word, &end);
+    if (!*end && (isdigit((unsigned char)*word) || (*word == '-') || (*word == '.') || (*word == '+'))) {
+      atom_setfloat(a, f); return;
+    }
+  }
+
+  atom_setsym(a, gensym(word));
+}
+
+//******************************************************************************
+//  Parse a message into atoms, as Max does: words separated by spaces,
+//  double quotes grouping words into one symbol.
+//
+t_max_err atom_setparse(long* ac, t_atom** av, const char* str) {
+
+  t_int32 atom_cnt = 0;
+  t_int32 atom_max = 0;
+  t_atom* atom_arr = NULL;
+  char* word = (char*)malloc(strlen(str) + 1);
+
+  while (*str) {
+
+    while (isspace((unsigned char)*str)) { str++; }
+    if (!*str) { break; }
+
+    t_int32 len = 0;
+    t_bool is_quoted = (*str == '"');
+
+    if (is_quoted) {
+      str++;
+      while (*str && (*str != '"')) {
+        if ((*str == '\\') && str[1]) { str++; }
+        word[len++] = *str++;
+      }
+      if (*str) { str++; }
+    }
+    else {
+      while (*str && !isspace((unsigned char)*str)) { word[len++] = *str++; }
+    }
+    word[len] = '\0';
+
+    if (!_host_grow((void**)&atom_arr, atom_cnt, &atom_max, sizeof(t_atom))) { break; }
+    _host_atom_parse(atom_arr + atom_cnt++, word, is_quoted);
+  }
+
+  free(word);
+
+  *ac = atom_cnt;
+  *av = atom_arr;
+  return MAX_ERR_NONE;
+}
+
+// ====  POSTING AND STRINGS  ====
+
+static void _host_vpost(const char* prefix, const char* fmt, va_list args) {
+
+  pthread_mutex_lock(&host_post_mutex);
+  fputs(prefix, stdout);
+  vprintf(fmt, args);
+  fputc('\n', stdout);
+  fflush(stdout);
+  pthread_mutex_unlock(&host_post_mutex);
+}
+
+#define HOST_POST(_prefix, _is_quiet) do { if (_is_quiet) { break; } \
+  va_list args; va_start(args, fmt); _host_vpost(_prefix, fmt, args); va_end(args); } while (0)
+
+void post(const char* fmt, ...) { HOST_POST("", host_is_quiet); }
+
+void cpost(const char* fmt, ...) { HOST_POST("", host_is_quiet); }
+
+void error(const char* fmt, ...) { HOST_POST("ERROR: ", false); }
+
+void object_post(t_object* x, const char* fmt, ...) { HOST_POST("", host_is_quiet); }
+
+void object_warn(t_object* x, const char* fmt, ...) { HOST_POST("WARNING: ", host_is_quiet); }
+
+void object_error(t_object* x, const char* fmt, ...) { HOST_POST("ERROR: ", false); }
+
+//******************************************************************************
+//  Silence the posts and the outlets, but not the errors.
+//
+void host_set_quiet(t_bool is_quiet) { host_is_quiet = is_quiet; }
+
+char* strncpy_zero(char* dst, const char* src, long size) {
+
+  if (size <= 0) { return dst; }
+
+  long len = (long)strlen(src);
+  if (len > size - 1) { len = size - 1; }
+  memcpy(dst, src, len);
+  dst[len] = '\0';
+  return dst;
+}
+
+char* strncat_zero(char* dst, const char* src, long size) {
+
+  long len = (long)strlen(dst);
+  if (len < size - 1) { strncpy_zero(dst + len, src, size - len); }
+  return dst;
+}
+
+int snprintf_zero(char* buffer, size_t count, const char* format, ...) {
+
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buffer, count, format, args);
+  va_end(args);
+  return len;
+}
+
+// ====  DICTIONARIES  ====
+
+static t_uint32 _host_hash(t_symbol* key) { return (t_uint32)(((t_ptr_uint)key >> 4) * 2654435761u); }
+
+//******************************************************************************
+//  Find the entry of a key in an array of entries starting with their key.
+//
+//  @return The index of the entry, or -1.
+//
+static t_int32 _host_index_find(const t_host_index* index, const void* entry_arr, long stride, t_symbol* key) {
+
+  if (!index->slot_max) { return -1; }
+
+  for (t_uint32 slot = _host_hash(key) & (index->slot_max - 1); index->slot_arr[slot]; slot = (slot + 1) & (index->slot_max - 1)) {
+    t_int32 ind = index->slot_arr[slot] - 1;
+    if (*(t_symbol**)((const char*)entry_arr + ind * stride) == key) { return ind; }
+  }
+
+  return -1;
+}
+
+static void _host_index_insert(t_host_index* index, t_symbol* key, t_int32 ind) {
+
+  t_uint32 slot = _host_hash(key) & (index->slot_max - 1);
+  while (index->slot_arr[slot]) { slot = (slot + 1) & (index->slot_max - 1); }
+  index->slot_arr[slot] = ind + 1;
+}
+
+//******************************************************************************
+//  Index all the entries, sizing the index for one more. The index is never shrunk.
+//
+//  @return true on success.
+//
+static t_bool _host_index_build(t_host_index* index, const void* entry_arr, long stride, t_int32 entry_cnt) {
+
+  t_int32 slot_max = 8;
+  while (slot_max < 2 * (entry_cnt + 1)) { slot_max *= 2; }
+
+  if (slot_max > index->slot_max) {
+    t_int32* slot_arr = (t_int32*)_host_alloc(slot_max * sizeof(t_int32), false);
+    if (!slot_arr) { return false; }
+    _host_free(index->slot_arr);
+    index->slot_arr = slot_arr;
+    index->slot_max = slot_max;
+  }
+
+  memset(index->slot_arr, 0, index->slot_max * sizeof(t_int32));
+  for (t_int32 ind = 0; ind < entry_cnt; ind++) {
+    t_symbol* key = *(t_symbol**)((const char*)entry_arr + ind * stride);
+    if (key) { _host_index_insert(index, key, ind); }
+  }
+
+  return true;
+}
+
+//******************************************************************************
+//  Index the last entry of an array, growing the index if necessary.
+//
+static t_bool _host_index_add(t_host_index* index, const void* entry_arr, long stride, t_int32 entry_cnt) {
+
+  if (2 * entry_cnt > index->slot_max) { return _host_index_build(index, entry_arr, stride, entry_cnt); }
+
+  _host_index_insert(index, *(t_symbol**)((const char*)entry_arr + (entry_cnt - 1) * stride), entry_cnt - 1);
+  return true;
+}
+
+//******************************************************************************
+//  Remove an entry from the array and from the index, leaving its place with a
+//  NULL key. The slots following it are shifted back, as linear probing requires.
+//  The array is compacted once half of it is removed, so that a removal is
+//  constant in amortized time and the order of the entries is kept.
+//
+static void _host_index_remove(t_host_index* index, void* entry_arr, long stride, t_int32* entry_cnt, t_int32* dead_cnt, t_int32 ind) {
+
+  t_symbol** key_ptr = (t_symbol**)((char*)entry_arr + ind * stride);
+  t_uint32 mask = index->slot_max - 1;
+  t_uint32 slot = _host_hash(*key_ptr) & mask;
+  while (index->slot_arr[slot] != ind + 1) { slot = (slot + 1) & mask; }
+
+  for (t_uint32 next = (slot + 1) & mask; index->slot_arr[next]; next = (next + 1) & mask) {
+    t_uint32 home = _host_hash(*(t_symbol**)((char*)entry_arr + (index->slot_arr[next] - 1) * stride)) & mask;
+    if (((next - home) & mask) >= ((next - slot) & mask)) {
+      index->slot_arr[slot] = index->slot_arr[next];
+      slot = next;
+    }
+  }
+  index->slot_arr[slot] = 0;
+
+  *key_ptr = NULL;
+  (*dead_cnt)++;
+  if (2 * *dead_cnt < *entry_cnt) { return; }
+
+  t_int32 live_cnt = 0;
+  for (t_int32 src = 0; src < *entry_cnt; src++) {
+    char* entry = (char*)entry_arr + src * stride;
+    if (!*(t_symbol**)entry) { continue; }
+    if (src != live_cnt) { memcpy((char*)entry_arr + live_cnt * stride, entry, stride); }
+    live_cnt++;
+  }
+
+  *entry_cnt = live_cnt;
+  *dead_cnt = 0;
+  _host_index_build(index, entry_arr, stride, live_cnt);    // Not grown, so it cannot fail
+}
+
+static void _host_value_free(t_atom* value) {
+
+  if ((value->a_type == A_OBJ) && value->a_w.w_obj) { object_free(value->a_w.w_obj); }
+}
+
+t_dictionary* dictionary_new(void) {
+
+  t_dictionary* dict = (t_dictionary*)_host_alloc(sizeof(t_dictionary), true);
+  if (dict) { dict->ob.o_kind = HOST_DICT; }
+  return dict;
+}
+
+t_max_err dictionary_getkeys(t_dictionary* d, long* numkeys, t_symbol*** keys) {
+
+  *numkeys = d->entry_cnt - d->dead_cnt;
+  *keys = NULL;
+  if (!*numkeys) { return MAX_ERR_NONE; }
+
+  *keys = (t_symbol**)sysmem_newptr(*numkeys * sizeof(t_symbol*));
+  if (!*keys) { *numkeys = 0; return MAX_ERR_GENERIC; }
+
+  t_int32 key_cnt = 0;
+  for (t_int32 ind = 0; ind < d->entry_cnt; ind++) {
+    if (d->entry_arr[ind].key) { (*keys)[key_cnt++] = d->entry_arr[ind].key; }
+  }
+  return MAX_ERR_NONE;
+}
+
+void dictionary_freekeys(t_dictionary* d, long numkeys, t_symbol** keys) { sysmem_freeptr(keys); }
+
+t_max_err dictionary_getatom(const t_dictionary* d, t_symbol* key, t_atom* value) {
+
+  t_int32 ind = _host_index_find(&d->index, d->entry_arr, sizeof(t_dictionary_entry), key);
+  if (ind < 0) { value->a_type = A_NOTHING; return MAX_ERR_GENERIC; }
+
+  *value = d->entry_arr[ind].value;
+  return MAX_ERR_NONE;
+}
+
+long dictionary_hasentry(const t_dictionary* d, t_symbol* key) {
+
+  return _host_index_find(&d->index, d->entry_arr, sizeof(t_dictionary_entry), key) >= 0;
+}
+
+t_atom_long dictionary_getentrycount(const t_dictionary* d) { return d->entry_cnt - d->dead_cnt; }
+
+void dictionary_funall(t_dictionary* d, method fun, void* arg) {
+
+  for (t_int32 ind = 0; ind < d->entry_cnt; ind++) {
+    if (d->entry_arr[ind].key) { ((void (*)(t_dictionary_entry*, void*))fun)(d->entry_arr + ind, arg); }
+  }
+}
+
+//******************************************************************************
+//  Append an entry, or replace the value of an existing one, freeing the former
+//  value unless it is the same object.
+//
+t_max_err dictionary_appendatom(t_dictionary* d, t_symbol* key, t_atom* value) {
+
+  t_int32 ind = _host_index_find(&d->index, d->entry_arr, sizeof(t_dictionary_entry), key);
+
+  if (ind >= 0) {
+    t_atom* former = &d->entry_arr[ind].value;
+    if ((former->a_type != A_OBJ) || (value->a_type != A_OBJ) || (former->a_w.w_obj != value->a_w.w_obj)) {
+      _host_value_free(former);
+    }
+    *former = *value;
+    return MAX_ERR_NONE;
+  }
+
+  if (!_host_grow((void**)&d->entry_arr, d->entry_cnt, &d->entry_max, sizeof(t_dictionary_entry))) { return MAX_ERR_GENERIC; }
+
+  d->entry_arr[d->entry_cnt].key = key;
+  d->entry_arr[d->entry_cnt].value = *value;
+  d->entry_cnt++;
+
+  if (!_host_index_add(&d->index, d->entry_arr, sizeof(t_dictionary_entry), d->entry_cnt)) { d->entry_cnt--; return MAX_ERR_GENERIC; }
+  return MAX_ERR_NONE;
+}
+
+t_max_err dictionary_appendsym(t_dictionary* d, t_symbol* key, t_symbol* value) {
+
+  t_atom a; atom_setsym(&a, value);
+  return dictionary_appendatom(d, key, &a);
+}
+
+t_max_err dictionary_appendlong(t_dictionary* d, t_symbol* key, t_atom_long value) {
+
+  t_atom a; atom_setlong(&a, value);
+  return dictionary_appendatom(d, key, &a);
+}
+
+t_max_err dictionary_appendfloat(t_dictionary* d, t_symbol* key, double value) {
+
+  t_atom a; atom_setfloat(&a, value);
+  return dictionary_appendatom(d, key, &a);
+}
+
+t_max_err dictionary_appenddictionary(t_dictionary* d, t_symbol* key, t_object* value) {
+
+  t_atom a; atom_setobj(&a, value);
+  return dictionary_appendatom(d, key, &a);
+}
+
+t_max_err dictionary_appendatomarray(t_dictionary* d, t_symbol* key, t_object* value) {
+
+  t_atom a; atom_setobj(&a, value);
+  ((t_atomarray*)value)->flags |= ATOMARRAY_FLAG_FREECHILDREN;
+  return dictionary_appendatom(d, key, &a);
+}
+
+//******************************************************************************
+//  Remove an entry without freeing its value.
+//
+t_max_err dictionary_chuckentry(t_dictionary* d, t_symbol* key) {
+
+  t_int32 ind = _host_index_find(&d->index, d->entry_arr, sizeof(t_dictionary_entry), key);
+  if (ind < 0) { return MAX_ERR_GENERIC; }
+
+  _host_index_remove(&d->index, d->entry_arr, sizeof(t_dictionary_entry), &d->entry_cnt, &d->dead_cnt, ind);
+  return MAX_ERR_NONE;
+}
+
+t_max_err dictionary_deleteentry(t_dictionary* d, t_symbol* key) {
+
+  t_atom value;
+  if (dictionary_getatom(d, key, &value) != MAX_ERR_NONE) { return MAX_ERR_GENERIC; }
+
+  dictionary_chuckentry(d, key);
+  _host_value_free(&value);
+  return MAX_ERR_NONE;
+}
+
+t_max_err dictionary_clear(t_dictionary* d) {
+
+  for (t_int32 ind = 0; ind < d->entry_cnt; ind++) {
+    if (d->entry_arr[ind].key) { _host_value_free(&d->entry_arr[ind].value); }
+  }
+  d->entry_cnt = 0;
+  d->dead_cnt = 0;
+
+  if (d->index.slot_max) { memset(d->index.slot_arr, 0, d->index.slot_max * sizeof(t_int32)); }
+  return MAX_ERR_NONE;
+}
+
+static void _host_value_clone(t_atom* dst, const t_atom* src);
+
+//******************************************************************************
+//  Copy a dictionary, with copies of its nested dictionaries and arrays.
+//
+t_dictionary* dictionary_clone(t_dictionary* d) {
+
+  t_dictionary* clone = dictionary_new();
+  t_atom value;
+
+  for (t_int32 ind = 0; clone && (ind < d->entry_cnt); ind++) {
+    if (!d->entry_arr[ind].key) { continue; }
+    _host_value_clone(&value, &d->entry_arr[ind].value);
+    if (atomisatomarray(&value)) { dictionary_appendatomarray(clone, d->entry_arr[ind].key, value.a_w.w_obj); }
+    else { dictionary_appendatom(clone, d->entry_arr[ind].key, &value); }
+  }
+
+  return clone;
+}
+
+t_symbol* dictionary_entry_getkey(t_dictionary_entry* x) { return x->key; }
+
+void dictionary_entry_getvalue(t_dictionary_entry* x, t_atom* value) { *value = x->value; }
+
+long atomisdictionary(t_atom* a) { return (a->a_type == A_OBJ) && a->a_w.w_obj && (a->a_w.w_obj->o_kind == HOST_DICT); }
+
+long atomisatomarray(t_atom* a) { return (a->a_type == A_OBJ) && a->a_w.w_obj && (a->a_w.w_obj->o_kind == HOST_ARRAY); }
+
+long atomisstring(const t_atom* a) { return 0; }    // Strings are read as symbols
+
+// ====  ATOM ARRAYS  ====
+
+t_atomarray* atomarray_new(long ac, t_atom* av) {
+
+  t_atomarray* arr = (t_atomarray*)_host_alloc(sizeof(t_atomarray), true);
+  if (!arr) { return NULL; }
+
+  arr->ob.o_kind = HOST_ARRAY;
+  atomarray_setatoms(arr, ac, av);
+  return arr;
+}
+
+t_max_err atomarray_getatoms(t_atomarray* x, long* ac, t_atom** av) {
+
+  *ac = x->atom_cnt;
+  *av = x->atom_arr;
+  return MAX_ERR_NONE;
+}
+
+t_max_err atomarray_setatoms(t_atomarray* x, long ac, t_atom* av) {
+
+  x->atom_cnt = 0;
+  for (long ind = 0; ind < ac; ind++) { atomarray_appendatom(x, av + ind); }
+  return MAX_ERR_NONE;
+}
+
+t_atom_long atomarray_getsize(t_atomarray* x) { return x->atom_cnt; }
+
+void atomarray_appendatom(t_atomarray* x, t_atom* a) {
+
+  if (!_host_grow((void**)&x->atom_arr, x->atom_cnt, &x->atom_max, sizeof(t_atom))) { return; }
+  x->atom_arr[x->atom_cnt++] = *a;
+}
+
+//******************************************************************************
+//  Remove an atom without freeing it.
+//
+void atomarray_chuckindex(t_atomarray* x, long index) {
+
+  if ((index < 0) || (index >= x->atom_cnt)) { return; }
+
+  memmove(x->atom_arr + index, x->atom_arr + index + 1, (x->atom_cnt - index - 1) * sizeof(t_atom));
+  x->atom_cnt--;
+}
+
+void atomarray_flags(t_atomarray* x, long flags) { x->flags = flags; }
+
+static void _host_value_clone(t_atom* dst, const t_atom* src) {
+
+  *dst = *src;
+  if ((src->a_type != A_OBJ) || !src->a_w.w_obj) { return; }
+
+  if (src->a_w.w_obj->o_kind == HOST_DICT) {
+    dst->a_w.w_obj = (t_object*)dictionary_clone((t_dictionary*)src->a_w.w_obj);
+  }
+  else if (src->a_w.w_obj->o_kind == HOST_ARRAY) {
+    t_atomarray* arr = (t_atomarray*)src->a_w.w_obj;
+    t_atomarray* clone = atomarray_new(0, NULL);
+    t_atom value;
+
+    clone->flags = arr->flags;
+    for (t_int32 ind = 0; ind < arr->atom_cnt; ind++) {
+      _host_value_clone(&value, arr->atom_arr + ind);
+      atomarray_appendatom(clone, &value);
+    }
+    dst->a_w.w_obj = (t_object*)clone;
+  }
+}
+
+// ====  REGISTERED DICTIONARIES  ====
+
+t_dictionary* dictobj_register(t_dictionary* d, t_symbol** name) {
+
+  if (!*name || (*name == gensym(""))) {
+    char name_s[32];
+    snprintf(name_s, 32, "u%06i", host_reg_cnt + 1);
+    *name = gensym(name_s);
+  }
+
+  if (d->name) { return d; }
+  if (!_host_grow((void**)&host_reg_arr, host_reg_cnt, &host_reg_max, sizeof(t_dictionary*))) { return NULL; }
+
+  d->name = *name;
+  host_reg_arr[host_reg_cnt++] = d;
+  return d;
+}
+
+t_max_err dictobj_unregister(t_dictionary* d) {
+
+  for (t_int32 ind = 0; ind < host_reg_cnt; ind++) {
+    if (host_reg_arr[ind] == d) {
+      memmove(host_reg_arr + ind, host_reg_arr + ind + 1, (host_reg_cnt - ind - 1) * sizeof(t_dictionary*));
+      host_reg_cnt--;
+      d->name = NULL;
+      return MAX_ERR_NONE;
+    }
+  }
+
+  return MAX_ERR_GENERIC;
+}
+
+//******************************************************************************
+//  Find a registered dictionary, the latest one registered under the name.
+//
+t_dictionary* dictobj_findregistered_retain(t_symbol* name) {
+
+  for (t_int32 ind = host_reg_cnt - 1; ind >= 0; ind--) {
+    if (host_reg_arr[ind]->name == name) { host_reg_arr[ind]->retain_cnt++; return host_reg_arr[ind]; }
+  }
+
+  return NULL;
+}
+
+t_max_err dictobj_release(t_dictionary* d) {
+
+  if (d && (d->retain_cnt > 0)) { d->retain_cnt--; }
+  return MAX_ERR_NONE;
+}
+
+t_symbol* dictobj_namefromptr(t_dictionary* d) { return d->name; }
+
+// ====  HASH TABLES  ====
+
+t_hashtab* hashtab_new(long slotcount) {
+
+  t_hashtab* tab = (t_hashtab*)_host_alloc(sizeof(t_hashtab), true);
+  if (tab) { tab->ob.o_kind = HOST_HASHTAB; }
+  return tab;
+}
+
+t_max_err hashtab_storeflags(t_hashtab* x, t_symbol* key, t_object* val, long flags) {
+
+  t_int32 ind = _host_index_find(&x->index, x->entry_arr, sizeof(t_hashtab_entry), key);
+
+  if (ind < 0) {
+    if (!_host_grow((void**)&x->entry_arr, x->entry_cnt, &x->entry_max, sizeof(t_hashtab_entry))) { return MAX_ERR_GENERIC; }
+    ind = x->entry_cnt++;
+    x->entry_arr[ind].key = key;
+    if (!_host_index_add(&x->index, x->entry_arr, sizeof(t_hashtab_entry), x->entry_cnt)) { x->entry_cnt--; return MAX_ERR_GENERIC; }
+  }
+  else if ((x->entry_arr[ind].flags == OBJ_FLAG_OBJ) && (x->entry_arr[ind].value != val)) {
+    object_free(x->entry_arr[ind].value);
+  }
+
+  x->entry_arr[ind].value = val;
+  x->entry_arr[ind].flags = flags;
+  return MAX_ERR_NONE;
+}
+
+t_max_err hashtab_store(t_hashtab* x, t_symbol* key, t_object* val) { return hashtab_storeflags(x, key, val, OBJ_FLAG_OBJ); }
+
+t_max_err hashtab_storelong(t_hashtab* x, t_symbol* key, t_atom_long val) { return hashtab_storeflags(x, key, (t_object*)val, OBJ_FLAG_DATA); }
+
+t_max_err hashtab_lookup(t_hashtab* x, t_symbol* key, t_object** val) {
+
+  t_int32 ind = _host_index_find(&x->index, x->entry_arr, sizeof(t_hashtab_entry), key);
+  if (ind < 0) { *val = NULL; return MAX_ERR_GENERIC; }
+
+  *val = x->entry_arr[ind].value;
+  return MAX_ERR_NONE;
+}
+
+t_max_err hashtab_lookuplong(t_hashtab* x, t_symbol* key, t_atom_long* val) {
+
+  t_object* obj = NULL;
+  if (hashtab_lookup(x, key, &obj) != MAX_ERR_NONE) { return MAX_ERR_GENERIC; }
+
+  *val = (t_atom_long)obj;
+  return MAX_ERR_NONE;
+}
+
+//******************************************************************************
+//  Remove an entry without freeing its value.
+//
+t_max_err hashtab_chuckkey(t_hashtab* x, t_symbol* key) {
+
+  t_int32 ind = _host_index_find(&x->index, x->entry_arr, sizeof(t_hashtab_entry), key);
+  if (ind < 0) { return MAX_ERR_GENERIC; }
+
+  _host_index_remove(&x->index, x->entry_arr, sizeof(t_hashtab_entry), &x->entry_cnt, &x->dead_cnt, ind);
+  return MAX_ERR_NONE;
+}
+
+t_max_err hashtab_delete(t_hashtab* x, t_symbol* key) {
+
+  t_object* val = NULL;
+  t_int32 ind = _host_index_find(&x->index, x->entry_arr, sizeof(t_hashtab_entry), key);
+  if (ind < 0) { return MAX_ERR_GENERIC; }
+
+  if (x->entry_arr[ind].flags == OBJ_FLAG_OBJ) { val = x->entry_arr[ind].value; }
+  hashtab_chuckkey(x, key);
+  if (val) { object_free(val); }
+  return MAX_ERR_NONE;
+}
+
+t_max_err hashtab_clear(t_hashtab* x) {
+
+  for (t_int32 ind = 0; ind < x->entry_cnt; ind++) {
+    if (x->entry_arr[ind].key && (x->entry_arr[ind].flags == OBJ_FLAG_OBJ)) { object_free(x->entry_arr[ind].value); }
+  }
+  x->entry_cnt = 0;
+  x->dead_cnt = 0;
+
+  if (x->index.slot_max) { memset(x->index.slot_arr, 0, x->index.slot_max * sizeof(t_int32)); }
+  return MAX_ERR_NONE;
+}
+
+t_max_err hashtab_getkeys(t_hashtab* x, long* kc, t_symbol*** kv) {
+
+  *kc = x->entry_cnt - x->dead_cnt;
+  *kv = NULL;
+  if (!*kc) { return MAX_ERR_NONE; }
+
+  *kv = (t_symbol**)sysmem_newptr(*kc * sizeof(t_symbol*));
+  if (!*kv) { *kc = 0; return MAX_ERR_GENERIC; }
+
+  t_int32 key_cnt = 0;
+  for (t_int32 ind = 0; ind < x->entry_cnt; ind++) {
+    if (x->entry_arr[ind].key) { (*kv)[key_cnt++] = x->entry_arr[ind].key; }
+  }
+  return MAX_ERR_NONE;
+}
+
+t_atom_long hashtab_getsize(t_hashtab* x) { return x->entry_cnt - x->dead_cnt; }
+
+// ====  CLASSES AND OBJECTS  ====
+
+t_class* class_new(const char* name, method mnew, method mfree, long size, method mmenu, short type, ...) {
+
+  t_class* c = (t_class*)_host_alloc(sizeof(t_class), true);
+  if (!c) { return NULL; }
+
+  strncpy_zero(c->name, name, 64);
+  c->new_fct = mnew;
+  c->free_fct = mfree;
+  c->size = size;
+  return c;
+}
+
+t_max_err class_addmethod(t_class* c, method m, const char* name, ...) {
+
+  va_list args;
+  va_start(args, name);
+  long type = va_arg(args, int);
+  va_end(args);
+
+  if (!_host_grow((void**)&c->method_arr, c->method_cnt, &c->method_max, sizeof(t_host_method))) { return MAX_ERR_GENERIC; }
+
+  t_host_method* meth = c->method_arr + c->method_cnt++;
+  strncpy_zero(meth->name, name, 64);
+  meth->fct = m;
+  meth->type = type;
+  return MAX_ERR_NONE;
+}
+
+t_max_err class_register(t_symbol* name_space, t_class* c) {
+
+  host_class = c;
+  return MAX_ERR_NONE;
+}
+
+void host_attr_new(t_class* c, const char* name, t_host_attr_type type, long offset, long size, long cnt_offset, long cnt_max) {
+
+  if (!_host_grow((void**)&c->attr_arr, c->attr_cnt, &c->attr_max, sizeof(t_host_attr))) { return; }
+
+  t_host_attr* attr = c->attr_arr + c->attr_cnt++;
+  strncpy_zero(attr->name, name, 64);
+  attr->type = type;
+  attr->offset = offset;
+  attr->size = size;
+  attr->cnt_offset = cnt_offset;
+  attr->cnt_max = cnt_max;
+  attr->min = -1e300;
+  attr->max = 1e300;
+}
+
+void host_attr_filter(t_class* c, const char* name, double min, double max) {
+
+  for (t_int32 ind = 0; ind < c->attr_cnt; ind++) {
+    if (!strcmp(c->attr_arr[ind].name, name)) { c->attr_arr[ind].min = min; c->attr_arr[ind].max = max; }
+  }
+}
+
+static t_host_method* _host_method_find(t_class* c, const char* name) {
+
+  for (t_int32 ind = 0; ind < c->method_cnt; ind++) {
+    if (!strcmp(c->method_arr[ind].name, name)) { return c->method_arr + ind; }
+  }
+
+  return NULL;
+}
+
+void* object_alloc(t_class* c) {
+
+  t_object* x = (t_object*)_host_alloc(c->size, true);
+  if (!x) { return NULL; }
+
+  x->o_kind = HOST_INSTANCE;
+  x->o_class = c;
+  return x;
+}
+
+static void _host_detach_all(void* x);
+
+//******************************************************************************
+//  Free an object of any kind. A retained dictionary is not freed, and
+//  a freed dictionary notifies the objects attached to it.
+//
+t_max_err object_free(void* x) {
+
+  t_object* ob = (t_object*)x;
+  if (!ob) { return MAX_ERR_NONE; }
+
+  switch (ob->o_kind) {
+
+  case HOST_INSTANCE:
+    if (ob->o_class->free_fct) { ((void (*)(void*))ob->o_class->free_fct)(x); }
+    _host_detach_all(x);
+    for (t_int32 ind = host_outlet_cnt - 1; ind >= 0; ind--) {
+      if (host_outlet_arr[ind]->owner != x) { continue; }
+      _host_free(host_outlet_arr[ind]);
+      host_outlet_arr[ind] = host_outlet_arr[--host_outlet_cnt];
+    }
+    break;
+
+  case HOST_DICT: {
+    t_dictionary* dict = (t_dictionary*)x;
+    if (dict->retain_cnt > 0) { return MAX_ERR_NONE; }
+
+    object_notify(dict, gensym("free"), NULL);
+    _host_detach_all(x);
+    if (dict->name) { dictobj_unregister(dict); }
+    dictionary_clear(dict);
+    _host_free(dict->entry_arr);
+    _host_free(dict->index.slot_arr);
+    break;
+  }
+
+  case HOST_ARRAY: {
+    t_atomarray* arr = (t_atomarray*)x;
+    if (arr->flags & ATOMARRAY_FLAG_FREECHILDREN) {
+      for (t_int32 ind = 0; ind < arr->atom_cnt; ind++) { _host_value_free(arr->atom_arr + ind); }
+    }
+    _host_free(arr->atom_arr);
+    break;
+  }
+
+  case HOST_HASHTAB: {
+    t_hashtab* tab = (t_hashtab*)x;
+    hashtab_clear(tab);
+    _host_free(tab->entry_arr);
+    _host_free(tab->index.slot_arr);
+    break;
+  }
+
+  case HOST_QELEM: qelem_free(x); return MAX_ERR_NONE;
+  case HOST_CLOCK: clock_unset(x); break;
+  default: break;
+  }
+
+  ob->o_kind = HOST_FREED;
+  _host_free(x);
+  return MAX_ERR_NONE;
+}
+
+void freeobject(t_object* x) { object_free(x); }
+
+// ====  NOTIFICATIONS  ====
+
+t_max_err object_attach_byptr(void* x, void* registered) {
+
+  pthread_mutex_lock(&host_attach_mutex);
+
+  t_int32 ind = 0;
+  while ((ind < host_attach_cnt) && ((host_attach_arr[ind].listener != x) || (host_attach_arr[ind].registered != registered))) { ind++; }
+
+  if ((ind == host_attach_cnt) && _host_grow((void**)&host_attach_arr, host_attach_cnt, &host_attach_max, sizeof(t_host_attach))) {
+    host_attach_arr[host_attach_cnt].listener = x;
+    host_attach_arr[host_attach_cnt].registered = registered;
+    host_attach_cnt++;
+  }
+
+  pthread_mutex_unlock(&host_attach_mutex);
+  return MAX_ERR_NONE;
+}
+
+t_max_err object_detach_byptr(void* x, void* registered) {
+
+  pthread_mutex_lock(&host_attach_mutex);
+
+  for (t_int32 ind = 0; ind < host_attach_cnt; ind++) {
+    if ((host_attach_arr[ind].listener == x) && (host_attach_arr[ind].registered == registered)) {
+      host_attach_arr[ind] = host_attach_arr[--host_attach_cnt];
+      break;
+    }
+  }
+
+  pthread_mutex_unlock(&host_attach_mutex);
+  return MAX_ERR_NONE;
+}
+
+//******************************************************************************
+//  Remove the attachments of an object freed, as a listener or as a sender.
+//
+static void _host_detach_all(void* x) {
+
+  pthread_mutex_lock(&host_attach_mutex);
+
+  for (t_int32 ind = host_attach_cnt - 1; ind >= 0; ind--) {
+    if ((host_attach_arr[ind].listener == x) || (host_attach_arr[ind].registered == x)) {
+      host_attach_arr[ind] = host_attach_arr[--host_attach_cnt];
+    }
+  }
+
+  pthread_mutex_unlock(&host_attach_mutex);
+}
+
+//******************************************************************************
+//  Call the notify method of the objects attached to an object. The listeners
+//  are collected first, since a listener may detach itself.
+//
+t_max_err object_notify(void* x, t_symbol* msg, void* data) {
+
+  void* listener_arr[64];
+  t_int32 listener_cnt = 0;
+
+  pthread_mutex_lock(&host_attach_mutex);
+  for (t_int32 ind = 0; (ind < host_attach_cnt) && (listener_cnt < 64); ind++) {
+    if (host_attach_arr[ind].registered == x) { listener_arr[listener_cnt++] = host_attach_arr[ind].listener; }
+  }
+  pthread_mutex_unlock(&host_attach_mutex);
+
+  for (t_int32 ind = 0; ind < listener_cnt; ind++) {
+    t_object* listener = (t_object*)listener_arr[ind];
+    if ((listener->o_kind != HOST_INSTANCE) || !listener->o_class) { continue; }
+
+    t_host_method* meth = _host_method_find(listener->o_class, "notify");
+    if (meth) {
+      ((t_max_err (*)(void*, t_symbol*, t_symbol*, void*, void*))meth->fct)(listener, gensym("nobox"), msg, x, data);
+    }
+  }
+
+  return MAX_ERR_NONE;
+}
+
+// ====  OUTLETS  ====
+
+void* outlet_new(void* x, const char* s) {
+
+  t_host_outlet* outlet = (t_host_outlet*)_host_alloc(sizeof(t_host_outlet), true);
+  if (!outlet) { return NULL; }
+  if (!_host_grow((void**)&host_outlet_arr, host_outlet_cnt, &host_outlet_max, sizeof(t_host_outlet*))) { _host_free(outlet); return NULL; }
+
+  outlet->ob.o_kind = HOST_OUTLET;
+  outlet->owner = x;
+  for (t_int32 ind = 0; ind < host_outlet_cnt; ind++) { outlet->order += (host_outlet_arr[ind]->owner == x); }
+
+  host_outlet_arr[host_outlet_cnt++] = outlet;
+  return outlet;
+}
+
+void* bangout(void* x) { return outlet_new(x, "bang"); }
+
+void* intout(void* x) { return outlet_new(x, "int"); }
+
+//******************************************************************************
+//  Number an outlet as Max does, from 0 for the leftmost one, which is the last created.
+//
+static t_int32 _host_outlet_index(t_host_outlet* outlet) {
+
+  t_int32 index = -1;
+  for (t_int32 ind = 0; ind < host_outlet_cnt; ind++) { index += (host_outlet_arr[ind]->owner == outlet->owner); }
+  return index - outlet->order;
+}
+
+//******************************************************************************
+//  Print a message out of an outlet:  [out0] match int gain 1 d presets
+//
+static void _host_outlet_print(void* o, const char* sel, short ac, t_atom* av) {
+
+  if (host_is_quiet || !o) { return; }
+
+  pthread_mutex_lock(&host_post_mutex);
+
+  printf("[out%i] %s", _host_outlet_index((t_host_outlet*)o), sel);
+  for (short ind = 0; ind < ac; ind++) {
+    if (av[ind].a_type == A_SYM) { printf(" %s", av[ind].a_w.w_sym->s_name); }
+    else if (av[ind].a_type == A_LONG) { printf(" %lld", (long long)av[ind].a_w.w_long); }
+    else if (av[ind].a_type == A_FLOAT) { printf(" %g", av[ind].a_w.w_float); }
+    else { printf(" <obj>"); }
+  }
+  printf("\n");
+  fflush(stdout);
+
+  pthread_mutex_unlock(&host_post_mutex);
+}
+
+void* outlet_bang(void* o) { _host_outlet_print(o, "bang", 0, NULL); return NULL; }
+
+void* outlet_int(void* o, t_atom_long n) {
+
+  char str[32];
+  snprintf(str, 32, "%lld", (long long)n);
+  _host_outlet_print(o, str, 0, NULL);
+  return NULL;
+}
+
+void* outlet_float(void* o, double f) {
+
+  char str[32];
+  snprintf(str, 32, "%g", f);
+  _host_outlet_print(o, str, 0, NULL);
+  return NULL;
+}
+
+void* outlet_list(void* o, t_symbol* s, short ac, t_atom* av) { _host_outlet_print(o, "list", ac, av); return NULL; }
+
+void* outlet_anything(void* o, t_symbol* s, short ac, t_atom* av) { _host_outlet_print(o, s->s_name, ac, av); return NULL; }
+
+// ====  SCHEDULER  ====
+
+double systimer_gettime(void) {
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+t_uint32 gettime(void) { return (t_uint32)systimer_gettime(); }
+
+//******************************************************************************
+//  Queue a call for the main thread, after the calls already queued.
+//
+static void _host_task_push(t_object* target, void* owner, method fct, t_symbol* sym, short argc, t_atom* argv, double delay) {
+
+  t_host_task* task = (t_host_task*)calloc(1, sizeof(t_host_task));
+  if (!task) { return; }
+
+  task->target = target;
+  task->owner = owner;
+  task->fct = fct;
+  task->sym = sym;
+  task->when = systimer_gettime() + delay;
+  if (argc) {
+    task->argv = (t_atom*)malloc(argc * sizeof(t_atom));
+    memcpy(task->argv, argv, argc * sizeof(t_atom));
+    task->argc = argc;
+  }
+
+  pthread_mutex_lock(&host_task_mutex);
+  t_host_task** last = &host_task_first;
+  while (*last) { last = &(*last)->next; }
+  *last = task;
+  pthread_mutex_unlock(&host_task_mutex);
+}
+
+//******************************************************************************
+//  Remove the queued calls to a qelem or clock.
+//
+static void _host_task_remove(t_object* target) {
+
+  pthread_mutex_lock(&host_task_mutex);
+
+  for (t_host_task** task = &host_task_first; *task; ) {
+    if ((*task)->target != target) { task = &(*task)->next; continue; }
+
+    t_host_task* next = (*task)->next;
+    free((*task)->argv);
+    free(*task);
+    *task = next;
+  }
+
+  pthread_mutex_unlock(&host_task_mutex);
+}
+
+void* qelem_new(void* obj, method fn) {
+
+  t_host_qelem* q = (t_host_qelem*)_host_alloc(sizeof(t_host_qelem), true);
+  if (!q) { return NULL; }
+
+  q->ob.o_kind = HOST_QELEM;
+  q->owner = obj;
+  q->fct = fn;
+  return q;
+}
+
+void qelem_set(void* q) {
+
+  t_host_qelem* qelem = (t_host_qelem*)q;
+  if (__atomic_exchange_n(&qelem->is_set, true, __ATOMIC_ACQ_REL)) { return; }
+
+  _host_task_push(&qelem->ob, qelem->owner, qelem->fct, NULL, 0, NULL, 0);
+}
+
+void qelem_unset(void* q) {
+
+  __atomic_store_n(&((t_host_qelem*)q)->is_set, false, __ATOMIC_RELEASE);
+  _host_task_remove((t_object*)q);
+}
+
+void qelem_free(void* q) {
+
+  _host_task_remove((t_object*)q);
+  ((t_object*)q)->o_kind = HOST_FREED;
+  _host_free(q);
+}
+
+t_clock* clock_new(void* obj, method fn) {
+
+  t_clock* c = (t_clock*)_host_alloc(sizeof(t_clock), true);
+  if (!c) { return NULL; }
+
+  c->ob.o_kind = HOST_CLOCK;
+  c->owner = obj;
+  c->fct = fn;
+  return c;
+}
+
+void clock_fdelay(void* c, double ms) {
+
+  t_clock* clock = (t_clock*)c;
+  clock_unset(clock);
+  clock->is_set = true;
+  _host_task_push(&clock->ob, clock->owner, clock->fct, NULL, 0, NULL, ms);
+}
+
+void clock_delay(void* c, long ms) { clock_fdelay(c, (double)ms); }
+
+void clock_unset(void* c) {
+
+  ((t_clock*)c)->is_set = false;
+  _host_task_remove((t_object*)c);
+}
+
+void* defer(void* ob, method fn, t_symbol* sym, short argc, t_atom* argv) {
+
+  if (systhread_ismainthread()) { ((void (*)(void*, t_symbol*, short, t_atom*))fn)(ob, sym, argc, argv); }
+  else { _host_task_push(NULL, ob, fn, sym, argc, argv, 0); }
+  return NULL;
+}
+
+void* defer_low(void* ob, method fn, t_symbol* sym, short argc, t_atom* argv) {
+
+  _host_task_push(NULL, ob, fn, sym, argc, argv, 0);
+  return NULL;
+}
+
+//******************************************************************************
+//  Run the queued calls which are due, on the calling thread, as the main thread
+//  of Max does, then wait for more of them until none is queued for a while.
+//
+//  @param idle_ms The time to wait for calls from other threads, in ms, after the queue is empty.
+//
+//  @return The number of calls run.
+//
+t_int32 host_run_queue(t_int32 idle_ms) {
+
+  t_int32 run_cnt = 0;
+  double idle_end = systimer_gettime() + idle_ms;
+
+  while (true) {
+
+    double now = systimer_gettime();
+    t_bool is_pending = false;
+    t_host_task* task = NULL;
+
+    pthread_mutex_lock(&host_task_mutex);
+    for (t_host_task** prev = &host_task_first; *prev; prev = &(*prev)->next) {
+      if ((*prev)->when <= now) { task = *prev; *prev = task->next; break; }
+    }
+    is_pending = (host_task_first != NULL);
+    pthread_mutex_unlock(&host_task_mutex);
+
+    if (!task) {
+      if (!is_pending && (now >= idle_end)) { break; }
+      usleep(200);
+      continue;
+    }
+
+    // A qelem or clock is unset before its function is called, so that it can set itself again
+    if (task->target && (task->target->o_kind == HOST_QELEM)) {
+      __atomic_store_n(&((t_host_qelem*)task->target)->is_set, false, __ATOMIC_RELEASE);
+      ((void (*)(void*))task->fct)(task->owner);
+    }
+    else if (task->target) {
+      ((t_clock*)task->target)->is_set = false;
+      ((void (*)(void*))task->fct)(task->owner);
+    }
+    else {
+      ((void (*)(void*, t_symbol*, short, t_atom*))task->fct)(task->owner, task->sym, task->argc, task->argv);
+    }
+
+    free(task->argv);
+    free(task);
+    run_cnt++;
+    idle_end = systimer_gettime() + idle_ms;
+  }
+
+  return run_cnt;
+}
+
+// ====  THREADS  ====
+
+long systhread_create(method entryproc, void* arg, long stacksize, long priority, long flags, t_systhread* thread) {
+
+  pthread_t* th = (pthread_t*)malloc(sizeof(pthread_t));
+  if (!th) { return 1; }
+
+  if (pthread_create(th, NULL, (void* (*)(void*))entryproc, arg)) { free(th); return 1; }
+
+  *thread = th;
+  return 0;
+}
+
+long systhread_join(t_systhread thread, unsigned int* retval) {
+
+  void* ret = NULL;
+  pthread_join(*(pthread_t*)thread, &ret);
+  free(thread);
+
+  if (retval) { *retval = 0; }
+  return 0;
+}
+
+void systhread_exit(long status) { pthread_exit(NULL); }
+
+short systhread_ismainthread(void) {
+
+  if (!host_has_main) { host_main_thread = pthread_self(); host_has_main = true; }
+  return pthread_equal(host_main_thread, pthread_self()) != 0;
+}
+
+long systhread_mutex_new(t_systhread_mutex* pmutex, long flags) {
+
+  pthread_mutex_t* mutex = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
+  if (!mutex) { return 1; }
+
+  pthread_mutex_init(mutex, NULL);
+  *pmutex = mutex;
+  return 0;
+}
+
+long systhread_mutex_free(t_systhread_mutex pmutex) {
+
+  pthread_mutex_destroy((pthread_mutex_t*)pmutex);
+  free(pmutex);
+  return 0;
+}
+
+long systhread_mutex_lock(t_systhread_mutex pmutex) { return pthread_mutex_lock((pthread_mutex_t*)pmutex); }
+
+long systhread_mutex_unlock(t_systhread_mutex pmutex) { return pthread_mutex_unlock((pthread_mutex_t*)pmutex); }
+
+// ====  FILES  ====
+
+short path_getdefault(void) { return 0; }
+
+short path_frompotentialpathname(const char* name, short* path, char* filename) {
+
+  if ((name[0] != '/') && (name[0] != '.')) { return 1; }
+
+  *path = 0;
+  strncpy_zero(filename, name, MAX_PATH_CHARS);
+  return 0;
+}
+
+short locatefile_extended(char* name, short* outvol, t_fourcc* outtype, const t_fourcc* filetypelist, short numtypes) {
+
+  *outvol = 0;
+  if (outtype) { *outtype = 0; }
+  return access(name, R_OK) ? 1 : 0;
+}
+
+short path_opensysfile(const char* name, short path, t_filehandle* ref, short perm) {
+
+  FILE* file = fopen(name, (perm == READ_PERM) ? "rb" : "rb+");
+  *ref = (t_filehandle)file;
+  return file ? 0 : 1;
+}
+
+t_max_err path_createsysfile(const char* name, short path, t_fourcc type, t_filehandle* ref) {
+
+  FILE* file = fopen(name, "wb+");
+  *ref = (t_filehandle)file;
+  return file ? MAX_ERR_NONE : MAX_ERR_GENERIC;
+}
+
+t_max_err sysfile_close(t_filehandle f) { return fclose((FILE*)f) ? MAX_ERR_GENERIC : MAX_ERR_NONE; }
+
+t_max_err sysfile_read(t_filehandle f, t_ptr_size* count, void* bufptr) {
+
+  *count = fread(bufptr, 1, *count, (FILE*)f);
+  return ferror((FILE*)f) ? MAX_ERR_GENERIC : MAX_ERR_NONE;
+}
+
+t_max_err sysfile_write(t_filehandle f, t_ptr_size* count, const void* bufptr) {
+
+  t_ptr_size len = *count;
+  *count = fwrite(bufptr, 1, len, (FILE*)f);
+  return (*count == len) ? MAX_ERR_NONE : MAX_ERR_GENERIC;
+}
+
+t_max_err sysfile_geteof(t_filehandle f, t_ptr_size* logeof) {
+
+  long pos = ftell((FILE*)f);
+  fseek((FILE*)f, 0, SEEK_END);
+  *logeof = (t_ptr_size)ftell((FILE*)f);
+  fseek((FILE*)f, pos, SEEK_SET);
+  return MAX_ERR_NONE;
+}
+
+// ====  HOST_NEW  ====
+
+//******************************************************************************
+//  Create an instance of an external, initializing its class on the first call.
+//  The calling thread becomes the main thread.
+//
+//  @param main_fct The ext_main() function of the external.
+//
+//  @return The instance, or NULL on failure.
+//
+void* host_new(method main_fct) {
+
+  if (!host_has_main) { host_main_thread = pthread_self(); host_has_main = true; }
+  if (!host_class) { ((void (*)(void*))main_fct)(NULL); }
+  if (!host_class) { return NULL; }
+
+  return ((void* (*)(t_symbol*, long, t_atom*))host_class->new_fct)(gensym(host_class->name), 0, NULL);
+}
+
+void host_free(void* x) { object_free(x); }
+
+//******************************************************************************
+//  Send a message to an instance, as parsed atoms: set an attribute, or call
+//  the method of the selector, or the anything method.
+//
+void host_send_args(void* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  t_class* c = ((t_object*)x)->o_class;
+
+  for (t_int32 ind = 0; ind < c->attr_cnt; ind++) {
+
+    t_host_attr* attr = c->attr_arr + ind;
+    if (strcmp(attr->name, sym->s_name)) { continue; }
+
+    char* member = (char*)x + attr->offset;
+    double num = MAX(attr->min, MIN(attr->max, atom_getfloat(argv)));
+
+    switch (attr->type) {
+    case HOST_ATTR_CHAR: *member = (char)num; break;
+    case HOST_ATTR_LONG:
+      if (attr->size == sizeof(t_int32)) { *(t_int32*)member = (t_int32)num; }
+      else { *(t_atom_long*)member = (t_atom_long)num; }
+      break;
+    case HOST_ATTR_DOUBLE: *(double*)member = num; break;
+    case HOST_ATTR_SYM: *(t_symbol**)member = atom_getsym(argv); break;
+    case HOST_ATTR_SYM_VARSIZE:
+      argc = MIN(argc, attr->cnt_max);
+      for (long arg = 0; arg < argc; arg++) { ((t_symbol**)member)[arg] = atom_getsym(argv + arg); }
+      *(long*)((char*)x + attr->cnt_offset) = argc;
+      break;
+    }
+    return;
+  }
+
+  t_host_method* meth = _host_method_find(c, sym->s_name);
+
+  if (!meth) {
+    meth = _host_method_find(c, "anything");
+    if (!meth) { object_error((t_object*)x, "%s: doesn't understand \"%s\"", c->name, sym->s_name); return; }
+    ((void (*)(void*, t_symbol*, long, t_atom*))meth->fct)(x, sym, argc, argv);
+    return;
+  }
+
+  switch (meth->type) {
+  case A_GIMME: ((void (*)(void*, t_symbol*, long, t_atom*))meth->fct)(x, sym, argc, argv); break;
+  case A_SYM: ((void (*)(void*, t_symbol*))meth->fct)(x, atom_getsym(argv)); break;
+  case A_LONG: ((void (*)(void*, t_atom_long))meth->fct)(x, atom_getlong(argv)); break;
+  case A_FLOAT: ((void (*)(void*, double))meth->fct)(x, atom_getfloat(argv)); break;
+  default: ((void (*)(void*))meth->fct)(x); break;
+  }
+}
+
+//******************************************************************************
+//  Send a message to an instance, as typed in a message box.
+//
+void host_send(void* x, const char* msg) {
+
+  long argc = 0;
+  t_atom* argv = NULL;
+  atom_setparse(&argc, &argv, msg);
+
+  if (argc && (atom_gettype(argv) == A_SYM)) { host_send_args(x, atom_getsym(argv), argc - 1, argv + 1); }
+  else if (argc) { object_error((t_object*)x, "host: A message starts with a selector."); }
+
+  sysmem_freeptr(argv);
+}
+
+// ====  HOST_DICT_PARSE  ====
+
+//******************************************************************************
+//  JSON reader, as Max reads dictionaries, also accepting words without quotes
+//  and missing commas, to write dictionaries inline:  { a: [ 1, 2.5, foo ] }
+//  Strings and the literals true, false and null are read as symbols.
+//
+typedef struct _host_parse {
+
+  const char* p;
+  char*       word;
+  t_int32     word_max;
+  t_bool      is_error;
+
+} t_host_parse;
+
+static void _host_parse_space(t_host_parse* ps) {
+
+  while (isspace((unsigned char)*ps->p) || (*ps->p == ',')) { ps->p++; }
+}
+
+//******************************************************************************
+//  Read a word or a quoted string into ps->word.
+//
+//  @return true if the word was quoted.
+//
+static t_bool _host_parse_word(t_host_parse* ps) {
+
+  t_int32 len = 0;
+  t_bool is_quoted = (*ps->p == '"');
+
+  if (is_quoted) { ps->p++; }
+
+  while (*ps->p && (is_quoted ? (*ps->p != '"') : !strchr(" \t\r\n,:]}", *ps->p))) {
+
+    char c = *ps->p++;
+    if (is_quoted && (c == '\\') && *ps->p) {
+      c = *ps->p++;
+      if (c == 'n') { c = '\n'; } else if (c == 't') { c = '\t'; } else if (c == 'r') { c = '\r'; }
+    }
+
+    if (len + 1 >= ps->word_max) {
+      ps->word_max = ps->word_max ? 2 * ps->word_max : 256;
+      ps->word = (char*)realloc(ps->word, ps->word_max);
+    }
+    ps->word[len++] = c;
+  }
+
+  if (is_quoted) {
+    if (*ps->p != '"') { ps->is_error = true; }
+    else { ps->p++; }
+  }
+
+  if (!ps->word) { ps->word_max = 256; ps->word = (char*)malloc(ps->word_max); }
+  ps->word[len] = '\0';
+  return is_quoted;
+}
+
+static t_dictionary* _host_parse_dict(t_host_parse* ps);
+
+static void _host_parse_value(t_host_parse* ps, t_atom* value) {
+
+  _host_parse_space(ps);
+
+  if (*ps->p == '{') { atom_setobj(value, _host_parse_dict(ps)); }
+
+  else if (*ps->p == '[') {
+
+    t_atomarray* arr = atomarray_new(0, NULL);
+    t_atom child;
+    arr->flags = ATOMARRAY_FLAG_FREECHILDREN;
+    ps->p++;
+
+    while (!ps->is_error) {
+      _host_parse_space(ps);
+      if (*ps->p == ']') { ps->p++; break; }
+      if (!*ps->p) { ps->is_error = true; break; }
+      _host_parse_value(ps, &child);
+      atomarray_appendatom(arr, &child);
+    }
+
+    atom_setobj(value, arr);
+  }
+
+  else if (!*ps->p || strchr(":]}", *ps->p)) { ps->is_error = true; atom_setsym(value, gensym("")); }
+
+  else {
+    t_bool is_quoted = _host_parse_word(ps);
+    _host_atom_parse(value, ps->word, is_quoted);
+  }
+}
+
+static t_dictionary* _host_parse_dict(t_host_parse* ps) {
+
+  t_dictionary* dict = dictionary_new();
+  t_atom value;
+
+  ps->p++;    // Skip the {
+
+  while (!ps->is_error) {
+
+    _host_parse_space(ps);
+    if (*ps->p == '}') { ps->p++; break; }
+    if (!*ps->p) { ps->is_error = true; break; }
+
+    _host_parse_word(ps);
+    t_symbol* key = gensym(ps->word);
+
+    _host_parse_space(ps);
+    if (*ps->p != ':') { ps->is_error = true; break; }
+    ps->p++;
+
+    _host_parse_value(ps, &value);
+
+    if (atomisatomarray(&value)) { dictionary_appendatomarray(dict, key, value.a_w.w_obj); }
+    else { dictionary_appendatom(dict, key, &value); }
+  }
+
+  return dict;
+}
+
+//******************************************************************************
+//  Build a dictionary from JSON text.
+//
+//  @return The dictionary, or NULL on a syntax error.
+//
+t_dictionary* host_dict_parse(const char* text) {
+
+  t_host_parse ps = { text, NULL, 0, false };
+
+  _host_parse_space(&ps);
+  if (*ps.p != '{') { return NULL; }
+
+  t_dictionary* dict = _host_parse_dict(&ps);
+  free(ps.word);
+
+  if (ps.is_error) { object_free(dict); return NULL; }
+  return dict;
+}
+
+//******************************************************************************
+//  Build a dictionary from a JSON file.
+//
+//  @return The dictionary, or NULL if the file cannot be read or on a syntax error.
+//
+t_dictionary* host_dict_read(const char* file_s) {
+
+  FILE* file = fopen(file_s, "rb");
+  if (!file) { return NULL; }
+
+  fseek(file, 0, SEEK_END);
+  long len = ftell(file);
+  fseek(file, 0, SEEK_SET);
+
+  char* text = (char*)malloc(len + 1);
+  long len_read = text ? (long)fread(text, 1, len, file) : 0;
+  fclose(file);
+  if (!text) { return NULL; }
+
+  text[len_read] = '\0';
+  t_dictionary* dict = host_dict_parse(text);
+  free(text);
+  return dict;
+}
+
+static void _host_print_value(t_atom* value, FILE* out);
+
+static void _host_print_dict(t_dictionary* dict, FILE* out) {
+
+  t_bool is_first = true;
+  fputc('{', out);
+  for (t_int32 ind = 0; ind < dict->entry_cnt; ind++) {
+    if (!dict->entry_arr[ind].key) { continue; }
+    fprintf(out, "%s%s:", is_first ? "" : ",", dict->entry_arr[ind].key->s_name);
+    _host_print_value(&dict->entry_arr[ind].value, out);
+    is_first = false;
+  }
+  fputc('}', out);
+}
+
+static void _host_print_value(t_atom* value, FILE* out) {
+
+  if (atomisdictionary(value)) { _host_print_dict((t_dictionary*)value->a_w.w_obj, out); }
+
+  else if (atomisatomarray(value)) {
+    t_atomarray* arr = (t_atomarray*)value->a_w.w_obj;
+    fputc('[', out);
+    for (t_int32 ind = 0; ind < arr->atom_cnt; ind++) {
+      if (ind) { fputc(',', out); }
+      _host_print_value(arr->atom_arr + ind, out);
+    }
+    fputc(']', out);
+  }
+
+  else if (value->a_type == A_SYM) { fputs(value->a_w.w_sym->s_name, out); }
+  else if (value->a_type == A_LONG) { fprintf(out, "%lld", (long long)value->a_w.w_long); }
+  else if (value->a_type == A_FLOAT) { fprintf(out, "%g", value->a_w.w_float); }
+}
+
+//******************************************************************************
+//  Print a dictionary on one line, in the relaxed syntax of host_dict_parse().
+//
+void host_dict_print(t_dictionary* dict, FILE* out) {
+
+  _host_print_dict(dict, out);
+  fputc('\n', out);
+  fflush(out);
+}
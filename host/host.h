@@ -0,0 +1,47 @@
+#ifndef YC_HOST_H_
+#define YC_HOST_H_
+
+// ========  HEADER FILE FOR THE IN-MEMORY MAX HOST: DRIVER INTERFACE  ========
+//
+// What Max does around an external, for the programs built on Linux:
+// creating an instance, sending it messages, running the scheduler, and
+// building dictionaries. The posts and the outlets are printed on stdout.
+
+#include "ext.h"
+#include "ext_obex.h"
+#include "ext_dictionary.h"
+#include "ext_dictobj.h"
+
+// ========  STRUCTURES  ========
+
+//******************************************************************************
+//  Memory allocated through the host: sysmem, dictionaries, atom arrays, hash tables
+//
+typedef struct _host_mem {
+
+  t_int64 alloc_cnt;    // Number of allocations, resizes excluded
+  t_int64 bytes;        // Bytes currently allocated
+  t_int64 bytes_peak;   // Maximum of bytes since the last host_mem_reset()
+
+} t_host_mem;
+
+// ========  FUNCTION DECLARATIONS  ========
+
+void* host_new       (method main_fct);
+void  host_send      (void* x, const char* msg);
+void  host_send_args (void* x, t_symbol* sym, long argc, t_atom* argv);
+void  host_free      (void* x);
+
+t_int32 host_run_queue (t_int32 idle_ms);
+void    host_set_quiet (t_bool is_quiet);
+
+t_dictionary* host_dict_parse (const char* text);
+t_dictionary* host_dict_read  (const char* file_s);
+void          host_dict_print (t_dictionary* dict, FILE* out);
+
+void host_mem       (t_host_mem* mem);
+void host_mem_reset (void);
+
+// ========  END OF HEADER FILE  ========
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef YC_HOST_EXT_H_
+#define YC_HOST_EXT_H_
+
+// ========  HEADER FILE FOR THE IN-MEMORY MAX HOST: TYPES, ATOMS, MEMORY AND POSTING  ========
+//
+// The host directory implements the part of the Max API used by the sources,
+// so that they can be built on Linux, without the Max SDK, for profiling and
+// benchmarking. Only what the sources call is declared, with the signatures of
+// the SDK. The headers keep the names of the SDK headers, so that the sources
+// build unchanged: this directory must never be on the include path of the
+// Max builds.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdbool.h>
+
+// ========  TYPES  ========
+
+typedef int8_t   t_int8;
+typedef uint8_t  t_uint8;
+typedef int16_t  t_int16;
+typedef uint16_t t_uint16;
+typedef int32_t  t_int32;
+typedef uint32_t t_uint32;
+typedef int64_t  t_int64;
+typedef uint64_t t_uint64;
+
+typedef intptr_t  t_ptr_int;
+typedef uintptr_t t_ptr_uint;
+typedef size_t    t_ptr_size;
+typedef t_ptr_int t_int;
+typedef char*     t_ptr;
+
+typedef t_ptr_int t_atom_long;
+typedef double    t_atom_float;
+typedef double    t_double;
+typedef float     t_float;
+typedef t_uint32  t_fourcc;
+typedef int       t_bool;
+typedef long      t_max_err;
+
+typedef void* (*method)();
+
+#define MAX_ERR_NONE     0
+#define MAX_ERR_GENERIC -1
+
+#define C74_EXPORT
+
+#ifndef TRUE
+#define TRUE  1
+#define FALSE 0
+#endif
+
+#ifndef MAX
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+#define MAX_PATH_CHARS     2048
+#define MAX_FILENAME_CHARS 512
+
+// ========  OBJECTS, SYMBOLS AND ATOMS  ========
+
+//******************************************************************************
+//  The header of every object of the host, to tell them apart in object_free()
+//
+typedef struct _object {
+
+  t_int32        o_kind;    // From t_host_kind, in host.c
+  struct _class* o_class;   // The class of the instances of a registered class
+
+} t_object;
+
+typedef struct _symbol {
+
+  char*     s_name;
+  t_object* s_thing;
+
+} t_symbol;
+
+enum {
+  A_NOTHING = 0, A_LONG, A_FLOAT, A_SYM, A_OBJ, A_DEFLONG, A_DEFFLOAT, A_DEFSYM,
+  A_GIMME, A_CANT, A_SEMI, A_COMMA, A_DOLLAR, A_DOLLSYM, A_GIMMEBACK
+};
+
+union word {
+
+  t_atom_long  w_long;
+  t_atom_float w_float;
+  t_symbol*    w_sym;
+  t_object*    w_obj;
+};
+
+typedef struct _atom {
+
+  short      a_type;
+  union word a_w;
+
+} t_atom;
+
+t_symbol* gensym (const char* s);
+
+t_max_err    atom_setsym   (t_atom* a, t_symbol* s);
+t_max_err    atom_setlong  (t_atom* a, t_atom_long l);
+t_max_err    atom_setfloat (t_atom* a, double f);
+t_max_err    atom_setobj   (t_atom* a, void* o);
+t_symbol*    atom_getsym   (const t_atom* a);
+t_atom_long  atom_getlong  (const t_atom* a);
+t_atom_float atom_getfloat (const t_atom* a);
+void*        atom_getobj   (const t_atom* a);
+long         atom_gettype  (const t_atom* a);
+
+t_max_err atom_setparse (long* ac, t_atom** av, const char* str);
+
+// ========  MEMORY  ========
+
+t_ptr sysmem_newptr      (long size);
+t_ptr sysmem_newptrclear (long size);
+t_ptr sysmem_resizeptr   (void* ptr, long size);
+void  sysmem_freeptr     (void* ptr);
+void  sysmem_copyptr     (const void* src, void* dst, long bytes);
+
+// ========  POSTING AND STRINGS  ========
+
+void post         (const char* fmt, ...);
+void cpost        (const char* fmt, ...);
+void error        (const char* fmt, ...);
+void object_post  (t_object* x, const char* fmt, ...);
+void object_warn  (t_object* x, const char* fmt, ...);
+void object_error (t_object* x, const char* fmt, ...);
+
+char* strncpy_zero  (char* dst, const char* src, long size);
+char* strncat_zero  (char* dst, const char* src, long size);
+int   snprintf_zero (char* buffer, size_t count, const char* format, ...);
+
+// ========  OUTLETS  ========
+
+#define ASSIST_INLET  1
+#define ASSIST_OUTLET 2
+
+void* outlet_new      (void* x, const char* s);
+void* bangout         (void* x);
+void* intout          (void* x);
+void* outlet_bang     (void* o);
+void* outlet_int      (void* o, t_atom_long n);
+void* outlet_float    (void* o, double f);
+void* outlet_list     (void* o, t_symbol* s, short ac, t_atom* av);
+void* outlet_anything (void* o, t_symbol* s, short ac, t_atom* av);
+
+// ========  SCHEDULER  ========
+
+typedef void* t_qelem;
+typedef struct _clock t_clock;
+
+void* qelem_new   (void* obj, method fn);
+void  qelem_set   (void* q);
+void  qelem_unset (void* q);
+void  qelem_free  (void* q);
+
+t_clock* clock_new    (void* obj, method fn);
+void     clock_delay  (void* c, long ms);
+void     clock_fdelay (void* c, double ms);
+void     clock_unset  (void* c);
+
+void* defer     (void* ob, method fn, t_symbol* sym, short argc, t_atom* argv);
+void* defer_low (void* ob, method fn, t_symbol* sym, short argc, t_atom* argv);
+
+double   systimer_gettime (void);
+t_uint32 gettime          (void);
+
+// ========  END OF HEADER FILE  ========
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef YC_HOST_EXT_ATOMIC_H_
+#define YC_HOST_EXT_ATOMIC_H_
+
+// ========  HEADER FILE FOR THE IN-MEMORY MAX HOST: ATOMIC OPERATIONS  ========
+
+#include "ext.h"
+
+typedef volatile t_int32 t_int32_atomic;
+
+#define ATOMIC_INCREMENT(p)          __atomic_add_fetch((p), 1, __ATOMIC_RELAXED)
+#define ATOMIC_DECREMENT(p)          __atomic_sub_fetch((p), 1, __ATOMIC_RELAXED)
+#define ATOMIC_INCREMENT_BARRIER(p)  __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define ATOMIC_DECREMENT_BARRIER(p)  __atomic_sub_fetch((p), 1, __ATOMIC_SEQ_CST)
+
+// ========  END OF HEADER FILE  ========
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef YC_HOST_EXT_DICTIONARY_H_
+#define YC_HOST_EXT_DICTIONARY_H_
+
+// ========  HEADER FILE FOR THE IN-MEMORY MAX HOST: DICTIONARIES AND ATOM ARRAYS  ========
+
+#include "ext.h"
+#include "ext_obex.h"
+#include "ext_hashtab.h"
+
+// ========  STRUCTURES  ========
+
+typedef struct _dictionary t_dictionary;
+typedef struct _atomarray  t_atomarray;
+
+typedef struct _dictionary_entry {
+
+  t_symbol* key;
+  t_atom    value;
+
+} t_dictionary_entry;
+
+#define ATOMARRAY_FLAG_FREECHILDREN 1
+
+// ========  FUNCTION DECLARATIONS  ========
+
+t_dictionary* dictionary_new (void);
+
+t_max_err   dictionary_getkeys       (t_dictionary* d, long* numkeys, t_symbol*** keys);
+void        dictionary_freekeys      (t_dictionary* d, long numkeys, t_symbol** keys);
+t_max_err   dictionary_getatom       (const t_dictionary* d, t_symbol* key, t_atom* value);
+long        dictionary_hasentry      (const t_dictionary* d, t_symbol* key);
+t_atom_long dictionary_getentrycount (const t_dictionary* d);
+void        dictionary_funall        (t_dictionary* d, method fun, void* arg);
+
+t_max_err dictionary_appendatom       (t_dictionary* d, t_symbol* key, t_atom* value);
+t_max_err dictionary_appendsym        (t_dictionary* d, t_symbol* key, t_symbol* value);
+t_max_err dictionary_appendlong       (t_dictionary* d, t_symbol* key, t_atom_long value);
+t_max_err dictionary_appendfloat      (t_dictionary* d, t_symbol* key, double value);
+t_max_err dictionary_appenddictionary (t_dictionary* d, t_symbol* key, t_object* value);
+t_max_err dictionary_appendatomarray  (t_dictionary* d, t_symbol* key, t_object* value);
+t_max_err dictionary_chuckentry       (t_dictionary* d, t_symbol* key);
+t_max_err dictionary_deleteentry      (t_dictionary* d, t_symbol* key);
+t_max_err dictionary_clear            (t_dictionary* d);
+t_dictionary* dictionary_clone        (t_dictionary* d);
+
+t_symbol* dictionary_entry_getkey   (t_dictionary_entry* x);
+void      dictionary_entry_getvalue (t_dictionary_entry* x, t_atom* value);
+
+long atomisdictionary (t_atom* a);
+long atomisatomarray  (t_atom* a);
+long atomisstring     (const t_atom* a);
+
+t_atomarray* atomarray_new        (long ac, t_atom* av);
+t_max_err    atomarray_getatoms   (t_atomarray* x, long* ac, t_atom** av);
+t_max_err    atomarray_setatoms   (t_atomarray* x, long ac, t_atom* av);
+t_atom_long  atomarray_getsize    (t_atomarray* x);
+void         atomarray_appendatom (t_atomarray* x, t_atom* a);
+void         atomarray_chuckindex (t_atomarray* x, long index);
+void         atomarray_flags      (t_atomarray* x, long flags);
+
+// ========  END OF HEADER FILE  ========
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef YC_HOST_EXT_DICTOBJ_H_
+#define YC_HOST_EXT_DICTOBJ_H_
+
+// ========  HEADER FILE FOR THE IN-MEMORY MAX HOST: REGISTERED DICTIONARIES  ========
+
+#include "ext_dictionary.h"
+
+t_dictionary* dictobj_register              (t_dictionary* d, t_symbol** name);
+t_max_err     dictobj_unregister            (t_dictionary* d);
+t_dictionary* dictobj_findregistered_retain (t_symbol* name);
+t_max_err     dictobj_release               (t_dictionary* d);
+t_symbol*     dictobj_namefromptr           (t_dictionary* d);
+
+// ========  END OF HEADER FILE  ========
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef YC_HOST_EXT_HASHTAB_H_
+#define YC_HOST_EXT_HASHTAB_H_
+
+// ========  HEADER FILE FOR THE IN-MEMORY MAX HOST: HASH TABLES  ========
+
+#include "ext.h"
+
+typedef struct _hashtab t_hashtab;
+
+#define OBJ_FLAG_OBJ    0   // The value is freed with the table
+#define OBJ_FLAG_REF    1
+#define OBJ_FLAG_DATA   2   // The value is not freed
+
+t_hashtab*  hashtab_new        (long slotcount);
+t_max_err   hashtab_store      (t_hashtab* x, t_symbol* key, t_object* val);
+t_max_err   hashtab_storeflags (t_hashtab* x, t_symbol* key, t_object* val, long flags);
+t_max_err   hashtab_storelong  (t_hashtab* x, t_symbol* key, t_atom_long val);
+t_max_err   hashtab_lookup     (t_hashtab* x, t_symbol* key, t_object** val);
+t_max_err   hashtab_lookuplong (t_hashtab* x, t_symbol* key, t_atom_long* val);
+t_max_err   hashtab_chuckkey   (t_hashtab* x, t_symbol* key);
+t_max_err   hashtab_delete     (t_hashtab* x, t_symbol* key);
+t_max_err   hashtab_clear      (t_hashtab* x);
+t_max_err   hashtab_getkeys    (t_hashtab* x, long* kc, t_symbol*** kv);
+t_atom_long hashtab_getsize    (t_hashtab* x);
+
+// ========  END OF HEADER FILE  ========
+
+#endif
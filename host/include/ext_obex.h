@@ -0,0 +1,68 @@
+#ifndef YC_HOST_EXT_OBEX_H_
+#define YC_HOST_EXT_OBEX_H_
+
+// ========  HEADER FILE FOR THE IN-MEMORY MAX HOST: CLASSES AND ATTRIBUTES  ========
+
+#include "ext.h"
+
+// ========  CLASSES  ========
+
+typedef struct _class t_class;
+
+#define CLASS_BOX   gensym("box")
+#define CLASS_NOBOX gensym("nobox")
+
+t_class*  class_new       (const char* name, method mnew, method mfree, long size, method mmenu, short type, ...);
+t_max_err class_addmethod (t_class* c, method m, const char* name, ...);
+t_max_err class_register  (t_symbol* name_space, t_class* c);
+
+void*     object_alloc   (t_class* c);
+t_max_err object_free    (void* x);
+void      freeobject     (t_object* x);
+
+t_max_err object_attach_byptr (void* x, void* registered);
+t_max_err object_detach_byptr (void* x, void* registered);
+t_max_err object_notify       (void* x, t_symbol* msg, void* data);
+
+// ========  ATTRIBUTES  ========
+
+//******************************************************************************
+//  The types of the attributes, set by host_send() as messages named after them
+//
+typedef enum _host_attr_type {
+
+  HOST_ATTR_CHAR,
+  HOST_ATTR_LONG,
+  HOST_ATTR_DOUBLE,
+  HOST_ATTR_SYM,
+  HOST_ATTR_SYM_VARSIZE
+
+} t_host_attr_type;
+
+void host_attr_new    (t_class* c, const char* name, t_host_attr_type type, long offset, long size, long cnt_offset, long cnt_max);
+void host_attr_filter (t_class* c, const char* name, double min, double max);
+
+#define _HOST_ATTR(c, name, type, s, member) \
+  host_attr_new(c, name, type, (long)offsetof(s, member), (long)sizeof(((s*)0)->member), -1, 1)
+
+#define CLASS_ATTR_CHAR(c, name, flags, s, member)   _HOST_ATTR(c, name, HOST_ATTR_CHAR, s, member)
+#define CLASS_ATTR_LONG(c, name, flags, s, member)   _HOST_ATTR(c, name, HOST_ATTR_LONG, s, member)
+#define CLASS_ATTR_DOUBLE(c, name, flags, s, member) _HOST_ATTR(c, name, HOST_ATTR_DOUBLE, s, member)
+#define CLASS_ATTR_SYM(c, name, flags, s, member)    _HOST_ATTR(c, name, HOST_ATTR_SYM, s, member)
+
+#define CLASS_ATTR_SYM_VARSIZE(c, name, flags, s, member, cnt, cnt_max) \
+  host_attr_new(c, name, HOST_ATTR_SYM_VARSIZE, (long)offsetof(s, member), (long)sizeof(t_symbol*), (long)offsetof(s, cnt), cnt_max)
+
+#define CLASS_ATTR_FILTER_MIN(c, name, min)        host_attr_filter(c, name, min, 1e300)
+#define CLASS_ATTR_FILTER_CLIP(c, name, min, max)  host_attr_filter(c, name, min, max)
+
+// Only used by the inspector of the patcher
+#define CLASS_ATTR_STYLE(c, name, flags, style)               ((void)0)
+#define CLASS_ATTR_STYLE_LABEL(c, name, flags, style, label)  ((void)0)
+#define CLASS_ATTR_LABEL(c, name, flags, label)               ((void)0)
+#define CLASS_ATTR_ENUMINDEX(c, name, flags, items)           ((void)0)
+#define CLASS_ATTR_SAVE(c, name, flags)                       ((void)0)
+
+// ========  END OF HEADER FILE  ========
+
+#endif
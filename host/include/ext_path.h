@@ -0,0 +1,25 @@
+#ifndef YC_HOST_EXT_PATH_H_
+#define YC_HOST_EXT_PATH_H_
+
+// ========  HEADER FILE FOR THE IN-MEMORY MAX HOST: FILE PATHS  ========
+//
+// There is no search path: every file name is a native path, relative to the
+// working directory, and every path id is 0.
+
+#include "ext.h"
+
+typedef struct _filehandle* t_filehandle;
+
+#define READ_PERM       1
+#define WRITE_PERM      2
+#define READ_WRITE_PERM 3
+
+short     path_getdefault            (void);
+short     path_frompotentialpathname (const char* name, short* path, char* filename);
+short     locatefile_extended        (char* name, short* outvol, t_fourcc* outtype, const t_fourcc* filetypelist, short numtypes);
+short     path_opensysfile           (const char* name, short path, t_filehandle* ref, short perm);
+t_max_err path_createsysfile         (const char* name, short path, t_fourcc type, t_filehandle* ref);
+
+// ========  END OF HEADER FILE  ========
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef YC_HOST_EXT_SYSFILE_H_
+#define YC_HOST_EXT_SYSFILE_H_
+
+// ========  HEADER FILE FOR THE IN-MEMORY MAX HOST: FILES  ========
+
+#include "ext_path.h"
+
+t_max_err sysfile_close  (t_filehandle f);
+t_max_err sysfile_read   (t_filehandle f, t_ptr_size* count, void* bufptr);
+t_max_err sysfile_write  (t_filehandle f, t_ptr_size* count, const void* bufptr);
+t_max_err sysfile_geteof (t_filehandle f, t_ptr_size* logeof);
+
+// ========  END OF HEADER FILE  ========
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef YC_HOST_EXT_SYSTHREAD_H_
+#define YC_HOST_EXT_SYSTHREAD_H_
+
+// ========  HEADER FILE FOR THE IN-MEMORY MAX HOST: THREADS  ========
+
+#include "ext.h"
+
+typedef void* t_systhread;
+typedef void* t_systhread_mutex;
+
+#define SYSTHREAD_MUTEX_NORMAL 0
+
+long systhread_create (method entryproc, void* arg, long stacksize, long priority, long flags, t_systhread* thread);
+long systhread_join   (t_systhread thread, unsigned int* retval);
+void systhread_exit   (long status);
+
+short systhread_ismainthread (void);
+
+long systhread_mutex_new    (t_systhread_mutex* pmutex, long flags);
+long systhread_mutex_free   (t_systhread_mutex pmutex);
+long systhread_mutex_lock   (t_systhread_mutex pmutex);
+long systhread_mutex_unlock (t_systhread_mutex pmutex);
+
+// ========  END OF HEADER FILE  ========
+
+#endif
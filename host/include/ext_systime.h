@@ -0,0 +1,10 @@
+#ifndef YC_HOST_EXT_SYSTIME_H_
+#define YC_HOST_EXT_SYSTIME_H_
+
+// ========  HEADER FILE FOR THE IN-MEMORY MAX HOST: TIME  ========
+//
+// systimer_gettime() and gettime() are declared in ext.h.
+
+#include "ext.h"
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef YC_HOST_Z_DSP_H_
+#define YC_HOST_Z_DSP_H_
+
+// ========  HEADER FILE FOR THE IN-MEMORY MAX HOST: MSP  ========
+//
+// Only included by the sources for t_double, declared in ext.h.
+
+#include "ext.h"
+
+#endif
@@ -0,0 +1,90 @@
+#include "host.h"
+
+#include <unistd.h>
+
+// Command line driver of y.dict.recurse on the in-memory host, to run it
+// under perf, valgrind or the sanitizers:
+//
+//   dict_recurse_shell -d d=presets.json "verbose 1" "find key d gain"
+//   dict_recurse_shell -D "d={ a: { gain: 1 } }" < messages.txt
+//
+// Each argument after the options, or else each line of stdin, is a message.
+// The line "~" runs the scheduler queue until no call is queued for 50 ms,
+// so that the async commands complete, "= d" prints the dictionary "d", and
+// lines starting with "#" are ignored. The queue is run again at the end.
+
+void ext_main(void* r);
+
+//******************************************************************************
+//  Register a dictionary from an option:  name=file  or  name=text
+//
+static int _shell_dict(const char* arg, t_bool is_file) {
+
+  const char* eq = strchr(arg, '=');
+  if (!eq || (eq == arg)) { fprintf(stderr, "Invalid dictionary option:  %s\n", arg); return 1; }
+
+  char name_s[256];
+  long len = MIN((long)(eq - arg), 255);
+  memcpy(name_s, arg, len);
+  name_s[len] = '\0';
+
+  t_dictionary* dict = is_file ? host_dict_read(eq + 1) : host_dict_parse(eq + 1);
+  if (!dict) { fprintf(stderr, "Unable to read the dictionary \"%s\".\n", name_s); return 1; }
+
+  t_symbol* name = gensym(name_s);
+  dictobj_register(dict, &name);
+  return 0;
+}
+
+static void _shell_line(void* x, const char* line) {
+
+  while (*line == ' ') { line++; }
+
+  if (!*line || (*line == '#')) { return; }
+  if (!strcmp(line, "~")) { host_run_queue(50); return; }
+
+  if (*line == '=') {
+    while (*++line == ' ') { }
+    t_dictionary* dict = dictobj_findregistered_retain(gensym(line));
+    if (!dict) { printf("= %s:  no such dictionary\n", line); return; }
+    printf("= ");
+    host_dict_print(dict, stdout);
+    dictobj_release(dict);
+    return;
+  }
+
+  host_send(x, line);
+}
+
+int main(int argc, char** argv) {
+
+  int opt;
+  while ((opt = getopt(argc, argv, "d:D:qh")) != -1) {
+    switch (opt) {
+    case 'd': if (_shell_dict(optarg, true)) { return 1; } break;
+    case 'D': if (_shell_dict(optarg, false)) { return 1; } break;
+    case 'q': host_set_quiet(true); break;
+    default:
+      fprintf(stderr, "Usage:  %s [-d name=file.json] [-D name=json] [-q] [message ...]\n", argv[0]);
+      return (opt == 'h') ? 0 : 1;
+    }
+  }
+
+  void* x = host_new((method)ext_main);
+  if (!x) { fprintf(stderr, "Unable to create the object.\n"); return 1; }
+
+  if (optind < argc) {
+    for (int ind = optind; ind < argc; ind++) { _shell_line(x, argv[ind]); }
+  }
+  else {
+    char line[4096];
+    while (fgets(line, sizeof(line), stdin)) {
+      line[strcspn(line, "\r\n")] = '\0';
+      _shell_line(x, line);
+    }
+  }
+
+  host_run_queue(50);
+  host_free(x);
+  return 0;
+}
@@ -8,7 +8,7 @@
 
 // TO DO:
 //   Check string length
-//   Simulate, all, clean empty, depth
+//   Simulate, all, clean empty
 //   Remove dynamic allocation for regexpr
 //   Systematize replace entry vs from replace_dict
 
@@ -20,8 +20,25 @@
 
 #include "ext_dictionary.h"
 #include "ext_dictobj.h"
+#include "ext_systime.h"
+#include "ext_path.h"
+#include "ext_sysfile.h"
+
+#include <stdarg.h>
 
 #include "regexpr.h"
+#include "pathexpr.h"
+#include "keyindex.h"
+#include "editlog.h"
+#include "workpool.h"
+#include "numpred.h"
+#include "dicttmpl.h"
+#include "resultcache.h"
+#include "journal.h"
+#include "jsonstream.h"
+#include "snapshot.h"
+#include "walkstats.h"
+#include "tracebuf.h"
 
 // ========  MACROS  ========
 
@@ -38,10 +55,36 @@
 #define MY_ASSERT(test, err, ...) if (test) { object_error((t_object*)x, __VA_ARGS__); return err; }
 #define MY_ASSERT_GOTO(test, label, ...) if (test) { object_error((t_object*)x, __VA_ARGS__); goto label; }
 
+#define WALK_POST(...) do { if (_POST) _dict_recurse_post(x, w, __VA_ARGS__); } while (0)
+
+#define WALK_MATCH(_value, ...) do { if (x->a_output == OUTPUT_LIST) { _dict_recurse_result(x, w, _value); } \
+  else { WALK_POST(__VA_ARGS__); } } while (0)
+
+// Count the tests of the search key and value, and their hits, in the stats of the traversal
+#define KEY_TRY(_test) (w->stats.key_try_cnt++, (_test) ? (w->stats.key_hit_cnt++, TRACE_HIT("key match"), true) : false)
+#define VAL_TRY(_test) (w->stats.val_try_cnt++, (_test) ? (w->stats.val_hit_cnt++, TRACE_HIT("value match"), true) : false)
+#define TRACE_HIT(_name) (w->trace_lane ? tracebuf_event(w->trace_lane, 'i', "regex", _name, w->key_iter) : (void)0)
+
+#define LOG_EDIT(_call) do { TRACEBUF_EVENT(w->trace_lane, 'i', "edit", "edit", w->key_iter);\
+  if ((_call) != ERR_NONE) { MY_ERR("Allocation error for the edit log."); } } while (0)
+#define LOG_JOURNAL(_call) do { if ((_call) != ERR_NONE) { MY_ERR("Allocation error for the undo journal."); } } while (0)
+
 // ========  DEFINES  ========
 
 #define MAX_LEN_PATH   1000  // Maximum message size
 #define MAX_LEN_NUMBER 50    // Maximum string length for numbers
+#define MAX_LEN_POST   2100  // Maximum length of a buffered post
+
+#define TASK_PER_THREAD 8    // Tasks aimed for per thread in a parallel traversal
+#define TASK_SPLIT_MAX  8    // Maximum number of levels split into tasks
+
+#define FRAME_CNT_INI   16   // Initial size of the traversal stack
+#define ENTRY_CNT_INI   256  // Initial size of the entry buffer
+#define SEG_PRE_MAX     (TASK_SPLIT_MAX + 1)    // Maximum number of path segments above the traversal stack
+#define SLICE_CHECK_CNT 64   // Steps between two checks of the time budget of a slice
+#define BATCH_OP_MAX    64   // Maximum number of operations in a batch, one bit each in has_match
+#define BATCH_LINE_MAX  256  // Maximum number of atoms in one operation of a batch
+#define MULTI_MAX       1024 // Maximum number of candidate dictionaries for the multi-dictionary commands
 
 // ========  TYPEDEF AND CONST GLOBAL VARIABLES  ========
 
@@ -57,21 +100,32 @@ typedef enum _command {
   CMD_FIND_VALUE_SYM,
   CMD_FIND_ENTRY,
   CMD_FIND_DICT_CONT_ENTRY,
+  CMD_FIND_NUMBER,
   CMD_REPLACE_KEY,
   CMD_REPLACE_VALUE_SYM,
   CMD_REPLACE_ENTRY,
   CMD_REPLACE_DICT_CONT_ENTRY,
   CMD_REPLACE_VALUE_FROM_DICT,
+  CMD_REPLACE_NUMBER,
   CMD_APPEND_IN_DICT_CONT_ENTRY,
   CMD_APPEND_IN_DICT_CONT_ENTRY_D,
   CMD_APPEND_IN_DICT_FROM_KEY,
   CMD_DELETE_KEY,
   CMD_DELETE_VALUE_SYM,
   CMD_DELETE_ENTRY,
-  CMD_DELETE_DICT_CONT_ENTRY
+  CMD_DELETE_DICT_CONT_ENTRY,
+  CMD_DELETE_NUMBER,
+  CMD_BATCH
 
 } t_command;
 
+#define CMD_IS_FIND(_cmd) (((_cmd) >= CMD_ALL) && ((_cmd) <= CMD_FIND_NUMBER))
+
+#define CMD_IS_NUMBER(_cmd) (((_cmd) == CMD_FIND_NUMBER) || ((_cmd) == CMD_REPLACE_NUMBER) || ((_cmd) == CMD_DELETE_NUMBER))
+
+#define CMD_IS_DICT_CONT(_cmd) (((_cmd) == CMD_FIND_DICT_CONT_ENTRY) || ((_cmd) == CMD_REPLACE_DICT_CONT_ENTRY) \
+  || ((_cmd) == CMD_DELETE_DICT_CONT_ENTRY) || ((_cmd) == CMD_APPEND_IN_DICT_CONT_ENTRY) || ((_cmd) == CMD_APPEND_IN_DICT_CONT_ENTRY_D))
+
 //******************************************************************************
 //  The different types of values
 //
@@ -91,27 +145,77 @@ typedef enum _value_type {
 
 //******************************************************************************
 //  Return value used by _dict_recurse_value() to indicate
-//  when a value was deleted in an array
+//  when a value was deleted in an array.
+//  The value is only removed when the array is compacted, after the loop.
 //
 typedef enum _value_del {
 
   VALUE_NO_DEL,
-  VALUE_DEL
+  VALUE_DEL,
+  VALUE_REPLACED    // Kept, but replaced, so not stepped into
 
 } t_value_del;
 
+//******************************************************************************
+//  How the matches of find and all are output
+//
+typedef enum _output {
+
+  OUTPUT_POST,    // One line per match in the Max console
+  OUTPUT_LIST     // One message per match, out of the message outlet at the end of the command
+
+} t_output;
+
 // ========  STRUCTURE DECLARATION  ========
 
-typedef struct _dict_recurse {
+//******************************************************************************
+//  One dictionary entry, read with its value in a single pass
+//
+typedef struct _entry {
 
-  t_object ob;
+  t_symbol* key;
+  t_atom    value;
 
-  void* outl_dict;    // Outlet 0: dictionaries
-  void* outl_mess;    // Outlet 1: messages
-  void* outl_bang;    // Outlet 2: bang on completion
+} t_entry;
+
+//******************************************************************************
+//  One level of the traversal stack: the loop through a dictionary or an array,
+//  with the trailing state to restore when it ends.
+//
+typedef struct _frame {
+
+  t_value_type type;          // VALUE_TYPE_DICT or VALUE_TYPE_ARRAY
+  t_int32      depth;         // Depth of the values in the loop
+  t_int32      ind;
+  t_int32      cnt;
+  t_bool       is_pending;    // The value at ind was entered, and has to be closed
+  t_int32      test;          // For arrays, the result for the pending value
 
-  t_symbol*     dict_sym;
   t_dictionary* dict;
+  t_int32       entry_ofs;    // Offset of the entries in the entry buffer of the traversal
+
+  t_atomarray* atomarray;
+  t_atom*      atom_arr;
+  t_int32      keep_cnt;      // Number of values kept, for the compaction
+
+  t_value_type  type_iter;    // The trailing state on entering the loop
+  t_dictionary* dict_iter;
+  t_symbol*     key_iter;
+  t_atomarray*  array_iter;
+  t_int32       index_iter;
+  t_path_state  path_state;
+  t_bool        is_selected;
+  t_uint64      has_match;
+  t_int32       path_len;
+  t_int32       edit_ini;
+
+} t_frame;
+
+//******************************************************************************
+//  Trailing state of one traversal. The object holds the main one,
+//  and each task of a parallel traversal has its own.
+//
+typedef struct _walk {
 
   t_value_type  type_iter;
   t_dictionary* dict_iter;
@@ -122,9 +226,119 @@ typedef struct _dict_recurse {
   char* path;
   char  str_tmp[MAX_LEN_NUMBER];
 
-  t_int32 path_len_max;
+  t_int32  count;
+  t_uint64 has_match;         // One bit per operation, for find key and key_in
+  t_bool   is_edited;         // Set when an operation of a batch edited the key of the entry whose value is next
+
+  t_path_state path_state;    // Trailing state of the path selector
+  t_bool       is_selected;   // Whether the current entry matches the path selector
+
+  char*   out_buf;            // Posts buffered until the end of a parallel or asynchronous traversal, or NULL
+  t_int32 out_len;
+  t_int32 out_max;
+
+  t_int32      depth_cut;     // Depth of the dictionaries not to enter, 0 for none
+  t_bool       is_cut;        // Set when a dictionary was not entered, with the state it was reached with:
+  t_path_state cut_path_state;
+  t_bool       cut_is_selected;
+  t_uint64     cut_has_match;
+
+  t_frame* frame_arr;         // Traversal stack, so that a traversal can be suspended and resumed
+  t_int32  frame_cnt;
+  t_int32  frame_max;
+  t_int32  node_cnt;          // Number of entries and array values visited, for the progress
+
+  t_entry*   entry_buf;       // Entries of the dictionaries on the stack, reused from one dictionary to the next
+  t_int32    entry_len;
+  t_int32    entry_max;
+  t_int32    read_cnt;        // Number of dictionaries read, for verbose output
+  t_int32    alloc_cnt;       // Number of allocations of the stack and key buffer, for verbose output
+
+  t_atom  seg_arr[SEG_PRE_MAX]; // Path segments above the traversal stack: the dictionary name, and keys for a parallel task
+  t_int32 seg_cnt;
+
+  t_atom* res_arr;            // Matches recorded for list output, each one preceded by its length
+  t_int32 res_len;
+  t_int32 res_max;
+
+  t_walkstats stats;          // Work counters of the traversal, the atoms being counted by node_cnt
+  t_trace_lane* trace_lane;   // Lane recording the events of the traversal, or NULL when the trace is off
+
+} t_walk;
+
+//******************************************************************************
+//  One task of a parallel traversal: a range of keys in a dictionary
+//
+typedef struct _task {
+
+  t_dictionary* dict;
+  t_symbol**    key_arr;      // The keys of dict, shared by the tasks of the same dictionary
+  long          key_cnt;      // Set for the task which frees key_arr, otherwise 0
+  t_int32       key_beg;
+  t_int32       key_end;
+  t_int32       depth;
+  t_bool        is_head;      // Already run, its dictionary value is split into the next tasks
+
+  t_walk walk;
+
+} t_task;
+
+//******************************************************************************
+//  One operation of a batch, with the arguments of its command.
+//  They are swapped in and out of the object around each node.
+//
+typedef struct _batch_op {
+
+  t_symbol* label;            // The key of the operation, or its line number
+  t_symbol* cmd_sym;
+  t_command command;
+  t_uint64  op_bit;           // The bit of the operation in has_match
+
+  t_regexpr* search_key_expr;
+  t_regexpr* search_val_expr;
+
+  t_symbol*     replace_key_sym;
+  t_symbol*     replace_val_sym;
+  t_symbol*     replace_dict_sym;
+  t_dictionary* replace_dict;
+  t_dicttmpl*   replace_tmpl;
+
+  t_numpred num_pred;
+  t_atom    replace_num;
+
   t_int32 count;
 
+} t_batch_op;
+
+//******************************************************************************
+//  One dictionary of a multi-dictionary command, retained for its duration
+//
+typedef struct _multi {
+
+  t_symbol*     dict_sym;
+  t_dictionary* dict;
+  t_int32       count;        // The count of the command in the dictionary
+  t_bool        is_modified;  // Notified once the command is complete
+
+} t_multi;
+
+typedef struct _dict_recurse {
+
+  t_object ob;
+
+  void* outl_dict;    // Outlet 0: dictionaries
+  void* outl_mess;    // Outlet 1: messages
+  void* outl_bang;    // Outlet 2: bang on completion
+  void* outl_progress;  // Outlet 3: nodes visited by a time-sliced command
+
+  t_symbol*     dict_sym;
+  t_dictionary* dict;
+
+  t_walk  walk;               // Trailing state of the main traversal
+  t_int32 path_len_max;
+
+  t_pathexpr* path_expr;      // Path selector following the dictionary name
+
   t_command command;
 
   t_regexpr* search_key_expr;
@@ -135,11 +349,67 @@ typedef struct _dict_recurse {
 
   t_symbol*     replace_dict_sym;
   t_dictionary* replace_dict;
+  t_dicttmpl*   replace_tmpl;     // The replacement dictionary, compiled once per command
+
+  t_numpred num_pred;         // The predicate of the numeric commands
+  t_atom    replace_num;      // The replacement number
+  t_uint64  op_bit;           // The bit of the command in has_match
+
+  t_batch_op* batch_arr;      // The operations of a batch
+  t_int32     batch_cnt;
+  t_batch_op  batch_self;     // The arguments of the object itself, while a batch runs
+
+  t_regexpr* dict_expr;       // The dictionary name of a multi-dictionary command, matched against the candidates
+  t_multi*   multi_arr;       // The matching dictionaries, or NULL for a single dictionary
+  t_int32    multi_cnt;
+  t_int32    multi_ind;       // The dictionary being processed
+  t_symbol*  multi_sym;       // The dictionary name, for the summary
+  t_int32    multi_count;     // The count and edit count when the dictionary was opened
+  t_int32    multi_edit;
 
   t_bool is_busy;
-  t_bool has_match;
+  volatile t_bool is_cancelled;
+
+  t_symbol*   cmd_sym;        // The command being processed, for its summary
+  t_systhread async_thread;   // The worker thread of an asynchronous command, or NULL
+  t_bool      is_async;       // Whether the command runs on the worker thread, without the index, cache and snapshot
+  void*       async_qelem;    // Ends an asynchronous command on the main thread
+
+  void*  slice_clock;         // Resumes a time-sliced command on the next scheduler tick
+  t_bool slice_attached;      // Whether the dictionary is watched for the time-sliced command
+  volatile t_bool is_stale;   // Set when the dictionary is modified by another object between two slices
+
+  t_hashtab* index_tab;       // Key indexes by dictionary name
+  t_hashtab* cache_tab;       // Result caches by dictionary name
+  t_hashtab* snapshot_tab;    // Flat snapshots by dictionary name
+  t_symbol*  query_sym;       // The query of a read-only command, keying the result cache, or NULL
+  t_editlog* edit_log;        // Edits deferred until the end of each dictionary
+  t_journal* journal;         // Prior state of the entries edited by the last commands, for undo
+  t_bool     is_notifying;    // Set while the object notifies its own modifications
+  t_jsonstream* stream;       // The JSON file of a streaming command, instead of a dictionary, or NULL
+  t_task*    task_arr;        // Tasks of a parallel traversal
+  t_int32    par_task_cnt;    // The tasks, threads and steals of a parallel traversal, for verbose output
+  t_int32    par_thread_cnt;
+  t_int32    par_steal_cnt;
+
+  double        cmd_time;     // Start time of the command being processed, for its stats
+  t_walkstats   stats_last;   // Work counters of the last command
+  t_walkstats   stats_total;  // Work counters of all the commands since the last reset
+  t_dictionary* stats_dict;   // The dictionary output by stats, or NULL
+  t_tracebuf*   trace;        // Events of the commands, or NULL until the trace is first turned on
 
   char a_verbose;
+  long a_depth;
+  char a_index;
+  long a_threads;
+  char a_async;
+  double a_slice;
+  char a_output;
+  char a_cache;
+  char a_journal;
+  char a_trace;
+  t_symbol* a_dicts[MULTI_MAX];
+  long a_dicts_cnt;
 
   t_regexp2* re2;
 
@@ -150,6 +420,7 @@ typedef struct _dict_recurse {
 void* dict_recurse_new    (t_symbol* sym, long argc, t_atom* argv);
 void  dict_recurse_free   (t_dict_recurse* x);
 void  dict_recurse_assist (t_dict_recurse* x, void* b, long msg, long arg, char* str);
+t_max_err dict_recurse_notify (t_dict_recurse* x, t_symbol* sym, t_symbol* msg, void* sender, void* data);
 
 void  dict_recurse_all     (t_dict_recurse* x, t_symbol* dict_sym);
 void  dict_recurse_find    (t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv);
@@ -157,13 +428,90 @@ void  dict_recurse_replace (t_dict_recurse* x, t_symbol* sym, long argc, t_atom*
 void  dict_recurse_append  (t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv);
 void  dict_recurse_delete  (t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv);
 
+void  dict_recurse_batch  (t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv);
+void  dict_recurse_find_file    (t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv);
+void  dict_recurse_replace_file (t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv);
+void  dict_recurse_cancel (t_dict_recurse* x);
+void  dict_recurse_undo   (t_dict_recurse* x);
+void  dict_recurse_snapshot  (t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv);
+void  dict_recurse_stats     (t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv);
+void  dict_recurse_dumptrace (t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv);
+
 void     _dict_recurse_reset     (t_dict_recurse* x);
+void     _dict_recurse_batch_free (t_dict_recurse* x);
+t_my_err _dict_recurse_batch_add  (t_dict_recurse* x, t_atom* dict_ato, t_symbol* label, long argc, t_atom* argv);
+t_my_err _dict_recurse_batch_dict (t_dict_recurse* x, t_atom* dict_ato, t_dictionary* src_dict);
+t_my_err _dict_recurse_batch_file (t_dict_recurse* x, t_atom* dict_ato, t_symbol* file_sym);
+void     _batch_op_store          (t_dict_recurse* x, t_batch_op* op);
+void     _batch_op_load           (t_dict_recurse* x, t_batch_op* op);
 t_my_err _dict_recurse_begin_cmd (t_dict_recurse* x, t_atom* dict_ato, t_symbol* cmd_sym);
+t_my_err _dict_recurse_begin_file (t_dict_recurse* x, t_atom* file_ato, t_atom* out_ato, t_symbol* cmd_sym);
+t_my_err _dict_recurse_multi_set (t_dict_recurse* x, t_symbol* cmd_sym);
+void     _dict_recurse_multi_open (t_dict_recurse* x, t_int32 multi_ind);
+void     _dict_recurse_open      (t_dict_recurse* x);
+t_bool   _dict_recurse_next      (t_dict_recurse* x);
+void     _dict_recurse_release   (t_dict_recurse* x);
+t_my_err _dict_recurse_parse_find    (t_dict_recurse* x, long argc, t_atom* argv, t_symbol** cmd_out);
+t_my_err _dict_recurse_parse_replace (t_dict_recurse* x, long argc, t_atom* argv, t_symbol** cmd_out);
+t_my_err _dict_recurse_parse_append  (t_dict_recurse* x, long argc, t_atom* argv, t_symbol** cmd_out);
+t_my_err _dict_recurse_parse_delete  (t_dict_recurse* x, long argc, t_atom* argv, t_symbol** cmd_out);
+void     _dict_recurse_launch    (t_dict_recurse* x, t_symbol* cmd_sym);
+void     _dict_recurse_start     (t_dict_recurse* x);
+void     _dict_recurse_slice     (t_dict_recurse* x);
+void     _dict_recurse_exec      (t_dict_recurse* x);
+void*    _dict_recurse_worker    (t_dict_recurse* x);
+void     _dict_recurse_done      (t_dict_recurse* x);
+void     _dict_recurse_tick      (t_dict_recurse* x);
+void     _dict_recurse_finish    (t_dict_recurse* x);
 void     _dict_recurse_end_cmd   (t_dict_recurse* x);
-
-void    _dict_recurse_dict  (t_dict_recurse* x, t_dictionary* dict, t_int32 depth);
-t_int32 _dict_recurse_value (t_dict_recurse* x, t_atom* value, t_int32 depth);
-void    _dict_recurse_array (t_dict_recurse* x, t_atomarray* atom_arr, t_int32 depth);
+t_symbol* _dict_recurse_query    (t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv);
+void     _dict_recurse_trace_set (t_dict_recurse* x);
+
+t_bool _dict_recurse_is_watched (t_dict_recurse* x, t_dictionary* dict);
+void   _dict_recurse_watch      (t_dict_recurse* x, t_dictionary** dict_watched, t_dictionary* dict);
+void   _dict_recurse_modified   (t_dict_recurse* x, t_dictionary* dict);
+
+t_bool _dict_recurse_is_editing    (t_dict_recurse* x);
+void   _dict_recurse_journal_begin (t_dict_recurse* x, t_symbol* cmd_sym);
+void   _dict_recurse_journal_mark  (t_dict_recurse* x);
+void   _dict_recurse_journal_pop   (t_dict_recurse* x, t_int32 mark_cnt);
+void   _dict_recurse_journal_clear (t_dict_recurse* x);
+
+t_my_err   _walk_init         (t_walk* w, t_int32 path_len_max);
+void       _walk_free         (t_walk* w);
+void       _walk_reset        (t_walk* w);
+t_frame*   _walk_push         (t_walk* w);
+t_entry*   _walk_entries_grow (t_walk* w, t_int32 entry_cnt);
+
+void _dict_recurse_post  (t_dict_recurse* x, t_walk* w, const char* fmt, ...);
+void _dict_recurse_flush (t_dict_recurse* x, t_walk* w);
+
+t_atom* _walk_results_grow   (t_walk* w, t_int32 len);
+void    _dict_recurse_result (t_dict_recurse* x, t_walk* w, t_atom* value);
+void    _dict_recurse_output (t_dict_recurse* x, t_walk* w);
+
+const char* _dict_recurse_value_str (t_dict_recurse* x, t_walk* w, t_atom* value);
+t_bool      _dict_recurse_can_index (t_dict_recurse* x);
+t_bool      _dict_recurse_indexed   (t_dict_recurse* x, t_walk* w);
+t_resultcache* _dict_recurse_cache  (t_dict_recurse* x);
+void        _dict_recurse_cached    (t_dict_recurse* x, t_resultcache* cache);
+void        _dict_recurse_run       (t_dict_recurse* x);
+t_bool      _dict_recurse_snapshotted (t_dict_recurse* x, t_walk* w);
+t_bool      _dict_recurse_parallel  (t_dict_recurse* x);
+
+t_int32  _dict_recurse_read    (t_dict_recurse* x, t_walk* w, t_dictionary* dict);
+void     _dict_recurse_enter   (t_dict_recurse* x, t_walk* w, t_dictionary* dict, t_int32 entry_cnt, t_int32 depth);
+void     _dict_recurse_dict    (t_dict_recurse* x, t_walk* w, t_dictionary* dict, t_int32 depth);
+t_my_err _dict_recurse_keys    (t_dict_recurse* x, t_walk* w, t_dictionary* dict, t_int32 key_cnt, t_int32 depth);
+t_bool   _dict_recurse_walk    (t_dict_recurse* x, t_walk* w, t_int32 frame_base, double time_end);
+void     _dict_recurse_pop     (t_dict_recurse* x, t_walk* w);
+void     _dict_recurse_abandon (t_dict_recurse* x, t_walk* w);
+t_int32  _dict_recurse_value   (t_dict_recurse* x, t_walk* w, t_atom* value, t_int32 depth);
+t_int32  _dict_recurse_value_op    (t_dict_recurse* x, t_walk* w, t_atom* value, t_int32* entry_cnt);
+t_int32  _dict_recurse_value_batch (t_dict_recurse* x, t_walk* w, t_atom* value, t_int32* entry_cnt);
+t_int32  _dict_recurse_number  (t_dict_recurse* x, t_walk* w, t_atom* value);
+void     _dict_recurse_array   (t_dict_recurse* x, t_walk* w, t_atomarray* atom_arr, t_int32 depth);
+void     _dict_recurse_stream  (t_dict_recurse* x);
 
 void  dict_recurse_bang     (t_dict_recurse* x);
 void  dict_recurse_set      (t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv);
@@ -173,6 +521,7 @@ void  dict_recurse_anything (t_dict_recurse* x, t_symbol* sym, long argc, t_atom
 void  dict_compile_re  (t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv);
 void  dict_simulate_re (t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv);
 void  dict_post_state  (t_dict_recurse* x);
+void  dict_re_profile  (t_dict_recurse* x, long is_profiled);
 
 // ========  GLOBAL CLASS POINTER AND STATIC VARIABLES  ========
 
@@ -207,6 +556,15 @@ void dict_re_simulate(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv)
 void dict_re_states(t_dict_recurse* x) {
 
   state_post(x->re2);
+  if (x->re2->is_profiled) { re_profile_post(x->re2); }
+}
+
+void dict_re_profile(t_dict_recurse* x, long is_profiled) {
+
+  TRACE("dict_re_profile");
+
+  re_profile_set(x->re2, is_profiled != 0);
+  POST("Profile: %s - Counts cleared, and reset by each compilation", is_profiled ? "On" : "Off");
 }
 
 // ========  INITIALIZATION ROUTINE  ========
@@ -220,12 +578,21 @@ void C74_EXPORT ext_main(void* r) {
 
   // Methods
   class_addmethod(c, (method)dict_recurse_assist, "assist", A_CANT, 0);
+  class_addmethod(c, (method)dict_recurse_notify, "notify", A_CANT, 0);
 
   class_addmethod(c, (method)dict_recurse_all, "all", A_SYM, 0);
   class_addmethod(c, (method)dict_recurse_find, "find", A_GIMME, 0);
   class_addmethod(c, (method)dict_recurse_replace, "replace", A_GIMME, 0);
   class_addmethod(c, (method)dict_recurse_append, "append", A_GIMME, 0);
   class_addmethod(c, (method)dict_recurse_delete, "delete", A_GIMME, 0);
+  class_addmethod(c, (method)dict_recurse_batch, "batch", A_GIMME, 0);
+  class_addmethod(c, (method)dict_recurse_find_file, "find_file", A_GIMME, 0);
+  class_addmethod(c, (method)dict_recurse_replace_file, "replace_file", A_GIMME, 0);
+  class_addmethod(c, (method)dict_recurse_cancel, "cancel", 0);
+  class_addmethod(c, (method)dict_recurse_undo, "undo", 0);
+  class_addmethod(c, (method)dict_recurse_snapshot, "snapshot", A_GIMME, 0);
+  class_addmethod(c, (method)dict_recurse_stats, "stats", A_GIMME, 0);
+  class_addmethod(c, (method)dict_recurse_dumptrace, "dumptrace", A_GIMME, 0);
 
   class_addmethod(c, (method)dict_recurse_bang, "bang", 0);
   class_addmethod(c, (method)dict_recurse_set, "set", A_GIMME, 0);
@@ -235,12 +602,61 @@ void C74_EXPORT ext_main(void* r) {
   class_addmethod(c, (method)dict_re_compile, "compile", A_GIMME, 0);
   class_addmethod(c, (method)dict_re_simulate, "simulate", A_GIMME, 0);
   class_addmethod(c, (method)dict_re_states, "states", 0);
+  class_addmethod(c, (method)dict_re_profile, "profile", A_LONG, 0);
 
   // Attributes
   CLASS_ATTR_CHAR(c, "verbose", 0, t_dict_recurse, a_verbose);
   CLASS_ATTR_STYLE(c, "verbose", 0, "onoff");
   CLASS_ATTR_SAVE(c, "verbose", 0);
 
+  CLASS_ATTR_LONG(c, "depth", 0, t_dict_recurse, a_depth);
+  CLASS_ATTR_FILTER_MIN(c, "depth", 0);
+  CLASS_ATTR_LABEL(c, "depth", 0, "Maximum depth (0 for none)");
+  CLASS_ATTR_SAVE(c, "depth", 0);
+
+  CLASS_ATTR_CHAR(c, "index", 0, t_dict_recurse, a_index);
+  CLASS_ATTR_STYLE(c, "index", 0, "onoff");
+  CLASS_ATTR_LABEL(c, "index", 0, "Key index for find key and replace key");
+  CLASS_ATTR_SAVE(c, "index", 0);
+
+  CLASS_ATTR_LONG(c, "threads", 0, t_dict_recurse, a_threads);
+  CLASS_ATTR_FILTER_CLIP(c, "threads", 0, WORKPOOL_THREAD_MAX);
+  CLASS_ATTR_LABEL(c, "threads", 0, "Threads for read-only commands (0 for none)");
+  CLASS_ATTR_SAVE(c, "threads", 0);
+
+  CLASS_ATTR_CHAR(c, "async", 0, t_dict_recurse, a_async);
+  CLASS_ATTR_STYLE(c, "async", 0, "onoff");
+  CLASS_ATTR_LABEL(c, "async", 0, "Run the commands on a worker thread");
+  CLASS_ATTR_SAVE(c, "async", 0);
+
+  CLASS_ATTR_DOUBLE(c, "slice", 0, t_dict_recurse, a_slice);
+  CLASS_ATTR_FILTER_MIN(c, "slice", 0);
+  CLASS_ATTR_LABEL(c, "slice", 0, "Time budget per scheduler tick in ms (0 for none)");
+  CLASS_ATTR_SAVE(c, "slice", 0);
+
+  CLASS_ATTR_CHAR(c, "output", 0, t_dict_recurse, a_output);
+  CLASS_ATTR_ENUMINDEX(c, "output", 0, "post list");
+  CLASS_ATTR_LABEL(c, "output", 0, "Output of the matches");
+  CLASS_ATTR_SAVE(c, "output", 0);
+
+  CLASS_ATTR_CHAR(c, "cache", 0, t_dict_recurse, a_cache);
+  CLASS_ATTR_STYLE(c, "cache", 0, "onoff");
+  CLASS_ATTR_LABEL(c, "cache", 0, "Result cache for find and all");
+  CLASS_ATTR_SAVE(c, "cache", 0);
+
+  CLASS_ATTR_CHAR(c, "journal", 0, t_dict_recurse, a_journal);
+  CLASS_ATTR_STYLE(c, "journal", 0, "onoff");
+  CLASS_ATTR_LABEL(c, "journal", 0, "Record the edits to undo them");
+  CLASS_ATTR_SAVE(c, "journal", 0);
+
+  CLASS_ATTR_CHAR(c, "trace", 0, t_dict_recurse, a_trace);
+  CLASS_ATTR_STYLE(c, "trace", 0, "onoff");
+  CLASS_ATTR_LABEL(c, "trace", 0, "Record the events of the commands for dumptrace");
+
+  CLASS_ATTR_SYM_VARSIZE(c, "dicts", 0, t_dict_recurse, a_dicts, a_dicts_cnt, MULTI_MAX);
+  CLASS_ATTR_LABEL(c, "dicts", 0, "Candidate dictionaries for the multi-dictionary commands");
+  CLASS_ATTR_SAVE(c, "dicts", 0);
+
   class_register(CLASS_BOX, c);
   dict_recurse_class = c;
 }
@@ -258,14 +674,13 @@ void* dict_recurse_new(t_symbol* sym, long argc, t_atom* argv) {
     return NULL;
   }
 
+  x->outl_progress = intout(x);                   // Outlet 2: Nodes visited
   x->outl_bang = bangout(x);                      // Outler 1: Bang on completion
   x->outl_mess = outlet_new((t_object*)x, NULL);  // Outlet 0: General messages
 
   x->path_len_max = MAX_LEN_PATH;
 
-  x->path = NULL;
-  x->path = (char*)sysmem_newptr(sizeof(char) * x->path_len_max);
-  if (!x->path) { MY_ERR("new:  Allocation error for \"path\"."); }
+  if (_walk_init(&x->walk, x->path_len_max) != ERR_NONE) { MY_ERR("new:  Allocation error for \"path\"."); }
 
   x->search_key_expr = regexpr_new();
   x->search_val_expr = regexpr_new();
@@ -273,6 +688,62 @@ void* dict_recurse_new(t_symbol* sym, long argc, t_atom* argv) {
     MY_ERR("new:  Allocation error for the search expressions.");
   }
 
+  x->path_expr = pathexpr_new();
+  if (!x->path_expr) { MY_ERR("new:  Allocation error for the path selector."); }
+
+  x->index_tab = hashtab_new(0);
+  if (!x->index_tab) { MY_ERR("new:  Allocation error for the key indexes."); }
+
+  x->cache_tab = hashtab_new(0);
+  if (!x->cache_tab) { MY_ERR("new:  Allocation error for the result caches."); }
+
+  x->snapshot_tab = hashtab_new(0);
+  if (!x->snapshot_tab) { MY_ERR("new:  Allocation error for the snapshots."); }
+
+  x->task_arr = NULL;
+
+  x->edit_log = editlog_new();
+  if (!x->edit_log) { MY_ERR("new:  Allocation error for the edit log."); }
+
+  x->journal = journal_new();
+  if (!x->journal) { MY_ERR("new:  Allocation error for the undo journal."); }
+  x->is_notifying = false;
+  x->stream = NULL;
+
+  x->replace_tmpl = dicttmpl_new();
+  if (!x->replace_tmpl) { MY_ERR("new:  Allocation error for the replacement template."); }
+
+  x->dict_expr = regexpr_new();
+  if (!x->dict_expr) { MY_ERR("new:  Allocation error for the dictionary pattern."); }
+
+  x->a_depth = 0;
+  x->a_index = false;
+  x->a_threads = 0;
+  x->a_async = false;
+
+  x->async_thread = NULL;
+  x->async_qelem = qelem_new(x, (method)_dict_recurse_done);
+
+  x->a_slice = 0;
+  x->a_output = OUTPUT_POST;
+  x->a_cache = false;
+  x->a_journal = false;
+  x->a_trace = false;
+  x->a_dicts_cnt = 0;
+
+  x->op_bit = 1;
+  x->batch_arr = NULL;
+  x->batch_cnt = 0;
+  x->multi_arr = NULL;
+  x->slice_clock = clock_new(x, (method)_dict_recurse_tick);
+  x->slice_attached = false;
+
+  x->cmd_time = 0;
+  walkstats_clear(&x->stats_last);
+  walkstats_clear(&x->stats_total);
+  x->stats_dict = NULL;
+  x->trace = NULL;
+
   _dict_recurse_reset(x);
 
   re_set_object(x);
@@ -289,14 +760,235 @@ void dict_recurse_free(t_dict_recurse* x) {
 
   TRACE("dict_recurse_free");
 
-  if (x->path) { sysmem_freeptr(x->path); }
+  // Stop an asynchronous command, and release its dictionaries
+  if (x->async_thread) {
+    x->is_cancelled = true;
+    systhread_join(x->async_thread, NULL);
+    _dict_recurse_release(x);
+  }
+  if (x->async_qelem) { qelem_free(x->async_qelem); }
+
+  // Abandon a time-sliced command, and release its dictionaries
+  if (x->slice_clock) { clock_unset(x->slice_clock); object_free(x->slice_clock); }
+  if (x->walk.frame_cnt) {
+    _dict_recurse_abandon(x, &x->walk);
+    if (x->slice_attached) { object_detach_byptr(x, x->dict); }
+    _dict_recurse_release(x);
+  }
+
+  _walk_free(&x->walk);
+
+  if (x->stats_dict) { object_free(x->stats_dict); }    // NB: Unregisters it
+  if (x->trace) { tracebuf_free(x->trace); }
 
   regexpr_free(x->search_key_expr);
   regexpr_free(x->search_val_expr);
+  regexpr_free(x->dict_expr);
+  pathexpr_free(x->path_expr);
+  editlog_free(x->edit_log);
+  dicttmpl_free(x->replace_tmpl);
+
+  // Free the journal and stop watching its dictionaries
+  if (x->journal) { _dict_recurse_journal_clear(x); }
+  journal_free(x->journal);
+
+  // Free the key indexes and stop watching their dictionaries
+  if (x->index_tab) {
+    long key_cnt = 0;
+    t_symbol** key_arr = NULL;
+    t_keyindex* index = NULL;
+    hashtab_getkeys(x->index_tab, &key_cnt, &key_arr);
+
+    for (t_int32 ind = 0; ind < key_cnt; ind++) {
+      hashtab_lookup(x->index_tab, key_arr[ind], (t_object**)&index);
+      if (index->dict_watched) { object_detach_byptr(x, index->dict_watched); }
+      keyindex_free(index);
+    }
+
+    if (key_arr) { sysmem_freeptr(key_arr); }
+    object_free(x->index_tab);
+  }
+
+  // Free the result caches and stop watching their dictionaries
+  if (x->cache_tab) {
+    long key_cnt = 0;
+    t_symbol** key_arr = NULL;
+    t_resultcache* cache = NULL;
+    hashtab_getkeys(x->cache_tab, &key_cnt, &key_arr);
+
+    for (t_int32 ind = 0; ind < key_cnt; ind++) {
+      hashtab_lookup(x->cache_tab, key_arr[ind], (t_object**)&cache);
+      if (cache->dict_watched) { object_detach_byptr(x, cache->dict_watched); }
+      resultcache_free(cache);
+    }
+
+    if (key_arr) { sysmem_freeptr(key_arr); }
+    object_free(x->cache_tab);
+  }
+
+  // Free the snapshots and stop watching their dictionaries
+  if (x->snapshot_tab) {
+    long key_cnt = 0;
+    t_symbol** key_arr = NULL;
+    t_snapshot* snap = NULL;
+    hashtab_getkeys(x->snapshot_tab, &key_cnt, &key_arr);
+
+    for (t_int32 ind = 0; ind < key_cnt; ind++) {
+      hashtab_lookup(x->snapshot_tab, key_arr[ind], (t_object**)&snap);
+      if (snap->dict_watched) { object_detach_byptr(x, snap->dict_watched); }
+      snapshot_free(snap);
+    }
+
+    if (key_arr) { sysmem_freeptr(key_arr); }
+    object_free(x->snapshot_tab);
+  }
 
   re_free(&x->re2);
 }
 
+// ====  DICT_RECURSE_NOTIFY  ====
+//******************************************************************************
+//  Invalidate the key index, the result cache and the snapshot of a dictionary
+//  when it is modified or freed, abandon a time-sliced command on it, and stop
+//  undoing the commands on it if it is modified by another object.
+//
+t_max_err dict_recurse_notify(t_dict_recurse* x, t_symbol* sym, t_symbol* msg, void* sender, void* data) {
+
+  TRACE("dict_recurse_notify");
+
+  if ((msg != gensym("modified")) && (msg != gensym("free"))) { return MAX_ERR_NONE; }
+
+  if (x->walk.frame_cnt && (sender == x->dict)) { x->is_stale = true; }
+
+  long key_cnt = 0;
+  t_symbol** key_arr = NULL;
+  t_keyindex* index = NULL;
+  hashtab_getkeys(x->index_tab, &key_cnt, &key_arr);
+
+  for (t_int32 ind = 0; ind < key_cnt; ind++) {
+    hashtab_lookup(x->index_tab, key_arr[ind], (t_object**)&index);
+    if (index->dict_watched != sender) { continue; }
+
+    keyindex_invalidate(index);
+    if (msg == gensym("free")) { index->dict_watched = NULL; }    // NB: Detached by the sender
+  }
+
+  if (key_arr) { sysmem_freeptr(key_arr); }
+
+  // Move the result cache to a new version
+  t_resultcache* cache = NULL;
+  key_arr = NULL;
+  hashtab_getkeys(x->cache_tab, &key_cnt, &key_arr);
+
+  for (t_int32 ind = 0; ind < key_cnt; ind++) {
+    hashtab_lookup(x->cache_tab, key_arr[ind], (t_object**)&cache);
+    if (cache->dict_watched != sender) { continue; }
+
+    resultcache_bump(cache);
+    if (msg == gensym("free")) { cache->dict_watched = NULL; }
+  }
+
+  if (key_arr) { sysmem_freeptr(key_arr); }
+
+  // Invalidate the snapshot, rebuilt by the next query
+  t_snapshot* snap = NULL;
+  key_arr = NULL;
+  hashtab_getkeys(x->snapshot_tab, &key_cnt, &key_arr);
+
+  for (t_int32 ind = 0; ind < key_cnt; ind++) {
+    hashtab_lookup(x->snapshot_tab, key_arr[ind], (t_object**)&snap);
+    if (snap->dict_watched != sender) { continue; }
+
+    snapshot_invalidate(snap);
+    if (msg == gensym("free")) { snap->dict_watched = NULL; }
+  }
+
+  if (key_arr) { sysmem_freeptr(key_arr); }
+
+  // The journaled edits cannot be undone over the modifications of another object
+  for (t_int32 ind = 0; ind < x->journal->mark_cnt; ind++) {
+    t_journal_mark* mark = x->journal->mark_arr + ind;
+    if (mark->dict != sender) { continue; }
+
+    if (!x->is_notifying || (msg == gensym("free"))) { mark->is_stale = true; }
+    if (msg == gensym("free")) { mark->dict = NULL; }
+  }
+
+  return MAX_ERR_NONE;
+}
+
+// ====  _DICT_RECURSE_WATCH  ====
+
+//******************************************************************************
+//  Test if a dictionary is watched for a key index, a result cache, a snapshot or the journal.
+//
+t_bool _dict_recurse_is_watched(t_dict_recurse* x, t_dictionary* dict) {
+
+  long key_cnt = 0;
+  t_symbol** key_arr = NULL;
+  t_keyindex* index = NULL;
+  t_resultcache* cache = NULL;
+  t_snapshot* snap = NULL;
+  t_bool is_watched = false;
+
+  hashtab_getkeys(x->index_tab, &key_cnt, &key_arr);
+  for (t_int32 ind = 0; (ind < key_cnt) && !is_watched; ind++) {
+    hashtab_lookup(x->index_tab, key_arr[ind], (t_object**)&index);
+    is_watched = (index->dict_watched == dict);
+  }
+  if (key_arr) { sysmem_freeptr(key_arr); }
+
+  key_arr = NULL;
+  hashtab_getkeys(x->cache_tab, &key_cnt, &key_arr);
+  for (t_int32 ind = 0; (ind < key_cnt) && !is_watched; ind++) {
+    hashtab_lookup(x->cache_tab, key_arr[ind], (t_object**)&cache);
+    is_watched = (cache->dict_watched == dict);
+  }
+  if (key_arr) { sysmem_freeptr(key_arr); }
+
+  key_arr = NULL;
+  hashtab_getkeys(x->snapshot_tab, &key_cnt, &key_arr);
+  for (t_int32 ind = 0; (ind < key_cnt) && !is_watched; ind++) {
+    hashtab_lookup(x->snapshot_tab, key_arr[ind], (t_object**)&snap);
+    is_watched = (snap->dict_watched == dict);
+  }
+  if (key_arr) { sysmem_freeptr(key_arr); }
+
+  for (t_int32 ind = 0; (ind < x->journal->mark_cnt) && !is_watched; ind++) {
+    is_watched = (x->journal->mark_arr[ind].dict == dict);
+  }
+
+  return is_watched;
+}
+
+//******************************************************************************
+//  Change the dictionary watched for a key index, a result cache, a snapshot or a journal mark.
+//  The object is attached once to each dictionary, whatever it is watched for.
+//
+//  @param dict_watched A pointer to the watched dictionary of the index, cache or snapshot.
+//  @param dict The dictionary to watch, or NULL.
+//
+void _dict_recurse_watch(t_dict_recurse* x, t_dictionary** dict_watched, t_dictionary* dict) {
+
+  t_dictionary* dict_prev = *dict_watched;
+  *dict_watched = NULL;
+
+  if (dict_prev && !_dict_recurse_is_watched(x, dict_prev)) { object_detach_byptr(x, dict_prev); }
+  if (dict && !_dict_recurse_is_watched(x, dict)) { object_attach_byptr(x, dict); }
+
+  *dict_watched = dict;
+}
+
+//******************************************************************************
+//  Notify the modification of a dictionary by the object itself.
+//
+void _dict_recurse_modified(t_dict_recurse* x, t_dictionary* dict) {
+
+  x->is_notifying = true;
+  object_notify(dict, gensym("modified"), NULL);
+  x->is_notifying = false;
+}
+
 // ====  DICT_RECURSE_ASSIST  ====
 
 void dict_recurse_assist(t_dict_recurse* x, void* b, long msg, long arg, char* str) {
@@ -310,8 +1002,9 @@ void dict_recurse_assist(t_dict_recurse* x, void* b, long msg, long arg, char* s
 
   else if (msg == ASSIST_OUTLET) {
     switch (arg) {
-    case 0: sprintf(str, "Outlet 0: All purpose messages"); break;
+    case 0: sprintf(str, "Outlet 0: All purpose messages, and match <type> <key> <value> <path segments>"); break;
     case 1: sprintf(str, "Outlet 1: Bang on command completion"); break;
+    case 2: sprintf(str, "Outlet 2: Nodes visited by a time-sliced command"); break;
     default: break;
   }
 }
@@ -326,20 +1019,27 @@ void _dict_recurse_reset(t_dict_recurse* x) {
   // Reset the object variables
   x->dict = NULL;
   x->dict_sym = gensym("");
-  x->type_iter = VALUE_TYPE_NONE;
-  x->dict_iter = NULL;
-  x->key_iter = gensym("");
-  x->array_iter = NULL;
-  x->index_iter = -1;
-  x->path[0] = '\0';
+  x->multi_cnt = 0;
+  x->multi_ind = 0;
+  x->multi_sym = gensym("");
+  _walk_reset(&x->walk);
   x->command = CMD_NONE;
   x->replace_key_sym = gensym("");
   x->replace_val_sym = gensym("");
   x->replace_dict = NULL;
   x->replace_dict_sym = gensym("");
-  x->count = 0;
-  x->has_match = false;
   x->is_busy = false;
+  x->is_cancelled = false;
+  x->is_stale = false;
+  x->is_async = false;
+  x->cmd_sym = gensym("");
+  x->query_sym = NULL;
+  x->par_task_cnt = 0;
+  pathexpr_reset(x->path_expr);
+  x->walk.path_state = x->path_expr->state_ini;
+  editlog_clear(x->edit_log);
+  x->edit_log->journal = NULL;
+  dicttmpl_clear(x->replace_tmpl);
 }
 
 // ====  _DICT_RECURSE_BEGIN_CMD  ====
@@ -351,594 +1051,3049 @@ t_my_err _dict_recurse_begin_cmd(t_dict_recurse* x, t_atom* dict_ato, t_symbol*
   // Test if the object is already busy
   MY_ASSERT(x->is_busy, ERR_LOCKED, "%s:  The object is still busy.", cmd_sym->s_name);
 
-  // Arg 0: The name of the dictionary to process
-  x->dict_sym = atom_getsym(dict_ato);
+  x->cmd_time = systimer_gettime();
+  _dict_recurse_trace_set(x);
+
+  // Arg 0: The name of the dictionary to process, optionally followed by a path selector
+  //   dict_name::presets::*::tracks[*]::gain
+  char* sep = strstr(atom_getsym(dict_ato)->s_name, PATH_SEP_S);
+
+  if (sep) {
+    char dict_s[MAX_LEN_PATH];
+    strncpy_zero(dict_s, atom_getsym(dict_ato)->s_name,
+      MIN((long)(sep - atom_getsym(dict_ato)->s_name + 1), MAX_LEN_PATH));
+    x->dict_sym = gensym(dict_s);
+
+    MY_ASSERT(pathexpr_set(x->path_expr, sep + 2) != ERR_NONE, ERR_SYNTAX,
+      "%s:  Arg 1:  Invalid path selector \"%s\".", cmd_sym->s_name, sep + 2);
+  }
+
+  else {
+    x->dict_sym = atom_getsym(dict_ato);
+    pathexpr_reset(x->path_expr);
+  }
+
   x->dict = dictobj_findregistered_retain(x->dict_sym);
+
+  // Otherwise match the name against the candidates of the dicts attribute:
+  //   replace value preset_* old new
+  if (!x->dict && x->a_dicts_cnt) {
+    if (_dict_recurse_multi_set(x, cmd_sym) != ERR_NONE) { return ERR_DICT_NONE; }
+  }
+
   MY_ASSERT(!x->dict, ERR_DICT_NONE, "%s:  Arg 1:  Unable to reference the dictionary named \"%s\".",
     cmd_sym->s_name, x->dict_sym->s_name);
 
-  // Copy the name of the root dictionary into the path
-  strncpy_zero(x->path, x->dict_sym->s_name, x->path_len_max);
-
-  // Set the trailing variables
-  x->type_iter = VALUE_TYPE_DICT;
-  x->dict_iter = x->dict;
+  _dict_recurse_journal_begin(x, cmd_sym);
+  _dict_recurse_open(x);
 
   // Set the object to busy status
   x->is_busy = true;
+  TRACEBUF_EVENT(x->walk.trace_lane, 'B', "command", cmd_sym->s_name, x->dict_sym);
 
   return ERR_NONE;
 }
 
-// ====  _DICT_RECURSE_END_CMD  ====
+// ====  _DICT_RECURSE_MULTI  ====
 
-void _dict_recurse_end_cmd(t_dict_recurse* x) {
+//******************************************************************************
+//  The number of edits of the command so far, to tell if a dictionary was modified.
+//
+static t_int32 _dict_recurse_edit_count(t_dict_recurse* x) {
 
-  TRACE("_dict_recurse_end_cmd");
+  t_int32 count = 0;
 
-  // Release the dictionary or dictionaries
-  if (x->dict) { dictobj_release(x->dict); }
-  if (x->replace_dict) { dictobj_release(x->replace_dict); }
+  if (x->command != CMD_BATCH) { return CMD_IS_FIND(x->command) ? 0 : x->walk.count; }
 
-  // Reset the object variables
-  _dict_recurse_reset(x);
+  for (t_int32 ind = 0; ind < x->batch_cnt; ind++) {
+    if (!CMD_IS_FIND(x->batch_arr[ind].command)) { count += x->batch_arr[ind].count; }
+  }
 
-  // Indicate the completion of the cmd with a bang
-  outlet_bang(x->outl_bang);
+  return count;
 }
 
-// ====  DICT_RECURSE_ALL  ====
 //******************************************************************************
-//  all (sym: dictionary)
+//  Match the dictionary name of a command against the candidate dictionaries,
+//  and retain the registered ones, in the order of the candidates.
+//  The first one is opened.
 //
-void dict_recurse_all(t_dict_recurse* x, t_symbol* dict_sym) {
+//  @return ERR_NONE, or an error if the name is invalid or matches no dictionary.
+//
+t_my_err _dict_recurse_multi_set(t_dict_recurse* x, t_symbol* cmd_sym) {
 
-  TRACE("dict_recurse_all");
+  TRACE("_dict_recurse_multi_set");
 
-  // Initialize the object variables
-  x->command = CMD_ALL;
+  MY_ASSERT(regexpr_set(x->dict_expr, x->dict_sym) != ERR_NONE, ERR_SYNTAX,
+    "%s:  Arg 1:  Invalid dictionary name \"%s\".", cmd_sym->s_name, x->dict_sym->s_name);
 
-  t_atom dict_ato[1];
-  atom_setsym(dict_ato, dict_sym);
-  if (_dict_recurse_begin_cmd(x, dict_ato, gensym("all")) != ERR_NONE) { return; }
+  x->multi_arr = (t_multi*)sysmem_newptr(x->a_dicts_cnt * sizeof(t_multi));
+  MY_ASSERT(!x->multi_arr, ERR_ALLOC, "%s:  Allocation error for the dictionaries.", cmd_sym->s_name);
+  x->multi_cnt = 0;
 
-  // Start the recursion
-  _dict_recurse_dict(x, x->dict, 0);
+  for (t_int32 ind = 0; ind < x->a_dicts_cnt; ind++) {
 
-  // Post a summary for the command
-  POST("all:  %i reference%s found in \"%s\".", x->count, (x->count == 1) ? "" : "s", x->dict_sym->s_name);
+    t_symbol* dict_sym = x->a_dicts[ind];
+    if (!regexpr_match(x->dict_expr, dict_sym)) { continue; }
 
-  // End the command
-  _dict_recurse_end_cmd(x);
+    // Skip the duplicates
+    t_int32 dup = 0;
+    while ((dup < x->multi_cnt) && (x->multi_arr[dup].dict_sym != dict_sym)) { dup++; }
+    if (dup < x->multi_cnt) { continue; }
+
+    t_dictionary* dict = dictobj_findregistered_retain(dict_sym);
+    if (!dict) {
+      WARNING("%s:  Unable to reference the dictionary named \"%s\", skipped.", cmd_sym->s_name, dict_sym->s_name);
+      continue;
+    }
+
+    t_multi* multi = x->multi_arr + x->multi_cnt++;
+    multi->dict_sym = dict_sym;
+    multi->dict = dict;
+    multi->count = 0;
+    multi->is_modified = false;
+  }
+
+  if (!x->multi_cnt) {
+    sysmem_freeptr(x->multi_arr);
+    x->multi_arr = NULL;
+    MY_ERR("%s:  Arg 1:  No registered dictionary matching \"%s\".", cmd_sym->s_name, x->dict_sym->s_name);
+    return ERR_DICT_NONE;
+  }
+
+  x->multi_sym = x->dict_sym;
+  _dict_recurse_multi_open(x, 0);
+
+  return ERR_NONE;
 }
 
-// ====  DICT_RECURSE_FIND  ====
+//******************************************************************************
+//  Set one of the dictionaries of a multi-dictionary command as the dictionary to process.
+//
+void _dict_recurse_multi_open(t_dict_recurse* x, t_int32 multi_ind) {
+
+  x->multi_ind = multi_ind;
+  x->dict_sym = x->multi_arr[multi_ind].dict_sym;
+  x->dict = x->multi_arr[multi_ind].dict;
+  x->multi_count = x->walk.count;
+  x->multi_edit = _dict_recurse_edit_count(x);
+}
 
 //******************************************************************************
-//  find key (sym: dictionary) (sym: search key)
-//  find key_in (sym: dictionary) (sym: search key)
-//  find value (sym: dictionary) (sym: search value)
-//  find entry (sym: dictionary) (sym: search key) (sym: search value)
-//  find dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value)
+//  Close the dictionary being processed by a multi-dictionary command, and open the next one.
+//  The modified dictionaries are notified once the command is complete, on the main thread.
 //
-void dict_recurse_find(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+//  @return true if there is a next dictionary to process.
+//
+t_bool _dict_recurse_next(t_dict_recurse* x) {
 
-  TRACE("dict_recurse_find");
+  if (!x->multi_cnt) { return false; }
 
-  t_symbol* search_key_sym = gensym("");
-  t_symbol* search_val_sym = gensym("");
+  // Close the dictionary, unless it was processed in parallel with the others
+  if (x->dict) {
+    t_multi* multi = x->multi_arr + x->multi_ind;
+    multi->count = x->walk.count - x->multi_count;
+    multi->is_modified = (_dict_recurse_edit_count(x) > x->multi_edit);
+    x->dict = NULL;
+  }
 
-  // Arg 0: Find a key, all entries with the key in, a value, or a dictionary
-  t_symbol* cmd_arg = atom_getsym(argv);
-  t_symbol* cmd_sym = gensym("");
-  if (cmd_arg == gensym("key")) { x->command = CMD_FIND_KEY; cmd_sym = gensym("find key"); }
-  else if (cmd_arg == gensym("key_in")) { x->command = CMD_FIND_KEY_IN; cmd_sym = gensym("find key_in"); }
-  else if (cmd_arg == gensym("value")) { x->command = CMD_FIND_VALUE_SYM; cmd_sym = gensym("find value"); }
-  else if (cmd_arg == gensym("entry")) { x->command = CMD_FIND_ENTRY; cmd_sym = gensym("find entry"); }
-  else if (cmd_arg == gensym("dict_cont_entry")) { x->command = CMD_FIND_DICT_CONT_ENTRY; cmd_sym = gensym("find dict_cont_entry"); }
-  else { MY_ASSERT(1, , "find:  Arg 0:  Invalid argument."); }
+  if (x->is_cancelled || x->is_stale || (x->multi_ind + 1 == x->multi_cnt)) { return false; }
 
-  switch (x->command) {
+  _dict_recurse_multi_open(x, x->multi_ind + 1);
+  _dict_recurse_open(x);
 
-  // find key (sym: dictionary) (sym: search key)
-  // find key_in (sym: dictionary) (sym: search key)
-  case CMD_FIND_KEY:
-  case CMD_FIND_KEY_IN:
-    search_key_sym = atom_getsym(argv + 2);
-    MY_ASSERT(search_key_sym == gensym(""), , "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
-    regexpr_set(x->search_key_expr, search_key_sym);
-    break;
+  return true;
+}
 
-  // find value (sym: dictionary) (sym: search value)
-  case CMD_FIND_VALUE_SYM:
-    search_val_sym = atom_getsym(argv + 2);
-    MY_ASSERT(search_val_sym == gensym(""), , "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
-    regexpr_set(x->search_val_expr, search_val_sym);
-    break;
+// ====  _DICT_RECURSE_OPEN  ====
+//******************************************************************************
+//  Set the trailing state to start a traversal from the dictionary to process.
+//
+void _dict_recurse_open(t_dict_recurse* x) {
 
-  // find entry (sym: dictionary) (sym: search key) (sym: search value)
-  // find dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value)
-  case CMD_FIND_ENTRY:
-  case CMD_FIND_DICT_CONT_ENTRY:
-    search_key_sym = atom_getsym(argv + 2);
-    search_val_sym = atom_getsym(argv + 3);
-    MY_ASSERT(search_key_sym == gensym(""), , "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(search_val_sym == gensym(""), , "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
-    regexpr_set(x->search_key_expr, search_key_sym);
-    regexpr_set(x->search_val_expr, search_val_sym);
-    break;
+  x->walk.path_state = x->path_expr->state_ini;
+  x->walk.is_selected = !pathexpr_is_set(x->path_expr);
 
-    default: break;
+  // Copy the name of the root dictionary into the path, and as its first segment
+  strncpy_zero(x->walk.path, x->dict_sym->s_name, x->path_len_max);
+  atom_setsym(x->walk.seg_arr, x->dict_sym);
+  x->walk.seg_cnt = 1;
+
+  // Set the trailing variables
+  x->walk.type_iter = VALUE_TYPE_DICT;
+  x->walk.dict_iter = x->dict;
+}
+
+// ====  _DICT_RECURSE_RELEASE  ====
+//******************************************************************************
+//  Release the dictionaries of a command, free the operations of a batch,
+//  and close the files of a streaming command.
+//
+void _dict_recurse_release(t_dict_recurse* x) {
+
+  if (x->multi_arr) {
+    for (t_int32 ind = 0; ind < x->multi_cnt; ind++) { dictobj_release(x->multi_arr[ind].dict); }
+    sysmem_freeptr(x->multi_arr);
+    x->multi_arr = NULL;
+    x->multi_cnt = 0;
   }
+  else if (x->dict) { dictobj_release(x->dict); }
+  x->dict = NULL;
 
-  // Initialize the object variables
-  if (_dict_recurse_begin_cmd(x, argv + 1, cmd_sym) != ERR_NONE) { return; }
+  if (x->replace_dict) { dictobj_release(x->replace_dict); }
+  x->replace_dict = NULL;
 
-  // Start the recursion
-  _dict_recurse_dict(x, x->dict, 0);
+  jsonstream_free(x->stream);
+  x->stream = NULL;
 
-  // Post a summary for the command
-  POST("%s:  %i reference%s found in \"%s\".", cmd_sym->s_name, x->count, (x->count == 1) ? "" : "s", x->dict_sym->s_name);
+  _dict_recurse_batch_free(x);
+}
 
-  // End the command
-  _dict_recurse_end_cmd(x);
+// ====  _DICT_RECURSE_JOURNAL  ====
+
+//******************************************************************************
+//  Test if the command can edit the dictionaries: a batch if one of its operations can.
+//
+t_bool _dict_recurse_is_editing(t_dict_recurse* x) {
+
+  if (x->command != CMD_BATCH) { return !CMD_IS_FIND(x->command); }
+
+  for (t_int32 ind = 0; ind < x->batch_cnt; ind++) {
+    if (!CMD_IS_FIND(x->batch_arr[ind].command)) { return true; }
+  }
+
+  return false;
 }
 
-// ====  DICT_RECURSE_REPLACE  ====
+//******************************************************************************
+//  Record the edits of the command in the journal. Without the journal attribute,
+//  the journal is cleared instead, since its edits could not be undone after these.
+//
+void _dict_recurse_journal_begin(t_dict_recurse* x, t_symbol* cmd_sym) {
+
+  x->edit_log->journal = NULL;
+  if (!x->journal || !_dict_recurse_is_editing(x)) { return; }
+
+  if (!x->a_journal) { _dict_recurse_journal_clear(x); return; }
+
+  journal_begin(x->journal, cmd_sym);
+  x->edit_log->journal = x->journal;
+  _dict_recurse_journal_mark(x);
+}
 
 //******************************************************************************
-//  replace key (sym: dictionary) (sym: search key) (sym: replace key)
-//  replace value (sym: dictionary) (sym: search value) (sym: replace value)
-//  replace entry (sym: dictionary) (sym: search key) (sym: search value) (sym: replace key) (sym: replace value)
-//  replace dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value) (sym: replace dict)
-//  replace value_from_dict (sym: dictionary) (sym: search key) (sym: replace dict)
+//  Mark the dictionaries of the command, and watch them for the modifications
+//  of other objects. All are marked when the command begins, on the main thread,
+//  the undo starting from the first mark of the command.
 //
-void dict_recurse_replace(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+void _dict_recurse_journal_mark(t_dict_recurse* x) {
 
-  TRACE("dict_recurse_replace");
+  t_int32 dict_cnt = x->multi_cnt ? x->multi_cnt : 1;
 
-  t_symbol* search_key_sym = gensym("");
-  t_symbol* search_val_sym = gensym("");
+  for (t_int32 ind = 0; ind < dict_cnt; ind++) {
 
-  // Arg 1: Find a key, all entries with the key in, a value, or a dictionary
-  t_symbol* cmd_arg = atom_getsym(argv);
-  t_symbol* cmd_sym = gensym("");
-  if (cmd_arg == gensym("key")) { x->command = CMD_REPLACE_KEY; cmd_sym = gensym("replace key"); }
-  else if (cmd_arg == gensym("value")) { x->command = CMD_REPLACE_VALUE_SYM; cmd_sym = gensym("replace value"); }
-  else if (cmd_arg == gensym("entry")) { x->command = CMD_REPLACE_ENTRY; cmd_sym = gensym("replace entry"); }
-  else if (cmd_arg == gensym("dict_cont_entry")) { x->command = CMD_REPLACE_DICT_CONT_ENTRY; cmd_sym = gensym("replace dict_cont_entry"); }
-  else if (cmd_arg == gensym("value_from_dict")) { x->command = CMD_REPLACE_VALUE_FROM_DICT; cmd_sym = gensym("replace value_from_dict"); }
-  else { MY_ASSERT(1, , "replace:  Arg 0:  Invalid argument."); }
+    t_journal_mark* mark = journal_mark(x->journal, x->multi_cnt ? x->multi_arr[ind].dict_sym : x->dict_sym);
+    if (!mark) { MY_ERR("%s:  Allocation error for the undo journal.", x->journal->cmd_sym->s_name); return; }
 
-  switch (x->command) {
+    _dict_recurse_watch(x, &mark->dict, x->multi_cnt ? x->multi_arr[ind].dict : x->dict);
+  }
+}
 
-  // replace key (sym: dictionary) (sym: search key) (sym: replace key)
-  case CMD_REPLACE_KEY:
-    search_key_sym = atom_getsym(argv + 2);
-    x->replace_key_sym = atom_getsym(argv + 3);
-    MY_ASSERT(search_key_sym == gensym(""), , "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(x->replace_key_sym == gensym(""), , "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
-    regexpr_set(x->search_key_expr, search_key_sym);
-    break;
+//******************************************************************************
+//  Stop watching the dictionaries of the marks dropped from the journal.
+//
+//  @param mark_cnt The number of marks before they were dropped.
+//
+void _dict_recurse_journal_pop(t_dict_recurse* x, t_int32 mark_cnt) {
 
-  // replace value (sym: dictionary) (sym: search value) (sym: replace value)
-  case CMD_REPLACE_VALUE_SYM:
-    search_val_sym = atom_getsym(argv + 2);
-    x->replace_val_sym = atom_getsym(argv + 3);
-    MY_ASSERT(search_val_sym == gensym(""), , "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(x->replace_val_sym == gensym(""), , "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
-    regexpr_set(x->search_val_expr, search_val_sym);
-    break;
+  for (t_int32 ind = x->journal->mark_cnt; ind < mark_cnt; ind++) {
+    _dict_recurse_watch(x, &x->journal->mark_arr[ind].dict, NULL);
+  }
+}
 
-  // replace dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value) (sym: replace dict)
-  case CMD_REPLACE_DICT_CONT_ENTRY:
-    search_key_sym = atom_getsym(argv + 2);
-    search_val_sym = atom_getsym(argv + 3);
-    x->replace_dict_sym = atom_getsym(argv + 4);
-    MY_ASSERT(search_key_sym == gensym(""), , "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(search_val_sym == gensym(""), , "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(x->replace_dict_sym == gensym(""), , "%s:  Arg 4:  Invalid argument.", cmd_sym->s_name);
-    regexpr_set(x->search_key_expr, search_key_sym);
-    regexpr_set(x->search_val_expr, search_val_sym);
+//******************************************************************************
+//  Clear the journal and stop watching its dictionaries.
+//
+void _dict_recurse_journal_clear(t_dict_recurse* x) {
 
-    x->replace_dict = dictobj_findregistered_retain(x->replace_dict_sym);
-    MY_ASSERT(!x->replace_dict, , "%s:  Arg 4:  Unable to reference the dictionary named \"%s\".",
-      cmd_sym->s_name, x->replace_dict_sym->s_name);
-    break;
+  t_int32 mark_cnt = x->journal->mark_cnt;
 
-  // replace value_from_dict (sym: dictionary) (sym: search key) (sym: replace dict)
-  case CMD_REPLACE_VALUE_FROM_DICT:
-    search_key_sym = atom_getsym(argv + 2);
-    x->replace_dict_sym = atom_getsym(argv + 3);
-    MY_ASSERT(search_key_sym == gensym(""), , "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(x->replace_dict_sym == gensym(""), , "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
-    regexpr_set(x->search_key_expr, search_key_sym);
+  journal_clear(x->journal);
+  _dict_recurse_journal_pop(x, mark_cnt);
+}
 
-    x->replace_dict = dictobj_findregistered_retain(x->replace_dict_sym);
-    MY_ASSERT(!x->replace_dict, , "%s:  Arg 3:  Unable to reference the dictionary named \"%s\".",
-      cmd_sym->s_name, x->replace_dict_sym->s_name);
-    break;
+// ====  _DICT_RECURSE_LAUNCH  ====
+//******************************************************************************
+//  Run a command once its arguments are set: on the calling thread,
+//  or on a worker thread in async mode, in which case the posts are buffered
+//  and the command ends on the main thread.
+//
+void _dict_recurse_launch(t_dict_recurse* x, t_symbol* cmd_sym) {
 
-  // replace entry (sym: dictionary) (sym: search key) (sym: search value) (sym: replace key) (sym: replace value)
-  case CMD_REPLACE_ENTRY:
-    search_key_sym = atom_getsym(argv + 2);
-    search_val_sym = atom_getsym(argv + 3);
-    x->replace_key_sym = atom_getsym(argv + 4);
-    x->replace_val_sym = atom_getsym(argv + 5);
-    MY_ASSERT(search_key_sym == gensym(""), , "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(search_val_sym == gensym(""), , "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(x->replace_key_sym == gensym(""), , "%s:  Arg 4:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(x->replace_val_sym == gensym(""), , "%s:  Arg 5:  Invalid argument.", cmd_sym->s_name);
-    regexpr_set(x->search_key_expr, search_key_sym);
-    regexpr_set(x->search_val_expr, search_val_sym);
-    break;
+  TRACE("_dict_recurse_launch");
 
-  default: break;
+  x->cmd_sym = cmd_sym;
+
+  // Compile the replacement dictionary once, to stamp out its copies
+  if (x->replace_dict && (dicttmpl_set(x->replace_tmpl, x->replace_dict) != ERR_NONE)) {
+    MY_ERR("%s:  Allocation error for the replacement template.", cmd_sym->s_name);
+  }
+
+  _dict_recurse_start(x);
 }
 
-  // Initialize the object variables
-  if (_dict_recurse_begin_cmd(x, argv + 1, cmd_sym) != ERR_NONE) { return; }
+// ====  _DICT_RECURSE_START  ====
+//******************************************************************************
+//  Run a command over its dictionary, or over each dictionary of a multi-dictionary command.
+//
+void _dict_recurse_start(t_dict_recurse* x) {
+
+  TRACE("_dict_recurse_start");
+
+  t_symbol* cmd_sym = x->cmd_sym;
+
+  if (x->a_async) {
 
-  // Start the recursion
-  _dict_recurse_dict(x, x->dict, 0);
+    x->walk.out_buf = (char*)sysmem_newptr(1024);
+    if (x->walk.out_buf) {
+      x->walk.out_max = 1024;
+      x->is_async = true;
+      if (systhread_create((method)_dict_recurse_worker, x, 0, 0, 0, &x->async_thread) == MAX_ERR_NONE) { return; }
+    }
 
-  // Notify that the dictionary has been modified
-  if (x->count > 0) {
-    object_notify(x->dict, gensym("modified"), NULL);
+    // Otherwise run the command synchronously
+    WARNING("%s:  Unable to start a worker thread.", cmd_sym->s_name);
+    x->is_async = false;
+    if (x->walk.out_buf) { sysmem_freeptr(x->walk.out_buf); }
+    x->walk.out_buf = NULL;
+    x->walk.out_max = 0;
+    x->async_thread = NULL;
   }
 
-  // Post a summary for the command
-  POST("%s:  %i replacement%s made in \"%s\".", cmd_sym->s_name, x->count, (x->count == 1) ? "" : "s", x->dict_sym->s_name);
+  // In time-sliced mode, run the first slice now. The key index is not used,
+  // since building it would not be sliced. A JSON file is streamed in one go.
+  else if ((x->a_slice > 0) && !x->stream) {
+    _dict_recurse_slice(x);
+    _dict_recurse_tick(x);
+    return;
+  }
 
-  // End the command
-  _dict_recurse_end_cmd(x);
+  do { _dict_recurse_exec(x); } while (_dict_recurse_next(x));
+  _dict_recurse_finish(x);
 }
 
-// ====  DICT_RECURSE_APPEND  ====
+// ====  _DICT_RECURSE_SLICE  ====
+//******************************************************************************
+//  Start the time-sliced traversal of the dictionary to process.
+//
+void _dict_recurse_slice(t_dict_recurse* x) {
+
+  // Watch the dictionary, unless it already is for a key index or a result cache
+  x->slice_attached = !_dict_recurse_is_watched(x, x->dict);
+  if (x->slice_attached) { object_attach_byptr(x, x->dict); }
+
+  _dict_recurse_dict(x, &x->walk, x->dict, 0);
+}
 
+// ====  _DICT_RECURSE_EXEC  ====
 //******************************************************************************
-//  append in_dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value) (sym: replace key) (sym: replace value)
-//  append in_dict_cont_entry_d (sym: dictionary) (sym: search key) (sym: search value) (sym: replace key) (sym: replace dict)
-//  append in_dict_from_key (sym: dictionary) (sym: search key) (sym: replace key) (sym: replace dict)
+//  Process the command: stream it over a JSON file, serve it from the result
+//  cache or the key index, or start the recursion.
 //
-void dict_recurse_append(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+//  On the worker thread of an async command, the recursion is always started:
+//  the key indexes, result caches and snapshots are invalidated by the
+//  notifications, and attach the object to the dictionaries, on the main thread.
+//
+void _dict_recurse_exec(t_dict_recurse* x) {
 
-  TRACE("dict_recurse_append");
+  if (x->stream) { _dict_recurse_stream(x); return; }
+  if (x->is_async) { _dict_recurse_run(x); return; }
 
-  t_symbol* search_key_sym = gensym("");
-  t_symbol* search_val_sym = gensym("");
+  t_resultcache* cache = _dict_recurse_cache(x);
 
-  // Arg 1: Find a key, all entries with the key in, a value, or a dictionary
-  t_symbol* cmd_arg = atom_getsym(argv);
-  t_symbol* cmd_sym = gensym("");
-  if (cmd_arg == gensym("in_dict_cont_entry")) { x->command = CMD_APPEND_IN_DICT_CONT_ENTRY; cmd_sym = gensym("append in_dict_cont_entry"); }
-  else if (cmd_arg == gensym("in_dict_cont_entry_d")) { x->command = CMD_APPEND_IN_DICT_CONT_ENTRY_D; cmd_sym = gensym("append in_dict_cont_entry_d"); }
-  else if (cmd_arg == gensym("in_dict_from_key")) { x->command = CMD_APPEND_IN_DICT_FROM_KEY; cmd_sym = gensym("append in_dict_from_key"); }
-  else { MY_ASSERT(1, , "replace:  Arg 0:  Invalid argument."); }
+  if (cache) { _dict_recurse_cached(x, cache); }
+  else if (!_dict_recurse_indexed(x, &x->walk)) { _dict_recurse_run(x); }
+}
 
-  switch (x->command) {
+// ====  _DICT_RECURSE_WORKER  ====
+//******************************************************************************
+//  Worker thread of an asynchronous command.
+//
+void* _dict_recurse_worker(t_dict_recurse* x) {
 
-  // append in_dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value) (sym: replace key) (sym: replace value)
-  case CMD_APPEND_IN_DICT_CONT_ENTRY:
-    search_key_sym = atom_getsym(argv + 2);
-    search_val_sym = atom_getsym(argv + 3);
-    x->replace_key_sym = atom_getsym(argv + 4);
-    x->replace_val_sym = atom_getsym(argv + 5);
-    MY_ASSERT(search_key_sym == gensym(""), , "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(search_val_sym == gensym(""), , "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(x->replace_key_sym == gensym(""), , "%s:  Arg 4:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(x->replace_val_sym == gensym(""), , "%s:  Arg 5:  Invalid argument.", cmd_sym->s_name);
-    regexpr_set(x->search_key_expr, search_key_sym);
-    regexpr_set(x->search_val_expr, search_val_sym);
-    break;
+  do { _dict_recurse_exec(x); } while (_dict_recurse_next(x));
+  qelem_set(x->async_qelem);
 
-  // append in_dict_cont_entry_d (sym: dictionary) (sym: search key) (sym: search value) (sym: replace key) (sym: replace dict)
-  case CMD_APPEND_IN_DICT_CONT_ENTRY_D:
-    search_key_sym = atom_getsym(argv + 2);
-    search_val_sym = atom_getsym(argv + 3);
-    x->replace_key_sym = atom_getsym(argv + 4);
-    x->replace_dict_sym = atom_getsym(argv + 5);
-    MY_ASSERT(search_key_sym == gensym(""), , "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(search_val_sym == gensym(""), , "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(x->replace_key_sym == gensym(""), , "%s:  Arg 4:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(x->replace_dict_sym == gensym(""), , "%s:  Arg 5:  Invalid argument.", cmd_sym->s_name);
-    regexpr_set(x->search_key_expr, search_key_sym);
-    regexpr_set(x->search_val_expr, search_val_sym);
+  systhread_exit(0);
+  return NULL;
+}
 
-    x->replace_dict = dictobj_findregistered_retain(x->replace_dict_sym);
-    MY_ASSERT(!x->replace_dict, , "%s:  Arg 5:  Unable to reference the dictionary named \"%s\".",
-      cmd_sym->s_name, x->replace_dict_sym->s_name);
-    break;
+// ====  _DICT_RECURSE_DONE  ====
+//******************************************************************************
+//  End an asynchronous command on the main thread: post the buffered lines,
+//  notify the modifications, post the summary and bang.
+//
+void _dict_recurse_done(t_dict_recurse* x) {
 
-  // append in_dict_from_key (sym: dictionary) (sym: search key) (sym: replace key) (sym: replace dict)
-  case CMD_APPEND_IN_DICT_FROM_KEY:
-    search_key_sym = atom_getsym(argv + 2);
-    x->replace_key_sym = atom_getsym(argv + 3);
-    x->replace_dict_sym = atom_getsym(argv + 4);
-    MY_ASSERT(search_key_sym == gensym(""), , "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(x->replace_key_sym == gensym(""), , "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(x->replace_dict_sym == gensym(""), , "%s:  Arg 4:  Invalid argument.", cmd_sym->s_name);
-    regexpr_set(x->search_key_expr, search_key_sym);
+  TRACE("_dict_recurse_done");
 
-    x->replace_dict = dictobj_findregistered_retain(x->replace_dict_sym);
-    MY_ASSERT(!x->replace_dict, , "%s:  Arg 4:  Unable to reference the dictionary named \"%s\".",
-      cmd_sym->s_name, x->replace_dict_sym->s_name);
-    break;
+  if (!x->async_thread) { return; }
 
-  default: break;
+  systhread_join(x->async_thread, NULL);
+  x->async_thread = NULL;
+
+  _dict_recurse_flush(x, &x->walk);
+  sysmem_freeptr(x->walk.out_buf);
+  x->walk.out_buf = NULL;
+  x->walk.out_max = 0;
+
+  _dict_recurse_finish(x);
 }
 
-  // Initialize the object variables
-  if (_dict_recurse_begin_cmd(x, argv + 1, cmd_sym) != ERR_NONE) { return; }
+// ====  _DICT_RECURSE_TICK  ====
+//******************************************************************************
+//  Run one slice of a time-sliced command, and output the nodes visited so far.
+//  The command ends once the traversal is complete, otherwise the next slice
+//  is scheduled for the next tick.
+//
+void _dict_recurse_tick(t_dict_recurse* x) {
 
-  // Start the recursion
-  _dict_recurse_dict(x, x->dict, 0);
+  TRACE("_dict_recurse_tick");
 
-  // Notify that the dictionary has been modified
-  if (x->count > 0) {
-    object_notify(x->dict, gensym("modified"), NULL);
+  t_bool is_done = true;
+
+  if (x->is_stale) {
+    WARNING("%s:  \"%s\" was modified by another object, the command is abandoned.",
+      x->cmd_sym->s_name, x->dict_sym->s_name);
+    _dict_recurse_abandon(x, &x->walk);
   }
+  else { is_done = _dict_recurse_walk(x, &x->walk, 0, systimer_gettime() + x->a_slice); }
 
-  // Post a summary for the command
-  POST("%s:  %i entr%s appended in \"%s\".", cmd_sym->s_name, x->count, (x->count == 1) ? "y" : "ies", x->dict_sym->s_name);
+  outlet_int(x->outl_progress, x->walk.node_cnt);
 
-  // End the command
-  _dict_recurse_end_cmd(x);
-}
+  if (!is_done) { clock_delay(x->slice_clock, 0); return; }
 
-// ====  DICT_RECURSE_DELETE  ====
+  if (x->slice_attached) { object_detach_byptr(x, x->dict); x->slice_attached = false; }
+
+  // Continue with the next dictionary of a multi-dictionary command, on the next tick
+  if (_dict_recurse_next(x)) {
+    _dict_recurse_slice(x);
+    clock_delay(x->slice_clock, 0);
+    return;
+  }
 
+  _dict_recurse_finish(x);
+}
+
+// ====  _DICT_RECURSE_FINISH  ====
 //******************************************************************************
-//  delete key (sym: dictionary) (sym: search key)
-//  delete value (sym: dictionary) (sym: search value)
-//  delete entry (sym: dictionary) (sym: search key) (sym: search value)
-//  delete dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value)
+//  Notify the modifications, post a summary for the command and end it.
 //
-void dict_recurse_delete(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+void _dict_recurse_finish(t_dict_recurse* x) {
 
-  TRACE("dict_recurse_delete");
+  TRACE("_dict_recurse_finish");
 
-  t_symbol* search_key_sym = gensym("");
-  t_symbol* search_val_sym = gensym("");
+  const char* cmd_s = x->cmd_sym->s_name;
+  const char* dict_s = x->multi_cnt ? x->multi_sym->s_name : x->dict_sym->s_name;
+  t_int32 count = x->walk.count;
 
-  // Arg 1: Find a key, all entries with the key in, a value, or a dictionary
-  t_symbol* cmd_arg = atom_getsym(argv);
-  t_symbol* cmd_sym = gensym("");
-  if (cmd_arg == gensym("key")) { x->command = CMD_DELETE_KEY; cmd_sym = gensym("delete key"); }
-  else if (cmd_arg == gensym("value")) { x->command = CMD_DELETE_VALUE_SYM; cmd_sym = gensym("delete value"); }
-  else if (cmd_arg == gensym("entry")) { x->command = CMD_DELETE_ENTRY; cmd_sym = gensym("delete entry"); }
-  else if (cmd_arg == gensym("dict_cont_entry")) { x->command = CMD_DELETE_DICT_CONT_ENTRY; cmd_sym = gensym("delete dict_cont_entry"); }
-  else { MY_ASSERT(1, , "delete:  Arg 0:  Invalid argument."); }
+  if (x->is_cancelled) { WARNING("%s:  Cancelled.", cmd_s); }
+
+  _dict_recurse_output(x, &x->walk);
 
   switch (x->command) {
 
-  // delete key (sym: dictionary) (sym: search key)
-  case CMD_DELETE_KEY:
-    search_key_sym = atom_getsym(argv + 2);
-    MY_ASSERT(search_key_sym == gensym(""), , "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
-    regexpr_set(x->search_key_expr, search_key_sym);
+  case CMD_ALL:
+  case CMD_FIND_KEY_IN:
+  case CMD_FIND_KEY:
+  case CMD_FIND_VALUE_SYM:
+  case CMD_FIND_ENTRY:
+  case CMD_FIND_DICT_CONT_ENTRY:
+  case CMD_FIND_NUMBER:
+    POST("%s:  %i reference%s found in \"%s\".", cmd_s, count, (count == 1) ? "" : "s", dict_s);
     break;
 
-  // delete value (sym: dictionary) (sym: search value)
-  case CMD_DELETE_VALUE_SYM:
-    search_val_sym = atom_getsym(argv + 2);
-    MY_ASSERT(search_val_sym == gensym(""), , "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
-    regexpr_set(x->search_val_expr, search_val_sym);
+  case CMD_REPLACE_KEY:
+  case CMD_REPLACE_VALUE_SYM:
+  case CMD_REPLACE_ENTRY:
+  case CMD_REPLACE_DICT_CONT_ENTRY:
+  case CMD_REPLACE_VALUE_FROM_DICT:
+  case CMD_REPLACE_NUMBER:
+    if ((count > 0) && x->dict) { _dict_recurse_modified(x, x->dict); }
+    POST("%s:  %i replacement%s made in \"%s\".", cmd_s, count, (count == 1) ? "" : "s", dict_s);
     break;
 
-  // delete entry (sym: dictionary) (sym: search key) (sym: search value)
-  // delete dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value)
+  case CMD_APPEND_IN_DICT_CONT_ENTRY:
+  case CMD_APPEND_IN_DICT_CONT_ENTRY_D:
+  case CMD_APPEND_IN_DICT_FROM_KEY:
+    if ((count > 0) && x->dict) { _dict_recurse_modified(x, x->dict); }
+    POST("%s:  %i entr%s appended in \"%s\".", cmd_s, count, (count == 1) ? "y" : "ies", dict_s);
+    break;
+
+  case CMD_DELETE_KEY:
+  case CMD_DELETE_VALUE_SYM:
   case CMD_DELETE_ENTRY:
   case CMD_DELETE_DICT_CONT_ENTRY:
-    search_key_sym = atom_getsym(argv + 2);
-    search_val_sym = atom_getsym(argv + 3);
-    MY_ASSERT(search_key_sym == gensym(""), , "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
-    MY_ASSERT(search_val_sym == gensym(""), , "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
-    regexpr_set(x->search_key_expr, search_key_sym);
-    regexpr_set(x->search_val_expr, search_val_sym);
+  case CMD_DELETE_NUMBER:
+    if ((count > 0) && x->dict) { _dict_recurse_modified(x, x->dict); }
+    POST("%s:  %i deletion%s made in \"%s\".", cmd_s, count, (count == 1) ? "" : "s", dict_s);
     break;
 
+  case CMD_BATCH: {
+    t_bool is_modified = false;
+    POST("%s:  %i operation%s applied to \"%s\".", cmd_s, x->batch_cnt, (x->batch_cnt == 1) ? "" : "s", dict_s);
+    for (t_int32 ind = 0; ind < x->batch_cnt; ind++) {
+      t_batch_op* op = x->batch_arr + ind;
+      POST("  %s:  %s:  %i", op->label->s_name, op->cmd_sym->s_name, op->count);
+      if (op->count && !CMD_IS_FIND(op->command)) { is_modified = true; }
+    }
+    if (is_modified && x->dict) { _dict_recurse_modified(x, x->dict); }
+    break; }
+
   default: break;
+  }
+
+  // Notify the modified dictionaries of a multi-dictionary command
+  for (t_int32 ind = 0; ind < x->multi_cnt; ind++) {
+    t_multi* multi = x->multi_arr + ind;
+    if (multi->is_modified) { _dict_recurse_modified(x, multi->dict); }
+    if (x->a_verbose) { POST("  \"%s\":  %i", multi->dict_sym->s_name, multi->count); }
+  }
+
+  _dict_recurse_end_cmd(x);
+}
+
+// ====  _DICT_RECURSE_END_CMD  ====
+
+void _dict_recurse_end_cmd(t_dict_recurse* x) {
+
+  TRACE("_dict_recurse_end_cmd");
+
+  // Complete the stats of the command, before the batch is released
+  x->walk.stats.cmd_cnt = 1;
+  x->walk.stats.atom_cnt += x->walk.node_cnt;
+  x->walk.stats.edit_cnt = _dict_recurse_edit_count(x);
+  x->walk.stats.time_ms = systimer_gettime() - x->cmd_time;
+  x->stats_last = x->walk.stats;
+  walkstats_add(&x->stats_total, &x->stats_last);
+
+  TRACEBUF_EVENT(x->walk.trace_lane, 'E', "command", "command", NULL);
+
+  // Release the dictionary or dictionaries
+  _dict_recurse_release(x);
+
+  if (x->a_verbose && x->par_task_cnt) {
+    POST("  Parallel traversal:  %i tasks on %i threads, %i stolen.", x->par_task_cnt, x->par_thread_cnt, x->par_steal_cnt);
+  }
+
+  if (x->a_verbose && x->walk.read_cnt) {
+    POST("  %i dictionar%s read with %i allocation%s.", x->walk.read_cnt, (x->walk.read_cnt == 1) ? "y" : "ies",
+      x->walk.alloc_cnt, (x->walk.alloc_cnt == 1) ? "" : "s");
+  }
+
+  if (x->a_verbose && x->replace_tmpl->stamp_cnt) {
+    POST("  %i cop%s stamped from the template of \"%s\".", x->replace_tmpl->stamp_cnt,
+      (x->replace_tmpl->stamp_cnt == 1) ? "y" : "ies", x->replace_dict_sym->s_name);
+  }
+
+  if (x->a_verbose && x->edit_log->dict_cnt) {
+    POST("  %i dictionar%s rebuilt.", x->edit_log->dict_cnt, (x->edit_log->dict_cnt == 1) ? "y" : "ies");
+  }
+
+  if (x->edit_log->drop_cnt) {
+    WARNING("%s:  %i edit%s dropped, for entries missing or already edited.", x->cmd_sym->s_name,
+      x->edit_log->drop_cnt, (x->edit_log->drop_cnt == 1) ? "" : "s");
+  }
+
+  // Forget a command which edited nothing, so that undo reaches the previous one
+  t_journal* journal = x->edit_log->journal;
+  if (journal) {
+    t_journal_mark* mark = journal_last(journal);
+    t_int32 rec_cnt = journal->rec_cnt - journal->cmd_rec_ini;
+
+    if (!rec_cnt && mark && (mark->cmd_ind == journal->cmd_cnt)) {
+      t_int32 mark_cnt = journal->mark_cnt;
+      journal_undo(journal);
+      _dict_recurse_journal_pop(x, mark_cnt);
+    }
+    else if (x->a_verbose && rec_cnt) {
+      POST("  %i edit%s journaled, %i in total.", rec_cnt, (rec_cnt == 1) ? "" : "s", journal->rec_cnt);
+    }
+  }
+
+  // Reset the object variables
+  _dict_recurse_reset(x);
+
+  // Indicate the completion of the cmd with a bang
+  outlet_bang(x->outl_bang);
+}
+
+// ====  _DICT_RECURSE_QUERY  ====
+//******************************************************************************
+//  The query of a read-only command as one symbol, keying the result cache:
+//  the command and its arguments, with the path selector instead of the dictionary
+//  name, and the attributes that change the result or its posts. Each argument
+//  is prefixed with its type, and the symbols with their length, so that
+//  arguments with spaces do not run into the next ones.
+//
+//  @return The query, or NULL if it is too long to be cached.
+//
+t_symbol* _dict_recurse_query(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  char query_s[MAX_LEN_PATH];
+  char atom_s[MAX_LEN_NUMBER];
+  const char* path_s = x->path_expr->path_sym->s_name;
+
+  snprintf_zero(query_s, MAX_LEN_PATH, "%s %ld %i %i s%i:%s", sym->s_name, x->a_depth, (t_int32)x->a_output,
+    (t_int32)x->a_verbose, (t_int32)strlen(path_s), path_s);
+  if (strlen(query_s) + 1 >= MAX_LEN_PATH) { return NULL; }
+
+  for (t_int32 ind = 0; ind < argc; ind++) {
+
+    if (ind == 1) { continue; }    // The dictionary name
+
+    const char* str = "";
+    switch (atom_gettype(argv + ind)) {
+    case A_LONG: snprintf_zero(atom_s, MAX_LEN_NUMBER, " l%lld", (long long)atom_getlong(argv + ind)); break;
+    case A_FLOAT: snprintf_zero(atom_s, MAX_LEN_NUMBER, " f%.17g", atom_getfloat(argv + ind)); break;
+    default:
+      str = atom_getsym(argv + ind)->s_name;
+      snprintf_zero(atom_s, MAX_LEN_NUMBER, " s%i:", (t_int32)strlen(str));
+      break;
+    }
+
+    if (strlen(query_s) + strlen(atom_s) + strlen(str) + 1 >= MAX_LEN_PATH) { return NULL; }
+    strncat_zero(query_s, atom_s, MAX_LEN_PATH);
+    strncat_zero(query_s, str, MAX_LEN_PATH);
+  }
+
+  return gensym(query_s);
+}
+
+// ====  DICT_RECURSE_ALL  ====
+//******************************************************************************
+//  all (sym: dictionary)
+//
+void dict_recurse_all(t_dict_recurse* x, t_symbol* dict_sym) {
+
+  TRACE("dict_recurse_all");
+
+  MY_ASSERT(x->is_busy, , "all:  The object is still busy.");
+
+  // Initialize the object variables
+  x->command = CMD_ALL;
+
+  t_atom dict_ato[1];
+  atom_setsym(dict_ato, dict_sym);
+  if (_dict_recurse_begin_cmd(x, dict_ato, gensym("all")) != ERR_NONE) { return; }
+  x->query_sym = _dict_recurse_query(x, gensym("all"), 0, NULL);
+
+  // Run the command, then post a summary and end it
+  _dict_recurse_launch(x, gensym("all"));
+}
+
+// ====  DICT_RECURSE_FIND  ====
+
+//******************************************************************************
+//  find key (sym: dictionary) (sym: search key)
+//  find key_in (sym: dictionary) (sym: search key)
+//  find value (sym: dictionary) (sym: search value)
+//  find entry (sym: dictionary) (sym: search key) (sym: search value)
+//  find dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value)
+//  find number (sym: dictionary) (= (num) | range (num: min) (num: max) | near (num) (num: tolerance))
+//
+t_my_err _dict_recurse_parse_find(t_dict_recurse* x, long argc, t_atom* argv, t_symbol** cmd_out) {
+
+  TRACE("_dict_recurse_parse_find");
+
+  _dict_recurse_trace_set(x);
+
+  t_symbol* search_key_sym = gensym("");
+  t_symbol* search_val_sym = gensym("");
+
+  // Arg 0: Find a key, all entries with the key in, a value, or a dictionary
+  t_symbol* cmd_arg = atom_getsym(argv);
+  t_symbol* cmd_sym = gensym("");
+  if (cmd_arg == gensym("key")) { x->command = CMD_FIND_KEY; cmd_sym = gensym("find key"); }
+  else if (cmd_arg == gensym("key_in")) { x->command = CMD_FIND_KEY_IN; cmd_sym = gensym("find key_in"); }
+  else if (cmd_arg == gensym("value")) { x->command = CMD_FIND_VALUE_SYM; cmd_sym = gensym("find value"); }
+  else if (cmd_arg == gensym("entry")) { x->command = CMD_FIND_ENTRY; cmd_sym = gensym("find entry"); }
+  else if (cmd_arg == gensym("dict_cont_entry")) { x->command = CMD_FIND_DICT_CONT_ENTRY; cmd_sym = gensym("find dict_cont_entry"); }
+  else if (cmd_arg == gensym("number")) { x->command = CMD_FIND_NUMBER; cmd_sym = gensym("find number"); }
+  else { MY_ASSERT(1, ERR_ARG_VALUE, "find:  Arg 0:  Invalid argument."); }
+
+  switch (x->command) {
+
+  // find key (sym: dictionary) (sym: search key)
+  // find key_in (sym: dictionary) (sym: search key)
+  case CMD_FIND_KEY:
+  case CMD_FIND_KEY_IN:
+    search_key_sym = atom_getsym(argv + 2);
+    MY_ASSERT(search_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
+    regexpr_set(x->search_key_expr, search_key_sym);
+    break;
+
+  // find value (sym: dictionary) (sym: search value)
+  case CMD_FIND_VALUE_SYM:
+    search_val_sym = atom_getsym(argv + 2);
+    MY_ASSERT(search_val_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
+    regexpr_set(x->search_val_expr, search_val_sym);
+    break;
+
+  // find entry (sym: dictionary) (sym: search key) (sym: search value)
+  // find dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value)
+  case CMD_FIND_ENTRY:
+  case CMD_FIND_DICT_CONT_ENTRY:
+    search_key_sym = atom_getsym(argv + 2);
+    search_val_sym = atom_getsym(argv + 3);
+    MY_ASSERT(search_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(search_val_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
+    regexpr_set(x->search_key_expr, search_key_sym);
+    regexpr_set(x->search_val_expr, search_val_sym);
+    break;
+
+  // find number (sym: dictionary) (predicate)
+  case CMD_FIND_NUMBER:
+    MY_ASSERT(!numpred_set(&x->num_pred, argc - 2, argv + 2), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid numeric predicate.", cmd_sym->s_name);
+    break;
+
+    default: break;
+  }
+
+  *cmd_out = cmd_sym;
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  find ...:  Parse the arguments, then run the command.
+//
+void dict_recurse_find(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  TRACE("dict_recurse_find");
+
+  t_symbol* cmd_sym = gensym("");
+
+  // Test if the object is already busy, before the arguments of a running command are overwritten
+  MY_ASSERT(x->is_busy, , "%s:  The object is still busy.", sym->s_name);
+
+  if (_dict_recurse_parse_find(x, argc, argv, &cmd_sym) != ERR_NONE) { return; }
+
+  // Initialize the object variables
+  if (_dict_recurse_begin_cmd(x, argv + 1, cmd_sym) != ERR_NONE) { return; }
+  x->query_sym = _dict_recurse_query(x, sym, argc, argv);
+
+  // Run the command, then post a summary and end it
+  _dict_recurse_launch(x, cmd_sym);
+}
+
+// ====  DICT_RECURSE_REPLACE  ====
+
+//******************************************************************************
+//  replace key (sym: dictionary) (sym: search key) (sym: replace key)
+//  replace value (sym: dictionary) (sym: search value) (sym: replace value)
+//  replace entry (sym: dictionary) (sym: search key) (sym: search value) (sym: replace key) (sym: replace value)
+//  replace dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value) (sym: replace dict)
+//  replace value_from_dict (sym: dictionary) (sym: search key) (sym: replace dict)
+//  replace number (sym: dictionary) (predicate) (num: replace value)
+//
+t_my_err _dict_recurse_parse_replace(t_dict_recurse* x, long argc, t_atom* argv, t_symbol** cmd_out) {
+
+  TRACE("_dict_recurse_parse_replace");
+
+  _dict_recurse_trace_set(x);
+
+  t_symbol* search_key_sym = gensym("");
+  t_symbol* search_val_sym = gensym("");
+
+  // Arg 1: Find a key, all entries with the key in, a value, or a dictionary
+  t_symbol* cmd_arg = atom_getsym(argv);
+  t_symbol* cmd_sym = gensym("");
+  if (cmd_arg == gensym("key")) { x->command = CMD_REPLACE_KEY; cmd_sym = gensym("replace key"); }
+  else if (cmd_arg == gensym("value")) { x->command = CMD_REPLACE_VALUE_SYM; cmd_sym = gensym("replace value"); }
+  else if (cmd_arg == gensym("entry")) { x->command = CMD_REPLACE_ENTRY; cmd_sym = gensym("replace entry"); }
+  else if (cmd_arg == gensym("dict_cont_entry")) { x->command = CMD_REPLACE_DICT_CONT_ENTRY; cmd_sym = gensym("replace dict_cont_entry"); }
+  else if (cmd_arg == gensym("value_from_dict")) { x->command = CMD_REPLACE_VALUE_FROM_DICT; cmd_sym = gensym("replace value_from_dict"); }
+  else if (cmd_arg == gensym("number")) { x->command = CMD_REPLACE_NUMBER; cmd_sym = gensym("replace number"); }
+  else { MY_ASSERT(1, ERR_ARG_VALUE, "replace:  Arg 0:  Invalid argument."); }
+
+  switch (x->command) {
+
+  // replace key (sym: dictionary) (sym: search key) (sym: replace key)
+  case CMD_REPLACE_KEY:
+    search_key_sym = atom_getsym(argv + 2);
+    x->replace_key_sym = atom_getsym(argv + 3);
+    MY_ASSERT(search_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(x->replace_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
+    regexpr_set(x->search_key_expr, search_key_sym);
+    break;
+
+  // replace value (sym: dictionary) (sym: search value) (sym: replace value)
+  case CMD_REPLACE_VALUE_SYM:
+    search_val_sym = atom_getsym(argv + 2);
+    x->replace_val_sym = atom_getsym(argv + 3);
+    MY_ASSERT(search_val_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(x->replace_val_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
+    regexpr_set(x->search_val_expr, search_val_sym);
+    break;
+
+  // replace dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value) (sym: replace dict)
+  case CMD_REPLACE_DICT_CONT_ENTRY:
+    search_key_sym = atom_getsym(argv + 2);
+    search_val_sym = atom_getsym(argv + 3);
+    x->replace_dict_sym = atom_getsym(argv + 4);
+    MY_ASSERT(search_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(search_val_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(x->replace_dict_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 4:  Invalid argument.", cmd_sym->s_name);
+    regexpr_set(x->search_key_expr, search_key_sym);
+    regexpr_set(x->search_val_expr, search_val_sym);
+
+    x->replace_dict = dictobj_findregistered_retain(x->replace_dict_sym);
+    MY_ASSERT(!x->replace_dict, ERR_ARG_VALUE, "%s:  Arg 4:  Unable to reference the dictionary named \"%s\".",
+      cmd_sym->s_name, x->replace_dict_sym->s_name);
+    break;
+
+  // replace value_from_dict (sym: dictionary) (sym: search key) (sym: replace dict)
+  case CMD_REPLACE_VALUE_FROM_DICT:
+    search_key_sym = atom_getsym(argv + 2);
+    x->replace_dict_sym = atom_getsym(argv + 3);
+    MY_ASSERT(search_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(x->replace_dict_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
+    regexpr_set(x->search_key_expr, search_key_sym);
+
+    x->replace_dict = dictobj_findregistered_retain(x->replace_dict_sym);
+    MY_ASSERT(!x->replace_dict, ERR_ARG_VALUE, "%s:  Arg 3:  Unable to reference the dictionary named \"%s\".",
+      cmd_sym->s_name, x->replace_dict_sym->s_name);
+    break;
+
+  // replace entry (sym: dictionary) (sym: search key) (sym: search value) (sym: replace key) (sym: replace value)
+  case CMD_REPLACE_ENTRY:
+    search_key_sym = atom_getsym(argv + 2);
+    search_val_sym = atom_getsym(argv + 3);
+    x->replace_key_sym = atom_getsym(argv + 4);
+    x->replace_val_sym = atom_getsym(argv + 5);
+    MY_ASSERT(search_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(search_val_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(x->replace_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 4:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(x->replace_val_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 5:  Invalid argument.", cmd_sym->s_name);
+    regexpr_set(x->search_key_expr, search_key_sym);
+    regexpr_set(x->search_val_expr, search_val_sym);
+    break;
+
+  // replace number (sym: dictionary) (predicate) (num: replace value)
+  case CMD_REPLACE_NUMBER: {
+    t_int32 pred_cnt = numpred_set(&x->num_pred, argc - 2, argv + 2);
+    MY_ASSERT(!pred_cnt, ERR_ARG_VALUE, "%s:  Arg 2:  Invalid numeric predicate.", cmd_sym->s_name);
+    MY_ASSERT((argc <= 2 + pred_cnt) || ((atom_gettype(argv + 2 + pred_cnt) != A_LONG) && (atom_gettype(argv + 2 + pred_cnt) != A_FLOAT)), ERR_ARG_VALUE,
+      "%s:  Arg %i:  Invalid argument.", cmd_sym->s_name, 2 + pred_cnt);
+    x->replace_num = argv[2 + pred_cnt];
+    break; }
+
+  default: break;
+}
+
+  *cmd_out = cmd_sym;
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  replace ...:  Parse the arguments, then run the command.
+//
+void dict_recurse_replace(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  TRACE("dict_recurse_replace");
+
+  t_symbol* cmd_sym = gensym("");
+
+  // Test if the object is already busy, before the arguments of a running command are overwritten
+  MY_ASSERT(x->is_busy, , "%s:  The object is still busy.", sym->s_name);
+
+  if (_dict_recurse_parse_replace(x, argc, argv, &cmd_sym) != ERR_NONE) { return; }
+
+  // Initialize the object variables
+  if (_dict_recurse_begin_cmd(x, argv + 1, cmd_sym) != ERR_NONE) { return; }
+
+  // Run the command, then post a summary and end it
+  _dict_recurse_launch(x, cmd_sym);
+}
+
+// ====  DICT_RECURSE_APPEND  ====
+
+//******************************************************************************
+//  append in_dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value) (sym: replace key) (sym: replace value)
+//  append in_dict_cont_entry_d (sym: dictionary) (sym: search key) (sym: search value) (sym: replace key) (sym: replace dict)
+//  append in_dict_from_key (sym: dictionary) (sym: search key) (sym: replace key) (sym: replace dict)
+//
+t_my_err _dict_recurse_parse_append(t_dict_recurse* x, long argc, t_atom* argv, t_symbol** cmd_out) {
+
+  TRACE("_dict_recurse_parse_append");
+
+  _dict_recurse_trace_set(x);
+
+  t_symbol* search_key_sym = gensym("");
+  t_symbol* search_val_sym = gensym("");
+
+  // Arg 1: Find a key, all entries with the key in, a value, or a dictionary
+  t_symbol* cmd_arg = atom_getsym(argv);
+  t_symbol* cmd_sym = gensym("");
+  if (cmd_arg == gensym("in_dict_cont_entry")) { x->command = CMD_APPEND_IN_DICT_CONT_ENTRY; cmd_sym = gensym("append in_dict_cont_entry"); }
+  else if (cmd_arg == gensym("in_dict_cont_entry_d")) { x->command = CMD_APPEND_IN_DICT_CONT_ENTRY_D; cmd_sym = gensym("append in_dict_cont_entry_d"); }
+  else if (cmd_arg == gensym("in_dict_from_key")) { x->command = CMD_APPEND_IN_DICT_FROM_KEY; cmd_sym = gensym("append in_dict_from_key"); }
+  else { MY_ASSERT(1, ERR_ARG_VALUE, "replace:  Arg 0:  Invalid argument."); }
+
+  switch (x->command) {
+
+  // append in_dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value) (sym: replace key) (sym: replace value)
+  case CMD_APPEND_IN_DICT_CONT_ENTRY:
+    search_key_sym = atom_getsym(argv + 2);
+    search_val_sym = atom_getsym(argv + 3);
+    x->replace_key_sym = atom_getsym(argv + 4);
+    x->replace_val_sym = atom_getsym(argv + 5);
+    MY_ASSERT(search_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(search_val_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(x->replace_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 4:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(x->replace_val_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 5:  Invalid argument.", cmd_sym->s_name);
+    regexpr_set(x->search_key_expr, search_key_sym);
+    regexpr_set(x->search_val_expr, search_val_sym);
+    break;
+
+  // append in_dict_cont_entry_d (sym: dictionary) (sym: search key) (sym: search value) (sym: replace key) (sym: replace dict)
+  case CMD_APPEND_IN_DICT_CONT_ENTRY_D:
+    search_key_sym = atom_getsym(argv + 2);
+    search_val_sym = atom_getsym(argv + 3);
+    x->replace_key_sym = atom_getsym(argv + 4);
+    x->replace_dict_sym = atom_getsym(argv + 5);
+    MY_ASSERT(search_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(search_val_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(x->replace_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 4:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(x->replace_dict_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 5:  Invalid argument.", cmd_sym->s_name);
+    regexpr_set(x->search_key_expr, search_key_sym);
+    regexpr_set(x->search_val_expr, search_val_sym);
+
+    x->replace_dict = dictobj_findregistered_retain(x->replace_dict_sym);
+    MY_ASSERT(!x->replace_dict, ERR_ARG_VALUE, "%s:  Arg 5:  Unable to reference the dictionary named \"%s\".",
+      cmd_sym->s_name, x->replace_dict_sym->s_name);
+    break;
+
+  // append in_dict_from_key (sym: dictionary) (sym: search key) (sym: replace key) (sym: replace dict)
+  case CMD_APPEND_IN_DICT_FROM_KEY:
+    search_key_sym = atom_getsym(argv + 2);
+    x->replace_key_sym = atom_getsym(argv + 3);
+    x->replace_dict_sym = atom_getsym(argv + 4);
+    MY_ASSERT(search_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(x->replace_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(x->replace_dict_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 4:  Invalid argument.", cmd_sym->s_name);
+    regexpr_set(x->search_key_expr, search_key_sym);
+
+    x->replace_dict = dictobj_findregistered_retain(x->replace_dict_sym);
+    MY_ASSERT(!x->replace_dict, ERR_ARG_VALUE, "%s:  Arg 4:  Unable to reference the dictionary named \"%s\".",
+      cmd_sym->s_name, x->replace_dict_sym->s_name);
+    break;
+
+  default: break;
+}
+
+  *cmd_out = cmd_sym;
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  append ...:  Parse the arguments, then run the command.
+//
+void dict_recurse_append(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  TRACE("dict_recurse_append");
+
+  t_symbol* cmd_sym = gensym("");
+
+  // Test if the object is already busy, before the arguments of a running command are overwritten
+  MY_ASSERT(x->is_busy, , "%s:  The object is still busy.", sym->s_name);
+
+  if (_dict_recurse_parse_append(x, argc, argv, &cmd_sym) != ERR_NONE) { return; }
+
+  // Initialize the object variables
+  if (_dict_recurse_begin_cmd(x, argv + 1, cmd_sym) != ERR_NONE) { return; }
+
+  // Run the command, then post a summary and end it
+  _dict_recurse_launch(x, cmd_sym);
+}
+
+// ====  DICT_RECURSE_DELETE  ====
+
+//******************************************************************************
+//  delete key (sym: dictionary) (sym: search key)
+//  delete value (sym: dictionary) (sym: search value)
+//  delete entry (sym: dictionary) (sym: search key) (sym: search value)
+//  delete dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value)
+//  delete number (sym: dictionary) (predicate)
+//
+t_my_err _dict_recurse_parse_delete(t_dict_recurse* x, long argc, t_atom* argv, t_symbol** cmd_out) {
+
+  TRACE("_dict_recurse_parse_delete");
+
+  _dict_recurse_trace_set(x);
+
+  t_symbol* search_key_sym = gensym("");
+  t_symbol* search_val_sym = gensym("");
+
+  // Arg 1: Find a key, all entries with the key in, a value, or a dictionary
+  t_symbol* cmd_arg = atom_getsym(argv);
+  t_symbol* cmd_sym = gensym("");
+  if (cmd_arg == gensym("key")) { x->command = CMD_DELETE_KEY; cmd_sym = gensym("delete key"); }
+  else if (cmd_arg == gensym("value")) { x->command = CMD_DELETE_VALUE_SYM; cmd_sym = gensym("delete value"); }
+  else if (cmd_arg == gensym("entry")) { x->command = CMD_DELETE_ENTRY; cmd_sym = gensym("delete entry"); }
+  else if (cmd_arg == gensym("dict_cont_entry")) { x->command = CMD_DELETE_DICT_CONT_ENTRY; cmd_sym = gensym("delete dict_cont_entry"); }
+  else if (cmd_arg == gensym("number")) { x->command = CMD_DELETE_NUMBER; cmd_sym = gensym("delete number"); }
+  else { MY_ASSERT(1, ERR_ARG_VALUE, "delete:  Arg 0:  Invalid argument."); }
+
+  switch (x->command) {
+
+  // delete key (sym: dictionary) (sym: search key)
+  case CMD_DELETE_KEY:
+    search_key_sym = atom_getsym(argv + 2);
+    MY_ASSERT(search_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
+    regexpr_set(x->search_key_expr, search_key_sym);
+    break;
+
+  // delete value (sym: dictionary) (sym: search value)
+  case CMD_DELETE_VALUE_SYM:
+    search_val_sym = atom_getsym(argv + 2);
+    MY_ASSERT(search_val_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
+    regexpr_set(x->search_val_expr, search_val_sym);
+    break;
+
+  // delete entry (sym: dictionary) (sym: search key) (sym: search value)
+  // delete dict_cont_entry (sym: dictionary) (sym: search key) (sym: search value)
+  case CMD_DELETE_ENTRY:
+  case CMD_DELETE_DICT_CONT_ENTRY:
+    search_key_sym = atom_getsym(argv + 2);
+    search_val_sym = atom_getsym(argv + 3);
+    MY_ASSERT(search_key_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(search_val_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 3:  Invalid argument.", cmd_sym->s_name);
+    regexpr_set(x->search_key_expr, search_key_sym);
+    regexpr_set(x->search_val_expr, search_val_sym);
+    break;
+
+  // delete number (sym: dictionary) (predicate)
+  case CMD_DELETE_NUMBER:
+    MY_ASSERT(!numpred_set(&x->num_pred, argc - 2, argv + 2), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid numeric predicate.", cmd_sym->s_name);
+    break;
+
+  default: break;
+}
+
+  *cmd_out = cmd_sym;
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  delete ...:  Parse the arguments, then run the command.
+//
+void dict_recurse_delete(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  TRACE("dict_recurse_delete");
+
+  t_symbol* cmd_sym = gensym("");
+
+  // Test if the object is already busy, before the arguments of a running command are overwritten
+  MY_ASSERT(x->is_busy, , "%s:  The object is still busy.", sym->s_name);
+
+  if (_dict_recurse_parse_delete(x, argc, argv, &cmd_sym) != ERR_NONE) { return; }
+
+  // Initialize the object variables
+  if (_dict_recurse_begin_cmd(x, argv + 1, cmd_sym) != ERR_NONE) { return; }
+
+  // Run the command, then post a summary and end it
+  _dict_recurse_launch(x, cmd_sym);
+}
+
+// ====  DICT_RECURSE_BATCH  ====
+
+//******************************************************************************
+//  Copy the arguments of the command in the object to a batch operation.
+//
+void _batch_op_store(t_dict_recurse* x, t_batch_op* op) {
+
+  op->command = x->command;
+  op->op_bit = x->op_bit;
+  op->search_key_expr = x->search_key_expr;
+  op->search_val_expr = x->search_val_expr;
+  op->replace_key_sym = x->replace_key_sym;
+  op->replace_val_sym = x->replace_val_sym;
+  op->replace_dict_sym = x->replace_dict_sym;
+  op->replace_dict = x->replace_dict;
+  op->replace_tmpl = x->replace_tmpl;
+  op->num_pred = x->num_pred;
+  op->replace_num = x->replace_num;
+}
+
+//******************************************************************************
+//  Swap the arguments of a batch operation into the object, to process a node for it.
+//
+void _batch_op_load(t_dict_recurse* x, t_batch_op* op) {
+
+  x->command = op->command;
+  x->op_bit = op->op_bit;
+  x->search_key_expr = op->search_key_expr;
+  x->search_val_expr = op->search_val_expr;
+  x->replace_key_sym = op->replace_key_sym;
+  x->replace_val_sym = op->replace_val_sym;
+  x->replace_dict_sym = op->replace_dict_sym;
+  x->replace_dict = op->replace_dict;
+  x->replace_tmpl = op->replace_tmpl;
+  x->num_pred = op->num_pred;
+  x->replace_num = op->replace_num;
+}
+
+//******************************************************************************
+//  Parse one operation of a batch: a find, replace, append or delete command
+//  without its dictionary, which is inserted as argument 1.
+//
+//  @param dict_ato The dictionary of the batch.
+//  @param label The key or the line of the operation, for the error messages and the summary.
+//
+//  @return ERR_NONE, or an error in which case the batch is abandoned.
+//
+t_my_err _dict_recurse_batch_add(t_dict_recurse* x, t_atom* dict_ato, t_symbol* label, long argc, t_atom* argv) {
+
+  TRACE("_dict_recurse_batch_add");
+
+  t_atom arg_arr[BATCH_LINE_MAX + 1];
+  t_symbol* cmd_sym = gensym("");
+  t_my_err err = ERR_NONE;
+
+  MY_ASSERT(x->batch_cnt == BATCH_OP_MAX, ERR_ARR_FULL, "batch:  More than %i operations.", BATCH_OP_MAX);
+  MY_ASSERT((argc < 2) || (argc >= BATCH_LINE_MAX), ERR_ARG_VALUE, "batch:  %s:  Invalid operation.", label->s_name);
+
+  // Counted right away, so that it is freed on an error
+  t_batch_op* op = x->batch_arr + x->batch_cnt++;
+  op->search_key_expr = regexpr_new();
+  op->search_val_expr = regexpr_new();
+  op->replace_dict = NULL;
+  op->replace_tmpl = NULL;
+  MY_ASSERT(!op->search_key_expr || !op->search_val_expr, ERR_ALLOC,
+    "batch:  %s:  Allocation error for the search expressions.", label->s_name);
+
+  // Parse the operation with the arguments of the object swapped out
+  arg_arr[0] = argv[1];
+  arg_arr[1] = *dict_ato;
+  for (t_int32 ind = 2; ind <= BATCH_LINE_MAX; ind++) {    // NB: The missing arguments are read as empty symbols
+    if (ind < argc) { arg_arr[ind] = argv[ind]; }
+    else { atom_setsym(arg_arr + ind, gensym("")); }
+  }
+
+  x->search_key_expr = op->search_key_expr;
+  x->search_val_expr = op->search_val_expr;
+  x->replace_dict = NULL;
+  x->replace_tmpl = NULL;
+
+  t_symbol* cmd = atom_getsym(argv);
+  if (cmd == gensym("find")) { err = _dict_recurse_parse_find(x, argc, arg_arr, &cmd_sym); }
+  else if (cmd == gensym("replace")) { err = _dict_recurse_parse_replace(x, argc, arg_arr, &cmd_sym); }
+  else if (cmd == gensym("append")) { err = _dict_recurse_parse_append(x, argc, arg_arr, &cmd_sym); }
+  else if (cmd == gensym("delete")) { err = _dict_recurse_parse_delete(x, argc, arg_arr, &cmd_sym); }
+  else { err = ERR_ARG_VALUE; }
+
+  // Compile the replacement dictionary of the operation
+  if ((err == ERR_NONE) && x->replace_dict) {
+    x->replace_tmpl = dicttmpl_new();
+    if (!x->replace_tmpl || (dicttmpl_set(x->replace_tmpl, x->replace_dict) != ERR_NONE)) { err = ERR_ALLOC; }
+  }
+
+  _batch_op_store(x, op);
+  op->label = label;
+  op->cmd_sym = cmd_sym;
+  op->op_bit = (t_uint64)1 << (x->batch_cnt - 1);
+  op->count = 0;
+
+  MY_ASSERT(err != ERR_NONE, err, "batch:  %s:  Invalid operation \"%s\".", label->s_name, cmd->s_name);
+
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  Read the operations of a batch from the entries of a dictionary, in order:
+//  each one is an array, or a string to parse.
+//
+t_my_err _dict_recurse_batch_dict(t_dict_recurse* x, t_atom* dict_ato, t_dictionary* src_dict) {
+
+  TRACE("_dict_recurse_batch_dict");
+
+  t_my_err err = ERR_NONE;
+  t_atom value[1];
+
+  long key_cnt = 0;
+  t_symbol** key_arr = NULL;
+  dictionary_getkeys(src_dict, &key_cnt, &key_arr);
+
+  for (t_int32 ind = 0; (ind < key_cnt) && (err == ERR_NONE); ind++) {
+
+    dictionary_getatom(src_dict, key_arr[ind], value);
+
+    if (atomisatomarray(value)) {
+      long argc;
+      t_atom* argv;
+      atomarray_getatoms((t_atomarray*)atom_getobj(value), &argc, &argv);
+      err = _dict_recurse_batch_add(x, dict_ato, key_arr[ind], argc, argv);
+    }
+
+    else {
+      long argc = 0;
+      t_atom* argv = NULL;
+      atom_setparse(&argc, &argv, atom_getsym(value)->s_name);
+      err = _dict_recurse_batch_add(x, dict_ato, key_arr[ind], argc, argv);
+      if (argv) { sysmem_freeptr(argv); }
+    }
+  }
+
+  if (key_arr) { dictionary_freekeys(src_dict, key_cnt, key_arr); }
+
+  return err;
+}
+
+//******************************************************************************
+//  Read the operations of a batch from a text file, one per line.
+//  Empty lines and lines starting with # are skipped.
+//
+t_my_err _dict_recurse_batch_file(t_dict_recurse* x, t_atom* dict_ato, t_symbol* file_sym) {
+
+  TRACE("_dict_recurse_batch_file");
+
+  t_my_err err = ERR_NONE;
+  char file_s[MAX_PATH_CHARS];
+  short path_id;
+  t_fourcc file_type;
+  t_filehandle file;
+  t_ptr_size len;
+
+  strncpy_zero(file_s, file_sym->s_name, MAX_PATH_CHARS);
+  MY_ASSERT(locatefile_extended(file_s, &path_id, &file_type, NULL, 0), ERR_DICT_NONE,
+    "batch:  Arg 1:  Unable to find a dictionary or a file named \"%s\".", file_sym->s_name);
+  MY_ASSERT(path_opensysfile(file_s, path_id, &file, READ_PERM), ERR_DICT_NONE,
+    "batch:  Arg 1:  Unable to open the file \"%s\".", file_sym->s_name);
+
+  sysfile_geteof(file, &len);
+  char* text = (char*)sysmem_newptr(len + 1);
+  if (text) { sysfile_read(file, &len, text); text[len] = '\0'; }
+  sysfile_close(file);
+  MY_ASSERT(!text, ERR_ALLOC, "batch:  Allocation error for the file \"%s\".", file_sym->s_name);
+
+  // Parse the file line by line
+  char* line = text;
+  for (t_int32 line_ind = 1; line && (err == ERR_NONE); line_ind++) {
+
+    char* next = strchr(line, '\n');
+    if (next) { *next++ = '\0'; }
+
+    long argc = 0;
+    t_atom* argv = NULL;
+    atom_setparse(&argc, &argv, line);
+
+    if (argc && (atom_getsym(argv)->s_name[0] != '#')) {
+      char label_s[MAX_LEN_NUMBER];
+      snprintf_zero(label_s, MAX_LEN_NUMBER, "line %i", line_ind);
+      err = _dict_recurse_batch_add(x, dict_ato, gensym(label_s), argc, argv);
+    }
+
+    if (argv) { sysmem_freeptr(argv); }
+    line = next;
+  }
+
+  sysmem_freeptr(text);
+
+  return err;
+}
+
+//******************************************************************************
+//  Free the operations of a batch, and release their dictionaries.
+//
+void _dict_recurse_batch_free(t_dict_recurse* x) {
+
+  for (t_int32 ind = 0; ind < x->batch_cnt; ind++) {
+    t_batch_op* op = x->batch_arr + ind;
+    if (op->search_key_expr) { regexpr_free(op->search_key_expr); }
+    if (op->search_val_expr) { regexpr_free(op->search_val_expr); }
+    if (op->replace_dict) { dictobj_release(op->replace_dict); }
+    dicttmpl_free(op->replace_tmpl);
+  }
+
+  if (x->batch_arr) { sysmem_freeptr(x->batch_arr); }
+  x->batch_arr = NULL;
+  x->batch_cnt = 0;
+}
+
+//******************************************************************************
+//  batch (sym: dictionary) (sym: batch dictionary or text file)
+//
+//  Apply a sequence of operations in one traversal, each node being processed for
+//  each operation in order. An operation is a find, replace, append or delete
+//  command without its dictionary, as an entry of a registered dictionary, or
+//  as a line of a text file:
+//    replace value foo bar
+//    delete key gain
+//
+//  For a dictionary entry, the operations on its key (find key, replace key,
+//  delete key and replace value_from_dict) all run before the operations on its value.
+//  An entry is edited once: the editing operations after the first one to edit
+//  it, in this order, skip it.
+//
+void dict_recurse_batch(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  TRACE("dict_recurse_batch");
+
+  t_my_err err = ERR_NONE;
+  t_symbol* cmd_sym = gensym("batch");
+
+  MY_ASSERT(x->is_busy, , "batch:  The object is still busy.");
+  MY_ASSERT(argc < 2, , "batch:  Missing arguments.");
+
+  t_symbol* src_sym = atom_getsym(argv + 1);
+  MY_ASSERT(src_sym == gensym(""), , "batch:  Arg 1:  Invalid argument.");
+
+  x->batch_arr = (t_batch_op*)sysmem_newptr(BATCH_OP_MAX * sizeof(t_batch_op));
+  MY_ASSERT(!x->batch_arr, , "batch:  Allocation error for the operations.");
+  x->batch_cnt = 0;
+
+  // Keep the arguments of the object itself, to restore them around each node
+  x->command = CMD_BATCH;
+  x->op_bit = 1;
+  x->replace_dict = NULL;
+  _batch_op_store(x, &x->batch_self);
+
+  // Read the operations from a registered dictionary, or from a text file
+  t_dictionary* src_dict = dictobj_findregistered_retain(src_sym);
+  if (src_dict) {
+    err = _dict_recurse_batch_dict(x, argv, src_dict);
+    dictobj_release(src_dict);
+  }
+  else { err = _dict_recurse_batch_file(x, argv, src_sym); }
+
+  _batch_op_load(x, &x->batch_self);
+
+  if ((err == ERR_NONE) && !x->batch_cnt) {
+    MY_ERR("batch:  No operation in \"%s\".", src_sym->s_name);
+    err = ERR_COUNT;
+  }
+
+  // Initialize the object variables
+  if ((err != ERR_NONE) || (_dict_recurse_begin_cmd(x, argv, cmd_sym) != ERR_NONE)) {
+    _dict_recurse_batch_free(x);
+    return;
+  }
+
+  // Run the operations, then post a summary and end the batch
+  _dict_recurse_launch(x, cmd_sym);
+}
+
+// ====  DICT_RECURSE_FILE  ====
+
+//******************************************************************************
+//  Open the JSON file of a streaming command, and the file to write it to.
+//
+//  @param file_ato The file, optionally followed by a path selector:  archive.json::presets::*
+//  @param out_ato The output file, or NULL for a read-only command.
+//
+t_my_err _dict_recurse_begin_file(t_dict_recurse* x, t_atom* file_ato, t_atom* out_ato, t_symbol* cmd_sym) {
+
+  TRACE("_dict_recurse_begin_file");
+
+  char file_s[MAX_PATH_CHARS];
+  char out_s[MAX_PATH_CHARS];
+  short path_id;
+  short out_path_id;
+  t_fourcc file_type;
+  t_filehandle file = NULL;
+  t_filehandle out_file = NULL;
+
+  // Test if the object is already busy
+  MY_ASSERT(x->is_busy, ERR_LOCKED, "%s:  The object is still busy.", cmd_sym->s_name);
+
+  x->cmd_time = systimer_gettime();
+  _dict_recurse_trace_set(x);
+
+  // Arg 1: The file to process, optionally followed by a path selector
+  t_symbol* file_sym = atom_getsym(file_ato);
+  MY_ASSERT(file_sym == gensym(""), ERR_ARG_VALUE, "%s:  Arg 1:  Invalid argument.", cmd_sym->s_name);
+
+  char* sep = strstr(file_sym->s_name, PATH_SEP_S);
+  strncpy_zero(file_s, file_sym->s_name, sep ? MIN((long)(sep - file_sym->s_name + 1), MAX_PATH_CHARS) : MAX_PATH_CHARS);
+  x->dict_sym = gensym(file_s);
+
+  if (sep) {
+    MY_ASSERT(pathexpr_set(x->path_expr, sep + 2) != ERR_NONE, ERR_SYNTAX,
+      "%s:  Arg 1:  Invalid path selector \"%s\".", cmd_sym->s_name, sep + 2);
+  }
+  else { pathexpr_reset(x->path_expr); }
+
+  // Arg 2: The output file, which cannot be the file read
+  if (out_ato) {
+    MY_ASSERT(atom_getsym(out_ato) == gensym(""), ERR_ARG_VALUE, "%s:  Arg 2:  Invalid argument.", cmd_sym->s_name);
+    MY_ASSERT(atom_getsym(out_ato) == x->dict_sym, ERR_ARG_VALUE,
+      "%s:  Arg 2:  The output file has to be different from the file read.", cmd_sym->s_name);
+  }
+
+  MY_ASSERT(locatefile_extended(file_s, &path_id, &file_type, NULL, 0), ERR_DICT_NONE,
+    "%s:  Arg 1:  Unable to find a file named \"%s\".", cmd_sym->s_name, x->dict_sym->s_name);
+  MY_ASSERT(path_opensysfile(file_s, path_id, &file, READ_PERM), ERR_DICT_NONE,
+    "%s:  Arg 1:  Unable to open the file \"%s\".", cmd_sym->s_name, x->dict_sym->s_name);
+
+  // An output file without a full path is created next to the file read
+  if (out_ato) {
+    if (path_frompotentialpathname(atom_getsym(out_ato)->s_name, &out_path_id, out_s)) {
+      strncpy_zero(out_s, atom_getsym(out_ato)->s_name, MAX_PATH_CHARS);
+      out_path_id = path_id;
+    }
+
+    if (path_createsysfile(out_s, out_path_id, 'TEXT', &out_file)) {
+      sysfile_close(file);
+      MY_ASSERT(1, ERR_ARG_VALUE, "%s:  Arg 2:  Unable to create the file \"%s\".", cmd_sym->s_name, atom_getsym(out_ato)->s_name);
+    }
+  }
+
+  x->stream = jsonstream_new(file, out_file, x->dict_sym->s_name);
+  if (!x->stream) {
+    sysfile_close(file);
+    if (out_file) { sysfile_close(out_file); }
+    MY_ASSERT(1, ERR_ALLOC, "%s:  Allocation error for the file \"%s\".", cmd_sym->s_name, x->dict_sym->s_name);
+  }
+
+  // Set the object to busy status
+  x->is_busy = true;
+  TRACEBUF_EVENT(x->walk.trace_lane, 'B', "command", cmd_sym->s_name, x->dict_sym);
+
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  find_file key (sym: file) (sym: search key)
+//  find_file value (sym: file) (sym: search value)
+//  find_file entry (sym: file) (sym: search key) (sym: search value)
+//  find_file number (sym: file) (predicate)
+//
+//  Search a JSON file as it is read, without loading it into a dictionary.
+//
+void dict_recurse_find_file(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  TRACE("dict_recurse_find_file");
+
+  t_symbol* cmd_sym = gensym("");
+
+  // Test if the object is already busy, before the arguments of a running command are overwritten
+  MY_ASSERT(x->is_busy, , "%s:  The object is still busy.", sym->s_name);
+  MY_ASSERT(argc < 3, , "%s:  Missing arguments.", sym->s_name);
+
+  t_symbol* cmd_arg = atom_getsym(argv);
+  MY_ASSERT((cmd_arg != gensym("key")) && (cmd_arg != gensym("value")) && (cmd_arg != gensym("entry"))
+    && (cmd_arg != gensym("number")), , "%s:  Arg 0:  Invalid argument.", sym->s_name);
+  MY_ASSERT((cmd_arg == gensym("entry")) && (argc < 4), , "%s:  Missing arguments.", sym->s_name);
+
+  if (_dict_recurse_parse_find(x, argc, argv, &cmd_sym) != ERR_NONE) { return; }
+
+  // Initialize the object variables
+  if (_dict_recurse_begin_file(x, argv + 1, NULL, cmd_sym) != ERR_NONE) { return; }
+
+  // Run the command, then post a summary and end it
+  _dict_recurse_launch(x, cmd_sym);
+}
+
+//******************************************************************************
+//  replace_file key (sym: file) (sym: output file) (sym: search key) (sym: replace key)
+//  replace_file value (sym: file) (sym: output file) (sym: search value) (sym: replace value)
+//  replace_file entry (sym: file) (sym: output file) (sym: search key) (sym: search value) (sym: replace key) (sym: replace value)
+//  replace_file number (sym: file) (sym: output file) (predicate) (num: replace value)
+//
+//  Copy a JSON file to an output file as it is read, with the replacements.
+//
+void dict_recurse_replace_file(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  TRACE("dict_recurse_replace_file");
+
+  t_symbol* cmd_sym = gensym("");
+  t_atom arg_arr[BATCH_LINE_MAX];
+
+  // Test if the object is already busy, before the arguments of a running command are overwritten
+  MY_ASSERT(x->is_busy, , "%s:  The object is still busy.", sym->s_name);
+  MY_ASSERT(argc < 5, , "%s:  Missing arguments.", sym->s_name);
+  MY_ASSERT(argc > BATCH_LINE_MAX, , "%s:  Too many arguments.", sym->s_name);
+
+  t_symbol* cmd_arg = atom_getsym(argv);
+  MY_ASSERT((cmd_arg != gensym("key")) && (cmd_arg != gensym("value")) && (cmd_arg != gensym("entry"))
+    && (cmd_arg != gensym("number")), , "%s:  Arg 0:  Invalid argument.", sym->s_name);
+  MY_ASSERT((cmd_arg == gensym("entry")) && (argc < 7), , "%s:  Missing arguments.", sym->s_name);
+
+  // Parse the arguments as those of replace, without the output file
+  arg_arr[0] = argv[0];
+  arg_arr[1] = argv[1];
+  for (t_int32 ind = 3; ind < argc; ind++) { arg_arr[ind - 1] = argv[ind]; }
+
+  if (_dict_recurse_parse_replace(x, argc - 1, arg_arr, &cmd_sym) != ERR_NONE) { return; }
+
+  // Initialize the object variables
+  if (_dict_recurse_begin_file(x, argv + 1, argv + 2, cmd_sym) != ERR_NONE) { return; }
+
+  // Run the command, then post a summary and end it
+  _dict_recurse_launch(x, cmd_sym);
+}
+
+// ====  _WALK  ====
+
+//******************************************************************************
+//  Initialize the trailing state of a traversal, allocating its path.
+//
+t_my_err _walk_init(t_walk* w, t_int32 path_len_max) {
+
+  w->out_buf = NULL;
+  w->out_max = 0;
+  w->frame_arr = NULL;
+  w->frame_max = 0;
+  w->entry_buf = NULL;
+  w->entry_max = 0;
+  w->res_arr = NULL;
+  w->res_max = 0;
+  w->seg_cnt = 0;
+  w->trace_lane = NULL;
+
+  w->path = (char*)sysmem_newptr(sizeof(char) * path_len_max);
+  if (!w->path) { return ERR_ALLOC; }
+
+  _walk_reset(w);
+
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  Free the allocations of the trailing state of a traversal.
+//
+void _walk_free(t_walk* w) {
+
+  if (w->path) { sysmem_freeptr(w->path); w->path = NULL; }
+  if (w->out_buf) { sysmem_freeptr(w->out_buf); w->out_buf = NULL; }
+  if (w->frame_arr) { sysmem_freeptr(w->frame_arr); w->frame_arr = NULL; }
+  if (w->res_arr) { sysmem_freeptr(w->res_arr); w->res_arr = NULL; }
+  if (w->entry_buf) { sysmem_freeptr(w->entry_buf); w->entry_buf = NULL; }
+}
+
+//******************************************************************************
+//  Reset the trailing state of a traversal. The path selector state is set by the caller.
+//
+void _walk_reset(t_walk* w) {
+
+  w->type_iter = VALUE_TYPE_NONE;
+  w->dict_iter = NULL;
+  w->key_iter = gensym("");
+  w->array_iter = NULL;
+  w->index_iter = -1;
+  w->path[0] = '\0';
+  w->count = 0;
+  w->has_match = 0;
+  w->is_edited = false;
+  w->is_selected = true;
+  w->out_len = 0;
+  w->depth_cut = 0;
+  w->is_cut = false;
+  w->frame_cnt = 0;
+  w->node_cnt = 0;
+  w->res_len = 0;
+  w->entry_len = 0;
+  w->read_cnt = 0;
+  w->alloc_cnt = 0;
+  walkstats_clear(&w->stats);
+}
+
+//******************************************************************************
+//  Push a frame on the traversal stack, growing it if necessary.
+//
+//  @return A pointer to the new frame, valid until the next push, or NULL on failure.
+//
+t_frame* _walk_push(t_walk* w) {
+
+  if (w->frame_cnt == w->frame_max) {
+
+    t_int32 frame_max = w->frame_max ? 2 * w->frame_max : FRAME_CNT_INI;
+    t_frame* frame_arr = w->frame_arr
+      ? (t_frame*)sysmem_resizeptr(w->frame_arr, frame_max * sizeof(t_frame))
+      : (t_frame*)sysmem_newptr(frame_max * sizeof(t_frame));
+    if (!frame_arr) { return NULL; }
+
+    w->frame_arr = frame_arr;
+    w->frame_max = frame_max;
+    w->alloc_cnt++;
+  }
+
+  t_frame* frame = w->frame_arr + w->frame_cnt++;
+
+  // Store the trailing state on entering the loop
+  frame->ind = 0;
+  frame->is_pending = false;
+  frame->type_iter = w->type_iter;
+  frame->dict_iter = w->dict_iter;
+  frame->key_iter = w->key_iter;
+  frame->array_iter = w->array_iter;
+  frame->index_iter = w->index_iter;
+  frame->path_state = w->path_state;
+  frame->is_selected = w->is_selected;
+  frame->has_match = w->has_match;
+  frame->path_len = (t_int32)strlen(w->path);
+
+  return frame;
+}
+
+//******************************************************************************
+//  Make room for a number of entries at the top of the entry buffer.
+//  The entries of a dictionary are stored there while it is on the stack,
+//  so that the buffer is reused by the next dictionaries instead of allocating keys for each one.
+//
+//  @return A pointer to the first free entry, valid until the next call, or NULL on failure.
+//
+t_entry* _walk_entries_grow(t_walk* w, t_int32 entry_cnt) {
+
+  if (!w->entry_buf || (w->entry_len + entry_cnt > w->entry_max)) {
+
+    t_int32 entry_max = MAX(w->entry_max ? 2 * w->entry_max : ENTRY_CNT_INI, w->entry_len + entry_cnt);
+    t_entry* entry_buf = w->entry_buf
+      ? (t_entry*)sysmem_resizeptr(w->entry_buf, entry_max * sizeof(t_entry))
+      : (t_entry*)sysmem_newptr(entry_max * sizeof(t_entry));
+    if (!entry_buf) { return NULL; }
+
+    w->entry_buf = entry_buf;
+    w->entry_max = entry_max;
+    w->alloc_cnt++;
+  }
+
+  return w->entry_buf + w->entry_len;
+}
+
+// ====  _DICT_RECURSE_POST  ====
+//******************************************************************************
+//  Post a line from a traversal: directly, or to the buffer of a parallel task.
+//
+void _dict_recurse_post(t_dict_recurse* x, t_walk* w, const char* fmt, ...) {
+
+  char str[MAX_LEN_POST];
+  va_list args;
+
+  va_start(args, fmt);
+  vsnprintf(str, MAX_LEN_POST, fmt, args);
+  va_end(args);
+  str[MAX_LEN_POST - 1] = '\0';
+
+  if (!w->out_max) { object_post((t_object*)x, "%s", str); return; }
+
+  // Append the line to the buffer, including its terminating null character
+  t_int32 len = (t_int32)strlen(str) + 1;
+
+  if (w->out_len + len > w->out_max) {
+    t_int32 out_max = MAX(2 * w->out_max, w->out_len + len);
+    char* out_buf = (char*)sysmem_resizeptr(w->out_buf, out_max);
+    if (!out_buf) { return; }
+    w->out_buf = out_buf;
+    w->out_max = out_max;
+  }
+
+  memcpy(w->out_buf + w->out_len, str, len);
+  w->out_len += len;
+}
+
+// ====  _DICT_RECURSE_FLUSH  ====
+//******************************************************************************
+//  Post the lines buffered by an asynchronous command, in order, on the main thread.
+//
+void _dict_recurse_flush(t_dict_recurse* x, t_walk* w) {
+
+  for (t_int32 ofs = 0; ofs < w->out_len; ofs += (t_int32)strlen(w->out_buf + ofs) + 1) {
+    object_post((t_object*)x, "%s", w->out_buf + ofs);
+  }
+
+  w->out_len = 0;
+}
+
+// ====  _DICT_RECURSE_RESULT  ====
+
+//******************************************************************************
+//  Make room for a number of atoms at the end of the recorded matches.
+//
+//  @return A pointer to the first atom, or NULL on failure.
+//
+t_atom* _walk_results_grow(t_walk* w, t_int32 len) {
+
+  if (w->res_len + len > w->res_max) {
+
+    t_int32 res_max = MAX(w->res_max ? 2 * w->res_max : 256, w->res_len + len);
+    t_atom* res_arr = w->res_arr
+      ? (t_atom*)sysmem_resizeptr(w->res_arr, res_max * sizeof(t_atom))
+      : (t_atom*)sysmem_newptr(res_max * sizeof(t_atom));
+    if (!res_arr) { return NULL; }
+
+    w->res_arr = res_arr;
+    w->res_max = res_max;
+  }
+
+  return w->res_arr + w->res_len;
+}
+
+//******************************************************************************
+//  Write the head of a recorded match: its length, type, key and value.
+//
+static void _walk_result_head(t_atom* res, t_int32 len, t_symbol* key, t_atom* value) {
+
+  atom_setlong(res, len - 1);
+  atom_setsym(res + 2, key);
+
+  if (atom_gettype(value) == A_LONG) { atom_setsym(res + 1, gensym("int")); res[3] = *value; }
+  else if (atom_gettype(value) == A_FLOAT) { atom_setsym(res + 1, gensym("float")); res[3] = *value; }
+  else if (atomisdictionary(value)) { atom_setsym(res + 1, gensym("dict")); atom_setsym(res + 3, gensym("_DICT_")); }
+  else if (atomisatomarray(value)) { atom_setsym(res + 1, gensym("array")); atom_setsym(res + 3, gensym("_ARRAY_")); }
+  else { atom_setsym(res + 1, gensym("symbol")); atom_setsym(res + 3, atom_getsym(value)); }
+}
+
+//******************************************************************************
+//  Record a match for list output: its type, key and value, then the segments of its path,
+//  taken from the traversal stack without formatting the path.
+//
+void _dict_recurse_result(t_dict_recurse* x, t_walk* w, t_atom* value) {
+
+  t_int32 len = 4 + w->seg_cnt + w->frame_cnt;    // Length, type, key, value and segments
+  t_atom* res = _walk_results_grow(w, len);
+  if (!res) { MY_ERR("Allocation error for the results."); return; }
+
+  _walk_result_head(res, len, w->key_iter, value);
+
+  res += 4;
+  for (t_int32 ind = 0; ind < w->seg_cnt; ind++) { *res++ = w->seg_arr[ind]; }
+
+  for (t_int32 ind = 0; ind < w->frame_cnt; ind++) {
+    t_frame* f = w->frame_arr + ind;
+    if (f->type == VALUE_TYPE_DICT) { atom_setsym(res++, w->entry_buf[f->entry_ofs + f->ind].key); }
+    else { atom_setlong(res++, f->ind); }
+  }
+
+  w->res_len += len;
+}
+
+//******************************************************************************
+//  Output the recorded matches, one message each, on the main thread.
+//
+void _dict_recurse_output(t_dict_recurse* x, t_walk* w) {
+
+  for (t_int32 ofs = 0; ofs < w->res_len; ofs += (t_int32)atom_getlong(w->res_arr + ofs) + 1) {
+    outlet_anything(x->outl_mess, gensym("match"), (short)atom_getlong(w->res_arr + ofs), w->res_arr + ofs + 1);
+  }
+
+  w->res_len = 0;
+}
+
+// ====  _DICT_RECURSE_VALUE_STR  ====
+//******************************************************************************
+//  Format a value as it is posted by the find commands
+//
+const char* _dict_recurse_value_str(t_dict_recurse* x, t_walk* w, t_atom* value) {
+
+  long type = atom_gettype(value);
+
+  if (type == A_LONG) { snprintf_zero(w->str_tmp, MAX_LEN_NUMBER, "%lld", (long long)atom_getlong(value)); }
+  else if (type == A_FLOAT) { snprintf_zero(w->str_tmp, MAX_LEN_NUMBER, "%f", atom_getfloat(value)); }
+  else if ((type == A_SYM) || atomisstring(value)) { snprintf_zero(w->str_tmp, MAX_LEN_NUMBER, "\"%s\"", atom_getsym(value)->s_name); }
+  else if (atomisdictionary(value)) { return "_DICT_"; }
+  else if (atomisatomarray(value)) { return "_ARRAY_"; }
+  else { w->str_tmp[0] = '\0'; }
+
+  return w->str_tmp;
+}
+
+// ====  _DICT_RECURSE_INDEXED  ====
+//******************************************************************************
+//  Test if the command can be served from the key index: find key and replace key,
+//  over the whole dictionary, without selector or depth, and with posted output
+//  since the index stores the paths as strings.
+//
+t_bool _dict_recurse_can_index(t_dict_recurse* x) {
+
+  return x->a_index && !pathexpr_is_set(x->path_expr) && !x->a_depth && (x->a_output != OUTPUT_LIST)
+    && ((x->command == CMD_FIND_KEY) || (x->command == CMD_REPLACE_KEY));
+}
+
+//******************************************************************************
+//  Serve find key and replace key from the inverted key index of the dictionary,
+//  building the index on the first query or after a modification.
+//
+//  @return true if the command was processed, false to fall back on the recursion.
+//
+t_bool _dict_recurse_indexed(t_dict_recurse* x, t_walk* w) {
+
+  TRACE("_dict_recurse_indexed");
+
+  t_keyindex* index = NULL;
+  t_atom value[1];
+
+  if (!_dict_recurse_can_index(x)) { return false; }
+
+  // ==== Get the index for the dictionary, or create it
+  if (hashtab_lookup(x->index_tab, x->dict_sym, (t_object**)&index) != MAX_ERR_NONE) {
+    index = keyindex_new(x->dict_sym);
+    if (!index) { return false; }
+    hashtab_storeflags(x->index_tab, x->dict_sym, (t_object*)index, OBJ_FLAG_DATA);
+  }
+
+  // ==== Build it if necessary, and watch the dictionary for modifications
+  if (!keyindex_is_valid(index) || (index->dict != x->dict)) {
+
+    if (keyindex_build(index, x->dict, x->path_len_max) != ERR_NONE) { return false; }
+
+    if (index->dict_watched != x->dict) { _dict_recurse_watch(x, &index->dict_watched, x->dict); }
+
+    if (x->a_verbose) {
+      WALK_POST("  Key index built for \"%s\":  %i keys, %i entries.", x->dict_sym->s_name, index->key_cnt, index->occur_cnt);
+    }
+  }
+
+  // ==== Loop through the matching entries, in traversal order
+  for (t_int32 occur = keyindex_first(index, x->search_key_expr); (occur != -1) && !x->is_cancelled; occur = keyindex_next(index, occur)) {
+
+    t_dictionary* dict = index->occur_arr[occur].dict;
+    t_symbol* key = keyindex_key(index, occur);
+
+    dictionary_getatom(dict, key, value);
+    w->count++;
+
+    switch (x->command) {
+
+    case CMD_FIND_KEY:
+      WALK_POST("  %s  %s", keyindex_path(index, occur), _dict_recurse_value_str(x, w, value));
+      break;
+
+    case CMD_REPLACE_KEY:
+      LOG_EDIT(editlog_rename(x->edit_log, dict, key, x->replace_key_sym));
+
+      if (x->a_verbose == true) {
+        WALK_POST("  %s  replaced by  \"%s\"", keyindex_path(index, occur), x->replace_key_sym->s_name);
+      }
+      break;
+
+    default: break;
+    }
+  }
+
+  // ==== Apply the renamings, once per dictionary, then drop the index whose paths changed
+  editlog_apply(x->edit_log, 0);
+  if ((x->command == CMD_REPLACE_KEY) && (w->count > 0)) { keyindex_invalidate(index); }
+
+  return true;
+}
+
+// ====  _DICT_RECURSE_CACHED  ====
+//******************************************************************************
+//  Get the result cache of the dictionary, or create it, for a read-only command.
+//  The key index is preferred when it applies.
+//
+//  @return A pointer to the cache, or NULL if the command is not cached.
+//
+t_resultcache* _dict_recurse_cache(t_dict_recurse* x) {
+
+  t_resultcache* cache = NULL;
+
+  if (!x->a_cache || !x->query_sym || _dict_recurse_can_index(x)) { return NULL; }
+
+  if (hashtab_lookup(x->cache_tab, x->dict_sym, (t_object**)&cache) != MAX_ERR_NONE) {
+    cache = resultcache_new(x->dict_sym);
+    if (!cache) { return NULL; }
+    hashtab_storeflags(x->cache_tab, x->dict_sym, (t_object*)cache, OBJ_FLAG_DATA);
+  }
+
+  // Watch the dictionary, as a new version if the name refers to another one
+  if (cache->dict_watched != x->dict) {
+    _dict_recurse_watch(x, &cache->dict_watched, x->dict);
+    resultcache_bump(cache);
+  }
+
+  return cache;
+}
+
+//******************************************************************************
+//  Serve a read-only command from the result cache, if the same query was run
+//  on the same version of the dictionary. Otherwise run it with its posts
+//  buffered, and store its result.
+//
+void _dict_recurse_cached(t_dict_recurse* x, t_resultcache* cache) {
+
+  TRACE("_dict_recurse_cached");
+
+  t_walk* w = &x->walk;
+  t_cache_entry* entry = resultcache_find(cache, x->query_sym);
+
+  // ==== Hit: output the stored result
+  if (entry) {
+
+    for (t_int32 ofs = 0; ofs < entry->out_len; ofs += (t_int32)strlen(entry->out_buf + ofs) + 1) {
+      _dict_recurse_post(x, w, "%s", entry->out_buf + ofs);
+    }
+
+    if (entry->res_len) {
+      t_atom* res = _walk_results_grow(w, entry->res_len);
+      if (res) { sysmem_copyptr(entry->res_arr, res, entry->res_len * sizeof(t_atom)); w->res_len += entry->res_len; }
+    }
+    w->count += entry->count;
+
+    if (x->a_verbose) {
+      WALK_POST("  Cache hit for \"%s\":  %i hit%s, %i miss%s.", x->dict_sym->s_name,
+        cache->hit_cnt, (cache->hit_cnt == 1) ? "" : "s", cache->miss_cnt, (cache->miss_cnt == 1) ? "" : "es");
+    }
+    return;
+  }
+
+  // ==== Miss: run the command, buffering the posts unless they already are
+  t_int32 out_ini = w->out_len;
+  t_int32 res_ini = w->res_len;
+  t_int32 count_ini = w->count;
+  t_bool is_local = !w->out_max;
+
+  if (is_local) {
+    w->out_buf = (char*)sysmem_newptr(1024);
+    if (w->out_buf) { w->out_max = 1024; }
+  }
+
+  _dict_recurse_run(x);
+
+  // Store the result, unless the dictionaries of a multi-dictionary command were all processed in parallel
+  if (x->dict && w->out_max && !x->is_cancelled
+      && (resultcache_store(cache, x->query_sym, w->count - count_ini, w->out_buf + out_ini, w->out_len - out_ini,
+        w->res_arr + res_ini, w->res_len - res_ini) != ERR_NONE)) {
+    MY_ERR("Allocation error for the result cache.");
+  }
+
+  if (x->a_verbose) {
+    WALK_POST("  Cache miss for \"%s\":  %i hit%s, %i miss%s.", x->dict_sym->s_name,
+      cache->hit_cnt, (cache->hit_cnt == 1) ? "" : "s", cache->miss_cnt, (cache->miss_cnt == 1) ? "" : "es");
+  }
+
+  if (is_local && w->out_buf) {
+    _dict_recurse_flush(x, w);
+    sysmem_freeptr(w->out_buf);
+    w->out_buf = NULL;
+    w->out_max = 0;
+  }
+}
+
+// ====  _DICT_RECURSE_RUN  ====
+//******************************************************************************
+//  Serve the command from the snapshot of the dictionary, or start the recursion
+//  from the root dictionary, in parallel if possible.
+//
+void _dict_recurse_run(t_dict_recurse* x) {
+
+  if (!x->is_async && _dict_recurse_snapshotted(x, &x->walk)) { return; }
+
+  if ((x->a_threads > 1) && _dict_recurse_parallel(x)) { return; }
+
+  _dict_recurse_dict(x, &x->walk, x->dict, 0);
+  _dict_recurse_walk(x, &x->walk, 0, 0);
+}
+
+// ====  _DICT_RECURSE_SNAPSHOTTED  ====
+
+//******************************************************************************
+//  Report a match found in a snapshot, as the traversal does.
+//
+static void _dict_recurse_snapshot_match(t_dict_recurse* x, t_walk* w, t_snapshot* snap, t_int32 node) {
+
+  t_atom value[1];
+  snapshot_atom(snap, node, value);
+
+  // List output: the head, the dictionary name, then the segments of the path
+  if (x->a_output == OUTPUT_LIST) {
+
+    t_int32 seg_cnt = 0;
+    for (t_int32 ind = node; ind >= 0; ind = snap->parent_arr[ind]) { seg_cnt++; }
+
+    t_atom* res = _walk_results_grow(w, 5 + seg_cnt);
+    if (!res) { MY_ERR("Allocation error for the results."); return; }
+
+    _walk_result_head(res, 5 + seg_cnt, snapshot_key(snap, node), value);
+    atom_setsym(res + 4, x->dict_sym);
+    snapshot_segments(snap, node, res + 5, seg_cnt);
+    w->res_len += 5 + seg_cnt;
+    return;
+  }
+
+  char path[MAX_LEN_PATH];
+  snapshot_path(snap, node, path, MAX_LEN_PATH);
+
+  if ((x->command == CMD_FIND_VALUE_SYM) || (x->command == CMD_FIND_ENTRY)) {
+    WALK_POST("  %s  \"%s\"", path, snap->value_arr[node].s->s_name);
+  }
+  else { WALK_POST("  %s  %s", path, _dict_recurse_value_str(x, w, value)); }
+}
+
+//******************************************************************************
+//  Serve the find commands from the snapshot of the dictionary, if the snapshot
+//  command created one, rebuilding it after a modification. The nodes are scanned
+//  in traversal order, so the matches are reported in the same order.
+//  Path selectors are left to the recursion.
+//
+//  @return true if the command was processed, false to fall back on the recursion.
+//
+t_bool _dict_recurse_snapshotted(t_dict_recurse* x, t_walk* w) {
+
+  TRACE("_dict_recurse_snapshotted");
+
+  t_snapshot* snap = NULL;
+  t_atom value[1];
+
+  switch (x->command) {
+  case CMD_FIND_KEY: case CMD_FIND_KEY_IN: case CMD_FIND_VALUE_SYM: case CMD_FIND_ENTRY: case CMD_FIND_NUMBER: break;
+  default: return false;
+  }
+
+  if (pathexpr_is_set(x->path_expr)
+    || (hashtab_lookup(x->snapshot_tab, x->dict_sym, (t_object**)&snap) != MAX_ERR_NONE)) { return false; }
+
+  // ==== Rebuild it if the dictionary was modified, or replaced under the same name
+  if (!snapshot_is_valid(snap) || (snap->dict != x->dict)) {
+
+    if (snapshot_build(snap, x->dict) != ERR_NONE) { return false; }
+
+    if (snap->dict_watched != x->dict) { _dict_recurse_watch(x, &snap->dict_watched, x->dict); }
+
+    if (x->a_verbose) {
+      WALK_POST("  Snapshot rebuilt for \"%s\":  %i nodes.", x->dict_sym->s_name, snap->node_cnt);
+    }
+  }
+
+  t_int32 node_cnt = snap->node_cnt;
+  t_int32 depth_max = x->a_depth ? (t_int32)x->a_depth : 0x7FFFFFFF;
+  t_symbol** key_arr = snap->key_arr;
+  t_uint8* type_arr = snap->type_arr;
+  t_regexpr* key_expr = x->search_key_expr;
+  t_regexpr* val_expr = x->search_val_expr;
+
+  // An exact key is compared by pointer, so that the scan only reads the keys
+  t_symbol* key_exact = ((x->command != CMD_FIND_VALUE_SYM) && (key_expr->match_fct == &_regexpr_match_reg))
+    ? key_expr->search_frag_sym : NULL;
+  t_int32 cover = 0;    // For find key_in, the end of the descendants of the last match
+
+  for (t_int32 node = 0; node < node_cnt; node++) {
+
+    if (!(node % SLICE_CHECK_CNT) && x->is_cancelled) { break; }
+
+    // ==== The descendants of a node past the maximum depth are all past it
+    if (snap->depth_arr[node] > depth_max) { node = snap->end_arr[node] - 1; continue; }
+
+    switch (x->command) {
+
+    case CMD_FIND_KEY:
+      if (key_exact ? (key_arr[node] != key_exact) : (!key_arr[node] || !regexpr_match(key_expr, key_arr[node]))) { break; }
+      _dict_recurse_snapshot_match(x, w, snap, node); w->count++;
+      break;
+
+    case CMD_FIND_KEY_IN:
+      if (key_arr[node] && (key_exact ? (key_arr[node] == key_exact) : regexpr_match(key_expr, key_arr[node]))) {
+        w->count++;
+        cover = MAX(cover, snap->end_arr[node]);
+      }
+      if (node < cover) { _dict_recurse_snapshot_match(x, w, snap, node); }
+      break;
+
+    case CMD_FIND_VALUE_SYM:
+      if ((type_arr[node] != SNAP_SYM) || !regexpr_match(val_expr, snap->value_arr[node].s)) { break; }
+      _dict_recurse_snapshot_match(x, w, snap, node); w->count++;
+      break;
+
+    case CMD_FIND_ENTRY:
+      if ((type_arr[node] != SNAP_SYM) || !key_arr[node]
+        || (key_exact ? (key_arr[node] != key_exact) : !regexpr_match(key_expr, key_arr[node]))
+        || !regexpr_match(val_expr, snap->value_arr[node].s)) { break; }
+      _dict_recurse_snapshot_match(x, w, snap, node); w->count++;
+      break;
+
+    case CMD_FIND_NUMBER:
+      if ((type_arr[node] != SNAP_INT) && (type_arr[node] != SNAP_FLOAT)) { break; }
+      snapshot_atom(snap, node, value);
+      if (!numpred_match(&x->num_pred, value)) { break; }
+      _dict_recurse_snapshot_match(x, w, snap, node); w->count++;
+      break;
+
+    default: break;
+    }
+  }
+
+  w->node_cnt += node_cnt;
+
+  return true;
+}
+
+// ====  DICT_RECURSE_SNAPSHOT  ====
+//******************************************************************************
+//  snapshot (sym: dictionary)
+//  snapshot (sym: dictionary) 0
+//
+//  Build a flat snapshot of a dictionary, which then serves the find commands
+//  on it, or drop it.
+//
+void dict_recurse_snapshot(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  TRACE("dict_recurse_snapshot");
+
+  t_snapshot* snap = NULL;
+
+  MY_ASSERT(x->is_busy, , "snapshot:  The object is still busy.");
+  MY_ASSERT(!argc || (atom_getsym(argv) == gensym("")), , "snapshot:  Arg 0:  Invalid argument.");
+
+  t_symbol* dict_sym = atom_getsym(argv);
+  hashtab_lookup(x->snapshot_tab, dict_sym, (t_object**)&snap);
+
+  // ==== Drop the snapshot and stop watching its dictionary
+  if ((argc > 1) && !atom_getlong(argv + 1)) {
+    MY_ASSERT(!snap, , "snapshot:  No snapshot of \"%s\".", dict_sym->s_name);
+
+    _dict_recurse_watch(x, &snap->dict_watched, NULL);
+    hashtab_chuckkey(x->snapshot_tab, dict_sym);
+    snapshot_free(snap);
+
+    POST("snapshot:  \"%s\" dropped.", dict_sym->s_name);
+    outlet_bang(x->outl_bang);
+    return;
+  }
+
+  t_dictionary* dict = dictobj_findregistered_retain(dict_sym);
+  MY_ASSERT(!dict, , "snapshot:  Arg 0:  Unable to reference the dictionary named \"%s\".", dict_sym->s_name);
+
+  // ==== Get the snapshot, or create it, then build it and watch the dictionary
+  if (!snap) {
+    snap = snapshot_new(dict_sym);
+    if (snap) { hashtab_storeflags(x->snapshot_tab, dict_sym, (t_object*)snap, OBJ_FLAG_DATA); }
+  }
+
+  if (!snap || (snapshot_build(snap, dict) != ERR_NONE)) {
+    MY_ERR("snapshot:  Allocation error for the snapshot of \"%s\".", dict_sym->s_name);
+    dictobj_release(dict);
+    return;
+  }
+
+  if (snap->dict_watched != dict) { _dict_recurse_watch(x, &snap->dict_watched, dict); }
+  dictobj_release(dict);
+
+  POST("snapshot:  %i node%s in \"%s\".", snap->node_cnt, (snap->node_cnt == 1) ? "" : "s", dict_sym->s_name);
+  outlet_bang(x->outl_bang);
+}
+
+// ====  DICT_RECURSE_STATS  ====
+//******************************************************************************
+//  stats
+//  stats reset
+//
+//  Output the work counters, of the last command and of all the commands since
+//  the last reset, as a dictionary with the subdictionaries "last" and "total".
+//  The dictionary is owned by the object and refreshed by each call.
+//
+void dict_recurse_stats(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  TRACE("dict_recurse_stats");
+
+  MY_ASSERT(argc && (atom_getsym(argv) != gensym("reset")), , "stats:  Arg 0:  Invalid argument.");
+
+  // ==== Reset the counters
+  if (argc) {
+    walkstats_clear(&x->stats_last);
+    walkstats_clear(&x->stats_total);
+    POST("stats:  Reset.");
+    return;
+  }
+
+  // ==== Create and register the dictionary on the first call, under a unique name
+  if (!x->stats_dict) {
+    t_symbol* name = gensym("");
+    x->stats_dict = dictionary_new();
+    MY_ASSERT(!x->stats_dict, , "stats:  Allocation error for the dictionary.");
+    x->stats_dict = dictobj_register(x->stats_dict, &name);
+  }
+
+  dictionary_clear(x->stats_dict);
+
+  t_dictionary* last = dictionary_new();
+  t_dictionary* total = dictionary_new();
+  if (!last || !total || (walkstats_to_dict(&x->stats_last, last) != ERR_NONE)
+      || (walkstats_to_dict(&x->stats_total, total) != ERR_NONE)) {
+    if (last) { object_free(last); }
+    if (total) { object_free(total); }
+    MY_ERR("stats:  Allocation error for the dictionary.");
+    return;
+  }
+
+  dictionary_appenddictionary(x->stats_dict, gensym("last"), (t_object*)last);
+  dictionary_appenddictionary(x->stats_dict, gensym("total"), (t_object*)total);
+
+  t_atom atom[1];
+  atom_setsym(atom, dictobj_namefromptr(x->stats_dict));
+  outlet_anything(x->outl_mess, gensym("dictionary"), 1, atom);
+}
+
+// ====  DICT_RECURSE_DUMPTRACE  ====
+//******************************************************************************
+//  Set the lanes recording the events of the next command, according to the trace
+//  attribute. Called before a command is parsed, so never while one is running.
+//
+void _dict_recurse_trace_set(t_dict_recurse* x) {
+
+  if (x->a_trace && !x->trace) {
+    x->trace = tracebuf_new();
+    if (!x->trace) { MY_ERR("Allocation error for the trace."); }
+  }
+
+  t_trace_lane* lane = x->a_trace ? tracebuf_lane(x->trace, 0) : NULL;
+  x->walk.trace_lane = lane;
+  x->search_key_expr->trace_lane = lane;
+  x->search_val_expr->trace_lane = lane;
+  x->dict_expr->trace_lane = lane;
+}
+
+//******************************************************************************
+//  dumptrace (sym: file)
+//
+//  Write the last events recorded with the trace attribute on, in the Chrome trace
+//  format. This can be done while a command is running, to see where it stalls.
+//  A file without a full path is created in the default folder.
+//
+void dict_recurse_dumptrace(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  TRACE("dict_recurse_dumptrace");
+
+  char file_s[MAX_PATH_CHARS];
+  short path_id;
+  t_filehandle file = NULL;
+  t_int32 event_cnt = 0;
+
+  MY_ASSERT(!x->trace, , "dumptrace:  No trace recorded, the trace attribute is off.");
+  MY_ASSERT((argc != 1) || (atom_getsym(argv) == gensym("")), , "dumptrace:  Arg 0:  Invalid argument.");
+
+  t_symbol* file_sym = atom_getsym(argv);
+  if (path_frompotentialpathname(file_sym->s_name, &path_id, file_s)) {
+    strncpy_zero(file_s, file_sym->s_name, MAX_PATH_CHARS);
+    path_id = path_getdefault();
+  }
+
+  MY_ASSERT(path_createsysfile(file_s, path_id, 'TEXT', &file), , "dumptrace:  Arg 0:  Unable to create the file \"%s\".", file_sym->s_name);
+
+  t_my_err err = tracebuf_write(x->trace, file, &event_cnt);
+  sysfile_close(file);
+
+  MY_ASSERT(err != ERR_NONE, , "dumptrace:  Unable to write the file \"%s\".", file_sym->s_name);
+  POST("dumptrace:  %i event%s written to \"%s\".", event_cnt, (event_cnt == 1) ? "" : "s", file_sym->s_name);
+}
+
+// ====  _DICT_RECURSE_PARALLEL  ====
+
+//******************************************************************************
+//  Initialize a task over a range of keys, with the trailing state it starts from.
+//
+static t_my_err _dict_recurse_task_init(t_dict_recurse* x, t_task* task, t_dictionary* dict, t_symbol** key_arr,
+  t_int32 key_beg, t_int32 key_end, t_int32 depth, t_walk* from, const char* path) {
+
+  task->dict = dict;
+  task->key_arr = key_arr;
+  task->key_beg = key_beg;
+  task->key_end = key_end;
+  task->depth = depth;
+  task->is_head = false;
+
+  if (_walk_init(&task->walk, x->path_len_max) != ERR_NONE) { return ERR_ALLOC; }
+
+  strncpy_zero(task->walk.path, path, x->path_len_max);
+  task->walk.type_iter = VALUE_TYPE_DICT;
+  task->walk.dict_iter = dict;
+  task->walk.path_state = from->path_state;
+  task->walk.is_selected = from->is_selected;
+  task->walk.has_match = from->has_match;
+  task->walk.trace_lane = from->trace_lane;    // The lane of the thread is set once the task runs
+  sysmem_copyptr(from->seg_arr, task->walk.seg_arr, from->seg_cnt * sizeof(t_atom));
+  task->walk.seg_cnt = from->seg_cnt;
+
+  // Buffer the posts, to merge them in order
+  task->walk.out_buf = (char*)sysmem_newptr(256);
+  if (!task->walk.out_buf) { return ERR_ALLOC; }
+  task->walk.out_max = 256;
+
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  Split the keys of a dictionary into tasks, inserted in a task array at a given position.
+//
+//  @return The number of tasks inserted, 0 if the dictionary is empty, or -1 on failure.
+//
+static t_int32 _dict_recurse_split(t_dict_recurse* x, t_task** task_arr, t_int32* task_cnt, t_int32* task_max,
+  t_int32 pos, t_dictionary* dict, t_int32 depth, t_walk* from, const char* path, t_int32 split_cnt) {
+
+  long key_cnt = 0;
+  t_symbol** key_arr = NULL;
+  dictionary_getkeys(dict, &key_cnt, &key_arr);
+  x->walk.read_cnt++;
+  x->walk.alloc_cnt++;
+  x->walk.stats.dict_cnt++;
+  walkstats_depth(&x->walk.stats, depth);
+  if (!key_cnt) { if (key_arr) { dictionary_freekeys(dict, key_cnt, key_arr); } return 0; }
+
+  split_cnt = (t_int32)MIN(split_cnt, key_cnt);
+
+  // Make room and shift the following tasks
+  if (*task_cnt + split_cnt > *task_max) {
+    t_int32 task_max_new = MAX(2 * (*task_max), *task_cnt + split_cnt);
+    t_task* task_arr_new = (t_task*)sysmem_resizeptr(*task_arr, task_max_new * sizeof(t_task));
+    if (!task_arr_new) { dictionary_freekeys(dict, key_cnt, key_arr); return -1; }
+    *task_arr = task_arr_new;
+    *task_max = task_max_new;
+  }
+
+  memmove(*task_arr + pos + split_cnt, *task_arr + pos, (*task_cnt - pos) * sizeof(t_task));
+  *task_cnt += split_cnt;
+
+  // Clear the new tasks first, so that they can all be freed on failure
+  for (t_int32 ind = 0; ind < split_cnt; ind++) {
+    t_task* task = *task_arr + pos + ind;
+    task->key_cnt = 0;
+    task->walk.path = NULL;
+    task->walk.out_buf = NULL;
+    task->walk.frame_arr = NULL;
+    task->walk.res_arr = NULL;
+    task->walk.entry_buf = NULL;
+  }
+
+  for (t_int32 ind = 0; ind < split_cnt; ind++) {
+    t_task* task = *task_arr + pos + ind;
+    t_my_err err = _dict_recurse_task_init(x, task, dict, key_arr,
+      (t_int32)((key_cnt * ind) / split_cnt), (t_int32)((key_cnt * (ind + 1)) / split_cnt), depth, from, path);
+    if (ind == 0) { task->key_cnt = key_cnt; }    // The first task frees the keys
+    if (err != ERR_NONE) { return -1; }
+  }
+
+  return split_cnt;
+}
+
+//******************************************************************************
+//  Run one task, on any thread.
+//
+static void _dict_recurse_task(t_dict_recurse* x, t_int32 task_ind, t_int32 thread_ind) {
+
+  t_task* task = x->task_arr + task_ind;
+  if (task->is_head) { return; }
+
+  if (task->walk.trace_lane) { task->walk.trace_lane = tracebuf_lane(x->trace, thread_ind); }
+
+  t_int32 key_cnt = task->key_end - task->key_beg;
+  t_entry* entry_arr = _walk_entries_grow(&task->walk, key_cnt);
+  if (!entry_arr) { MY_ERR("Allocation error for the entry buffer."); return; }
+
+  for (t_int32 ind = 0; ind < key_cnt; ind++) {
+    entry_arr[ind].key = task->key_arr[task->key_beg + ind];
+    dictionary_getatom(task->dict, entry_arr[ind].key, &entry_arr[ind].value);
+  }
+  task->walk.entry_len += key_cnt;
+
+  if (_dict_recurse_keys(x, &task->walk, task->dict, key_cnt, task->depth) != ERR_NONE) { return; }
+
+  _dict_recurse_walk(x, &task->walk, 0, 0);
+}
+
+//******************************************************************************
+//  Run a read-only command on a pool of threads.
+//
+//  The keys of the root dictionary are split into tasks. While there are too few,
+//  tasks with a single dictionary value are run up to that dictionary, on the
+//  calling thread, and its keys are split into the next tasks. The tasks are then
+//  run with work stealing, and their posts are merged in the order of the paths.
+//
+//  @return true if the command was processed, false to fall back on the serial recursion.
+//
+t_bool _dict_recurse_parallel(t_dict_recurse* x) {
+
+  TRACE("_dict_recurse_parallel");
+
+  switch (x->command) {
+  case CMD_ALL: case CMD_FIND_KEY: case CMD_FIND_KEY_IN: case CMD_FIND_VALUE_SYM:
+  case CMD_FIND_ENTRY: case CMD_FIND_DICT_CONT_ENTRY: case CMD_FIND_NUMBER: break;
+  default: return false;
+  }
+
+  t_int32 task_cnt = 0;
+  t_int32 task_max = 0;
+  t_int32 task_target = (t_int32)x->a_threads * TASK_PER_THREAD;
+  t_bool is_ok = true;
+  t_atom value[1];
+  t_workpool pool;
+  t_int32 multi_ini = x->multi_ind;
+
+  x->task_arr = NULL;
+
+  // ==== Split the root dictionary, or each remaining dictionary of a multi-dictionary command
+  x->task_arr = (t_task*)sysmem_newptr(sizeof(t_task) * task_target);
+  if (!x->task_arr) { return false; }
+  task_max = task_target;
+
+  if (!x->multi_cnt) {
+    if (_dict_recurse_split(x, &x->task_arr, &task_cnt, &task_max, 0, x->dict, 0, &x->walk, x->walk.path, task_target) < 0) {
+      is_ok = false;
+    }
+  }
+
+  else {
+    t_int32 split_cnt = MAX(1, task_target / (x->multi_cnt - multi_ini));
+
+    for (t_int32 ind = multi_ini; is_ok && (ind < x->multi_cnt); ind++) {
+      _dict_recurse_multi_open(x, ind);
+      _dict_recurse_open(x);
+      if (_dict_recurse_split(x, &x->task_arr, &task_cnt, &task_max, task_cnt, x->dict, 0, &x->walk, x->walk.path, split_cnt) < 0) {
+        is_ok = false;
+      }
+    }
+
+    _dict_recurse_multi_open(x, multi_ini);
+    _dict_recurse_open(x);
+  }
+
+  // ==== Split single dictionary values, level by level, while there are too few tasks
+  for (t_int32 level = 0; is_ok && (level < TASK_SPLIT_MAX) && (task_cnt < task_target); level++) {
+
+    t_int32 split_cnt = 0;
+
+    for (t_int32 ind = 0; is_ok && (ind < task_cnt) && (task_cnt < task_target); ind++) {
+
+      t_task* task = x->task_arr + ind;
+      if (task->is_head || (task->depth != level) || (task->key_end - task->key_beg != 1)) { continue; }
+
+      t_symbol* key = task->key_arr[task->key_beg];
+      dictionary_getatom(task->dict, key, value);
+      if (!atomisdictionary(value)) { continue; }
+
+      // Run the task up to the dictionary value
+      task->walk.depth_cut = level + 1;
+      _dict_recurse_task(x, ind, 0);
+      task->walk.depth_cut = 0;
+      task->is_head = true;
+      if (!task->walk.is_cut) { continue; }
+
+      // Split the dictionary value after it
+      t_walk from;
+      from.path_state = task->walk.cut_path_state;
+      from.is_selected = task->walk.cut_is_selected;
+      from.has_match = task->walk.cut_has_match;
+      from.trace_lane = task->walk.trace_lane;
+      sysmem_copyptr(task->walk.seg_arr, from.seg_arr, task->walk.seg_cnt * sizeof(t_atom));
+      atom_setsym(from.seg_arr + task->walk.seg_cnt, key);
+      from.seg_cnt = task->walk.seg_cnt + 1;
+
+      char path[MAX_LEN_PATH];
+      snprintf_zero(path, MAX_LEN_PATH, "%s%s%s", task->walk.path, PATH_SEP_S, key->s_name);
+
+      t_int32 inserted = _dict_recurse_split(x, &x->task_arr, &task_cnt, &task_max, ind + 1,
+        (t_dictionary*)atom_getobj(value), level + 1, &from, path, task_target - task_cnt + 1);
+
+      if (inserted < 0) { is_ok = false; }
+      else { ind += inserted; split_cnt++; }
+    }
+
+    if (!split_cnt) { break; }
+  }
+
+  // ==== Run the tasks, then merge the posts and counts in order
+  if (is_ok) {
+
+    // One lane per thread, allocated before they start
+    if (x->walk.trace_lane && (tracebuf_reserve(x->trace, (t_int32)x->a_threads) != ERR_NONE)) {
+      MY_ERR("Allocation error for the trace.");
+    }
+
+    workpool_run(&pool, (t_int32)x->a_threads, task_cnt, (t_workpool_fct)_dict_recurse_task, x);
+
+    t_multi* multi = x->multi_arr + multi_ini;
+
+    for (t_int32 ind = 0; ind < task_cnt; ind++) {
+      t_walk* w = &x->task_arr[ind].walk;
+
+      // The tasks follow the order of the dictionaries, named by their first segment
+      if (x->multi_cnt) {
+        while (multi->dict_sym != atom_getsym(w->seg_arr)) { multi++; }
+        multi->count += w->count;
+      }
+
+      for (t_int32 ofs = 0; ofs < w->out_len; ofs += (t_int32)strlen(w->out_buf + ofs) + 1) {
+        _dict_recurse_post(x, &x->walk, "%s", w->out_buf + ofs);
+      }
+      if (w->res_len) {
+        t_atom* res = _walk_results_grow(&x->walk, w->res_len);
+        if (res) { sysmem_copyptr(w->res_arr, res, w->res_len * sizeof(t_atom)); x->walk.res_len += w->res_len; }
+      }
+      x->walk.count += w->count;
+      x->walk.read_cnt += w->read_cnt;
+      x->walk.alloc_cnt += w->alloc_cnt;
+      walkstats_add(&x->walk.stats, &w->stats);
+      x->walk.stats.atom_cnt += w->node_cnt;
+    }
+
+    x->par_task_cnt += task_cnt;
+    x->par_thread_cnt = pool.thread_cnt;
+    x->par_steal_cnt += (t_int32)pool.steal_cnt;
+
+    // All the dictionaries are processed, and closed as such
+    if (x->multi_cnt) {
+      x->multi_ind = x->multi_cnt - 1;
+      x->dict = NULL;
+    }
+  }
+
+  // ==== Free the tasks
+  for (t_int32 ind = 0; ind < task_cnt; ind++) {
+    t_task* task = x->task_arr + ind;
+    if (task->key_cnt) { dictionary_freekeys(task->dict, task->key_cnt, task->key_arr); }
+    _walk_free(&task->walk);
+  }
+
+  sysmem_freeptr(x->task_arr);
+  x->task_arr = NULL;
+
+  return is_ok;
+}
+
+// ====  _DICT_RECURSE_MATCH_SYM  ====
+
+void  dict_recurse_test_match(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  t_symbol* expr = atom_getsym(argv);
+  t_symbol* key_sym = atom_getsym(argv + 1);
+
+  regexpr_set(x->search_key_expr, expr);
+  regexpr_match(x->search_key_expr, key_sym);
+  regexpr_reset(x->search_key_expr);
+}
+
+// ====  _DICT_RECURSE_MATCH_DICT  ====
+
+//******************************************************************************
+//  Look ahead function to test whether a dictionary matches a condition.
+//  The test runs on the entries already read into the entry buffer, so that
+//  the dictionary is only read once, for the test and for the traversal.
+//
+//  @param entry_arr The entries of the dictionary, on top of the entry buffer.
+//  @param entry_cnt The number of entries.
+//
+t_bool _dict_recurse_match_dict(t_dict_recurse* x, t_walk* w, t_entry* entry_arr, t_int32 entry_cnt, t_symbol** key_match, t_symbol** value_match) {
+
+  TRACE("_dict_recurse_match_dict");
+
+  for (t_int32 ind = 0; ind < entry_cnt; ind++) {
+
+    t_entry* entry = entry_arr + ind;
+    if (!KEY_TRY(regexpr_match(x->search_key_expr, entry->key))) { continue; }
+
+    if (VAL_TRY(regexpr_match(x->search_val_expr, atom_getsym(&entry->value)))) {
+      *key_match = entry->key;
+      *value_match = atom_getsym(&entry->value);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// ====  _DICT_RECURSE_DICT  ====
+
+//******************************************************************************
+//  Entries read by dictionary_funall() into the entry buffer
+//
+typedef struct _entry_fill {
+
+  t_entry* entry_arr;
+  t_int32  entry_cnt;
+  t_int32  entry_max;
+
+} t_entry_fill;
+
+//******************************************************************************
+//  Store the key and value of one entry, called by dictionary_funall().
+//
+static void _dict_recurse_entry_fill(t_dictionary_entry* entry, t_entry_fill* fill) {
+
+  if (fill->entry_cnt == fill->entry_max) { return; }
+
+  t_entry* entry_new = fill->entry_arr + fill->entry_cnt++;
+  entry_new->key = dictionary_entry_getkey(entry);
+  dictionary_entry_getvalue(entry, &entry_new->value);
+}
+
+//******************************************************************************
+//  Read the keys and values of a dictionary in one pass, on top of the entry buffer,
+//  where they stay until the frame is popped or they are dropped.
+//  NB: The values stay valid, since the edits of the dictionary are deferred until then.
+//
+//  @return The number of entries read, or -1 on an allocation error.
+//
+t_int32 _dict_recurse_read(t_dict_recurse* x, t_walk* w, t_dictionary* dict) {
+
+  TRACE("_dict_recurse_read");
+
+  t_entry_fill fill;
+  fill.entry_max = (t_int32)dictionary_getentrycount(dict);
+  fill.entry_cnt = 0;
+  fill.entry_arr = _walk_entries_grow(w, fill.entry_max);
+  if (!fill.entry_arr) { MY_ERR("Allocation error for the entry buffer."); return -1; }
+
+  dictionary_funall(dict, (method)_dict_recurse_entry_fill, &fill);
+  w->entry_len += fill.entry_cnt;
+  w->read_cnt++;
+
+  return fill.entry_cnt;
+}
+
+//******************************************************************************
+//  Test whether a dictionary at a given depth is entered, 0 for the root.
+//
+static t_bool _dict_recurse_can_enter(t_dict_recurse* x, t_walk* w, t_int32 depth) {
+
+  // ==== Do not go further than the maximum depth
+  if (x->a_depth && (depth >= x->a_depth)) { return false; }
+
+  // ==== Do not enter dictionaries past the cut, but keep the state they are reached with
+  if (w->depth_cut && (depth >= w->depth_cut)) {
+    w->is_cut = true;
+    w->cut_path_state = w->path_state;
+    w->cut_is_selected = w->is_selected;
+    w->cut_has_match = w->has_match;
+    return false;
+  }
+
+  return true;
+}
+
+//******************************************************************************
+//  Enter a dictionary whose entries have already been read on top of the entry buffer,
+//  or drop them if the dictionary is not entered.
+//
+void _dict_recurse_enter(t_dict_recurse* x, t_walk* w, t_dictionary* dict, t_int32 entry_cnt, t_int32 depth) {
+
+  TRACE("_dict_recurse_enter");
+
+  if (!_dict_recurse_can_enter(x, w, depth)
+      || (_dict_recurse_keys(x, w, dict, entry_cnt, depth) != ERR_NONE)) { w->entry_len -= entry_cnt; return; }
+
+  w->stats.dict_cnt++;
+  walkstats_depth(&w->stats, depth);
+}
+
+//******************************************************************************
+//  Enter a dictionary, at a given depth, 0 for the root.
+//  Its keys are looped through by _dict_recurse_walk().
+//
+void _dict_recurse_dict(t_dict_recurse* x, t_walk* w, t_dictionary* dict, t_int32 depth) {
+
+  TRACE("_dict_recurse_dict");
+
+  if (!_dict_recurse_can_enter(x, w, depth)) { return; }
+
+  t_int32 entry_cnt = _dict_recurse_read(x, w, dict);
+  if (entry_cnt < 0) { return; }
+
+  if (_dict_recurse_keys(x, w, dict, entry_cnt, depth) != ERR_NONE) { w->entry_len -= entry_cnt; return; }
+
+  w->stats.dict_cnt++;
+  walkstats_depth(&w->stats, depth);
+}
+
+// ====  _DICT_RECURSE_KEYS  ====
+//******************************************************************************
+//  Push the loop through some of the entries of a dictionary, on top of the entry buffer:
+//  all of them from _dict_recurse_dict(), or a range for a parallel task.
+//
+//  @return ERR_NONE, or ERR_ALLOC if the traversal stack could not grow.
+//
+t_my_err _dict_recurse_keys(t_dict_recurse* x, t_walk* w, t_dictionary* dict, t_int32 key_cnt, t_int32 depth) {
+
+  TRACE("_dict_recurse_keys");
+
+  // ==== Store the state variables on entering the loop
+  t_frame* f = _walk_push(w);
+  if (!f) { MY_ERR("Allocation error for the traversal stack."); return ERR_ALLOC; }
+
+  f->type = VALUE_TYPE_DICT;
+  f->depth = depth + 1;    // Increment the depth
+  f->cnt = key_cnt;
+  f->dict = dict;
+  f->entry_ofs = w->entry_len - key_cnt;
+  f->edit_ini = x->edit_log->edit_cnt;
+
+  TRACEBUF_EVENT(w->trace_lane, 'B', "walk", "dict", (w->frame_cnt > 1) ? w->key_iter : NULL);
+
+  // ==== Add :: to the path
+  strncat_zero(w->path, "::", x->path_len_max);
+
+  // ==== Set the trailing variables before for the recursions
+  w->type_iter = VALUE_TYPE_DICT;
+  w->dict_iter = dict;
+
+  return ERR_NONE;
+}
+
+// ====  _DICT_RECURSE_JOURNAL_EDIT  ====
+
+//******************************************************************************
+//  Record the prior value of an array value about to be replaced in place, when journaling.
+//  The array is the loop on top of the stack, the position is the one in its compacted values.
+//
+static void _dict_recurse_journal_array(t_dict_recurse* x, t_walk* w, t_atom* value) {
+
+  if (!x->edit_log->journal) { return; }
+
+  t_frame* f = w->frame_arr + w->frame_cnt - 1;
+  LOG_JOURNAL(journal_add(x->edit_log->journal, JOURNAL_ARRAY_SET, (t_object*)f->atomarray,
+    NULL, NULL, value, f->keep_cnt));
+}
+
+//******************************************************************************
+//  Record the prior state of an entry about to be appended to a dictionary, when journaling.
+//  An entry with the same key is chucked, with its value kept by the journal,
+//  otherwise the entry is recorded as added.
+//
+//  @return The position of the entry chucked, to move the appended one to, or -1.
+//
+static t_int32 _dict_recurse_journal_append(t_dict_recurse* x, t_dictionary* dict, t_symbol* key) {
+
+  t_journal* journal = x->edit_log->journal;
+  if (!journal) { return -1; }
+
+  if (!dictionary_hasentry(dict, key)) {
+    LOG_JOURNAL(journal_add(journal, JOURNAL_ADD, (t_object*)dict, NULL, key, NULL, -1));
+    return -1;
+  }
+
+  long key_cnt = 0;
+  t_symbol** key_arr = NULL;
+  dictionary_getkeys(dict, &key_cnt, &key_arr);
+
+  t_int32 pos = 0;
+  while ((pos < key_cnt) && (key_arr[pos] != key)) { pos++; }
+  if (key_arr) { dictionary_freekeys(dict, key_cnt, key_arr); }
+
+  t_atom value[1];
+  dictionary_getatom(dict, key, value);
+  dictionary_chuckentry(dict, key);
+  if (journal_add(journal, JOURNAL_SET, (t_object*)dict, key, key, value, pos) != ERR_NONE) {
+    MY_ERR("Allocation error for the undo journal.");
+    if (value->a_type == A_OBJ) { object_free(atom_getobj(value)); }
+  }
+
+  return pos;
+}
+
+// ====  _DICT_RECURSE_KEY_OPEN  ====
+//******************************************************************************
+//  Opening actions for a dictionary entry, depending on which command is being processed.
+//
+//  @return false if the entry is not stepped into.
+//
+static t_bool _dict_recurse_key_open(t_dict_recurse* x, t_walk* w, t_frame* f) {
+
+  t_int32 node_ind;
+
+  switch (w->is_selected ? x->command : CMD_NONE) {
+
+  case CMD_FIND_KEY_IN:
+  case CMD_FIND_KEY:
+    if (KEY_TRY(regexpr_match(x->search_key_expr, w->key_iter))) {
+      w->has_match |= x->op_bit; w->count++;
+    }  // w->has_match changed
+    break;
+
+  case CMD_REPLACE_KEY:
+    if (KEY_TRY(regexpr_match(x->search_key_expr, w->key_iter))) {
+      LOG_EDIT(editlog_rename(x->edit_log, f->dict, w->key_iter, x->replace_key_sym));
+      w->count++;
+
+      if (x->a_verbose == true) {
+        WALK_POST("  %s%s  replaced by  \"%s\"",
+          w->path, w->key_iter->s_name, x->replace_key_sym->s_name);
+        }
+      w->key_iter = x->replace_key_sym;    // NB: For the path, the entry is renamed at the end
+    }
+    break;
+
+  case CMD_DELETE_KEY:
+    if (KEY_TRY(regexpr_match(x->search_key_expr, w->key_iter))) {
+      LOG_EDIT(editlog_delete(x->edit_log, f->dict, w->key_iter));
+      w->count++;
+
+      if (x->a_verbose == true) {
+        WALK_POST("  %s%s  deleted",
+          w->path, w->key_iter->s_name, x->replace_key_sym->s_name);
+        }
+
+      return false;
+    }  // NB: No further recursion
+    break;
+
+  case CMD_REPLACE_VALUE_FROM_DICT:
+    if (KEY_TRY(regexpr_match(x->search_key_expr, w->key_iter))
+        && ((node_ind = dicttmpl_find(x->replace_tmpl, w->key_iter)) >= 0)) {
+
+      t_int32 pos = _dict_recurse_journal_append(x, f->dict, w->key_iter);
+      dicttmpl_append(x->replace_tmpl, node_ind, f->dict);
+      if (pos >= 0) { journal_move(f->dict, w->key_iter, pos); }
+      w->count++;
+
+      if (x->a_verbose == true) {
+        WALK_POST("  %s%s  replaced from  \"%s\"",
+          w->path, w->key_iter->s_name, x->replace_dict_sym->s_name);
+        }
+
+      return false;
+    }  // NB: No further recursion
+    break;
+
+  default: break;
+  }  // >>>> END switch through potential commands
+
+  return true;
 }
 
-  // Initialize the object variables
-  if (_dict_recurse_begin_cmd(x, argv + 1, cmd_sym) != ERR_NONE) { return; }
+//******************************************************************************
+//  Opening actions for a dictionary entry, for each operation of a batch in order.
+//  Once an operation edits the entry, the next ones which edit skip it, here
+//  and when its value is processed.
+//
+//  @return false if the entry is not stepped into.
+//
+static t_bool _dict_recurse_key_batch(t_dict_recurse* x, t_walk* w, t_frame* f) {
 
-  // Start the recursion
-  _dict_recurse_dict(x, x->dict, 0);
+  t_bool is_open = true;
+  t_bool is_edited = false;
 
-  // Notify that the dictionary has been modified
-  if (x->count > 0) {
-    object_notify(x->dict, gensym("modified"), NULL);
-  }
+  for (t_int32 ind = 0; is_open && (ind < x->batch_cnt); ind++) {
 
-  // Post a summary for the command
-  POST("%s:  %i deletion%s made in \"%s\".", cmd_sym->s_name, x->count, (x->count == 1) ? "" : "s", x->dict_sym->s_name);
+    t_batch_op* op = x->batch_arr + ind;
+    t_int32 count = w->count;
+    if (is_edited && !CMD_IS_FIND(op->command)) { continue; }
 
-  // End the command
-  _dict_recurse_end_cmd(x);
-}
+    _batch_op_load(x, op);
+    is_open = _dict_recurse_key_open(x, w, f);
+    op->count += w->count - count;
 
-// ====  _DICT_RECURSE_MATCH_SYM  ====
+    if ((w->count > count) && !CMD_IS_FIND(op->command)) { is_edited = true; }
+  }
 
-void  dict_recurse_test_match(t_dict_recurse* x, t_symbol* sym, long argc, t_atom* argv) {
+  _batch_op_load(x, &x->batch_self);
 
-  t_symbol* expr = atom_getsym(argv);
-  t_symbol* key_sym = atom_getsym(argv + 1);
+  w->is_edited = is_open && is_edited;    // For the value of the entry, processed next if it is stepped into
 
-  regexpr_set(x->search_key_expr, expr);
-  regexpr_match(x->search_key_expr, key_sym);
-  regexpr_reset(x->search_key_expr);
+  return is_open;
 }
 
-// ====  _DICT_RECURSE_MATCH_DICT  ====
+// ====  _DICT_RECURSE_WALK  ====
 //******************************************************************************
-//  Look ahead function to test whether a dictionary matches a condition
+//  Run the traversal from the frames on the stack, until it is back to a given
+//  number of frames, or until a time budget is spent. Stepping a value may push
+//  the frame of a dictionary or an array, which is then run before the next value.
+//
+//  @param frame_base The number of frames to leave on the stack.
+//  @param time_end The time to suspend the traversal at, or 0 to run it to the end.
 //
-t_bool _dict_recurse_match_dict(t_dict_recurse* x, t_dictionary* dict, t_symbol** key_match, t_symbol** value_match) {
+//  @return true if the traversal is done, false if it is suspended and can be resumed.
+//
+t_bool _dict_recurse_walk(t_dict_recurse* x, t_walk* w, t_int32 frame_base, double time_end) {
 
-  TRACE("_dict_recurse_match_dict");
+  TRACE("_dict_recurse_walk");
 
-  // Get the dictionary keys
-  long  key_cnt = 0;
-  t_symbol** key_arr = NULL;
-  t_symbol* key = gensym("");
-  t_atom value[1];
+  t_int32 step_cnt = 0;
 
-  *key_match = gensym("");
-  *value_match = gensym("");
+  while (w->frame_cnt > frame_base) {
 
-  dictionary_getkeys(dict, &key_cnt, &key_arr);
+    t_int32 frame_ind = w->frame_cnt - 1;
+    t_frame* f = w->frame_arr + frame_ind;
 
-  t_bool test = false;
-  for (t_int32 ind = 0; ind < key_cnt; ind++) {
+    // ==== Close the value entered on the previous step
+    if (f->is_pending) {
 
-    key = key_arr[ind];
+      f->is_pending = false;
 
-    if (!regexpr_match(x->search_key_expr, key)) { continue; }
+      if (f->type == VALUE_TYPE_DICT) {
+        w->path[f->path_len + 2] = '\0';
+        w->has_match = f->has_match;
+      }
+      else {
+        if (f->test != VALUE_DEL) { f->atom_arr[f->keep_cnt++] = f->atom_arr[f->ind]; }
+        else if (x->edit_log->journal) {
+          LOG_JOURNAL(journal_add(x->edit_log->journal, JOURNAL_ARRAY_DELETE, (t_object*)f->atomarray,
+            NULL, NULL, f->atom_arr + f->ind, f->keep_cnt));
+        }
+        w->path[f->path_len + 1] = '\0';
+      }
 
-    dictionary_getatom(dict, key, value);
-    if (regexpr_match(x->search_val_expr, atom_getsym(value))) {
-      test = true;
-      *key_match = key;
-      *value_match = atom_getsym(value);
-      break;
+      f->ind++;
     }
-  }
 
-  if (key_arr) { dictionary_freekeys(dict, key_cnt, key_arr); }
+    // ==== End of the loop, or cancelled: a dictionary is left, an array keeps its remaining values
+    if ((f->ind >= f->cnt) || ((f->type == VALUE_TYPE_DICT) && x->is_cancelled)) {
+      _dict_recurse_pop(x, w);
+      continue;
+    }
 
-  return test;
-}
+    // ==== Skip in one scan the numbers of an array failing a numeric predicate, keeping them
+    if ((f->type == VALUE_TYPE_ARRAY) && CMD_IS_NUMBER(x->command) && !x->is_cancelled) {
 
-// ====  _DICT_RECURSE_DICT  ====
+      t_int32 next = (t_int32)numpred_skip(&x->num_pred, f->atom_arr, f->ind, f->cnt);
 
-void _dict_recurse_dict(t_dict_recurse* x, t_dictionary* dict, t_int32 depth) {
+      if (next > f->ind) {
+        if (f->keep_cnt < f->ind) { memmove(f->atom_arr + f->keep_cnt, f->atom_arr + f->ind, (next - f->ind) * sizeof(t_atom)); }
+        f->keep_cnt += next - f->ind;
+        w->node_cnt += next - f->ind;
+        f->ind = next;
+        continue;
+      }
+    }
 
-  TRACE("_dict_recurse_dict");
+    // ==== Suspend the traversal once the time budget is spent
+    if (time_end && (++step_cnt % SLICE_CHECK_CNT == 0) && (systimer_gettime() >= time_end)) { return false; }
 
-  t_atom atom[1];
+    w->node_cnt++;
 
-  // ==== Store the state variables on the beginning of the function
-  t_bool has_match_ini = x->has_match;
-  t_int32 path_len_ini = (t_int32)strlen(x->path);
-  t_value_type type_iter_ini = x->type_iter;
-  t_dictionary* dict_iter_ini = x->dict_iter;
-  t_symbol* key_iter_ini = x->key_iter;
+    // ====  DICTIONARY ENTRY  ====
+    if (f->type == VALUE_TYPE_DICT) {
 
-  // ==== Add :: to the path
-  strncat_zero(x->path, "::", x->path_len_max);
+      t_atom atom[1];
+      t_entry* entry = w->entry_buf + f->entry_ofs + f->ind;
+      w->key_iter = entry->key;
 
-  // ==== Get the dictionary keys
-  long  key_cnt = 0;
-  t_symbol** key_arr = NULL;
-  dictionary_getkeys(dict, &key_cnt, &key_arr);
+      // == Step the path selector, and skip the subtree if no path below can match
+      if (pathexpr_is_set(x->path_expr)) {
+        w->path_state = pathexpr_step_key(x->path_expr, f->path_state, w->key_iter);
+        if (!w->path_state) { f->ind++; continue; }
+        w->is_selected = pathexpr_accepts(x->path_expr, w->path_state);
+      }
 
-  // ==== Increment the depth
-  depth++;
+      if (!(x->batch_cnt ? _dict_recurse_key_batch(x, w, f) : _dict_recurse_key_open(x, w, f))) { f->ind++; continue; }
 
-  // ==== Set the trailing variables before for the recursions
-  x->type_iter = VALUE_TYPE_DICT;
-  x->dict_iter = dict;
+      // == Set the trailing variables before for the recursion
+      strncat_zero(w->path, w->key_iter->s_name, x->path_len_max);    // NB: w->path changed
+      w->stats.path_bytes += (t_int64)strlen(w->key_iter->s_name);
 
-  // ==== Loop through the keys
-  for (t_int32 ind = 0; ind < key_cnt; ind++) {
+      // == Step into a copy of the value, since the entry buffer can move
+      f->is_pending = true;
+      *atom = entry->value;
+      _dict_recurse_value(x, w, atom, f->depth);    // NB: f is not valid after a push
+    }
 
-    x->key_iter = key_arr[ind];
+    // ====  ARRAY VALUE  ====
+    else {
 
-    // == Opening actions depending on which command is being processed
-    switch (x->command) {
+      t_atom* value = f->atom_arr + f->ind;
+      w->index_iter = f->ind;
 
-    case CMD_FIND_KEY_IN:
-    case CMD_FIND_KEY:
-      if (regexpr_match(x->search_key_expr, x->key_iter)) {
-        x->has_match = true; x->count++;
-      }  // x->has_match changed
-      break;
+      // == Once cancelled, only keep the remaining values
+      if (x->is_cancelled) { f->atom_arr[f->keep_cnt++] = *value; f->ind++; continue; }
 
-    case CMD_REPLACE_KEY:
-      if (regexpr_match(x->search_key_expr, x->key_iter)) {
-        dictionary_getatom(dict, x->key_iter, atom);
-        dictionary_chuckentry(dict, x->key_iter);
-        dictionary_appendatom(dict, x->replace_key_sym, atom);
-        x->count++;
-
-        if (x->a_verbose == true) {
-          POST("  %s%s  replaced by  \"%s\"",
-            x->path, x->key_iter->s_name, x->replace_key_sym->s_name);
-          }
-        x->key_iter = x->replace_key_sym;
+      // == Step the path selector, and skip the value if no path below can match
+      if (pathexpr_is_set(x->path_expr)) {
+        w->path_state = pathexpr_step_index(x->path_expr, f->path_state, f->ind);
+        if (!w->path_state) { f->atom_arr[f->keep_cnt++] = *value; f->ind++; continue; }
+        w->is_selected = pathexpr_accepts(x->path_expr, w->path_state);
       }
-      break;
 
-    case CMD_DELETE_KEY:
-      if (regexpr_match(x->search_key_expr, x->key_iter)) {
-        dictionary_deleteentry(dict, x->key_iter);
-        x->count++;
+      // == Update the path
+      w->stats.path_bytes += snprintf_zero(w->str_tmp, MAX_LEN_NUMBER, "%i]", f->ind);
+      strncat_zero(w->path, w->str_tmp, x->path_len_max);
 
-        if (x->a_verbose == true) {
-          POST("  %s%s  deleted",
-            x->path, x->key_iter->s_name, x->replace_key_sym->s_name);
-          }
+      // == Step into the value, the values kept are shifted over the deleted ones on closing
+      f->is_pending = true;
+      t_int32 test = _dict_recurse_value(x, w, value, f->depth);
+      w->frame_arr[frame_ind].test = test;
+    }
+  }
 
-        continue;
-      }  // NB: No further recursion
-      break;
+  return true;
+}
 
-    case CMD_REPLACE_VALUE_FROM_DICT:
-      if (regexpr_match(x->search_key_expr, x->key_iter)
-          && dictionary_hasentry(x->replace_dict, x->key_iter)) {
+// ====  _DICT_RECURSE_POP  ====
+//******************************************************************************
+//  End the loop on top of the stack, and restore the trailing state.
+//
+void _dict_recurse_pop(t_dict_recurse* x, t_walk* w) {
 
-        t_symbol* key_iter[2]; key_iter[0] = x->key_iter; key_iter[1] = NULL;
-        dictionary_copyentries(x->replace_dict, dict, key_iter);    // NB: Strange it does not require the array size
-        x->count++;
+  TRACE("_dict_recurse_pop");
 
-        if (x->a_verbose == true) {
-          POST("  %s%s  replaced from  \"%s\"",
-            x->path, x->key_iter->s_name, x->replace_dict_sym->s_name);
-          }
+  t_frame* f = w->frame_arr + --w->frame_cnt;
 
-        continue;
-      }  // NB: No further recursion
-      break;
+  if (f->type == VALUE_TYPE_DICT) {
 
-    default: break;
-    }  // >>>> END switch through potential commands
+    // ==== Apply the edits logged for this dictionary, in one rebuild
+    if (x->edit_log->edit_cnt > f->edit_ini) {
+      TRACEBUF_EVENT(w->trace_lane, 'B', "edit", "apply", NULL);
+      editlog_apply(x->edit_log, f->edit_ini);
+      TRACEBUF_EVENT(w->trace_lane, 'E', "edit", "apply", NULL);
+    }
+
+    TRACEBUF_EVENT(w->trace_lane, 'E', "walk", "dict", NULL);
 
-    // == Set the trailing variables before for the recursion
-    strncat_zero(x->path, x->key_iter->s_name, x->path_len_max);    // NB: x->path changed
+    w->entry_len = f->entry_ofs;
 
-    // == Get the value and recurse to it
-    dictionary_getatom(dict, x->key_iter, atom);    // NB: This creates a copy
-    _dict_recurse_value(x, atom, depth);
+    w->dict_iter = f->dict_iter;
+    w->key_iter = f->key_iter;
+  }
+
+  else {
+
+    // ==== Compact the array: the kept values are in front, chuck the tail from the end
+    for (t_int32 ind = f->cnt - 1; ind >= f->keep_cnt; ind--) {
+      atomarray_chuckindex(f->atomarray, ind);
+    }
 
-    // == Reset the values that changed in this loop
-    x->path[path_len_ini + 2] = '\0';
-    x->has_match = has_match_ini;
-  }  // >>>> END of loop through the keys
+    w->array_iter = f->array_iter;
+    w->index_iter = f->index_iter;
+  }
 
   // ==== Restore the remaining state variables to their beginning values
-  x->type_iter = type_iter_ini;
-  x->dict_iter = dict_iter_ini;
-  x->key_iter = key_iter_ini;
+  w->type_iter = f->type_iter;
+  w->path_state = f->path_state;
+  w->is_selected = f->is_selected;
+  w->path[f->path_len] = '\0';
+}
 
-  if (key_arr) { dictionary_freekeys(dict, key_cnt, key_arr); }
+// ====  _DICT_RECURSE_ABANDON  ====
+//******************************************************************************
+//  Drop all the frames of a suspended traversal, when its dictionaries cannot be
+//  trusted anymore: the edits are discarded and the arrays left as is.
+//
+void _dict_recurse_abandon(t_dict_recurse* x, t_walk* w) {
+
+  TRACE("_dict_recurse_abandon");
+
+  // Close the spans of the dictionaries dropped
+  if (w->trace_lane) {
+    for (t_int32 ind = 0; ind < w->frame_cnt; ind++) {
+      if (w->frame_arr[ind].type == VALUE_TYPE_DICT) { tracebuf_event(w->trace_lane, 'E', "walk", "dict", NULL); }
+    }
+  }
+
+  w->frame_cnt = 0;
+  w->entry_len = 0;
+
+  editlog_discard(x->edit_log);
 }
 
 // ====  _DICT_RECURSE_VALUE_FIND  ====
 
-void _dict_recurse_value_find(t_dict_recurse* x, t_atom* value, const char* str) {
+//******************************************************************************
+//  Report a value for find key and find key_in.
+//
+//  @param str The value as a string, or NULL to format it only if it is reported.
+//
+void _dict_recurse_value_find(t_dict_recurse* x, t_walk* w, t_atom* value, const char* str) {
 
   TRACE("_dict_recurse_value_find");
 
+  // Only entries matching the path selector are reported
+  if (!w->is_selected || !(w->has_match & x->op_bit)) { return; }
+  if (!str) { str = _dict_recurse_value_str(x, w, value); }
+
   switch (x->command) {
 
   case CMD_FIND_KEY:
-    if (x->has_match) { POST("  %s  %s", x->path, str); }
-    x->has_match = false;    // reset matching state
+    if (w->has_match & x->op_bit) { WALK_MATCH(value, "  %s  %s", w->path, str); }
+    w->has_match &= ~x->op_bit;    // reset matching state
 
   case CMD_FIND_KEY_IN:
-    if (x->has_match) { POST("  %s  %s", x->path, str); }
+    if (w->has_match & x->op_bit) { WALK_MATCH(value, "  %s  %s", w->path, str); }
     break;
 
   default: break;
@@ -947,24 +4102,67 @@ void _dict_recurse_value_find(t_dict_recurse* x, t_atom* value, const char* str)
 
 // ====  _DICT_RECURSE_VALUE  ====
 //******************************************************************************
-//  Called by _dict_recurse_dict() for each entry and _dict_recurse_array() for each index
+//  Called by _dict_recurse_walk() for each entry and each array value:
+//  process the value for the command, or for each operation of a batch,
+//  then step into dictionaries and arrays which are kept.
 //
-t_int32 _dict_recurse_value(t_dict_recurse* x, t_atom* value, t_int32 depth) {
+t_int32 _dict_recurse_value(t_dict_recurse* x, t_walk* w, t_atom* value, t_int32 depth) {
 
   TRACE("_dict_recurse_value");
 
+  t_int32 entry_cnt = -1;    // The entries of a dictionary value, if they were read ahead
+
+  t_int32 test = x->batch_cnt
+    ? _dict_recurse_value_batch(x, w, value, &entry_cnt)
+    : _dict_recurse_value_op(x, w, value, &entry_cnt);
+
+  // ==== Deleted or replaced values are not stepped into
+  if (test != VALUE_NO_DEL) { return test; }
+
+  if (atomisdictionary(value)) {
+    t_dictionary* sub_dict = (t_dictionary*)atom_getobj(value);
+    if (entry_cnt >= 0) { _dict_recurse_enter(x, w, sub_dict, entry_cnt, depth); }
+    else { _dict_recurse_dict(x, w, sub_dict, depth); }
+  }
+
+  else if (atomisatomarray(value)) {
+    _dict_recurse_array(x, w, (t_atomarray*)atom_getobj(value), depth);
+  }
+
+  return VALUE_NO_DEL;
+}
+
+//******************************************************************************
+//  Process a value for the command in the object.
+//
+//  @param entry_cnt The number of entries read ahead for a dictionary value, or -1.
+//    They are left on top of the entry buffer for the traversal.
+//
+//  @return VALUE_DEL or VALUE_REPLACED if the value is not stepped into, otherwise VALUE_NO_DEL.
+//
+t_int32 _dict_recurse_value_op(t_dict_recurse* x, t_walk* w, t_atom* value, t_int32* entry_cnt) {
+
+  TRACE("_dict_recurse_value_op");
+
   long type = atom_gettype(value);
 
+  // ====  NOT SELECTED  ====
+  // Entries not matching the path selector are only traversed
+  if (!w->is_selected && !atomisdictionary(value) && !atomisatomarray(value)) { return VALUE_NO_DEL; }
+
+  // ====  NUMERIC PREDICATE  ====
+  if (CMD_IS_NUMBER(x->command) && ((type == A_LONG) || (type == A_FLOAT))) {
+    return _dict_recurse_number(x, w, value);
+  }
+
   // ====  INT  ====
   if (type == A_LONG) {
-    snprintf_zero(x->str_tmp, MAX_LEN_NUMBER, "%i", atom_getlong(value));
-    _dict_recurse_value_find(x, value, x->str_tmp);
+    _dict_recurse_value_find(x, w, value, NULL);
   }
 
   // ====  FLOAT  ====
   else if (type == A_FLOAT) {
-    snprintf_zero(x->str_tmp, MAX_LEN_NUMBER, "%i", atom_getfloat(value));
-    _dict_recurse_value_find(x, value, x->str_tmp);
+    _dict_recurse_value_find(x, w, value, NULL);
   }
 
   // ====  SYMBOL / STRING  ====
@@ -978,40 +4176,44 @@ t_int32 _dict_recurse_value(t_dict_recurse* x, t_atom* value, t_int32 depth) {
     // == FIND A SYMBOL VALUE
     case CMD_FIND_VALUE_SYM:
 
-      if (regexpr_match(x->search_val_expr, value_sym)) {
-        POST("  %s  \"%s\"", x->path, value_sym->s_name); x->count++;
+      if (VAL_TRY(regexpr_match(x->search_val_expr, value_sym))) {
+        WALK_MATCH(value, "  %s  \"%s\"", w->path, value_sym->s_name); w->count++;
       }
       break;
 
     // == FIND AN ENTRY
     case CMD_FIND_ENTRY:
 
-      if (regexpr_match(x->search_key_expr, x->key_iter)
-          && regexpr_match(x->search_val_expr, value_sym)
-          && (x->type_iter == VALUE_TYPE_DICT)) {
+      if (KEY_TRY(regexpr_match(x->search_key_expr, w->key_iter))
+          && VAL_TRY(regexpr_match(x->search_val_expr, value_sym))
+          && (w->type_iter == VALUE_TYPE_DICT)) {
 
-        POST("  %s  \"%s\"", x->path, value_sym->s_name); x->count++;
+        WALK_MATCH(value, "  %s  \"%s\"", w->path, value_sym->s_name); w->count++;
       }
       break;
 
     // == REPLACE A SYMBOL VALUE
     case CMD_REPLACE_VALUE_SYM:
 
-      if (regexpr_match(x->search_val_expr, value_sym)) {
+      if (VAL_TRY(regexpr_match(x->search_val_expr, value_sym))) {
 
         // If the value is from a dictionary entry
-        if (x->type_iter == VALUE_TYPE_DICT) {
-          dictionary_chuckentry(x->dict_iter, x->key_iter);
-          dictionary_appendsym(x->dict_iter, x->key_iter, x->replace_val_sym);
+        if (w->type_iter == VALUE_TYPE_DICT) {
+          t_atom value_new[1];
+          atom_setsym(value_new, x->replace_val_sym);
+          LOG_EDIT(editlog_set(x->edit_log, w->dict_iter, w->key_iter, NULL, value_new));
         }
 
         // If the value is from an array
-        else if (x->type_iter == VALUE_TYPE_ARRAY) { atom_setsym(value, x->replace_val_sym); }
+        else if (w->type_iter == VALUE_TYPE_ARRAY) {
+          _dict_recurse_journal_array(x, w, value);
+          atom_setsym(value, x->replace_val_sym);
+        }
 
-        x->count++;
+        w->count++;
         if (x->a_verbose) {
-          POST("  %s  \"%s\"  replaced by  \"%s\"",
-            x->path, value_sym->s_name, x->replace_val_sym->s_name);
+          WALK_POST("  %s  \"%s\"  replaced by  \"%s\"",
+            w->path, value_sym->s_name, x->replace_val_sym->s_name);
           }
         }
       break;
@@ -1019,17 +4221,18 @@ t_int32 _dict_recurse_value(t_dict_recurse* x, t_atom* value, t_int32 depth) {
     // == REPLACE AN ENTRY
     case CMD_REPLACE_ENTRY:
 
-      if (regexpr_match(x->search_key_expr, x->key_iter)
-          && regexpr_match(x->search_val_expr, value_sym)
-          && (x->type_iter == VALUE_TYPE_DICT)) {
+      if (KEY_TRY(regexpr_match(x->search_key_expr, w->key_iter))
+          && VAL_TRY(regexpr_match(x->search_val_expr, value_sym))
+          && (w->type_iter == VALUE_TYPE_DICT)) {
 
-        dictionary_chuckentry(x->dict_iter, x->key_iter);
-        dictionary_appendsym(x->dict_iter, x->replace_key_sym, x->replace_val_sym);
+        t_atom value_new[1];
+        atom_setsym(value_new, x->replace_val_sym);
+        LOG_EDIT(editlog_set(x->edit_log, w->dict_iter, w->key_iter, x->replace_key_sym, value_new));
 
-        x->count++;
+        w->count++;
         if (x->a_verbose) {
-          POST("  %s  \"%s\"  replaced by  (%s : %s)",
-            x->path, value_sym->s_name, x->replace_key_sym->s_name, x->replace_val_sym->s_name);
+          WALK_POST("  %s  \"%s\"  replaced by  (%s : %s)",
+            w->path, value_sym->s_name, x->replace_key_sym->s_name, x->replace_val_sym->s_name);
           }
         }
       break;
@@ -1037,22 +4240,17 @@ t_int32 _dict_recurse_value(t_dict_recurse* x, t_atom* value, t_int32 depth) {
     // == DELETE A SYMBOL VALUE
     case CMD_DELETE_VALUE_SYM:
 
-      if (regexpr_match(x->search_val_expr, value_sym)) {
+      if (VAL_TRY(regexpr_match(x->search_val_expr, value_sym))) {
 
         // If the value is from a dictionary entry
-        if (x->type_iter == VALUE_TYPE_DICT) {
-          dictionary_deleteentry(x->dict_iter, x->key_iter);
-        }
-
-        // If the value is from an array
-        else if (x->type_iter == VALUE_TYPE_ARRAY) {
-          atomarray_chuckindex(x->array_iter, x->index_iter);
+        if (w->type_iter == VALUE_TYPE_DICT) {
+          LOG_EDIT(editlog_delete(x->edit_log, w->dict_iter, w->key_iter));
         }
 
-        x->count++;
+        w->count++;
         if (x->a_verbose) {
-          POST("  %s  \"%s\"  deleted",
-            x->path, value_sym->s_name);
+          WALK_POST("  %s  \"%s\"  deleted",
+            w->path, value_sym->s_name);
           }
         return VALUE_DEL;
       }
@@ -1061,16 +4259,16 @@ t_int32 _dict_recurse_value(t_dict_recurse* x, t_atom* value, t_int32 depth) {
     // == DELETE A SYMBOL VALUE
     case CMD_DELETE_ENTRY:
 
-      if (regexpr_match(x->search_key_expr, x->key_iter)
-          && regexpr_match(x->search_val_expr, value_sym)
-          && (x->type_iter == VALUE_TYPE_DICT)) {
+      if (KEY_TRY(regexpr_match(x->search_key_expr, w->key_iter))
+          && VAL_TRY(regexpr_match(x->search_val_expr, value_sym))
+          && (w->type_iter == VALUE_TYPE_DICT)) {
 
-        dictionary_deleteentry(x->dict_iter, x->key_iter);
+        LOG_EDIT(editlog_delete(x->edit_log, w->dict_iter, w->key_iter));
 
-        x->count++;
+        w->count++;
         if (x->a_verbose) {
-          POST("  %s  \"%s\"  deleted",
-            x->path, value_sym->s_name);
+          WALK_POST("  %s  \"%s\"  deleted",
+            w->path, value_sym->s_name);
           }
         return VALUE_DEL;
       }
@@ -1078,8 +4276,7 @@ t_int32 _dict_recurse_value(t_dict_recurse* x, t_atom* value, t_int32 depth) {
 
     // == DEFAULT: CMD_FIND_KEY or CMD_FIND_KEY_IN
     default:
-      snprintf_zero(x->str_tmp, MAX_LEN_NUMBER, "\"%s\"", atom_getsym(value)->s_name);
-      _dict_recurse_value_find(x, value, x->str_tmp);
+      _dict_recurse_value_find(x, w, value, NULL);
       break;
     }
   }
@@ -1090,69 +4287,84 @@ t_int32 _dict_recurse_value(t_dict_recurse* x, t_atom* value, t_int32 depth) {
     t_dictionary* sub_dict = (t_dictionary*)atom_getobj(value);
     t_symbol* key_match = gensym("");
     t_symbol* value_match = gensym("");
+    t_int32 node_ind;
+    t_int32 pos;
+
+    // == Read the entries once, both for the look-ahead and for the traversal
+    t_bool is_match = false;
+    if (w->is_selected && CMD_IS_DICT_CONT(x->command)) {
+      if (*entry_cnt < 0) { *entry_cnt = _dict_recurse_read(x, w, sub_dict); }
+      is_match = (*entry_cnt > 0)
+        && _dict_recurse_match_dict(x, w, w->entry_buf + w->entry_len - *entry_cnt, *entry_cnt, &key_match, &value_match);
+    }
 
-    switch (x->command) {
+    switch (w->is_selected ? x->command : CMD_NONE) {
 
     case CMD_FIND_DICT_CONT_ENTRY:
 
-      if (_dict_recurse_match_dict(x, sub_dict, &key_match, &value_match)) {
+      if (is_match) {
 
-        x->count++;
-        POST("  %s:  dict containing  (%s : %s)",
-          x->path, key_match->s_name, value_match->s_name);
+        w->count++;
+        WALK_MATCH(value, "  %s:  dict containing  (%s : %s)",
+          w->path, key_match->s_name, value_match->s_name);
         }
       break;
 
     case CMD_REPLACE_DICT_CONT_ENTRY:
 
-      if (_dict_recurse_match_dict(x, sub_dict, &key_match, &value_match)) {
+      if (is_match && dicttmpl_is_set(x->replace_tmpl)) {
 
-        t_dictionary* dict_cpy = dictionary_new();
-        dictionary_clone_to_existing(x->replace_dict, dict_cpy);
+        t_dictionary* dict_cpy = dicttmpl_new_dict(x->replace_tmpl);
 
         // If the value is from a dictionary entry
-        if (x->type_iter == VALUE_TYPE_DICT) {
-          dictionary_deleteentry(x->dict_iter, x->key_iter);
-          dictionary_appenddictionary(x->dict_iter, x->key_iter, (t_object*)dict_cpy);
+        if (w->type_iter == VALUE_TYPE_DICT) {
+          t_atom value_new[1];
+          atom_setobj(value_new, dict_cpy);
+          LOG_EDIT(editlog_set(x->edit_log, w->dict_iter, w->key_iter, NULL, value_new));
         }
 
-        // If the value is from an array
-        else if (x->type_iter == VALUE_TYPE_ARRAY) {
+        // If the value is from an array: the dictionary replaced is kept by the journal, or freed
+        else if (w->type_iter == VALUE_TYPE_ARRAY) {
           long array_len;
           t_atom* atom_arr;
-          atomarray_getatoms(x->array_iter, &array_len, &atom_arr);
-          atom_setobj(atom_arr + x->index_iter, dict_cpy);
+          atomarray_getatoms(w->array_iter, &array_len, &atom_arr);
+          _dict_recurse_journal_array(x, w, atom_arr + w->index_iter);
+          atom_setobj(atom_arr + w->index_iter, dict_cpy);
+          if (!x->edit_log->journal) { object_free(sub_dict); }
         }
 
-        x->count++;
+        w->count++;
         if (x->a_verbose) {
-          POST("  %s:  dict containing  (%s : %s):  replaced by  \"%s\"",
-            x->path, key_match->s_name, value_match->s_name, x->replace_dict_sym->s_name);
+          WALK_POST("  %s:  dict containing  (%s : %s):  replaced by  \"%s\"",
+            w->path, key_match->s_name, value_match->s_name, x->replace_dict_sym->s_name);
           }
 
-        return VALUE_NO_DEL;
+        w->entry_len -= *entry_cnt; *entry_cnt = -1;    // NB: Drop the entries read ahead
+        return VALUE_REPLACED;
       }
       break;
 
     case CMD_DELETE_DICT_CONT_ENTRY:
 
-      if (_dict_recurse_match_dict(x, sub_dict, &key_match, &value_match)) {
+      if (is_match) {
+
+        w->entry_len -= *entry_cnt; *entry_cnt = -1;    // NB: Drop the entries read ahead, before the dictionary is freed
 
         // If the value is from a dictionary entry
-        if (x->type_iter == VALUE_TYPE_DICT) {
-          dictionary_deleteentry(x->dict_iter, x->key_iter);
+        if (w->type_iter == VALUE_TYPE_DICT) {
+          LOG_EDIT(editlog_delete(x->edit_log, w->dict_iter, w->key_iter));
         }
 
-        // If the value is from an array
-        else if (x->type_iter == VALUE_TYPE_ARRAY) {
-          atomarray_chuckindex(x->array_iter, x->index_iter);
+        // If the value is from an array, it is removed when the array is compacted,
+        // and kept by the journal
+        else if ((w->type_iter == VALUE_TYPE_ARRAY) && !x->edit_log->journal) {
           object_free(sub_dict);
         }
 
-        x->count++;
+        w->count++;
         if (x->a_verbose) {
-          POST("  %s:  dict containing  (%s : %s):  deleted",
-            x->path, key_match->s_name, value_match->s_name);
+          WALK_POST("  %s:  dict containing  (%s : %s):  deleted",
+            w->path, key_match->s_name, value_match->s_name);
           }
 
         return VALUE_DEL;
@@ -1161,124 +4373,403 @@ t_int32 _dict_recurse_value(t_dict_recurse* x, t_atom* value, t_int32 depth) {
 
     case CMD_APPEND_IN_DICT_CONT_ENTRY:
 
-      if (_dict_recurse_match_dict(x, sub_dict, &key_match, &value_match)) {
+      if (is_match) {
 
+        pos = _dict_recurse_journal_append(x, sub_dict, x->replace_key_sym);
         dictionary_appendsym(sub_dict, x->replace_key_sym, x->replace_val_sym);
+        if (pos >= 0) { journal_move(sub_dict, x->replace_key_sym, pos); }
+        w->entry_len -= *entry_cnt; *entry_cnt = -1;    // NB: Read again with the appended entry
 
-        x->count++;
+        w->count++;
         if (x->a_verbose) {
-          POST("  %s:  dict containing  (%s : %s):  appended  (%s : %s)",
-            x->path, key_match->s_name, value_match->s_name, x->replace_key_sym->s_name, x->replace_val_sym->s_name);
+          WALK_POST("  %s:  dict containing  (%s : %s):  appended  (%s : %s)",
+            w->path, key_match->s_name, value_match->s_name, x->replace_key_sym->s_name, x->replace_val_sym->s_name);
           }
         }
       break;
 
     case CMD_APPEND_IN_DICT_CONT_ENTRY_D:
 
-      if (_dict_recurse_match_dict(x, sub_dict, &key_match, &value_match)
-          && dictionary_hasentry(x->replace_dict, x->replace_key_sym)) {
+      if (is_match
+          && ((node_ind = dicttmpl_find(x->replace_tmpl, x->replace_key_sym)) >= 0)) {
 
-        t_symbol* key[2]; key[0] = x->replace_key_sym; key[1] = NULL;
-        dictionary_copyentries(x->replace_dict, sub_dict, key);    // NB: Strange it does not require the array size
+        pos = _dict_recurse_journal_append(x, sub_dict, x->replace_key_sym);
+        dicttmpl_append(x->replace_tmpl, node_ind, sub_dict);
+        if (pos >= 0) { journal_move(sub_dict, x->replace_key_sym, pos); }
+        w->entry_len -= *entry_cnt; *entry_cnt = -1;    // NB: Read again with the appended entry
 
-        x->count++;
+        w->count++;
         if (x->a_verbose) {
-          POST("  %s:  dict containing  (%s : %s):  appended entry  (%s : ...)  from \"%s\"",
-            x->path, key_match->s_name, value_match->s_name, x->replace_key_sym->s_name, x->replace_dict_sym->s_name);
+          WALK_POST("  %s:  dict containing  (%s : %s):  appended entry  (%s : ...)  from \"%s\"",
+            w->path, key_match->s_name, value_match->s_name, x->replace_key_sym->s_name, x->replace_dict_sym->s_name);
           }
         }
       break;
 
     case CMD_APPEND_IN_DICT_FROM_KEY:
 
-      if (regexpr_match(x->search_key_expr, x->key_iter)
-          && (x->type_iter == VALUE_TYPE_DICT)
-          && dictionary_hasentry(x->replace_dict, x->replace_key_sym)) {
+      if (KEY_TRY(regexpr_match(x->search_key_expr, w->key_iter))
+          && (w->type_iter == VALUE_TYPE_DICT)
+          && ((node_ind = dicttmpl_find(x->replace_tmpl, x->replace_key_sym)) >= 0)) {
 
-        t_symbol* key[2]; key[0] = x->replace_key_sym; key[1] = NULL;
-        dictionary_copyentries(x->replace_dict, sub_dict, key);    // NB: Strange it does not require the array size
+        pos = _dict_recurse_journal_append(x, sub_dict, x->replace_key_sym);
+        dicttmpl_append(x->replace_tmpl, node_ind, sub_dict);
+        if (pos >= 0) { journal_move(sub_dict, x->replace_key_sym, pos); }
 
-        x->count++;
+        w->count++;
         if (x->a_verbose) {
-          POST("  %s:  dict value:  appended entry  (%s : ...)  from \"%s\"",
-            x->path, x->replace_key_sym->s_name, x->replace_dict_sym->s_name);
+          WALK_POST("  %s:  dict value:  appended entry  (%s : ...)  from \"%s\"",
+            w->path, x->replace_key_sym->s_name, x->replace_dict_sym->s_name);
           }
         }
       break;
 
     default:
-      _dict_recurse_value_find(x, value, "_DICT_");
+      _dict_recurse_value_find(x, w, value, "_DICT_");
     }  // End of command "switch ..."
-
-    _dict_recurse_dict(x, sub_dict, depth);
   }  // End of dictionary "else if ..."
 
   // ====  ARRAY  ====
   else if (atomisatomarray(value)) {
 
-    _dict_recurse_value_find(x, value, "_ARRAY_");
-
-    t_atomarray* atomarray = (t_atomarray*)atom_getobj(value);
-    _dict_recurse_array(x, atomarray, depth);
+    _dict_recurse_value_find(x, w, value, "_ARRAY_");
   }
 
   return VALUE_NO_DEL;
 }
 
-// ====  _DICT_RECURSE_ARRAY  ====
+//******************************************************************************
+//  Process a value for each operation of a batch in order.
+//  Once an operation edits the value, or edited the key of its entry,
+//  the next ones which edit skip it, and once it is deleted or replaced, all of them.
+//
+t_int32 _dict_recurse_value_batch(t_dict_recurse* x, t_walk* w, t_atom* value, t_int32* entry_cnt) {
 
-void _dict_recurse_array(t_dict_recurse* x, t_atomarray* atomarray, t_int32 depth) {
+  TRACE("_dict_recurse_value_batch");
 
-  TRACE("_dict_recurse_array");
+  t_int32 test = VALUE_NO_DEL;
+  t_bool is_edited = w->is_edited;
+  w->is_edited = false;
 
-  t_atom* value;
+  for (t_int32 ind = 0; (test == VALUE_NO_DEL) && (ind < x->batch_cnt); ind++) {
 
-  // ==== Store the state variables on the beginning of the function
-  t_int32 path_len = (t_int32)strlen(x->path);
-  t_value_type type_iter_ini = x->type_iter;
-  t_atomarray* array_iter_ini = x->array_iter;
-  t_int32 index_iter_ini = x->index_iter;
+    t_batch_op* op = x->batch_arr + ind;
+    t_int32 count = w->count;
+    if (is_edited && !CMD_IS_FIND(op->command)) { continue; }
 
-  // ==== Add [ to the path
-  strncat_zero(x->path, "[", x->path_len_max);
+    _batch_op_load(x, op);
+    test = _dict_recurse_value_op(x, w, value, entry_cnt);
+    op->count += w->count - count;
 
-  // ==== Set the trailing variables before the recursions
-  x->type_iter = VALUE_TYPE_ARRAY;
-  x->array_iter = atomarray;
+    if ((w->count > count) && !CMD_IS_FIND(op->command)) { is_edited = true; }
+  }
+
+  _batch_op_load(x, &x->batch_self);
+
+  return test;
+}
+
+// ====  _DICT_RECURSE_NUMBER  ====
+//******************************************************************************
+//  Process an int or float value for the numeric commands, comparing it directly.
+//
+//  @return VALUE_DEL if the value is deleted from an array, otherwise VALUE_NO_DEL.
+//
+t_int32 _dict_recurse_number(t_dict_recurse* x, t_walk* w, t_atom* value) {
+
+  TRACE("_dict_recurse_number");
+
+  if (!numpred_match(&x->num_pred, value)) { return VALUE_NO_DEL; }
+
+  w->count++;
+
+  switch (x->command) {
+
+  case CMD_FIND_NUMBER:
+    WALK_MATCH(value, "  %s  %s", w->path, _dict_recurse_value_str(x, w, value));
+    break;
+
+  case CMD_REPLACE_NUMBER:
+
+    if (x->a_verbose) {
+      char str_new[MAX_LEN_NUMBER];
+      strncpy_zero(str_new, _dict_recurse_value_str(x, w, &x->replace_num), MAX_LEN_NUMBER);
+      WALK_POST("  %s  %s  replaced by  %s", w->path, _dict_recurse_value_str(x, w, value), str_new);
+    }
+
+    // If the value is from a dictionary entry
+    if (w->type_iter == VALUE_TYPE_DICT) {
+      LOG_EDIT(editlog_set(x->edit_log, w->dict_iter, w->key_iter, NULL, &x->replace_num));
+    }
+
+    // If the value is from an array
+    else if (w->type_iter == VALUE_TYPE_ARRAY) {
+      _dict_recurse_journal_array(x, w, value);
+      *value = x->replace_num;
+    }
+    break;
+
+  case CMD_DELETE_NUMBER:
+
+    if (x->a_verbose) { WALK_POST("  %s  %s  deleted", w->path, _dict_recurse_value_str(x, w, value)); }
+
+    // If the value is from a dictionary entry
+    if (w->type_iter == VALUE_TYPE_DICT) {
+      LOG_EDIT(editlog_delete(x->edit_log, w->dict_iter, w->key_iter));
+    }
+    return VALUE_DEL;
+
+  default: break;
+  }
+
+  return VALUE_NO_DEL;
+}
+
+// ====  _DICT_RECURSE_ARRAY  ====
+//******************************************************************************
+//  Push the loop through the values of an array, looped through by _dict_recurse_walk().
+//
+void _dict_recurse_array(t_dict_recurse* x, t_walk* w, t_atomarray* atomarray, t_int32 depth) {
+
+  TRACE("_dict_recurse_array");
+
+  // ==== Store the state variables on entering the loop
+  t_frame* f = _walk_push(w);
+  if (!f) { MY_ERR("Allocation error for the traversal stack."); return; }
 
   // ==== Get the array of atoms associated with the atomarray
   long array_len;
   t_atom* atom_arr;
   atomarray_getatoms(atomarray, &array_len, &atom_arr);
-  t_int32 test;
 
-  // ==== Loop through the array
-  for (t_int32 ind = 0; ind < array_len; ind++) {
+  f->type = VALUE_TYPE_ARRAY;
+  f->depth = depth;
+  f->cnt = (t_int32)array_len;
+  f->atomarray = atomarray;
+  f->atom_arr = atom_arr;
+  f->keep_cnt = 0;
+
+  w->stats.array_cnt++;
+  walkstats_depth(&w->stats, depth);
+
+  // ==== Add [ to the path
+  strncat_zero(w->path, "[", x->path_len_max);
+
+  // ==== Set the trailing variables before the recursions
+  w->type_iter = VALUE_TYPE_ARRAY;
+  w->array_iter = atomarray;
+}
+
+// ====  _DICT_RECURSE_STREAM  ====
+
+//******************************************************************************
+//  Format the current value of a JSON file as it is posted by the find commands.
+//
+static const char* _dict_recurse_stream_str(t_dict_recurse* x, t_walk* w, t_jsonstream* js) {
+
+  t_atom value[1];
 
-    value = atom_arr + ind;
-    x->index_iter = ind;
+  switch (js->token) {
+  case JSON_OBJECT: return "_DICT_";
+  case JSON_ARRAY: return "_ARRAY_";
+  case JSON_STRING: snprintf_zero(w->str_tmp, MAX_LEN_NUMBER, "\"%s\"", js->value.s); return w->str_tmp;
+  case JSON_NUMBER: jsonstream_number(js, value); return _dict_recurse_value_str(x, w, value);
+  default: return js->value.s;
+  }
+}
 
-    // == Update the path
-    snprintf_zero(x->str_tmp, MAX_LEN_NUMBER, "%i]", ind);
-    strncat_zero(x->path, x->str_tmp, x->path_len_max);
+//******************************************************************************
+//  Run the command over a JSON file, token by token. The file is copied to the
+//  output file as it is read, with the replacements. The matches are posted,
+//  whatever the output attribute, since no dictionary is built to output them.
+//  A cancelled command stops matching, but completes the copy.
+//
+void _dict_recurse_stream(t_dict_recurse* x) {
 
-    // == Recurse to the value
-    test = _dict_recurse_value(x, value, depth);
+  TRACE("_dict_recurse_stream");
 
-    // == If there was a deletion reset the array and shift the index
-    if (test == VALUE_DEL) {
-      atomarray_getatoms(atomarray, &array_len, &atom_arr);
-      ind--;
+  t_walk* w = &x->walk;
+  t_jsonstream* js = x->stream;
+  t_json_token token;
+  t_atom value[1];
+  char str_new[MAX_LEN_NUMBER];
+  t_bool is_set = pathexpr_is_set(x->path_expr);
+
+  while (((token = jsonstream_next(js)) != JSON_EOF) && (token != JSON_ERROR)) {
+
+    if (token == JSON_END) { continue; }
+    w->node_cnt++;
+
+    // ==== Step the path selector from the state of the object or array holding the value
+    t_path_state state = x->path_expr->state_ini;
+    if (is_set && (js->level >= 0)) {
+      state = js->frame_arr[js->level].user;
+      if (state) {
+        state = js->has_key
+          ? pathexpr_step_key_str(x->path_expr, state, js->key.s)
+          : pathexpr_step_index(x->path_expr, state, js->index);
+      }
+    }
+    if ((token == JSON_OBJECT) || (token == JSON_ARRAY)) {
+      js->frame_arr[js->level + 1].user = state;
+      if (token == JSON_OBJECT) { w->stats.dict_cnt++; } else { w->stats.array_cnt++; }
+      walkstats_depth(&w->stats, js->level + 1);
     }
 
-    // == In loop resetting of the values that changed in this function
-    x->path[path_len +  1] = '\0';
-  }  // End of the loop through the array
+    // ==== Only the values within the maximum depth and matching the path selector are processed
+    if (x->is_cancelled || (js->level < 0) || (x->a_depth && (js->depth > x->a_depth))
+      || (is_set && !pathexpr_accepts(x->path_expr, state))) { continue; }
 
-  // ==== Restore the remaining state variables to their beginning values
-  x->type_iter = type_iter_ini;
-  x->array_iter = array_iter_ini;
-  x->index_iter = index_iter_ini;
+    switch (x->command) {
+
+    case CMD_FIND_KEY:
+      if (js->has_key && KEY_TRY(regexpr_match_str(x->search_key_expr, js->key.s))) {
+        WALK_POST("  %s  %s", js->path.s, _dict_recurse_stream_str(x, w, js)); w->count++;
+      }
+      break;
+
+    case CMD_FIND_VALUE_SYM:
+      if ((token == JSON_STRING) && VAL_TRY(regexpr_match_str(x->search_val_expr, js->value.s))) {
+        WALK_POST("  %s  \"%s\"", js->path.s, js->value.s); w->count++;
+      }
+      break;
+
+    case CMD_FIND_ENTRY:
+      if (js->has_key && (token == JSON_STRING) && KEY_TRY(regexpr_match_str(x->search_key_expr, js->key.s))
+          && VAL_TRY(regexpr_match_str(x->search_val_expr, js->value.s))) {
+        WALK_POST("  %s  \"%s\"", js->path.s, js->value.s); w->count++;
+      }
+      break;
+
+    case CMD_FIND_NUMBER:
+      if (token != JSON_NUMBER) { break; }
+      jsonstream_number(js, value);
+      if (numpred_match(&x->num_pred, value)) {
+        WALK_POST("  %s  %s", js->path.s, _dict_recurse_value_str(x, w, value)); w->count++;
+      }
+      break;
+
+    case CMD_REPLACE_KEY:
+      if (js->has_key && KEY_TRY(regexpr_match_str(x->search_key_expr, js->key.s))) {
+        jsonstream_emit(js, x->replace_key_sym->s_name, NULL);
+        w->count++;
+        if (x->a_verbose) { WALK_POST("  %s  replaced by  \"%s\"", js->path.s, x->replace_key_sym->s_name); }
+      }
+      break;
+
+    case CMD_REPLACE_VALUE_SYM:
+      if ((token == JSON_STRING) && VAL_TRY(regexpr_match_str(x->search_val_expr, js->value.s))) {
+        jsonstream_emit(js, NULL, jsonstream_quote(js, x->replace_val_sym->s_name));
+        w->count++;
+        if (x->a_verbose) {
+          WALK_POST("  %s  \"%s\"  replaced by  \"%s\"", js->path.s, js->value.s, x->replace_val_sym->s_name);
+        }
+      }
+      break;
+
+    case CMD_REPLACE_ENTRY:
+      if (js->has_key && (token == JSON_STRING) && KEY_TRY(regexpr_match_str(x->search_key_expr, js->key.s))
+          && VAL_TRY(regexpr_match_str(x->search_val_expr, js->value.s))) {
+        jsonstream_emit(js, x->replace_key_sym->s_name, jsonstream_quote(js, x->replace_val_sym->s_name));
+        w->count++;
+        if (x->a_verbose) {
+          WALK_POST("  %s  \"%s\"  replaced by  (%s : %s)",
+            js->path.s, js->value.s, x->replace_key_sym->s_name, x->replace_val_sym->s_name);
+        }
+      }
+      break;
+
+    case CMD_REPLACE_NUMBER:
+      if (token != JSON_NUMBER) { break; }
+      jsonstream_number(js, value);
+      if (!numpred_match(&x->num_pred, value)) { break; }
+
+      // A float is written with a decimal point, to be read back as a float
+      if (atom_gettype(&x->replace_num) == A_LONG) {
+        snprintf_zero(str_new, MAX_LEN_NUMBER, "%lld", (long long)atom_getlong(&x->replace_num));
+      }
+      else {
+        snprintf_zero(str_new, MAX_LEN_NUMBER, "%.17g", atom_getfloat(&x->replace_num));
+        if (!strpbrk(str_new, ".eE")) { strncat_zero(str_new, ".0", MAX_LEN_NUMBER); }
+      }
+
+      jsonstream_emit(js, NULL, str_new);
+      w->count++;
+      if (x->a_verbose) { WALK_POST("  %s  %s  replaced by  %s", js->path.s, js->value.s, str_new); }
+      break;
+
+    default: break;
+    }
+  }
+
+  if ((token == JSON_ERROR) || (jsonstream_close(js) != ERR_NONE)) {
+    MY_ERR("%s:  \"%s\":  %s", x->cmd_sym->s_name, x->dict_sym->s_name, js->err_s);
+  }
+}
+
+// ====  DICT_RECURSE_CANCEL  ====
+//******************************************************************************
+//  Stop the command being processed. It ends with what was done so far.
+//
+void dict_recurse_cancel(t_dict_recurse* x) {
+
+  TRACE("dict_recurse_cancel");
+
+  if (!x->is_busy) { WARNING("cancel:  No command to cancel."); return; }
+  x->is_cancelled = true;
+}
+
+// ====  DICT_RECURSE_UNDO  ====
+//******************************************************************************
+//  Undo the last command recorded in the journal, restoring the entries it edited.
+//  The journal is cleared if one of its dictionaries was modified by another object since.
+//
+void dict_recurse_undo(t_dict_recurse* x) {
+
+  TRACE("dict_recurse_undo");
+
+  t_journal* journal = x->journal;
+
+  MY_ASSERT(x->is_busy, , "undo:  The object is still busy.");
+  MY_ASSERT(!journal || !journal->mark_cnt, , "undo:  No command to undo.");
+
+  if (journal->err != ERR_NONE) {
+    MY_ERR("undo:  The journal is incomplete, it is cleared.");
+    _dict_recurse_journal_clear(x);
+    return;
+  }
+
+  // Test the dictionaries of the last command, from its first mark
+  t_int32 mark_cnt = journal->mark_cnt;
+  t_journal_mark* mark = journal_last(journal);
+  t_int32 mark_ind = mark_cnt - 1;
+  while ((mark_ind > 0) && (journal->mark_arr[mark_ind - 1].cmd_ind == mark->cmd_ind)) { mark_ind--; }
+
+  for (t_int32 ind = mark_ind; ind < mark_cnt; ind++) {
+    mark = journal->mark_arr + ind;
+    if (!mark->is_stale) { continue; }
+
+    MY_ERR("undo:  \"%s\" was modified by another object since \"%s\", the journal is cleared.",
+      mark->dict_sym->s_name, mark->cmd_sym->s_name);
+    _dict_recurse_journal_clear(x);
+    return;
+  }
+
+  // Restore the entries, then notify the dictionaries and stop watching them
+  t_symbol* cmd_sym = journal->mark_arr[mark_ind].cmd_sym;
+  t_int32 undo_cnt = journal_undo(journal);
+
+  POST("undo:  %i edit%s of \"%s\" undone.", undo_cnt, (undo_cnt == 1) ? "" : "s", cmd_sym->s_name);
+
+  for (t_int32 ind = mark_ind; ind < mark_cnt; ind++) {
+    mark = journal->mark_arr + ind;
+    if (undo_cnt) { _dict_recurse_modified(x, mark->dict); }
+    if (x->a_verbose) { POST("  \"%s\"", mark->dict_sym->s_name); }
+  }
+
+  _dict_recurse_journal_pop(x, mark_cnt);
+
+  outlet_bang(x->outl_bang);
 }
 
 // ====  DICT_RECURSE_BANG  ====
@@ -0,0 +1,268 @@
+#include "dicttmpl.h"
+
+// Cloning the replacement dictionary for each match reads it again, key by
+// key, every time. Instead it is compiled once per command into a flat
+// array of nodes in pre-order, with the numbers and symbols prebuilt, and
+// each instance is stamped out from the array with appends only.
+
+// ====  DICTTMPL  ====
+
+//******************************************************************************
+//  Create and allocate a new, empty, template.
+//
+//  @return A pointer to the newly allocated structure, or NULL on failure.
+//
+t_dicttmpl* dicttmpl_new() {
+
+  t_dicttmpl* tmpl = (t_dicttmpl*)sysmem_newptr(sizeof(t_dicttmpl));
+  if (!tmpl) { return NULL; }
+
+  tmpl->node_arr = NULL;
+  tmpl->node_max = 0;
+
+  dicttmpl_clear(tmpl);
+
+  return tmpl;
+}
+
+//******************************************************************************
+//  Free a template.
+//
+//  @param tmpl A pointer to the template.
+//
+//  Note: No need to check if the pointer argument is NULL.
+//
+void dicttmpl_free(t_dicttmpl* tmpl) {
+
+  if (!tmpl) { return; }
+
+  if (tmpl->node_arr) { sysmem_freeptr(tmpl->node_arr); }
+  sysmem_freeptr(tmpl);
+}
+
+//******************************************************************************
+//  Clear a template. The allocation is kept for the next compilation.
+//
+//  @param tmpl A pointer to the template.
+//
+void dicttmpl_clear(t_dicttmpl* tmpl) {
+
+  tmpl->node_cnt = 0;
+  tmpl->stamp_cnt = 0;
+}
+
+//******************************************************************************
+//  Add a node, growing the array if it is full.
+//
+//  @return The index of the new node, or -1 on an allocation error.
+//
+static t_int32 _dicttmpl_add(t_dicttmpl* tmpl, t_symbol* key, char type) {
+
+  if (tmpl->node_cnt == tmpl->node_max) {
+
+    t_int32 node_max = tmpl->node_max ? 2 * tmpl->node_max : 64;
+    t_tmpl_node* node_arr = tmpl->node_arr
+      ? (t_tmpl_node*)sysmem_resizeptr(tmpl->node_arr, node_max * sizeof(t_tmpl_node))
+      : (t_tmpl_node*)sysmem_newptr(node_max * sizeof(t_tmpl_node));
+    if (!node_arr) { return -1; }
+
+    tmpl->node_arr = node_arr;
+    tmpl->node_max = node_max;
+  }
+
+  t_tmpl_node* node = tmpl->node_arr + tmpl->node_cnt;
+  node->key = key;
+  node->type = type;
+  node->child_cnt = 0;
+  node->node_cnt = 1;
+  node->value.a_type = A_NOTHING;
+
+  return tmpl->node_cnt++;
+}
+
+static t_my_err _dicttmpl_compile_value (t_dicttmpl* tmpl, t_symbol* key, t_atom* value);
+static void     _dicttmpl_append        (t_dicttmpl* tmpl, t_int32 node_ind, t_dictionary* dict);
+
+//******************************************************************************
+//  Compile a dictionary, and its entries after it.
+//
+static t_my_err _dicttmpl_compile_dict(t_dicttmpl* tmpl, t_symbol* key, t_dictionary* dict) {
+
+  t_my_err err = ERR_NONE;
+  t_atom value[1];
+
+  t_int32 ind = _dicttmpl_add(tmpl, key, TMPL_DICT);
+  if (ind < 0) { return ERR_ALLOC; }
+
+  long key_cnt = 0;
+  t_symbol** key_arr = NULL;
+  dictionary_getkeys(dict, &key_cnt, &key_arr);
+
+  for (t_int32 key_ind = 0; (key_ind < key_cnt) && (err == ERR_NONE); key_ind++) {
+    dictionary_getatom(dict, key_arr[key_ind], value);
+    err = _dicttmpl_compile_value(tmpl, key_arr[key_ind], value);
+  }
+
+  if (key_arr) { dictionary_freekeys(dict, key_cnt, key_arr); }
+
+  tmpl->node_arr[ind].child_cnt = (t_int32)key_cnt;
+  tmpl->node_arr[ind].node_cnt = tmpl->node_cnt - ind;
+
+  return err;
+}
+
+//******************************************************************************
+//  Compile one value, and its children after it for dictionaries and arrays.
+//
+static t_my_err _dicttmpl_compile_value(t_dicttmpl* tmpl, t_symbol* key, t_atom* value) {
+
+  t_my_err err = ERR_NONE;
+
+  if (atomisdictionary(value)) {
+    return _dicttmpl_compile_dict(tmpl, key, (t_dictionary*)atom_getobj(value));
+  }
+
+  if (atomisatomarray(value)) {
+
+    t_int32 ind = _dicttmpl_add(tmpl, key, TMPL_ARRAY);
+    if (ind < 0) { return ERR_ALLOC; }
+
+    long array_len;
+    t_atom* atom_arr;
+    atomarray_getatoms((t_atomarray*)atom_getobj(value), &array_len, &atom_arr);
+
+    for (t_int32 val_ind = 0; (val_ind < array_len) && (err == ERR_NONE); val_ind++) {
+      err = _dicttmpl_compile_value(tmpl, NULL, atom_arr + val_ind);
+    }
+
+    tmpl->node_arr[ind].child_cnt = (t_int32)array_len;
+    tmpl->node_arr[ind].node_cnt = tmpl->node_cnt - ind;
+
+    return err;
+  }
+
+  t_int32 ind = _dicttmpl_add(tmpl, key, TMPL_ATOM);
+  if (ind < 0) { return ERR_ALLOC; }
+
+  // NB: Strings are stored as symbols, as everywhere else in the traversal
+  long type = atom_gettype(value);
+  if ((type == A_LONG) || (type == A_FLOAT) || (type == A_SYM)) { tmpl->node_arr[ind].value = *value; }
+  else { atom_setsym(&tmpl->node_arr[ind].value, atom_getsym(value)); }
+
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  Compile a dictionary into the template.
+//
+//  @param tmpl A pointer to the template.
+//  @param dict The dictionary to compile, which is not referenced afterwards.
+//
+//  @return ERR_NONE, or ERR_ALLOC in which case the template is cleared.
+//
+t_my_err dicttmpl_set(t_dicttmpl* tmpl, t_dictionary* dict) {
+
+  dicttmpl_clear(tmpl);
+
+  t_my_err err = _dicttmpl_compile_dict(tmpl, NULL, dict);
+  if (err != ERR_NONE) { dicttmpl_clear(tmpl); }
+
+  return err;
+}
+
+//******************************************************************************
+//  Find an entry of the root dictionary.
+//
+//  @return The index of the node, or -1 if the key is not found.
+//
+t_int32 dicttmpl_find(t_dicttmpl* tmpl, t_symbol* key) {
+
+  if (!dicttmpl_is_set(tmpl)) { return -1; }
+
+  t_int32 ind = 1;
+  for (t_int32 child = 0; child < tmpl->node_arr[0].child_cnt; child++) {
+    if (tmpl->node_arr[ind].key == key) { return ind; }
+    ind += tmpl->node_arr[ind].node_cnt;
+  }
+
+  return -1;
+}
+
+//******************************************************************************
+//  Stamp out the value of a node, creating new objects for dictionaries and arrays.
+//
+static void _dicttmpl_stamp(t_dicttmpl* tmpl, t_int32 ind, t_atom* value) {
+
+  t_tmpl_node* node = tmpl->node_arr + ind;
+  t_int32 child = ind + 1;
+  t_atom child_value[1];
+
+  switch (node->type) {
+
+  case TMPL_DICT: {
+    t_dictionary* dict = dictionary_new();
+    for (t_int32 cnt = 0; cnt < node->child_cnt; cnt++) {
+      _dicttmpl_append(tmpl, child, dict);
+      child += tmpl->node_arr[child].node_cnt;
+    }
+    atom_setobj(value, dict);
+    break; }
+
+  case TMPL_ARRAY: {
+    t_atomarray* atomarray = atomarray_new(0, NULL);
+    for (t_int32 cnt = 0; cnt < node->child_cnt; cnt++) {
+      _dicttmpl_stamp(tmpl, child, child_value);
+      atomarray_appendatom(atomarray, child_value);
+      child += tmpl->node_arr[child].node_cnt;
+    }
+    atom_setobj(value, atomarray);
+    break; }
+
+  default:
+    *value = node->value;
+    break;
+  }
+}
+
+//******************************************************************************
+//  Stamp out a new dictionary from the whole template.
+//
+//  @return The new dictionary, owned by the caller, or NULL if the template is not set.
+//
+t_dictionary* dicttmpl_new_dict(t_dicttmpl* tmpl) {
+
+  if (!dicttmpl_is_set(tmpl)) { return NULL; }
+
+  t_atom value[1];
+  _dicttmpl_stamp(tmpl, 0, value);
+  tmpl->stamp_cnt++;
+
+  return (t_dictionary*)atom_getobj(value);
+}
+
+//******************************************************************************
+//  Stamp out an entry and append it to a dictionary.
+//
+static void _dicttmpl_append(t_dicttmpl* tmpl, t_int32 node_ind, t_dictionary* dict) {
+
+  t_tmpl_node* node = tmpl->node_arr + node_ind;
+  t_atom value[1];
+
+  _dicttmpl_stamp(tmpl, node_ind, value);
+
+  if (node->type == TMPL_DICT) { dictionary_appenddictionary(dict, node->key, atom_getobj(value)); }
+  else if (node->type == TMPL_ARRAY) { dictionary_appendatomarray(dict, node->key, atom_getobj(value)); }
+  else { dictionary_appendatom(dict, node->key, value); }
+}
+
+//******************************************************************************
+//  Stamp out an entry of the root dictionary and append it to a dictionary,
+//  replacing an entry with the same key.
+//
+//  @param node_ind The index of the entry node, from dicttmpl_find().
+//
+void dicttmpl_append(t_dicttmpl* tmpl, t_int32 node_ind, t_dictionary* dict) {
+
+  _dicttmpl_append(tmpl, node_ind, dict);
+  tmpl->stamp_cnt++;
+}
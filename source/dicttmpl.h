@@ -0,0 +1,68 @@
+#ifndef YC_DICTTMPL_H_
+#define YC_DICTTMPL_H_
+
+// ========  HEADER FILE FOR THE DICTIONARY INSTANTIATION TEMPLATES  ========
+
+#include "ext.h"        // header file for all objects, should always be first
+#include "ext_obex.h"   // header file for all objects, required for new style Max object
+#include "z_dsp.h"      // header file for MSP objects, included here for t_double type
+
+#include "ext_dictionary.h"
+
+#include "regexpr.h"
+
+// ========  DEFINES  ========
+
+typedef enum _tmpl_type {
+
+  TMPL_ATOM,      // A number or a symbol, prebuilt
+  TMPL_DICT,      // A dictionary, with its entries as children
+  TMPL_ARRAY      // An array, with its values as children
+
+} t_tmpl_type;
+
+// ========  STRUCTURES  ========
+
+//******************************************************************************
+//  One value of the template, with its children following it in pre-order
+//
+typedef struct _tmpl_node {
+
+  t_symbol* key;        // The key, for the entries of a dictionary, otherwise NULL
+  t_atom    value;      // The prebuilt value for TMPL_ATOM
+  char      type;
+  t_int32   child_cnt;  // The number of children, for TMPL_DICT and TMPL_ARRAY
+  t_int32   node_cnt;   // The number of nodes of the subtree, itself included
+
+} t_tmpl_node;
+
+//******************************************************************************
+//  Flat instantiation template of a dictionary, compiled once per command
+//  and stamped out for each match, without reading the source dictionary again.
+//
+typedef struct _dicttmpl {
+
+  t_tmpl_node* node_arr;  // The root dictionary is node 0
+  t_int32      node_cnt;
+  t_int32      node_max;
+
+  t_int32 stamp_cnt;      // The number of values stamped out, for verbose output
+
+} t_dicttmpl;
+
+// ========  FUNCTION DECLARATIONS  ========
+
+t_dicttmpl* dicttmpl_new   ();
+void        dicttmpl_free  (t_dicttmpl* tmpl);
+void        dicttmpl_clear (t_dicttmpl* tmpl);
+t_my_err    dicttmpl_set   (t_dicttmpl* tmpl, t_dictionary* dict);
+
+t_int32       dicttmpl_find     (t_dicttmpl* tmpl, t_symbol* key);
+t_dictionary* dicttmpl_new_dict (t_dicttmpl* tmpl);
+void          dicttmpl_append   (t_dicttmpl* tmpl, t_int32 node_ind, t_dictionary* dict);
+
+#define dicttmpl_is_set(_tmpl)    ((_tmpl)->node_cnt > 0)
+
+// ========  END OF HEADER FILE  ========
+
+#endif
@@ -0,0 +1,411 @@
+#include "editlog.h"
+
+// Editing a dictionary while its keys are iterated means chucking and
+// re-appending an entry for each hit, which moves the entry to the end.
+// Instead the edits are logged during the traversal, and each dictionary
+// is rebuilt once, from its first edited key, with the key order preserved.
+
+// ====  EDITLOG  ====
+
+//******************************************************************************
+//  Create and allocate a new, empty, edit log.
+//
+//  @return A pointer to the newly allocated structure, or NULL on failure.
+//
+t_editlog* editlog_new() {
+
+  t_editlog* log = (t_editlog*)sysmem_newptr(sizeof(t_editlog));
+  if (!log) { return NULL; }
+
+  log->edit_arr = NULL;
+  log->edit_max = 0;
+  log->journal = NULL;
+
+  editlog_clear(log);
+
+  return log;
+}
+
+//******************************************************************************
+//  Free an edit log.
+//
+//  @param log A pointer to the edit log.
+//
+//  Note: No need to check if the pointer argument is NULL.
+//
+void editlog_free(t_editlog* log) {
+
+  if (!log) { return; }
+
+  if (log->edit_arr) { sysmem_freeptr(log->edit_arr); }
+  sysmem_freeptr(log);
+}
+
+//******************************************************************************
+//  Clear an edit log, without applying the edits.
+//
+//  @param log A pointer to the edit log.
+//
+void editlog_clear(t_editlog* log) {
+
+  log->edit_cnt = 0;
+  log->dict_cnt = 0;
+  log->drop_cnt = 0;
+}
+
+//******************************************************************************
+//  Discard the edits of a log without applying them, freeing their new values.
+//
+//  @param log A pointer to the edit log.
+//
+void editlog_discard(t_editlog* log) {
+
+  for (t_int32 ind = 0; ind < log->edit_cnt; ind++) {
+    t_edit* edit = log->edit_arr + ind;
+    if (edit->dict && (edit->value.a_type == A_OBJ) && atom_getobj(&edit->value)) { object_free(atom_getobj(&edit->value)); }
+  }
+
+  editlog_clear(log);
+}
+
+//******************************************************************************
+//  Add an edit to the log.
+//
+//  @return ERR_NONE or ERR_ALLOC.
+//
+static t_my_err _editlog_add(t_editlog* log, t_dictionary* dict, t_symbol* key, t_symbol* key_new, t_atom* value, t_bool is_del) {
+
+  // Grow the array if it is full
+  if (log->edit_cnt == log->edit_max) {
+
+    t_int32 edit_max = log->edit_max ? 2 * log->edit_max : 64;
+    t_edit* edit_arr = log->edit_arr
+      ? (t_edit*)sysmem_resizeptr(log->edit_arr, edit_max * sizeof(t_edit))
+      : (t_edit*)sysmem_newptr(edit_max * sizeof(t_edit));
+    if (!edit_arr) { return ERR_ALLOC; }
+
+    log->edit_arr = edit_arr;
+    log->edit_max = edit_max;
+  }
+
+  t_edit* edit = log->edit_arr + log->edit_cnt++;
+  edit->dict = dict;
+  edit->key = key;
+  edit->key_new = key_new;
+  edit->is_del = is_del;
+  if (value) { edit->value = *value; }
+  else { edit->value.a_type = A_NOTHING; }
+
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  Log the deletion of an entry.
+//
+t_my_err editlog_delete(t_editlog* log, t_dictionary* dict, t_symbol* key) {
+
+  return _editlog_add(log, dict, key, NULL, NULL, true);
+}
+
+//******************************************************************************
+//  Log the renaming of an entry, keeping its value.
+//
+t_my_err editlog_rename(t_editlog* log, t_dictionary* dict, t_symbol* key, t_symbol* key_new) {
+
+  return _editlog_add(log, dict, key, key_new, NULL, false);
+}
+
+//******************************************************************************
+//  Log the replacement of the value of an entry, and optionally of its key.
+//  The previous value is freed when the edit is applied.
+//
+//  @param key_new The new key, or NULL to keep it.
+//  @param value The new value. Objects are owned by the dictionary once applied.
+//
+t_my_err editlog_set(t_editlog* log, t_dictionary* dict, t_symbol* key, t_symbol* key_new, t_atom* value) {
+
+  return _editlog_add(log, dict, key, key_new, value, false);
+}
+
+//******************************************************************************
+//  Append an entry, with dictionaries appended as such.
+//
+static void _editlog_append(t_dictionary* dict, t_symbol* key, t_atom* value) {
+
+  if (atomisdictionary(value)) { dictionary_appenddictionary(dict, key, atom_getobj(value)); }
+  else { dictionary_appendatom(dict, key, value); }
+}
+
+// ====  EDITLOG_APPLY  ====
+
+//******************************************************************************
+//  Reference to an edit, sorted by dictionary, then by key, then in log order.
+//
+typedef struct _edit_ref {
+
+  t_dictionary* dict;
+  t_symbol*     key;
+  t_int32       ind;        // The position of the edit in the log
+
+} t_edit_ref;
+
+static int _editlog_ref_cmp(const void* a, const void* b) {
+
+  const t_edit_ref* ref_a = (const t_edit_ref*)a;
+  const t_edit_ref* ref_b = (const t_edit_ref*)b;
+
+  if (ref_a->dict != ref_b->dict) { return ((t_ptr_uint)ref_a->dict < (t_ptr_uint)ref_b->dict) ? -1 : 1; }
+  if (ref_a->key != ref_b->key) { return ((t_ptr_uint)ref_a->key < (t_ptr_uint)ref_b->key) ? -1 : 1; }
+  return (ref_a->ind < ref_b->ind) ? -1 : (ref_a->ind > ref_b->ind);
+}
+
+//******************************************************************************
+//  Find the first reference not lower than a dictionary and a key, in a sorted range.
+//
+static t_int32 _editlog_ref_find(t_edit_ref* ref_arr, t_int32 lo, t_int32 hi, t_dictionary* dict, t_symbol* key) {
+
+  t_edit_ref ref = { dict, key, -1 };
+
+  while (lo < hi) {
+    t_int32 mid = lo + (hi - lo) / 2;
+    if (_editlog_ref_cmp(ref_arr + mid, &ref) < 0) { lo = mid + 1; }
+    else { hi = mid; }
+  }
+
+  return lo;
+}
+
+//******************************************************************************
+//  The state of the rebuild of a dictionary.
+//
+//  The positions recorded in the journal are those of the dictionary as if it
+//  was rebuilt in place: the entries before the first edited key, then the
+//  entries rebuilt, then the entries still to rebuild, from the current one.
+//
+typedef struct _edit_rebuild {
+
+  t_dictionary* dict;
+  t_edit_ref*   ref_arr;    // The references to the edits, sorted
+  t_int32       ref_lo;     // The range of the references of the dictionary
+  t_int32       ref_hi;
+  t_symbol**    key_arr;    // The keys before the rebuild, set to NULL for the entries dropped by a renaming
+  long          key_cnt;
+  t_int32       key_ini;    // The first edited key
+  t_int32       key_ind;    // The key being rebuilt
+  t_int32       del_cnt;    // The entries removed before the current one
+  t_int32       ini_del;    // The entries removed before the first edited key
+
+} t_edit_rebuild;
+
+//******************************************************************************
+//  Get the edit of a key of the dictionary, the first one logged for it.
+//
+//  @return A pointer to the edit, or NULL if the key is not edited.
+//
+static t_edit* _editlog_edit_of(t_editlog* log, t_edit_rebuild* rb, t_symbol* key) {
+
+  t_int32 ind = _editlog_ref_find(rb->ref_arr, rb->ref_lo, rb->ref_hi, rb->dict, key);
+  return ((ind < rb->ref_hi) && (rb->ref_arr[ind].key == key)) ? log->edit_arr + rb->ref_arr[ind].ind : NULL;
+}
+
+//******************************************************************************
+//  Remove the entry a renaming is about to overwrite, instead of letting the
+//  append replace its value. With a journal, its value is recorded instead of freed.
+//
+static void _editlog_overwrite(t_editlog* log, t_edit_rebuild* rb, t_symbol* key_new) {
+
+  t_atom value_old[1];
+  t_int32 pos = rb->key_ind - rb->del_cnt;
+
+  // ==== An entry still to rebuild is skipped when it is reached, its edit being superseded
+  t_int32 ind = rb->key_ind;
+  for ( ; (ind < rb->key_cnt) && (rb->key_arr[ind] != key_new); ind++) {
+    if (ind > rb->key_ind) { pos += (rb->key_arr[ind] != NULL); }
+  }
+
+  if (ind < rb->key_cnt) {
+    t_edit* edit = _editlog_edit_of(log, rb, key_new);
+    if (edit) {
+      if ((edit->value.a_type == A_OBJ) && atom_getobj(&edit->value)) { object_free(atom_getobj(&edit->value)); }
+      edit->dict = NULL;
+    }
+
+    rb->key_arr[ind] = NULL;
+    pos++;    // After the current entry
+  }
+
+  // ==== Otherwise the entry is before the current one, and so are the next positions
+  else {
+
+    long key_cnt = 0;
+    t_symbol** key_arr = NULL;
+    dictionary_getkeys(rb->dict, &key_cnt, &key_arr);
+
+    t_int32 tail_cnt = 0;
+    for (ind = rb->key_ind; ind < rb->key_cnt; ind++) { tail_cnt += (rb->key_arr[ind] != NULL); }
+
+    t_int32 ini_cnt = rb->key_ini - rb->ini_del;
+    for (pos = 0; (pos < key_cnt) && (key_arr[pos] != key_new); pos++) { }
+    if (pos >= ini_cnt) { pos -= tail_cnt; }    // The entries rebuilt are moved after the ones to rebuild
+    else { rb->ini_del++; }
+
+    if (key_arr) { dictionary_freekeys(rb->dict, key_cnt, key_arr); }
+    rb->del_cnt++;
+  }
+
+  if (!log->journal) { dictionary_deleteentry(rb->dict, key_new); return; }
+
+  dictionary_getatom(rb->dict, key_new, value_old);
+  dictionary_chuckentry(rb->dict, key_new);
+  if ((journal_add(log->journal, JOURNAL_DELETE, (t_object*)rb->dict, key_new, NULL, value_old, pos) != ERR_NONE)
+    && (value_old->a_type == A_OBJ)) { object_free(atom_getobj(value_old)); }
+}
+
+//******************************************************************************
+//  Apply one edit to the entry being rebuilt.
+//  With a journal, the previous value is recorded instead of freed.
+//
+static void _editlog_apply_edit(t_editlog* log, t_edit* edit, t_edit_rebuild* rb) {
+
+  t_atom value[1];
+  t_atom value_old[1];
+  t_journal* journal = log->journal;
+  t_dictionary* dict = rb->dict;
+  t_symbol* key = rb->key_arr[rb->key_ind];
+  t_symbol* key_new = edit->key_new ? edit->key_new : key;
+
+  if (edit->is_del) {
+    t_int32 pos = rb->key_ind - rb->del_cnt++;
+    if (!journal) { dictionary_deleteentry(dict, key); return; }
+    dictionary_getatom(dict, key, value_old);
+    dictionary_chuckentry(dict, key);
+    if ((journal_add(journal, JOURNAL_DELETE, (t_object*)dict, key, NULL, value_old, pos) != ERR_NONE)
+      && (value_old->a_type == A_OBJ)) { object_free(atom_getobj(value_old)); }
+    return;
+  }
+
+  // Renamed over another entry: remove that one first
+  if ((key_new != key) && dictionary_hasentry(dict, key_new)) { _editlog_overwrite(log, rb, key_new); }
+
+  t_int32 pos = rb->key_ind - rb->del_cnt;
+
+  // Keep the value, or free the previous one
+  if (edit->value.a_type == A_NOTHING) {
+    dictionary_getatom(dict, key, value);
+    dictionary_chuckentry(dict, key);
+    if (journal) { journal_add(journal, JOURNAL_RENAME, (t_object*)dict, key, key_new, NULL, pos); }
+  }
+  else if (journal) {
+    *value = edit->value;
+    dictionary_getatom(dict, key, value_old);
+    dictionary_chuckentry(dict, key);
+    if ((journal_add(journal, JOURNAL_SET, (t_object*)dict, key, key_new, value_old, pos) != ERR_NONE)
+      && (value_old->a_type == A_OBJ)) { object_free(atom_getobj(value_old)); }
+  }
+  else {
+    *value = edit->value;
+    dictionary_deleteentry(dict, key);
+  }
+
+  _editlog_append(dict, key_new, value);
+}
+
+//******************************************************************************
+//  Apply the edits logged from a given position, then truncate the log there.
+//
+//  Each dictionary is rebuilt once: the entries from its first edited key
+//  onwards are chucked and re-appended in order, with the edits applied.
+//  The edits are looked up by key, in whatever order they were logged.
+//  A key is edited once: the other edits of the same key, and the edits of
+//  keys which are not found, are dropped with their values and counted.
+//
+//  @param log A pointer to the edit log.
+//  @param edit_start The position of the first edit to apply.
+//
+void editlog_apply(t_editlog* log, t_int32 edit_start) {
+
+  t_atom value[1];
+  t_int32 ref_cnt = log->edit_cnt - edit_start;
+  if (ref_cnt <= 0) { return; }
+
+  // Sort references to the edits, so that each dictionary has a range looked up by key
+  t_edit_ref* ref_arr = (t_edit_ref*)sysmem_newptr(ref_cnt * sizeof(t_edit_ref));
+  if (!ref_arr) {
+    log->drop_cnt += ref_cnt;
+    for (t_int32 ind = edit_start; ind < log->edit_cnt; ind++) {
+      t_edit* edit = log->edit_arr + ind;
+      if ((edit->value.a_type == A_OBJ) && atom_getobj(&edit->value)) { object_free(atom_getobj(&edit->value)); }
+    }
+    log->edit_cnt = edit_start;
+    return;
+  }
+
+  for (t_int32 ind = 0; ind < ref_cnt; ind++) {
+    t_edit* edit = log->edit_arr + edit_start + ind;
+    ref_arr[ind].dict = edit->dict;
+    ref_arr[ind].key = edit->key;
+    ref_arr[ind].ind = edit_start + ind;
+  }
+  qsort(ref_arr, ref_cnt, sizeof(t_edit_ref), _editlog_ref_cmp);
+
+  // Rebuild the dictionaries in the order of their first edit
+  for (t_int32 first = edit_start; first < log->edit_cnt; first++) {
+
+    t_dictionary* dict = log->edit_arr[first].dict;
+    if (!dict) { continue; }    // Already applied with a previous edit of the dictionary
+
+    t_edit_rebuild rb;
+    rb.dict = dict;
+    rb.ref_arr = ref_arr;
+    rb.ref_lo = _editlog_ref_find(ref_arr, 0, ref_cnt, dict, NULL);
+    rb.ref_hi = rb.ref_lo;
+    while ((rb.ref_hi < ref_cnt) && (ref_arr[rb.ref_hi].dict == dict)) { rb.ref_hi++; }
+
+    rb.key_cnt = 0;
+    rb.key_arr = NULL;
+    dictionary_getkeys(dict, &rb.key_cnt, &rb.key_arr);
+
+    // Find the first edited key
+    t_int32 ind = 0;
+    while ((ind < rb.key_cnt) && !_editlog_edit_of(log, &rb, rb.key_arr[ind])) { ind++; }
+
+    // Rebuild the dictionary from there
+    rb.key_ini = ind;
+    rb.del_cnt = 0;
+    rb.ini_del = 0;
+    for ( ; ind < rb.key_cnt; ind++) {
+
+      t_symbol* key = rb.key_arr[ind];
+      if (!key) { rb.del_cnt++; continue; }    // Overwritten by a renaming
+
+      t_edit* edit = _editlog_edit_of(log, &rb, key);
+      rb.key_ind = ind;
+
+      if (edit) {
+        _editlog_apply_edit(log, edit, &rb);
+        edit->dict = NULL;
+      }
+
+      else {
+        dictionary_getatom(dict, key, value);
+        dictionary_chuckentry(dict, key);
+        _editlog_append(dict, key, value);
+      }
+    }
+
+    // The other edits of the dictionary are dropped, with their values
+    for (t_int32 ref = rb.ref_lo; ref < rb.ref_hi; ref++) {
+      t_edit* edit = log->edit_arr + ref_arr[ref].ind;
+      if (!edit->dict) { continue; }
+      if ((edit->value.a_type == A_OBJ) && atom_getobj(&edit->value)) { object_free(atom_getobj(&edit->value)); }
+      edit->dict = NULL;
+      log->drop_cnt++;
+    }
+
+    if (rb.key_arr) { dictionary_freekeys(dict, rb.key_cnt, rb.key_arr); }
+    log->dict_cnt++;
+  }
+
+  sysmem_freeptr(ref_arr);
+  log->edit_cnt = edit_start;
+}
@@ -0,0 +1,61 @@
+#ifndef YC_EDITLOG_H_
+#define YC_EDITLOG_H_
+
+// ========  HEADER FILE FOR THE DEFERRED EDIT LOG  ========
+
+#include "ext.h"        // header file for all objects, should always be first
+#include "ext_obex.h"   // header file for all objects, required for new style Max object
+#include "z_dsp.h"      // header file for MSP objects, included here for t_double type
+
+#include "ext_dictionary.h"
+
+#include "regexpr.h"
+#include "journal.h"
+
+// ========  STRUCTURES  ========
+
+//******************************************************************************
+//  One deferred edit of a dictionary entry
+//
+typedef struct _edit {
+
+  t_dictionary* dict;       // The dictionary holding the entry, NULL once applied
+  t_symbol*     key;        // The key of the entry
+  t_symbol*     key_new;    // The new key, or NULL to keep it
+  t_atom        value;      // The new value, or A_NOTHING to keep it
+  t_bool        is_del;     // Whether the entry is deleted
+
+} t_edit;
+
+//******************************************************************************
+//  Log of the edits collected during a traversal, in any order.
+//
+typedef struct _editlog {
+
+  t_edit* edit_arr;
+  t_int32 edit_cnt;
+  t_int32 edit_max;
+
+  t_int32 dict_cnt;         // The number of dictionaries rebuilt, for verbose output
+  t_int32 drop_cnt;         // The number of edits dropped, their key being missing or already edited
+
+  t_journal* journal;       // The journal recording the prior state of the edited entries, or NULL
+
+} t_editlog;
+
+// ========  FUNCTION DECLARATIONS  ========
+
+t_editlog* editlog_new   ();
+void       editlog_free  (t_editlog* log);
+void       editlog_clear (t_editlog* log);
+void       editlog_discard (t_editlog* log);
+
+t_my_err editlog_delete (t_editlog* log, t_dictionary* dict, t_symbol* key);
+t_my_err editlog_rename (t_editlog* log, t_dictionary* dict, t_symbol* key, t_symbol* key_new);
+t_my_err editlog_set    (t_editlog* log, t_dictionary* dict, t_symbol* key, t_symbol* key_new, t_atom* value);
+
+void editlog_apply (t_editlog* log, t_int32 edit_start);
+
+// ========  END OF HEADER FILE  ========
+
+#endif
@@ -0,0 +1,273 @@
+#include "journal.h"
+
+// Undoing a command by keeping a copy of the dictionary costs the size of
+// the dictionary for each command. Instead only the prior state of each
+// edited entry is recorded: its position, its previous key and its previous
+// value, which the journal owns until the edit is undone or forgotten.
+// Undoing replays the records of the last command in reverse, each one
+// restoring the state the next one was recorded in.
+
+// ====  JOURNAL  ====
+
+//******************************************************************************
+//  Create and allocate a new, empty, journal.
+//
+//  @return A pointer to the newly allocated structure, or NULL on failure.
+//
+t_journal* journal_new() {
+
+  t_journal* journal = (t_journal*)sysmem_newptr(sizeof(t_journal));
+  if (!journal) { return NULL; }
+
+  journal->rec_arr = NULL;
+  journal->rec_cnt = 0;
+  journal->rec_max = 0;
+
+  journal->mark_arr = NULL;
+  journal->mark_cnt = 0;
+  journal->mark_max = 0;
+
+  journal->cmd_cnt = 0;
+  journal->cmd_sym = gensym("");
+  journal->cmd_rec_ini = 0;
+  journal->err = ERR_NONE;
+
+  return journal;
+}
+
+//******************************************************************************
+//  Free a journal, with the values it owns.
+//
+//  @param journal A pointer to the journal.
+//
+//  Note: No need to check if the pointer argument is NULL.
+//
+void journal_free(t_journal* journal) {
+
+  if (!journal) { return; }
+
+  journal_clear(journal);
+  if (journal->rec_arr) { sysmem_freeptr(journal->rec_arr); }
+  if (journal->mark_arr) { sysmem_freeptr(journal->mark_arr); }
+  sysmem_freeptr(journal);
+}
+
+//******************************************************************************
+//  Forget all the records, freeing the values the journal owns.
+//  The owner has to detach from the dictionaries of the marks first.
+//
+//  @param journal A pointer to the journal.
+//
+void journal_clear(t_journal* journal) {
+
+  for (t_int32 ind = 0; ind < journal->rec_cnt; ind++) {
+    t_atom* value = &journal->rec_arr[ind].value;
+    if ((value->a_type == A_OBJ) && atom_getobj(value)) { object_free(atom_getobj(value)); }
+  }
+
+  journal->rec_cnt = 0;
+  journal->mark_cnt = 0;
+  journal->err = ERR_NONE;
+}
+
+//******************************************************************************
+//  Start recording a new command.
+//
+void journal_begin(t_journal* journal, t_symbol* cmd_sym) {
+
+  journal->cmd_cnt++;
+  journal->cmd_sym = cmd_sym;
+  journal->cmd_rec_ini = journal->rec_cnt;
+}
+
+//******************************************************************************
+//  Mark the start of the records of a root dictionary for the current command.
+//
+//  @return A pointer to the mark, valid until the next mark, or NULL on failure.
+//
+t_journal_mark* journal_mark(t_journal* journal, t_symbol* dict_sym) {
+
+  // Grow the array if it is full
+  if (journal->mark_cnt == journal->mark_max) {
+
+    t_int32 mark_max = journal->mark_max ? 2 * journal->mark_max : 16;
+    t_journal_mark* mark_arr = journal->mark_arr
+      ? (t_journal_mark*)sysmem_resizeptr(journal->mark_arr, mark_max * sizeof(t_journal_mark))
+      : (t_journal_mark*)sysmem_newptr(mark_max * sizeof(t_journal_mark));
+    if (!mark_arr) { journal->err = ERR_ALLOC; return NULL; }
+
+    journal->mark_arr = mark_arr;
+    journal->mark_max = mark_max;
+  }
+
+  t_journal_mark* mark = journal->mark_arr + journal->mark_cnt++;
+  mark->rec_ini = journal->rec_cnt;
+  mark->cmd_ind = journal->cmd_cnt;
+  mark->cmd_sym = journal->cmd_sym;
+  mark->dict_sym = dict_sym;
+  mark->dict = NULL;
+  mark->is_stale = false;
+
+  return mark;
+}
+
+//******************************************************************************
+//  Record the prior state of an edited entry or array value.
+//
+//  @param container The dictionary or atomarray, as it is after the previous edits.
+//  @param key The key before the edit, for the dictionary entries.
+//  @param key_new The key after the edit, for the dictionary entries.
+//  @param value The value before the edit, owned by the journal on success, or NULL.
+//  @param pos The position of the entry or value before the edit.
+//
+//  @return ERR_NONE or ERR_ALLOC, in which case the journal can not undo the command anymore.
+//
+t_my_err journal_add(t_journal* journal, t_journal_op op, t_object* container,
+    t_symbol* key, t_symbol* key_new, t_atom* value, t_int32 pos) {
+
+  // Grow the array if it is full
+  if (journal->rec_cnt == journal->rec_max) {
+
+    t_int32 rec_max = journal->rec_max ? 2 * journal->rec_max : 64;
+    t_journal_rec* rec_arr = journal->rec_arr
+      ? (t_journal_rec*)sysmem_resizeptr(journal->rec_arr, rec_max * sizeof(t_journal_rec))
+      : (t_journal_rec*)sysmem_newptr(rec_max * sizeof(t_journal_rec));
+    if (!rec_arr) { journal->err = ERR_ALLOC; return ERR_ALLOC; }
+
+    journal->rec_arr = rec_arr;
+    journal->rec_max = rec_max;
+  }
+
+  t_journal_rec* rec = journal->rec_arr + journal->rec_cnt++;
+  rec->op = op;
+  rec->pos = pos;
+  rec->container = container;
+  rec->key = key;
+  rec->key_new = key_new;
+  if (value) { rec->value = *value; }
+  else { rec->value.a_type = A_NOTHING; }
+
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  Move an entry of a dictionary to a given position, by re-appending the entries after it.
+//
+void journal_move(t_dictionary* dict, t_symbol* key, t_int32 pos) {
+
+  t_atom value[1];
+  long key_cnt = 0;
+  t_symbol** key_arr = NULL;
+  dictionary_getkeys(dict, &key_cnt, &key_arr);
+
+  for (t_int32 ind = pos; ind < key_cnt; ind++) {
+    if (key_arr[ind] == key) { continue; }
+    dictionary_getatom(dict, key_arr[ind], value);
+    dictionary_chuckentry(dict, key_arr[ind]);
+    if (atomisdictionary(value)) { dictionary_appenddictionary(dict, key_arr[ind], atom_getobj(value)); }
+    else { dictionary_appendatom(dict, key_arr[ind], value); }
+  }
+
+  if (key_arr) { dictionary_freekeys(dict, key_cnt, key_arr); }
+}
+
+//******************************************************************************
+//  Insert an entry in a dictionary at a given position.
+//
+static void _journal_insert(t_dictionary* dict, t_symbol* key, t_atom* value, t_int32 pos) {
+
+  if (atomisdictionary(value)) { dictionary_appenddictionary(dict, key, atom_getobj(value)); }
+  else if (atomisatomarray(value)) { dictionary_appendatomarray(dict, key, atom_getobj(value)); }
+  else { dictionary_appendatom(dict, key, value); }
+
+  journal_move(dict, key, pos);
+}
+
+//******************************************************************************
+//  Restore the prior state of one record, giving its value back to the container.
+//
+static void _journal_undo_rec(t_journal_rec* rec) {
+
+  t_atom value[1];
+  t_dictionary* dict = (t_dictionary*)rec->container;
+  t_atomarray* atomarray = (t_atomarray*)rec->container;
+
+  switch (rec->op) {
+
+  case JOURNAL_SET:
+    dictionary_deleteentry(dict, rec->key_new);
+    _journal_insert(dict, rec->key, &rec->value, rec->pos);
+    break;
+
+  case JOURNAL_RENAME:
+    dictionary_getatom(dict, rec->key_new, value);
+    dictionary_chuckentry(dict, rec->key_new);
+    _journal_insert(dict, rec->key, value, rec->pos);
+    break;
+
+  case JOURNAL_DELETE:
+    _journal_insert(dict, rec->key, &rec->value, rec->pos);
+    break;
+
+  case JOURNAL_ADD:
+    dictionary_deleteentry(dict, rec->key_new);
+    break;
+
+  case JOURNAL_ARRAY_SET: {
+    long atom_cnt = 0;
+    t_atom* atom_arr = NULL;
+    atomarray_getatoms(atomarray, &atom_cnt, &atom_arr);
+    if (rec->pos >= atom_cnt) { break; }
+
+    // Free the new value if it is an object, e.g. a replacing dictionary
+    t_atom* current = atom_arr + rec->pos;
+    if ((current->a_type == A_OBJ) && atom_getobj(current)
+      && !((rec->value.a_type == A_OBJ) && (atom_getobj(&rec->value) == atom_getobj(current)))) {
+      object_free(atom_getobj(current)); }
+    *current = rec->value;
+    break; }
+
+  case JOURNAL_ARRAY_DELETE: {
+    atomarray_appendatom(atomarray, &rec->value);
+    long atom_cnt = 0;
+    t_atom* atom_arr = NULL;
+    atomarray_getatoms(atomarray, &atom_cnt, &atom_arr);
+    if (rec->pos >= atom_cnt - 1) { break; }
+    memmove(atom_arr + rec->pos + 1, atom_arr + rec->pos, (atom_cnt - 1 - rec->pos) * sizeof(t_atom));
+    atom_arr[rec->pos] = rec->value;
+    break; }
+
+  default: break;
+  }
+
+  rec->value.a_type = A_NOTHING;
+}
+
+//******************************************************************************
+//  Undo the last command recorded, replaying its records in reverse.
+//  The marks of the command are dropped, the owner checks them and detaches first.
+//
+//  @return The number of edits undone, or -1 if there is no command to undo.
+//
+t_int32 journal_undo(t_journal* journal) {
+
+  t_journal_mark* mark = journal_last(journal);
+  if (!mark) { return -1; }
+
+  // Find the first mark of the command
+  t_int32 cmd_ind = mark->cmd_ind;
+  t_int32 mark_ind = journal->mark_cnt - 1;
+  while ((mark_ind > 0) && (journal->mark_arr[mark_ind - 1].cmd_ind == cmd_ind)) { mark_ind--; }
+
+  t_int32 rec_ini = journal->mark_arr[mark_ind].rec_ini;
+  t_int32 undo_cnt = journal->rec_cnt - rec_ini;
+
+  for (t_int32 ind = journal->rec_cnt - 1; ind >= rec_ini; ind--) {
+    _journal_undo_rec(journal->rec_arr + ind);
+  }
+
+  journal->rec_cnt = rec_ini;
+  journal->mark_cnt = mark_ind;
+
+  return undo_cnt;
+}
@@ -0,0 +1,97 @@
+#ifndef YC_JOURNAL_H_
+#define YC_JOURNAL_H_
+
+// ========  HEADER FILE FOR THE UNDO JOURNAL  ========
+
+#include "ext.h"        // header file for all objects, should always be first
+#include "ext_obex.h"   // header file for all objects, required for new style Max object
+#include "z_dsp.h"      // header file for MSP objects, included here for t_double type
+
+#include "ext_dictionary.h"
+
+#include "regexpr.h"
+
+// ========  STRUCTURES  ========
+
+//******************************************************************************
+//  The different edits recorded
+//
+typedef enum _journal_op {
+
+  JOURNAL_SET,            // The value of a dictionary entry was replaced, and optionally its key
+  JOURNAL_RENAME,         // The key of a dictionary entry was replaced
+  JOURNAL_DELETE,         // A dictionary entry was deleted
+  JOURNAL_ADD,            // A dictionary entry was added
+  JOURNAL_ARRAY_SET,      // An array value was replaced
+  JOURNAL_ARRAY_DELETE    // An array value was deleted
+
+} t_journal_op;
+
+//******************************************************************************
+//  The prior state of one edited entry or array value
+//
+typedef struct _journal_rec {
+
+  t_uint8   op;           // From t_journal_op
+  t_int32   pos;          // The position of the entry or value before the edit
+  t_object* container;    // The dictionary or atomarray
+  t_symbol* key;          // The key before the edit
+  t_symbol* key_new;      // The key after the edit, for the dictionary entries
+  t_atom    value;        // The value before the edit, owned by the journal, or A_NOTHING
+
+} t_journal_rec;
+
+//******************************************************************************
+//  The start of the records of one root dictionary, for one command
+//
+typedef struct _journal_mark {
+
+  t_int32       rec_ini;
+  t_int32       cmd_ind;    // The command, a multi-dictionary command having several marks
+  t_symbol*     cmd_sym;
+  t_symbol*     dict_sym;
+  t_dictionary* dict;       // The dictionary the owner is attached to, or NULL once freed
+  t_bool        is_stale;   // Set when the dictionary is modified by another object
+
+} t_journal_mark;
+
+//******************************************************************************
+//  Journal of the edits of the last commands, replayed in reverse to undo them.
+//  Its size follows the number of edits, not the size of the dictionaries.
+//
+typedef struct _journal {
+
+  t_journal_rec* rec_arr;
+  t_int32        rec_cnt;
+  t_int32        rec_max;
+
+  t_journal_mark* mark_arr;
+  t_int32         mark_cnt;
+  t_int32         mark_max;
+
+  t_int32   cmd_cnt;        // The number of commands recorded
+  t_symbol* cmd_sym;        // The command being recorded
+  t_int32   cmd_rec_ini;    // The first record of the command being recorded
+  t_my_err  err;            // Set when an edit could not be recorded
+
+} t_journal;
+
+// ========  FUNCTION DECLARATIONS  ========
+
+t_journal* journal_new   ();
+void       journal_free  (t_journal* journal);
+void       journal_clear (t_journal* journal);
+
+void            journal_begin (t_journal* journal, t_symbol* cmd_sym);
+t_journal_mark* journal_mark  (t_journal* journal, t_symbol* dict_sym);
+t_my_err        journal_add   (t_journal* journal, t_journal_op op, t_object* container,
+  t_symbol* key, t_symbol* key_new, t_atom* value, t_int32 pos);
+
+t_int32 journal_undo (t_journal* journal);
+void    journal_move (t_dictionary* dict, t_symbol* key, t_int32 pos);
+
+#define journal_last(_journal) ((_journal)->mark_cnt ? (_journal)->mark_arr + (_journal)->mark_cnt - 1 : NULL)
+
+// ========  END OF HEADER FILE  ========
+
+#endif
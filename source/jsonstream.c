@@ -0,0 +1,697 @@
+#include "jsonstream.h"
+
+// Searching a JSON file through a t_dictionary means holding the whole tree
+// in memory, with one symbol per key and string. Instead the file is read
+// in fixed size chunks and tokenized as it is read, keeping only the open
+// objects and arrays and the current token. Everything around the value
+// tokens, whitespace, commas and closing brackets, is copied to the output
+// as it is read, so that an unchanged file is copied byte for byte.
+
+// ========  ENUM  ========
+
+//******************************************************************************
+//  What the grammar expects next
+//
+typedef enum _json_state {
+
+  STATE_ROOT,         // The root value
+  STATE_KEY_FIRST,    // A key, or the end of an empty object
+  STATE_KEY,          // A key, after a comma
+  STATE_ELEM_FIRST,   // A value, or the end of an empty array
+  STATE_ELEM,         // A value, after a comma
+  STATE_NEXT,         // A comma, or the end of the object or array
+  STATE_DONE          // The end of the file
+
+} t_json_state;
+
+// ====  JSON_STR  ====
+
+//******************************************************************************
+//  Allocate a growable string, empty.
+//
+static t_bool _json_str_init(t_json_str* str) {
+
+  str->s = (char*)sysmem_newptr(64);
+  str->len = 0;
+  str->max = str->s ? 64 : 0;
+  if (str->s) { str->s[0] = '\0'; }
+
+  return (str->s != NULL);
+}
+
+//******************************************************************************
+//  Append characters to a growable string, keeping it null terminated.
+//
+static t_bool _json_str_add(t_jsonstream* js, t_json_str* str, const char* s, t_int32 len) {
+
+  if (str->len + len + 1 > str->max) {
+
+    t_int32 max = MAX(2 * str->max, str->len + len + 1);
+    char* s_new = (char*)sysmem_resizeptr(str->s, max);
+    if (!s_new) {
+      js->err = ERR_ALLOC;
+      strncpy_zero(js->err_s, "Allocation error.", JSONSTREAM_ERR_LEN);
+      return false;
+    }
+
+    str->s = s_new;
+    str->max = max;
+  }
+
+  memcpy(str->s + str->len, s, len);
+  str->len += len;
+  str->s[str->len] = '\0';
+
+  return true;
+}
+
+static t_bool _json_str_char(t_jsonstream* js, t_json_str* str, char c) {
+
+  if (str->len + 2 > str->max) { return _json_str_add(js, str, &c, 1); }
+
+  str->s[str->len++] = c;
+  str->s[str->len] = '\0';
+
+  return true;
+}
+
+#define _json_str_clear(_str) do { (_str)->len = 0; (_str)->s[0] = '\0'; } while (0)
+
+//******************************************************************************
+//  Append a code point encoded in UTF-8.
+//
+static t_bool _json_str_utf8(t_jsonstream* js, t_json_str* str, t_uint32 code) {
+
+  char utf8[4];
+  t_int32 len;
+
+  if (code < 0x80) { utf8[0] = (char)code; len = 1; }
+  else if (code < 0x800) {
+    utf8[0] = (char)(0xC0 | (code >> 6));
+    utf8[1] = (char)(0x80 | (code & 0x3F));
+    len = 2;
+  }
+  else if (code < 0x10000) {
+    utf8[0] = (char)(0xE0 | (code >> 12));
+    utf8[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+    utf8[2] = (char)(0x80 | (code & 0x3F));
+    len = 3;
+  }
+  else {
+    utf8[0] = (char)(0xF0 | (code >> 18));
+    utf8[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+    utf8[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+    utf8[3] = (char)(0x80 | (code & 0x3F));
+    len = 4;
+  }
+
+  return _json_str_add(js, str, utf8, len);
+}
+
+//******************************************************************************
+//  Append a string as a JSON string, quoted and escaped.
+//
+static t_bool _json_str_quote(t_jsonstream* js, t_json_str* str, const char* s) {
+
+  char esc[8];
+  t_bool is_ok = _json_str_char(js, str, '"');
+
+  for (const unsigned char* c = (const unsigned char*)s; *c && is_ok; c++) {
+    switch (*c) {
+    case '"': is_ok = _json_str_add(js, str, "\\\"", 2); break;
+    case '\\': is_ok = _json_str_add(js, str, "\\\\", 2); break;
+    case '\n': is_ok = _json_str_add(js, str, "\\n", 2); break;
+    case '\r': is_ok = _json_str_add(js, str, "\\r", 2); break;
+    case '\t': is_ok = _json_str_add(js, str, "\\t", 2); break;
+    default:
+      if (*c < 0x20) {
+        snprintf_zero(esc, 8, "\\u%04x", *c);
+        is_ok = _json_str_add(js, str, esc, 6);
+      }
+      else { is_ok = _json_str_char(js, str, (char)*c); }
+      break;
+    }
+  }
+
+  return is_ok && _json_str_char(js, str, '"');
+}
+
+// ====  JSONSTREAM  ====
+
+//******************************************************************************
+//  Create a tokenizer over a JSON file, positioned before its root value.
+//
+//  @param in_file The JSON file, open for reading.
+//  @param out_file The file to copy it to, with the replacements, or NULL.
+//  @param root_s The name of the root, the first segment of the paths.
+//
+//  @return A pointer to the newly allocated structure, or NULL on failure,
+//    in which case the files are left open. Otherwise they are closed by
+//    jsonstream_close() or jsonstream_free().
+//
+t_jsonstream* jsonstream_new(t_filehandle in_file, t_filehandle out_file, const char* root_s) {
+
+  t_jsonstream* js = (t_jsonstream*)sysmem_newptr(sizeof(t_jsonstream));
+  if (!js) { return NULL; }
+
+  js->in_file = in_file;
+  js->in_left = 0;
+  js->in_len = 0;
+  js->in_pos = 0;
+  js->in_ofs = 0;
+  js->line = 1;
+  sysfile_geteof(in_file, &js->in_left);
+
+  js->out_file = out_file;
+  js->out_len = 0;
+
+  js->frame_cnt = 0;
+  js->frame_max = 16;
+  js->state = STATE_ROOT;
+
+  js->token = JSON_EOF;
+  js->has_key = false;
+  js->index = 0;
+  js->level = -1;
+  js->depth = 0;
+  js->is_pending = false;
+
+  js->err = ERR_NONE;
+  js->err_s[0] = '\0';
+
+  js->in_buf = (char*)sysmem_newptr(JSONSTREAM_BUF_LEN);
+  js->out_buf = out_file ? (char*)sysmem_newptr(JSONSTREAM_BUF_LEN) : NULL;
+  js->frame_arr = (t_json_frame*)sysmem_newptr(js->frame_max * sizeof(t_json_frame));
+
+  t_bool is_ok = js->in_buf && (js->out_buf || !out_file) && js->frame_arr;
+  is_ok = _json_str_init(&js->path) && is_ok;
+  is_ok = _json_str_init(&js->key) && is_ok;
+  is_ok = _json_str_init(&js->key_raw) && is_ok;
+  is_ok = _json_str_init(&js->sep) && is_ok;
+  is_ok = _json_str_init(&js->value) && is_ok;
+  is_ok = _json_str_init(&js->value_raw) && is_ok;
+  is_ok = _json_str_init(&js->quote) && is_ok;
+  is_ok = is_ok && _json_str_add(js, &js->path, root_s, (t_int32)strlen(root_s));
+  js->root_len = js->path.len;
+
+  if (!is_ok) {
+    js->in_file = NULL;
+    js->out_file = NULL;
+    jsonstream_free(js);
+    return NULL;
+  }
+
+  return js;
+}
+
+//******************************************************************************
+//  Free a tokenizer, closing its files if jsonstream_close() was not called.
+//
+//  Note: No need to check if the pointer argument is NULL.
+//
+void jsonstream_free(t_jsonstream* js) {
+
+  if (!js) { return; }
+
+  jsonstream_close(js);
+
+  if (js->in_buf) { sysmem_freeptr(js->in_buf); }
+  if (js->out_buf) { sysmem_freeptr(js->out_buf); }
+  if (js->frame_arr) { sysmem_freeptr(js->frame_arr); }
+
+  t_json_str* str_arr[] = { &js->path, &js->key, &js->key_raw, &js->sep, &js->value, &js->value_raw, &js->quote };
+  for (t_int32 ind = 0; ind < 7; ind++) {
+    if (str_arr[ind]->s) { sysmem_freeptr(str_arr[ind]->s); }
+  }
+
+  sysmem_freeptr(js);
+}
+
+// ====  JSONSTREAM INPUT AND OUTPUT  ====
+
+//******************************************************************************
+//  Set the error of the tokenizer, with the position it was found at.
+//
+static t_json_token _jsonstream_error(t_jsonstream* js, const char* msg_s) {
+
+  if (js->err == ERR_NONE) {
+    js->err = ERR_SYNTAX;
+    snprintf_zero(js->err_s, JSONSTREAM_ERR_LEN, "%s at line %i, byte %lld.",
+      msg_s, js->line, (long long)(js->in_ofs + js->in_pos));
+  }
+
+  js->token = JSON_ERROR;
+  return JSON_ERROR;
+}
+
+//******************************************************************************
+//  Write the output buffer to the output file.
+//
+static void _jsonstream_flush(t_jsonstream* js) {
+
+  if (!js->out_file || !js->out_len) { return; }
+
+  t_ptr_size count = js->out_len;
+  if ((sysfile_write(js->out_file, &count, js->out_buf) != MAX_ERR_NONE) || (count != (t_ptr_size)js->out_len)) {
+    if (js->err == ERR_NONE) { js->err = ERR_MISC; strncpy_zero(js->err_s, "Unable to write the output file.", JSONSTREAM_ERR_LEN); }
+  }
+
+  js->out_len = 0;
+}
+
+//******************************************************************************
+//  Copy characters to the output file, if any.
+//
+static void _jsonstream_write(t_jsonstream* js, const char* s, t_int32 len) {
+
+  if (!js->out_file) { return; }
+
+  if (js->out_len + len > JSONSTREAM_BUF_LEN) { _jsonstream_flush(js); }
+
+  // A string longer than the buffer is written directly
+  if (len > JSONSTREAM_BUF_LEN) {
+    t_ptr_size count = len;
+    if ((sysfile_write(js->out_file, &count, s) != MAX_ERR_NONE) || (count != (t_ptr_size)len)) {
+      if (js->err == ERR_NONE) { js->err = ERR_MISC; strncpy_zero(js->err_s, "Unable to write the output file.", JSONSTREAM_ERR_LEN); }
+    }
+    return;
+  }
+
+  memcpy(js->out_buf + js->out_len, s, len);
+  js->out_len += len;
+}
+
+static void _jsonstream_putc(t_jsonstream* js, char c) {
+
+  if (!js->out_file) { return; }
+  if (js->out_len == JSONSTREAM_BUF_LEN) { _jsonstream_flush(js); }
+  js->out_buf[js->out_len++] = c;
+}
+
+//******************************************************************************
+//  Look at the next character of the file, reading the next chunk if needed.
+//
+//  @return The character, or -1 at the end of the file.
+//
+static int _jsonstream_peek(t_jsonstream* js) {
+
+  if (js->in_pos < js->in_len) { return (unsigned char)js->in_buf[js->in_pos]; }
+  if (!js->in_left) { return -1; }
+
+  js->in_ofs += js->in_len;
+  js->in_pos = 0;
+
+  t_ptr_size count = MIN(js->in_left, (t_ptr_size)JSONSTREAM_BUF_LEN);
+  if ((sysfile_read(js->in_file, &count, js->in_buf) != MAX_ERR_NONE) || !count) {
+    js->in_len = 0;
+    js->in_left = 0;
+    if (js->err == ERR_NONE) { js->err = ERR_MISC; strncpy_zero(js->err_s, "Unable to read the file.", JSONSTREAM_ERR_LEN); }
+    return -1;
+  }
+
+  js->in_len = (t_int32)count;
+  js->in_left -= count;
+
+  return (unsigned char)js->in_buf[0];
+}
+
+static int _jsonstream_get(t_jsonstream* js) {
+
+  int c = _jsonstream_peek(js);
+  if (c < 0) { return c; }
+
+  js->in_pos++;
+  if (c == '\n') { js->line++; }
+  return c;
+}
+
+//******************************************************************************
+//  Skip whitespace, copying it to the output or to a string.
+//
+//  @return The next character, consumed, or -1 at the end of the file.
+//
+static int _jsonstream_skip(t_jsonstream* js, t_json_str* str) {
+
+  int c;
+
+  while (((c = _jsonstream_get(js)) == ' ') || (c == '\n') || (c == '\r') || (c == '\t')) {
+    if (str) { _json_str_char(js, str, (char)c); }
+    else { _jsonstream_putc(js, (char)c); }
+  }
+
+  return c;
+}
+
+// ====  JSONSTREAM TOKENS  ====
+
+//******************************************************************************
+//  Read 4 hexadecimal digits of a \u escape sequence.
+//
+//  @return The code unit, or -1 on failure.
+//
+static t_int32 _jsonstream_hex(t_jsonstream* js, t_json_str* raw) {
+
+  t_int32 code = 0;
+
+  for (t_int32 ind = 0; ind < 4; ind++) {
+    int c = _jsonstream_get(js);
+    if ((c >= '0') && (c <= '9')) { code = 16 * code + (c - '0'); }
+    else if ((c >= 'a') && (c <= 'f')) { code = 16 * code + (c - 'a' + 10); }
+    else if ((c >= 'A') && (c <= 'F')) { code = 16 * code + (c - 'A' + 10); }
+    else { return -1; }
+    _json_str_char(js, raw, (char)c);
+  }
+
+  return code;
+}
+
+//******************************************************************************
+//  Read a string after its opening quote.
+//
+//  @param raw The string as written, with the opening quote already in.
+//  @param dec The decoded string.
+//
+//  @return false on failure.
+//
+static t_bool _jsonstream_string(t_jsonstream* js, t_json_str* raw, t_json_str* dec) {
+
+  int c;
+
+  while ((c = _jsonstream_get(js)) != '"') {
+
+    if (c < 0) { _jsonstream_error(js, "Unterminated string"); return false; }
+    if (c < 0x20) { _jsonstream_error(js, "Control character in a string"); return false; }
+    _json_str_char(js, raw, (char)c);
+
+    if (c != '\\') { _json_str_char(js, dec, (char)c); continue; }
+
+    c = _jsonstream_get(js);
+    if (c < 0) { _jsonstream_error(js, "Unterminated string"); return false; }
+    _json_str_char(js, raw, (char)c);
+
+    switch (c) {
+    case '"': case '\\': case '/': _json_str_char(js, dec, (char)c); break;
+    case 'b': _json_str_char(js, dec, '\b'); break;
+    case 'f': _json_str_char(js, dec, '\f'); break;
+    case 'n': _json_str_char(js, dec, '\n'); break;
+    case 'r': _json_str_char(js, dec, '\r'); break;
+    case 't': _json_str_char(js, dec, '\t'); break;
+
+    case 'u': {
+      t_int32 code = _jsonstream_hex(js, raw);
+      if (code < 0) { _jsonstream_error(js, "Invalid \\u escape sequence"); return false; }
+
+      // A surrogate pair is written as two escape sequences
+      if ((code >= 0xD800) && (code < 0xDC00)) {
+        if ((_jsonstream_get(js) != '\\') || (_jsonstream_get(js) != 'u')) {
+          _jsonstream_error(js, "Invalid surrogate pair"); return false; }
+        _json_str_add(js, raw, "\\u", 2);
+
+        t_int32 low = _jsonstream_hex(js, raw);
+        if ((low < 0xDC00) || (low >= 0xE000)) { _jsonstream_error(js, "Invalid surrogate pair"); return false; }
+        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+      }
+
+      _json_str_utf8(js, dec, (t_uint32)code);
+      break; }
+
+    default: _jsonstream_error(js, "Invalid escape sequence"); return false;
+    }
+  }
+
+  _json_str_char(js, raw, '"');
+
+  return (js->err == ERR_NONE);
+}
+
+//******************************************************************************
+//  Read the remaining characters of a number or a literal, and check it.
+//
+static t_bool _jsonstream_scalar(t_jsonstream* js, t_bool is_number) {
+
+  int c;
+
+  while (((c = _jsonstream_peek(js)) >= 0)
+      && (is_number
+        ? (((c >= '0') && (c <= '9')) || (c == '.') || (c == 'e') || (c == 'E') || (c == '+') || (c == '-'))
+        : ((c >= 'a') && (c <= 'z')))) {
+    _json_str_char(js, &js->value, (char)_jsonstream_get(js));
+  }
+
+  if (is_number) {
+    char* end = NULL;
+    strtod(js->value.s, &end);
+    if (!end || *end || (js->value.s[js->value.len - 1] == '.')) { _jsonstream_error(js, "Invalid number"); return false; }
+  }
+  else if (strcmp(js->value.s, "true") && strcmp(js->value.s, "false") && strcmp(js->value.s, "null")) {
+    _jsonstream_error(js, "Invalid literal");
+    return false;
+  }
+
+  return _json_str_add(js, &js->value_raw, js->value.s, js->value.len);
+}
+
+//******************************************************************************
+//  Read a value, starting with a character already consumed. The path of the
+//  value is set, and for an object or an array, its frame is pushed.
+//
+static t_json_token _jsonstream_value(t_jsonstream* js, int c) {
+
+  t_json_frame* parent = js->frame_cnt ? js->frame_arr + js->frame_cnt - 1 : NULL;
+
+  // ==== Set the path of the value
+  js->level = js->frame_cnt - 1;
+  js->depth = parent ? parent->depth : 0;
+  js->path.len = parent ? parent->path_len : js->root_len;
+  js->path.s[js->path.len] = '\0';
+
+  if (parent && (parent->type == JSON_OBJECT)) {
+    _json_str_add(js, &js->path, "::", 2);
+    _json_str_add(js, &js->path, js->key.s, js->key.len);
+  }
+  else if (parent) {
+    char index_s[16];
+    js->index = parent->index;
+    snprintf_zero(index_s, 16, "[%i]", js->index);
+    _json_str_add(js, &js->path, index_s, (t_int32)strlen(index_s));
+  }
+  if (parent) { parent->index++; }
+
+  _json_str_clear(&js->value);
+  _json_str_clear(&js->value_raw);
+
+  // ==== Then read it
+  switch (c) {
+
+  case '{':
+  case '[': {
+    if (js->frame_cnt == js->frame_max) {
+      t_int32 frame_max = 2 * js->frame_max;
+      t_json_frame* frame_arr = (t_json_frame*)sysmem_resizeptr(js->frame_arr, frame_max * sizeof(t_json_frame));
+      if (!frame_arr) {
+        js->err = ERR_ALLOC;
+        strncpy_zero(js->err_s, "Allocation error.", JSONSTREAM_ERR_LEN);
+        return (js->token = JSON_ERROR);
+      }
+      js->frame_arr = frame_arr;
+      js->frame_max = frame_max;
+    }
+
+    t_json_frame* f = js->frame_arr + js->frame_cnt++;
+    f->type = (c == '{') ? JSON_OBJECT : JSON_ARRAY;
+    f->index = 0;
+    f->depth = js->depth + ((c == '{') ? 1 : 0);
+    f->path_len = js->path.len;
+    f->user = 0;
+
+    _json_str_char(js, &js->value_raw, (char)c);
+    js->state = (c == '{') ? STATE_KEY_FIRST : STATE_ELEM_FIRST;
+    js->token = (t_json_token)f->type;
+    break; }
+
+  case '"':
+    _json_str_char(js, &js->value_raw, '"');
+    if (!_jsonstream_string(js, &js->value_raw, &js->value)) { return JSON_ERROR; }
+    js->token = JSON_STRING;
+    break;
+
+  case '-': case '0': case '1': case '2': case '3': case '4':
+  case '5': case '6': case '7': case '8': case '9':
+    _json_str_char(js, &js->value, (char)c);
+    if (!_jsonstream_scalar(js, true)) { return JSON_ERROR; }
+    js->token = JSON_NUMBER;
+    break;
+
+  case 't': case 'f': case 'n':
+    _json_str_char(js, &js->value, (char)c);
+    if (!_jsonstream_scalar(js, false)) { return JSON_ERROR; }
+    js->token = JSON_LITERAL;
+    break;
+
+  default:
+    return _jsonstream_error(js, (c < 0) ? "Unexpected end of file" : "Expected a value");
+  }
+
+  if ((js->token != JSON_OBJECT) && (js->token != JSON_ARRAY)) {
+    js->state = js->frame_cnt ? STATE_NEXT : STATE_DONE;
+  }
+
+  if (js->err != ERR_NONE) { return (js->token = JSON_ERROR); }
+
+  js->is_pending = true;
+  return js->token;
+}
+
+//******************************************************************************
+//  Close the innermost object or array.
+//
+static t_json_token _jsonstream_end(t_jsonstream* js, int c) {
+
+  t_json_frame* f = js->frame_arr + js->frame_cnt - 1;
+  if ((c == '}') != (f->type == JSON_OBJECT)) { return _jsonstream_error(js, "Mismatched closing bracket"); }
+
+  _jsonstream_putc(js, (char)c);
+  js->frame_cnt--;
+  js->state = js->frame_cnt ? STATE_NEXT : STATE_DONE;
+  js->level = js->frame_cnt - 1;
+
+  return (js->token = JSON_END);
+}
+
+//******************************************************************************
+//  Read the next token, writing the previous one unchanged if jsonstream_emit()
+//  was not called for it.
+//
+//  @return The token, JSON_EOF after the root value, or JSON_ERROR.
+//
+t_json_token jsonstream_next(t_jsonstream* js) {
+
+  if (js->is_pending) { jsonstream_emit(js, NULL, NULL); }
+  if (js->err != ERR_NONE) { return (js->token = JSON_ERROR); }
+
+  while (true) {
+
+    int c = _jsonstream_skip(js, NULL);
+    if (js->err != ERR_NONE) { return (js->token = JSON_ERROR); }
+
+    switch (js->state) {
+
+    case STATE_ROOT:
+      js->has_key = false;
+      if (c < 0) { return _jsonstream_error(js, "Empty file"); }
+      return _jsonstream_value(js, c);
+
+    case STATE_DONE:
+      if (c >= 0) { return _jsonstream_error(js, "Unexpected character after the root value"); }
+      return (js->token = JSON_EOF);
+
+    case STATE_KEY_FIRST:
+      if (c == '}') { return _jsonstream_end(js, c); }
+      // fall through
+
+    case STATE_KEY:
+      if (c != '"') { return _jsonstream_error(js, (c < 0) ? "Unexpected end of file" : "Expected a key"); }
+
+      _json_str_clear(&js->key);
+      _json_str_clear(&js->key_raw);
+      _json_str_clear(&js->sep);
+      _json_str_char(js, &js->key_raw, '"');
+      if (!_jsonstream_string(js, &js->key_raw, &js->key)) { return JSON_ERROR; }
+
+      if (_jsonstream_skip(js, &js->sep) != ':') { return _jsonstream_error(js, "Expected ':'"); }
+      _json_str_char(js, &js->sep, ':');
+
+      js->has_key = true;
+      return _jsonstream_value(js, _jsonstream_skip(js, &js->sep));
+
+    case STATE_ELEM_FIRST:
+      if (c == ']') { return _jsonstream_end(js, c); }
+      // fall through
+
+    case STATE_ELEM:
+      js->has_key = false;
+      return _jsonstream_value(js, c);
+
+    case STATE_NEXT:
+      if ((c == '}') || (c == ']')) { return _jsonstream_end(js, c); }
+      if (c != ',') { return _jsonstream_error(js, (c < 0) ? "Unexpected end of file" : "Expected ',' or a closing bracket"); }
+
+      _jsonstream_putc(js, ',');
+      js->state = (js->frame_arr[js->frame_cnt - 1].type == JSON_OBJECT) ? STATE_KEY : STATE_ELEM;
+      break;
+
+    default: return _jsonstream_error(js, "Invalid state");
+    }
+  }
+}
+
+//******************************************************************************
+//  Write the current value token, with its key and value, or their replacements.
+//
+//  @param key_new The new key, unquoted, or NULL to keep the key.
+//  @param value_raw_new The new value as JSON text, e.g. from jsonstream_quote(),
+//    or NULL to keep the value. Objects and arrays can only be renamed.
+//
+//  @return ERR_NONE, or the error of the tokenizer.
+//
+t_my_err jsonstream_emit(t_jsonstream* js, const char* key_new, const char* value_raw_new) {
+
+  if (!js->is_pending) { return js->err; }
+  js->is_pending = false;
+
+  if (js->has_key) {
+    if (key_new) {
+      _json_str_clear(&js->key_raw);
+      _json_str_quote(js, &js->key_raw, key_new);
+    }
+    _jsonstream_write(js, js->key_raw.s, js->key_raw.len);
+    _jsonstream_write(js, js->sep.s, js->sep.len);
+  }
+
+  if (value_raw_new && (js->token != JSON_OBJECT) && (js->token != JSON_ARRAY)) {
+    _jsonstream_write(js, value_raw_new, (t_int32)strlen(value_raw_new));
+  }
+  else { _jsonstream_write(js, js->value_raw.s, js->value_raw.len); }
+
+  return js->err;
+}
+
+//******************************************************************************
+//  Quote and escape a string as JSON text.
+//
+//  @return The text, valid until the next call.
+//
+const char* jsonstream_quote(t_jsonstream* js, const char* str) {
+
+  _json_str_clear(&js->quote);
+  _json_str_quote(js, &js->quote, str);
+
+  return js->quote.s;
+}
+
+//******************************************************************************
+//  Convert the current number token to an int or float atom, as Max reads JSON.
+//
+void jsonstream_number(t_jsonstream* js, t_atom* value) {
+
+  if (strpbrk(js->value.s, ".eE")) { atom_setfloat(value, strtod(js->value.s, NULL)); }
+  else { atom_setlong(value, (t_atom_long)strtoll(js->value.s, NULL, 10)); }
+}
+
+//******************************************************************************
+//  Write the rest of the output and close the files.
+//
+//  @return ERR_NONE, or the error of the tokenizer.
+//
+t_my_err jsonstream_close(t_jsonstream* js) {
+
+  if (js->is_pending) { jsonstream_emit(js, NULL, NULL); }
+  _jsonstream_flush(js);
+
+  if (js->in_file) { sysfile_close(js->in_file); }
+  if (js->out_file) { sysfile_close(js->out_file); }
+  js->in_file = NULL;
+  js->out_file = NULL;
+
+  return js->err;
+}
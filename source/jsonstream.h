@@ -0,0 +1,123 @@
+#ifndef YC_JSONSTREAM_H_
+#define YC_JSONSTREAM_H_
+
+// ========  HEADER FILE FOR THE STREAMING JSON TOKENIZER  ========
+
+#include "ext.h"        // header file for all objects, should always be first
+#include "ext_obex.h"   // header file for all objects, required for new style Max object
+#include "z_dsp.h"      // header file for MSP objects, included here for t_double type
+
+#include "ext_path.h"
+#include "ext_sysfile.h"
+
+#include "regexpr.h"
+
+// ========  DEFINES  ========
+
+#define JSONSTREAM_BUF_LEN 65536  // Size of the input and output buffers
+#define JSONSTREAM_ERR_LEN 256    // Maximum length of the error message
+
+// ========  ENUM  ========
+
+//******************************************************************************
+//  The tokens returned by jsonstream_next()
+//
+typedef enum _json_token {
+
+  JSON_EOF,         // The end of the file, after the root value
+  JSON_ERROR,       // A syntax or file error, described in err_s
+  JSON_OBJECT,      // The opening of an object
+  JSON_ARRAY,       // The opening of an array
+  JSON_END,         // The closing of an object or array
+  JSON_STRING,
+  JSON_NUMBER,
+  JSON_LITERAL      // true, false or null
+
+} t_json_token;
+
+// ========  STRUCTURES  ========
+
+//******************************************************************************
+//  A growable string
+//
+typedef struct _json_str {
+
+  char*   s;
+  t_int32 len;
+  t_int32 max;
+
+} t_json_str;
+
+//******************************************************************************
+//  One open object or array
+//
+typedef struct _json_frame {
+
+  t_uint8  type;            // JSON_OBJECT or JSON_ARRAY
+  t_int32  index;           // The number of values read so far
+  t_int32  depth;           // The number of objects down to this one
+  t_int32  path_len;        // The length of the path of the object or array
+  t_uint32 user;            // Free for the owner, e.g. the state of a path selector
+
+} t_json_frame;
+
+//******************************************************************************
+//  Pull tokenizer over a JSON file, read in fixed size chunks, which copies
+//  the file to an output file as it goes. The characters of each value token
+//  are held until the next token, so that its key or value can be replaced.
+//
+typedef struct _jsonstream {
+
+  t_filehandle in_file;
+  t_ptr_size   in_left;     // The bytes of the file not read yet
+  char*        in_buf;
+  t_int32      in_len;
+  t_int32      in_pos;
+  t_int64      in_ofs;      // The offset of in_buf in the file, for the errors
+  t_int32      line;
+
+  t_filehandle out_file;    // The output file, or NULL
+  char*        out_buf;
+  t_int32      out_len;
+
+  t_json_frame* frame_arr;
+  t_int32       frame_cnt;
+  t_int32       frame_max;
+  t_uint8       state;      // What the grammar expects next, from t_json_state
+  t_int32       root_len;   // The length of the name of the root, the start of the paths
+
+  // The current token
+  t_json_token token;
+  t_bool       has_key;     // Whether the value is from an object entry
+  t_int32      index;       // The index of the value in its array
+  t_int32      level;       // The frame of the object or array holding the value, -1 for the root
+  t_int32      depth;       // The number of objects holding the value
+  t_bool       is_pending;  // Whether its characters are still to be written
+
+  t_json_str path;          // The path of the value:  name::presets::a::tracks[0]::gain
+  t_json_str key;           // The decoded key
+  t_json_str key_raw;       // The key as written, with its quotes
+  t_json_str sep;           // The characters between the key and the value
+  t_json_str value;         // The decoded string, or the text of a number or literal
+  t_json_str value_raw;     // The value as written, or the opening character of an object or array
+  t_json_str quote;         // Scratch string for jsonstream_quote()
+
+  t_my_err err;
+  char     err_s[JSONSTREAM_ERR_LEN];
+
+} t_jsonstream;
+
+// ========  FUNCTION DECLARATIONS  ========
+
+t_jsonstream* jsonstream_new   (t_filehandle in_file, t_filehandle out_file, const char* root_s);
+void          jsonstream_free  (t_jsonstream* js);
+t_my_err      jsonstream_close (t_jsonstream* js);
+
+t_json_token jsonstream_next   (t_jsonstream* js);
+t_my_err     jsonstream_emit   (t_jsonstream* js, const char* key_new, const char* value_raw_new);
+const char*  jsonstream_quote  (t_jsonstream* js, const char* str);
+void         jsonstream_number (t_jsonstream* js, t_atom* value);
+
+// ========  END OF HEADER FILE  ========
+
+#endif
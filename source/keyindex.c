@@ -0,0 +1,285 @@
+#include "keyindex.h"
+
+// The index is built with one walk of the dictionary tree, then serves
+// key searches without walking the tree again. It holds pointers to the
+// nested dictionaries, so it has to be invalidated whenever the tree changes.
+
+// ====  KEYINDEX  ====
+
+//******************************************************************************
+//  Create and allocate a new, invalid, key index.
+//
+//  @param dict_sym The name of the dictionary to index.
+//
+//  @return A pointer to the newly allocated structure, or NULL on failure.
+//
+t_keyindex* keyindex_new(t_symbol* dict_sym) {
+
+  t_keyindex* index = (t_keyindex*)sysmem_newptr(sizeof(t_keyindex));
+  if (!index) { return NULL; }
+
+  index->dict_sym = dict_sym;
+  index->dict = NULL;
+  index->dict_watched = NULL;
+  index->key_tab = hashtab_new(0);
+  index->key_arr = NULL;
+  index->occur_arr = NULL;
+  index->path_pool = NULL;
+  index->key_max = index->occur_max = index->pool_max = 0;
+
+  if (!index->key_tab) { sysmem_freeptr(index); return NULL; }
+
+  keyindex_invalidate(index);
+
+  return index;
+}
+
+//******************************************************************************
+//  Free a key index.
+//
+//  @param index A pointer to the key index.
+//
+//  Note: No need to check if the pointer argument is NULL.
+//
+void keyindex_free(t_keyindex* index) {
+
+  if (!index) { return; }
+
+  object_free(index->key_tab);
+  if (index->key_arr) { sysmem_freeptr(index->key_arr); }
+  if (index->occur_arr) { sysmem_freeptr(index->occur_arr); }
+  if (index->path_pool) { sysmem_freeptr(index->path_pool); }
+  sysmem_freeptr(index);
+}
+
+//******************************************************************************
+//  Invalidate a key index. The allocations are kept for the next build.
+//
+//  @param index A pointer to the key index.
+//
+void keyindex_invalidate(t_keyindex* index) {
+
+  index->dict = NULL;
+  hashtab_clear(index->key_tab);
+  index->key_cnt = 0;
+  index->occur_cnt = 0;
+  index->pool_len = 0;
+  index->exact_ind = -1;
+}
+
+//******************************************************************************
+//  Grow an array if it is full.
+//
+//  @return ERR_NONE or ERR_ALLOC.
+//
+static t_my_err _keyindex_grow(void** arr, t_int32* max, t_int32 cnt, t_int32 size) {
+
+  if (cnt < *max) { return ERR_NONE; }
+
+  t_int32 max_new = (*max) ? 2 * (*max) : 64;
+  void* arr_new = (*arr) ? sysmem_resizeptr(*arr, max_new * size) : sysmem_newptr(max_new * size);
+  if (!arr_new) { return ERR_ALLOC; }
+
+  *arr = arr_new;
+  *max = max_new;
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  Add an occurrence of a key to the index.
+//
+//  @param index A pointer to the key index.
+//  @param dict The dictionary holding the entry.
+//  @param key The key.
+//  @param path The path of the entry.
+//
+//  @return ERR_NONE or ERR_ALLOC.
+//
+static t_my_err _keyindex_add(t_keyindex* index, t_dictionary* dict, t_symbol* key, const char* path) {
+
+  t_atom_long key_ind = -1;
+  t_int32 path_len = (t_int32)strlen(path) + 1;
+
+  // Make room in the arrays
+  if ((_keyindex_grow((void**)&index->occur_arr, &index->occur_max, index->occur_cnt, sizeof(t_key_occur)) != ERR_NONE)
+      || (_keyindex_grow((void**)&index->key_arr, &index->key_max, index->key_cnt, sizeof(t_key_distinct)) != ERR_NONE)) {
+    return ERR_ALLOC;
+  }
+
+  while (index->pool_len + path_len > index->pool_max) {
+    if (_keyindex_grow((void**)&index->path_pool, &index->pool_max, index->pool_max, sizeof(char)) != ERR_NONE) {
+      return ERR_ALLOC;
+    }
+  }
+
+  // Get the distinct key, or create it
+  if (hashtab_lookuplong(index->key_tab, key, &key_ind) != MAX_ERR_NONE) {
+    key_ind = index->key_cnt++;
+    index->key_arr[key_ind].key = key;
+    index->key_arr[key_ind].first = -1;
+    index->key_arr[key_ind].last = -1;
+    index->key_arr[key_ind].is_match = false;
+    hashtab_storelong(index->key_tab, key, key_ind);
+  }
+
+  // Store the occurrence and link it to the previous one with the same key
+  t_int32 occur_ind = index->occur_cnt++;
+  t_key_occur* occur = index->occur_arr + occur_ind;
+  t_key_distinct* distinct = index->key_arr + key_ind;
+
+  occur->dict = dict;
+  occur->key_ind = (t_int32)key_ind;
+  occur->path_ofs = index->pool_len;
+  occur->next = -1;
+
+  if (distinct->last != -1) { index->occur_arr[distinct->last].next = occur_ind; }
+  else { distinct->first = occur_ind; }
+  distinct->last = occur_ind;
+
+  // Store the path
+  memcpy(index->path_pool + index->pool_len, path, path_len);
+  index->pool_len += path_len;
+
+  return ERR_NONE;
+}
+
+static t_my_err _keyindex_build_value (t_keyindex* index, t_atom* value, char* path, t_int32 path_len_max);
+
+//******************************************************************************
+//  Recursively index the entries of a dictionary.
+//
+static t_my_err _keyindex_build_dict(t_keyindex* index, t_dictionary* dict, char* path, t_int32 path_len_max) {
+
+  t_my_err err = ERR_NONE;
+  t_int32 path_len = (t_int32)strlen(path);
+  t_atom value[1];
+
+  long key_cnt = 0;
+  t_symbol** key_arr = NULL;
+  dictionary_getkeys(dict, &key_cnt, &key_arr);
+
+  for (t_int32 ind = 0; (ind < key_cnt) && (err == ERR_NONE); ind++) {
+
+    strncat_zero(path, PATH_SEP_S, path_len_max);
+    strncat_zero(path, key_arr[ind]->s_name, path_len_max);
+
+    err = _keyindex_add(index, dict, key_arr[ind], path);
+
+    if (err == ERR_NONE) {
+      dictionary_getatom(dict, key_arr[ind], value);
+      err = _keyindex_build_value(index, value, path, path_len_max);
+    }
+
+    path[path_len] = '\0';
+  }
+
+  if (key_arr) { dictionary_freekeys(dict, key_cnt, key_arr); }
+
+  return err;
+}
+
+//******************************************************************************
+//  Recursively index a value, if it is a dictionary or an array.
+//
+static t_my_err _keyindex_build_value(t_keyindex* index, t_atom* value, char* path, t_int32 path_len_max) {
+
+  t_my_err err = ERR_NONE;
+
+  if (atomisdictionary(value)) {
+    err = _keyindex_build_dict(index, (t_dictionary*)atom_getobj(value), path, path_len_max);
+  }
+
+  else if (atomisatomarray(value)) {
+
+    t_int32 path_len = (t_int32)strlen(path);
+    char str_tmp[16];
+    long array_len;
+    t_atom* atom_arr;
+    atomarray_getatoms((t_atomarray*)atom_getobj(value), &array_len, &atom_arr);
+
+    for (t_int32 ind = 0; (ind < array_len) && (err == ERR_NONE); ind++) {
+      snprintf_zero(str_tmp, 16, "[%i]", ind);
+      strncat_zero(path, str_tmp, path_len_max);
+      err = _keyindex_build_value(index, atom_arr + ind, path, path_len_max);
+      path[path_len] = '\0';
+    }
+  }
+
+  return err;
+}
+
+//******************************************************************************
+//  Build the index with one walk of the dictionary tree.
+//
+//  @param index A pointer to the key index.
+//  @param dict The dictionary registered under index->dict_sym.
+//  @param path_len_max The maximum length of a path.
+//
+//  @return ERR_NONE, or ERR_ALLOC in which case the index is invalid.
+//
+t_my_err keyindex_build(t_keyindex* index, t_dictionary* dict, t_int32 path_len_max) {
+
+  keyindex_invalidate(index);
+
+  char* path = (char*)sysmem_newptr(sizeof(char) * path_len_max);
+  if (!path) { return ERR_ALLOC; }
+
+  strncpy_zero(path, index->dict_sym->s_name, path_len_max);
+  t_my_err err = _keyindex_build_dict(index, dict, path, path_len_max);
+  sysmem_freeptr(path);
+
+  if (err != ERR_NONE) { keyindex_invalidate(index); return err; }
+
+  index->dict = dict;
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  Start a search for the occurrences of keys matching an expression.
+//
+//  An exact expression follows the linked list of its key. Otherwise each
+//  distinct key is matched once, and the occurrences are scanned in order.
+//
+//  @param index A pointer to a valid key index.
+//  @param expr The key expression.
+//
+//  @return The first matching occurrence, or -1 if there is none.
+//
+t_int32 keyindex_first(t_keyindex* index, t_regexpr* expr) {
+
+  t_atom_long key_ind = -1;
+
+  // Exact key: direct lookup
+  if (expr->match_fct == &_regexpr_match_reg) {
+    if (hashtab_lookuplong(index->key_tab, expr->search_frag_sym, &key_ind) != MAX_ERR_NONE) { return -1; }
+    index->exact_ind = (t_int32)key_ind;
+    return index->key_arr[key_ind].first;
+  }
+
+  // Otherwise match each distinct key once
+  index->exact_ind = -1;
+  for (t_int32 ind = 0; ind < index->key_cnt; ind++) {
+    index->key_arr[ind].is_match = regexpr_match(expr, index->key_arr[ind].key);
+  }
+
+  return keyindex_next(index, -1);
+}
+
+//******************************************************************************
+//  Get the next occurrence of a search started by keyindex_first().
+//
+//  @param index A pointer to a valid key index.
+//  @param occur_ind The current occurrence.
+//
+//  @return The next matching occurrence, or -1 if there is none.
+//
+t_int32 keyindex_next(t_keyindex* index, t_int32 occur_ind) {
+
+  if (index->exact_ind != -1) { return index->occur_arr[occur_ind].next; }
+
+  for (occur_ind++; occur_ind < index->occur_cnt; occur_ind++) {
+    if (index->key_arr[index->occur_arr[occur_ind].key_ind].is_match) { return occur_ind; }
+  }
+
+  return -1;
+}
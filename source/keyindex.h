@@ -0,0 +1,85 @@
+#ifndef YC_KEYINDEX_H_
+#define YC_KEYINDEX_H_
+
+// ========  HEADER FILE FOR THE INVERTED KEY INDEX  ========
+
+#include "ext.h"        // header file for all objects, should always be first
+#include "ext_obex.h"   // header file for all objects, required for new style Max object
+#include "z_dsp.h"      // header file for MSP objects, included here for t_double type
+
+#include "ext_dictionary.h"
+#include "ext_hashtab.h"
+
+#include "regexpr.h"
+#include "pathexpr.h"
+
+// ========  STRUCTURES  ========
+
+//******************************************************************************
+//  One occurrence of a key in the dictionary tree
+//
+typedef struct _key_occur {
+
+  t_dictionary* dict;     // The dictionary holding the entry
+  t_int32       key_ind;  // The index of the key in key_arr
+  t_int32       path_ofs; // The offset of the entry's path in path_pool
+  t_int32       next;     // The next occurrence of the same key, or -1
+
+} t_key_occur;
+
+//******************************************************************************
+//  One distinct key, with the linked list of its occurrences
+//
+typedef struct _key_distinct {
+
+  t_symbol* key;
+  t_int32   first;      // The first occurrence in occur_arr
+  t_int32   last;       // The last occurrence in occur_arr
+  t_bool    is_match;   // Set by keyindex_first() for the current search
+
+} t_key_distinct;
+
+//******************************************************************************
+//  Inverted index from keys to the paths where they occur, for one dictionary.
+//  Occurrences are stored in traversal order.
+//
+typedef struct _keyindex {
+
+  t_symbol*     dict_sym;   // The name of the indexed dictionary
+  t_dictionary* dict;       // The indexed dictionary, NULL when the index is invalid
+  t_dictionary* dict_watched; // The dictionary the owner is attached to, kept while the index is invalid
+
+  t_hashtab*      key_tab;  // Key symbol to index in key_arr
+  t_key_distinct* key_arr;
+  t_int32         key_cnt;
+  t_int32         key_max;
+
+  t_key_occur* occur_arr;
+  t_int32      occur_cnt;
+  t_int32      occur_max;
+
+  char*   path_pool;        // All the paths, separated by '\0'
+  t_int32 pool_len;
+  t_int32 pool_max;
+
+  t_int32 exact_ind;        // For an exact search, the matching key in key_arr, otherwise -1
+
+} t_keyindex;
+
+// ========  FUNCTION DECLARATIONS  ========
+
+t_keyindex* keyindex_new        (t_symbol* dict_sym);
+void        keyindex_free       (t_keyindex* index);
+void        keyindex_invalidate (t_keyindex* index);
+t_my_err    keyindex_build      (t_keyindex* index, t_dictionary* dict, t_int32 path_len_max);
+
+t_int32 keyindex_first (t_keyindex* index, t_regexpr* expr);
+t_int32 keyindex_next  (t_keyindex* index, t_int32 occur_ind);
+
+#define keyindex_is_valid(_index)           ((_index)->dict != NULL)
+#define keyindex_key(_index, _occur_ind)    ((_index)->key_arr[(_index)->occur_arr[_occur_ind].key_ind].key)
+#define keyindex_path(_index, _occur_ind)   ((_index)->path_pool + (_index)->occur_arr[_occur_ind].path_ofs)
+
+// ========  END OF HEADER FILE  ========
+
+#endif
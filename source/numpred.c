@@ -0,0 +1,89 @@
+#include "numpred.h"
+
+// A numeric predicate compares int and float values directly, without
+// formatting them into strings:
+//
+//   = 5            equal to 5, int or float
+//   range 0 10     between 0 and 10, included
+//   near 0.5 0.01  within 0.01 of 0.5
+//
+// All of them are stored as a closed interval, so that the scan of an array
+// is a single comparison per value.
+
+// ====  NUMPRED  ====
+
+//******************************************************************************
+//  Set a numeric predicate from a list of atoms.
+//
+//  @param pred A pointer to the predicate.
+//  @param argc The number of atoms available.
+//  @param argv The atoms, starting with the operator.
+//
+//  @return The number of atoms used, or 0 if the predicate is invalid.
+//
+t_int32 numpred_set(t_numpred* pred, long argc, t_atom* argv) {
+
+  if ((argc < 2) || (atom_gettype(argv) != A_SYM)) { return 0; }
+
+  t_symbol* op_sym = atom_getsym(argv);
+  for (t_int32 ind = 1; ind < MIN(argc, 3); ind++) {
+    if ((atom_gettype(argv + ind) != A_LONG) && (atom_gettype(argv + ind) != A_FLOAT)) { argc = ind; break; }
+  }
+
+  if (op_sym == gensym("=")) {
+    pred->lo = atom_getfloat(argv + 1);
+    pred->hi = pred->lo;
+    return 2;
+  }
+
+  if (argc < 3) { return 0; }
+
+  if (op_sym == gensym("range")) {
+    pred->lo = MIN(atom_getfloat(argv + 1), atom_getfloat(argv + 2));
+    pred->hi = MAX(atom_getfloat(argv + 1), atom_getfloat(argv + 2));
+    return 3;
+  }
+
+  if (op_sym == gensym("near")) {
+    t_double tol = atom_getfloat(argv + 2);
+    if (tol < 0) { tol = -tol; }
+    pred->lo = atom_getfloat(argv + 1) - tol;
+    pred->hi = atom_getfloat(argv + 1) + tol;
+    return 3;
+  }
+
+  return 0;
+}
+
+//******************************************************************************
+//  Test if an atom is a number satisfying the predicate.
+//
+t_bool numpred_match(t_numpred* pred, t_atom* atom) {
+
+  if (atom->a_type == A_LONG) { return numpred_test(pred, (t_double)atom->a_w.w_long); }
+  if (atom->a_type == A_FLOAT) { return numpred_test(pred, atom->a_w.w_float); }
+  return false;
+}
+
+//******************************************************************************
+//  Scan an array of atoms for the first value which is not a number failing
+//  the predicate: either a matching number, or a value of another type.
+//
+//  @param ind The index to start from.
+//  @param len The length of the array.
+//
+//  @return The index of the value found, or len if there is none.
+//
+long numpred_skip(t_numpred* pred, t_atom* atom_arr, long ind, long len) {
+
+  for ( ; ind < len; ind++) {
+
+    t_atom* atom = atom_arr + ind;
+
+    if (atom->a_type == A_LONG) { if (numpred_test(pred, (t_double)atom->a_w.w_long)) { break; } }
+    else if (atom->a_type == A_FLOAT) { if (numpred_test(pred, atom->a_w.w_float)) { break; } }
+    else { break; }
+  }
+
+  return ind;
+}
@@ -0,0 +1,35 @@
+#ifndef YC_NUMPRED_H_
+#define YC_NUMPRED_H_
+
+// ========  HEADER FILE FOR NUMERIC PREDICATES  ========
+
+#include "ext.h"        // header file for all objects, should always be first
+#include "ext_obex.h"   // header file for all objects, required for new style Max object
+#include "z_dsp.h"      // header file for MSP objects, included here for t_double type
+
+#include "regexpr.h"
+
+// ========  STRUCTURES  ========
+
+//******************************************************************************
+//  Numeric predicate, as a closed interval.
+//  Equality, ranges and tolerances all reduce to it.
+//
+typedef struct _numpred {
+
+  t_double lo;
+  t_double hi;
+
+} t_numpred;
+
+// ========  FUNCTION DECLARATIONS  ========
+
+t_int32 numpred_set   (t_numpred* pred, long argc, t_atom* argv);
+t_bool  numpred_match (t_numpred* pred, t_atom* atom);
+long    numpred_skip  (t_numpred* pred, t_atom* atom_arr, long ind, long len);
+
+#define numpred_test(_pred, _num)   (((_num) >= (_pred)->lo) && ((_num) <= (_pred)->hi))
+
+// ========  END OF HEADER FILE  ========
+
+#endif
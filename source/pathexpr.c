@@ -0,0 +1,266 @@
+#include "pathexpr.h"
+
+// A path selector is a dictionary path with wildcards, for instance:
+//
+//   presets::*::tracks[*]::gain
+//
+// Keys are separated by "::" and matched with the glob expressions of t_regexpr.
+// Array indexes are written [3] or [*], and "**" matches any number of levels.
+// The selector is compiled into a list of segments, simulated as an automaton
+// whose state is the bit field of active segments.
+
+// ====  PATHEXPR  ====
+
+//******************************************************************************
+//  Create and allocate a new path selector structure.
+//
+//  @return A pointer to the newly allocated structure, or NULL on failure.
+//
+t_pathexpr* pathexpr_new() {
+
+  t_pathexpr* pathexpr = (t_pathexpr*)sysmem_newptr(sizeof(t_pathexpr));
+  if (!pathexpr) { return NULL; }
+
+  for (t_int32 ind = 0; ind < PATH_SEG_MAX; ind++) {
+    pathexpr->seg_arr[ind].key_expr = NULL;
+  }
+
+  pathexpr_reset(pathexpr);
+
+  return pathexpr;
+}
+
+//******************************************************************************
+//  Free a path selector structure.
+//
+//  @param pathexpr A pointer to the path selector structure.
+//
+//  Note: No need to check if the pointer argument is NULL.
+//
+void pathexpr_free(t_pathexpr* pathexpr) {
+
+  if (!pathexpr) { return; }
+
+  pathexpr_reset(pathexpr);
+  sysmem_freeptr(pathexpr);
+}
+
+//******************************************************************************
+//  Reset a path selector structure to its unset state.
+//
+//  @param pathexpr A pointer to the path selector structure.
+//
+void pathexpr_reset(t_pathexpr* pathexpr) {
+
+  // Free the key expressions
+  for (t_int32 ind = 0; ind < PATH_SEG_MAX; ind++) {
+    if (pathexpr->seg_arr[ind].key_expr) {
+      regexpr_free(pathexpr->seg_arr[ind].key_expr);
+      pathexpr->seg_arr[ind].key_expr = NULL;
+    }
+  }
+
+  pathexpr->path_sym = gensym("");
+  pathexpr->seg_cnt = 0;
+  pathexpr->state_ini = 1;
+  pathexpr->accept = 1;
+}
+
+//******************************************************************************
+//  Add a segment to a path selector.
+//
+//  @param pathexpr A pointer to the path selector structure.
+//  @param type The segment type, from e_path_seg.
+//  @param index The array index for SEG_INDEX.
+//  @param key_s The key expression for SEG_KEY, otherwise NULL.
+//
+//  @return ERR_NONE, or ERR_ARR_FULL or ERR_ALLOC on failure.
+//
+static t_my_err _pathexpr_add_seg(t_pathexpr* pathexpr, e_path_seg type, t_int32 index, const char* key_s) {
+
+  if (pathexpr->seg_cnt == PATH_SEG_MAX) { return ERR_ARR_FULL; }
+
+  t_path_seg* seg = pathexpr->seg_arr + pathexpr->seg_cnt;
+  seg->type = type;
+  seg->index = index;
+
+  if (type == SEG_KEY) {
+    seg->key_expr = regexpr_new();
+    if (!seg->key_expr) { return ERR_ALLOC; }
+    if (regexpr_set(seg->key_expr, gensym(key_s)) != ERR_NONE) { return ERR_ALLOC; }
+  }
+
+  pathexpr->seg_cnt++;
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  Compile a path selector.
+//
+//  @param pathexpr A pointer to the path selector structure.
+//  @param path_s The selector, without the dictionary name.
+//
+//  @return ERR_NONE, or ERR_SYNTAX, ERR_STR_LEN, ERR_ARR_FULL or ERR_ALLOC.
+//    On failure the selector is reset.
+//
+t_my_err pathexpr_set(t_pathexpr* pathexpr, const char* path_s) {
+
+  char key_s[PATH_KEY_MAX];
+  const char* iter = path_s;
+  t_my_err err = ERR_NONE;
+
+  pathexpr_reset(pathexpr);
+
+  // Loop through the parts separated by "::"
+  while (*iter && (err == ERR_NONE)) {
+
+    // == The key: up to the first '[', or the next separator
+    t_int32 len = 0;
+    while (*iter && (*iter != '[') && strncmp(iter, PATH_SEP_S, 2)) {
+      if (len == PATH_KEY_MAX - 1) { err = ERR_STR_LEN; break; }
+      key_s[len++] = *iter++;
+    }
+    key_s[len] = '\0';
+
+    if (err != ERR_NONE) { break; }
+    else if (!strcmp(key_s, "**")) { err = _pathexpr_add_seg(pathexpr, SEG_ANY_DEPTH, 0, NULL); }
+    else if (len) { err = _pathexpr_add_seg(pathexpr, SEG_KEY, 0, key_s); }
+    else if (*iter != '[') { err = ERR_SYNTAX; }   // Empty part
+
+    // == The indexes: [3] or [*]
+    while ((*iter == '[') && (err == ERR_NONE)) {
+
+      iter++;
+      if ((iter[0] == '*') && (iter[1] == ']')) {
+        err = _pathexpr_add_seg(pathexpr, SEG_INDEX_ANY, 0, NULL);
+        iter += 2;
+      }
+
+      else if ((*iter >= '0') && (*iter <= '9')) {
+        t_int32 index = 0;
+        while ((*iter >= '0') && (*iter <= '9')) { index = 10 * index + (*iter++ - '0'); }
+        if (*iter++ != ']') { err = ERR_SYNTAX; break; }
+        err = _pathexpr_add_seg(pathexpr, SEG_INDEX, index, NULL);
+      }
+
+      else { err = ERR_SYNTAX; }
+    }
+
+    // == The separator, or the end of the selector
+    if (err != ERR_NONE) { break; }
+    else if (!strncmp(iter, PATH_SEP_S, 2)) {
+      iter += 2;
+      if (*iter == '\0') { err = ERR_SYNTAX; }   // Trailing separator
+    }
+    else if (*iter != '\0') { err = ERR_SYNTAX; }
+  }
+
+  if (err != ERR_NONE) { pathexpr_reset(pathexpr); return err; }
+
+  // Set the initial and accepting states
+  pathexpr->path_sym = gensym(path_s);
+  pathexpr->accept = (t_path_state)1 << pathexpr->seg_cnt;
+  pathexpr->state_ini = pathexpr_closure(pathexpr, 1);
+
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  Add to a state the segments reached without consuming a path element:
+//  "**" can match zero levels.
+//
+//  @param pathexpr A pointer to the path selector structure.
+//  @param state The set of active segments.
+//
+//  @return The closed set of active segments.
+//
+t_path_state pathexpr_closure(t_pathexpr* pathexpr, t_path_state state) {
+
+  for (t_int32 ind = 0; ind < pathexpr->seg_cnt; ind++) {
+    if ((state & ((t_path_state)1 << ind)) && (pathexpr->seg_arr[ind].type == SEG_ANY_DEPTH)) {
+      state |= (t_path_state)1 << (ind + 1);
+    }
+  }
+
+  return state;
+}
+
+//******************************************************************************
+//  Advance the automaton by one dictionary key, given as a symbol or as a string.
+//
+static t_path_state _pathexpr_step_key(t_pathexpr* pathexpr, t_path_state state, t_symbol* key, const char* key_s) {
+
+  t_path_state next = 0;
+  t_path_seg* seg = pathexpr->seg_arr;
+
+  for (t_int32 ind = 0; ind < pathexpr->seg_cnt; ind++, seg++) {
+
+    if (!(state & ((t_path_state)1 << ind))) { continue; }
+
+    switch (seg->type) {
+    case SEG_ANY_DEPTH: next |= (t_path_state)1 << ind; break;
+    case SEG_KEY:
+      if (key ? regexpr_match(seg->key_expr, key) : regexpr_match_str(seg->key_expr, key_s)) { next |= (t_path_state)1 << (ind + 1); }
+      break;
+    default: break;
+    }
+  }
+
+  return pathexpr_closure(pathexpr, next);
+}
+
+//******************************************************************************
+//  Advance the automaton by one dictionary key.
+//
+//  @param pathexpr A pointer to the path selector structure.
+//  @param state The set of active segments before the key.
+//  @param key The key.
+//
+//  @return The set of active segments after the key, 0 if no match is possible.
+//
+t_path_state pathexpr_step_key(t_pathexpr* pathexpr, t_path_state state, t_symbol* key) {
+
+  return _pathexpr_step_key(pathexpr, state, key, NULL);
+}
+
+//******************************************************************************
+//  Advance the automaton by one dictionary key which is not a symbol, e.g. a key
+//  read from a file, without adding it to the symbol table.
+//
+//  @param key_s The key, as a string.
+//
+//  @return The set of active segments after the key, 0 if no match is possible.
+//
+t_path_state pathexpr_step_key_str(t_pathexpr* pathexpr, t_path_state state, const char* key_s) {
+
+  return _pathexpr_step_key(pathexpr, state, NULL, key_s);
+}
+
+//******************************************************************************
+//  Advance the automaton by one array index.
+//
+//  @param pathexpr A pointer to the path selector structure.
+//  @param state The set of active segments before the index.
+//  @param index The array index.
+//
+//  @return The set of active segments after the index, 0 if no match is possible.
+//
+t_path_state pathexpr_step_index(t_pathexpr* pathexpr, t_path_state state, t_int32 index) {
+
+  t_path_state next = 0;
+  t_path_seg* seg = pathexpr->seg_arr;
+
+  for (t_int32 ind = 0; ind < pathexpr->seg_cnt; ind++, seg++) {
+
+    if (!(state & ((t_path_state)1 << ind))) { continue; }
+
+    switch (seg->type) {
+    case SEG_ANY_DEPTH: next |= (t_path_state)1 << ind; break;
+    case SEG_INDEX_ANY: next |= (t_path_state)1 << (ind + 1); break;
+    case SEG_INDEX: if (seg->index == index) { next |= (t_path_state)1 << (ind + 1); } break;
+    default: break;
+    }
+  }
+
+  return pathexpr_closure(pathexpr, next);
+}
@@ -0,0 +1,78 @@
+#ifndef YC_PATHEXPR_H_
+#define YC_PATHEXPR_H_
+
+// ========  HEADER FILE FOR PATH SELECTORS  ========
+
+#include "ext.h"        // header file for all objects, should always be first
+#include "ext_obex.h"   // header file for all objects, required for new style Max object
+#include "z_dsp.h"      // header file for MSP objects, included here for t_double type
+
+#include "regexpr.h"
+
+// ========  DEFINES  ========
+
+#define PATH_SEP_S     "::"   // Separator between keys in a path
+#define PATH_SEG_MAX   31     // Maximum number of segments, one bit each in t_path_state
+#define PATH_KEY_MAX   256    // Maximum length of a key expression in a segment
+
+// ========  ENUM  ========
+
+//******************************************************************************
+//  Enum to characterize the different types of path segments
+//
+typedef enum _path_seg_type {
+
+  SEG_KEY,          // A dictionary key, matched with a glob expression
+  SEG_INDEX,        // An array index:  [3]
+  SEG_INDEX_ANY,    // Any array index:  [*]
+  SEG_ANY_DEPTH     // Any number of keys or indexes, including none:  **
+
+} e_path_seg;
+
+// ========  STRUCTURES  ========
+
+//******************************************************************************
+//  Set of active segments in the automaton, as a bit field.
+//  Bit i is set when the first i segments have been matched.
+//  A state of 0 means that no path below the current one can match.
+//
+typedef t_uint32 t_path_state;
+
+typedef struct _path_seg {
+
+  t_uint8    type;       // The segment type, from e_path_seg
+  t_int32    index;      // The array index for SEG_INDEX
+  t_regexpr* key_expr;   // The key expression for SEG_KEY
+
+} t_path_seg;
+
+typedef struct _pathexpr {
+
+  t_symbol* path_sym;    // The original selector as a symbol
+
+  t_int32    seg_cnt;                  // The number of segments, 0 if no selector is set
+  t_path_seg seg_arr[PATH_SEG_MAX];    // The compiled segments
+
+  t_path_state state_ini;   // The state before the first segment, with its closure
+  t_path_state accept;      // The bit indicating a full match
+
+} t_pathexpr;
+
+// ========  FUNCTION DECLARATIONS  ========
+
+t_pathexpr* pathexpr_new   ();
+void        pathexpr_free  (t_pathexpr* pathexpr);
+void        pathexpr_reset (t_pathexpr* pathexpr);
+t_my_err    pathexpr_set   (t_pathexpr* pathexpr, const char* path_s);
+
+t_path_state pathexpr_step_key     (t_pathexpr* pathexpr, t_path_state state, t_symbol* key);
+t_path_state pathexpr_step_key_str (t_pathexpr* pathexpr, t_path_state state, const char* key_s);
+t_path_state pathexpr_step_index   (t_pathexpr* pathexpr, t_path_state state, t_int32 index);
+t_path_state pathexpr_closure      (t_pathexpr* pathexpr, t_path_state state);
+
+#define pathexpr_is_set(_pathexpr)          ((_pathexpr)->seg_cnt != 0)
+#define pathexpr_accepts(_pathexpr, _state) (((_state) & (_pathexpr)->accept) != 0)
+
+// ========  END OF HEADER FILE  ========
+
+#endif
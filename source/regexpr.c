@@ -1,4 +1,5 @@
 #include "regexpr.h"
+#include "tracebuf.h"
 
 // @TODO:
 // dynamic strings
@@ -58,6 +59,9 @@ t_regexp2* re_new(t_nfa_ind max) {
   t_regexp2* regexpr = (t_regexp2*)sysmem_newptr(sizeof(t_regexp2));
   if (!regexpr) { return NULL; }
 
+  regexpr->is_profiled = false;
+  regexpr->re_search_s = NULL;
+
   // Initialize the structure
   re_init(regexpr, max);
 
@@ -178,6 +182,10 @@ void re_reset(t_regexp2* regexpr) {
   regexpr->capt_flags = 0;
   regexpr->repl_sub_cnt = 1;
 
+  // ====  Profiling  ====
+
+  regexpr->profile = (t_re_profile){ 0 };
+
   // ====  Search compilation:  States  ====
 
   regexpr->state_cnt = 0;
@@ -189,9 +197,8 @@ void re_reset(t_regexp2* regexpr) {
   // Reset the array of states
   // It is organized as a linked list of free states, starting at state_first_free,
   // following the ind1 indexes, and with a terminal IND_NULL value
-  t_state* state;
   for (t_nfa_ind ind = 0; ind < regexpr->state_max; ind++) {
-    state = regexpr->state_arr + ind;
+    t_state* state = regexpr->state_arr + ind;
     state->type = ST_NULL;
     state->ind1 = ind + 1;
     state->u.ind2 = IND_NULL;
@@ -199,7 +206,7 @@ void re_reset(t_regexp2* regexpr) {
   }
 
   // Set the last state link to NULL
-  state->ind1 = IND_NULL;
+  if (regexpr->state_max) { regexpr->state_arr[regexpr->state_max - 1].ind1 = IND_NULL; }
 
   // ==== Search compilation:  Other  ====
 
@@ -354,6 +361,39 @@ void state_post(t_regexp2* regexpr) {
   }
 }
 
+//******************************************************************************
+//  Turn the counting of the work of the simulations on or off, clearing the counts.
+//
+//  @param regexpr A pointer to the regular expression structure.
+//  @param is_profiled true to count.
+//
+void re_profile_set(t_regexp2* regexpr, t_bool is_profiled) {
+
+  regexpr->is_profiled = is_profiled;
+  regexpr->profile = (t_re_profile){ 0 };
+}
+
+//******************************************************************************
+//  Post the cost of the expression compiled, from the counts of its simulations.
+//
+//  @param regexpr A pointer to the regular expression structure.
+//
+void re_profile_post(t_regexp2* regexpr) {
+
+  t_re_profile* prof = &regexpr->profile;
+  double sim_cnt = prof->sim_cnt ? (double)prof->sim_cnt : 1;
+
+  POST_L("RE Profile:  %s%s", regexpr->re_search_s ? regexpr->re_search_s : "", regexpr->is_profiled ? "" : " - Off");
+  POST_L("  Simulations: %llu - Matches: %llu - Rejected early: %llu (%.1f%%)",
+    (unsigned long long)prof->sim_cnt, (unsigned long long)prof->match_cnt,
+    (unsigned long long)prof->exit_cnt, 100.0 * prof->exit_cnt / sim_cnt);
+  POST_L("  Bytes: %llu (%.1f per simulation) - States per byte: %.2f",
+    (unsigned long long)prof->byte_cnt, prof->byte_cnt / sim_cnt,
+    prof->byte_cnt ? (double)prof->active_cnt / prof->byte_cnt : 0);
+  POST_L("  Capture set copies: %llu (%.2f per simulation) - Generation resets: %llu",
+    (unsigned long long)prof->capt_copy_cnt, prof->capt_copy_cnt / sim_cnt, (unsigned long long)prof->gen_reset_cnt);
+}
+
 //******************************************************************************
 //  Set the values of a fragment.
 //
@@ -1087,6 +1127,7 @@ void re_simul_state_wc(t_regexp2* regexpr, t_state* state, t_nfa_ind set_ind) {
         while (cntd--) { *capt_iter2++ = *capt_iter++; }
 
         CAPT_CNT(set_ind2) = 1;
+        if (regexpr->is_profiled) { regexpr->profile.capt_copy_cnt++; }
       }
 
       // Record the parenthesis index
@@ -1220,6 +1261,7 @@ t_bool re_simulate(t_regexp2* regexpr, const char* const match_s) {
       for (t_nfa_ind ind = 0; ind < regexpr->state_cnt; ind++) {
         (regexpr->state_arr + ind)->gen_cnt = 0;
       }
+      if (regexpr->is_profiled && regexpr->match_ind) { regexpr->profile.gen_reset_cnt++; }
     }
     regexpr->gen_cnt++;
 
@@ -1232,6 +1274,7 @@ t_bool re_simulate(t_regexp2* regexpr, const char* const match_s) {
 
     // Add a terminal index to the new list of matching states
     regexpr->rnew_iter->state_ind = IND_NULL;
+    if (regexpr->is_profiled) { regexpr->profile.active_cnt += regexpr->rnew_iter - regexpr->routine_new; }
 
     // Increment the match string index
     regexpr->match_ind++;
@@ -1240,8 +1283,18 @@ t_bool re_simulate(t_regexp2* regexpr, const char* const match_s) {
   // the list of matching states is empty, or the end of the string is reached
   } while ((regexpr->rnew_iter != regexpr->routine_new) && *(regexpr->match_iter++));
 
+  // NB: match_iter is only left on a character when the loop ended with no state left
+  t_bool is_match = ((regexpr->state_arr + regexpr->state_last)->gen_cnt == regexpr->gen_cnt);
+
+  if (regexpr->is_profiled) {
+    regexpr->profile.sim_cnt++;
+    regexpr->profile.byte_cnt += regexpr->match_ind;
+    if (is_match) { regexpr->profile.match_cnt++; }
+    if ((regexpr->rnew_iter == regexpr->routine_new) && *regexpr->match_iter) { regexpr->profile.exit_cnt++; }
+  }
+
   // Test the generation count of the last state for overall matching
-  if ((regexpr->state_arr + regexpr->state_last)->gen_cnt == regexpr->gen_cnt) {
+  if (is_match) {
     if (regexpr->repl_sub_cnt) { re_simul_replace(regexpr, match_s); }
     return true;
   }
@@ -1341,6 +1394,7 @@ t_regexpr* regexpr_new() {
 
   if (expr) {
     expr->search_frag_s = NULL;
+    expr->trace_lane = NULL;
     regexpr_reset(expr);
   }
 
@@ -1365,7 +1419,7 @@ void regexpr_reset(t_regexpr* expr) {
 
 // ====  REGEXPR_SET  ====
 
-t_my_err regexpr_set(t_regexpr* expr, t_symbol* search_sym) {
+static t_my_err _regexpr_set(t_regexpr* expr, t_symbol* search_sym) {
 
   // Universal wildcard
   if ((search_sym == gensym("*")) || (search_sym == gensym("**"))
@@ -1424,11 +1478,20 @@ t_my_err regexpr_set(t_regexpr* expr, t_symbol* search_sym) {
   }
 }
 
+t_my_err regexpr_set(t_regexpr* expr, t_symbol* search_sym) {
+
+  TRACEBUF_EVENT(expr->trace_lane, 'B', "regex", "compile", search_sym);
+  t_my_err err = _regexpr_set(expr, search_sym);
+  TRACEBUF_EVENT(expr->trace_lane, 'E', "regex", "compile", NULL);
+
+  return err;
+}
+
 // ====  REGEXPR_FREE  ====
 void regexpr_free(t_regexpr* expr) {
 
-  if (expr->search_frag_s) { sysmem_freeptr(expr->search_frag_s); }
-  regexpr_reset(expr);
+  regexpr_reset(expr);    // NB: Frees search_frag_s
+  sysmem_freeptr(expr);
 }
 
 // ====  REGEXPR_MATCH  ====
@@ -1438,6 +1501,22 @@ t_bool regexpr_match(t_regexpr* expr, t_symbol* match_sym) {
   return (expr->match_fct(expr, match_sym));
 }
 
+// ====  REGEXPR_MATCH_STR  ====
+//******************************************************************************
+//  Match a string which is not a symbol, e.g. a key read from a file,
+//  without adding it to the symbol table.
+//
+t_bool regexpr_match_str(t_regexpr* expr, const char* match_s) {
+
+  if (expr->match_fct == &_regexpr_match_reg) { return !strcmp(expr->search_frag_s, match_s); }
+
+  t_symbol match_sym;
+  match_sym.s_name = (char*)match_s;
+  match_sym.s_thing = NULL;
+
+  return (expr->match_fct(expr, &match_sym));
+}
+
 // ========  MATCHING FUNCTIONS  ========
 
 // ====  _REGEXPR_MATCH_TRUE  ====
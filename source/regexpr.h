@@ -150,6 +150,22 @@ typedef struct _state {
 
 } t_state;
 
+//******************************************************************************
+//  Work of the simulations of the expression compiled, counted when profiling.
+//  Reset by each compilation, so that it is the cost of one pattern.
+//
+typedef struct _re_profile {
+
+  t_uint64 sim_cnt;         // Simulations run
+  t_uint64 match_cnt;       // Simulations which matched
+  t_uint64 exit_cnt;        // Simulations rejected before the end of the string, no state being left
+  t_uint64 byte_cnt;        // Bytes scanned, the terminating null included
+  t_uint64 active_cnt;      // States activated for the next byte, summed over the bytes
+  t_uint64 capt_copy_cnt;   // Capture sets duplicated by re_simul_state_wc()
+  t_uint64 gen_reset_cnt;   // Resets of the generation counts of all the states, past the one starting each simulation
+
+} t_re_profile;
+
 // @TODO could reuse fragment stack maybe
 typedef struct _simul {
 
@@ -280,6 +296,11 @@ typedef struct _regexp2 {
 //
   t_uint8 prev_type;
 
+  // ====  PROFILING  ====
+
+  t_bool       is_profiled;   // Set to count the work of the simulations
+  t_re_profile profile;
+
   // ====  MISC  ====
 
   t_my_err err;   // Used for error control
@@ -304,6 +325,9 @@ void re_set_object (void* object);
 t_nfa_ind state_new (t_regexp2* regexpr, t_uint8 type, t_nfa_ind ind1, u_state_misc u);
 void state_post     (t_regexp2* regexpr);
 
+void re_profile_set  (t_regexp2* regexpr, t_bool is_profiled);
+void re_profile_post (t_regexp2* regexpr);
+
 void frag_set     (t_fragment* frag, t_nfa_ind first, t_nfa_ind term_beg, t_nfa_ind term_end);
 void frag_connect (t_regexp2* regexpr, t_fragment* frag, t_nfa_ind to_state);
 void frag_post    (t_regexp2* regexpr);
@@ -364,6 +388,8 @@ struct _regexpr {
   char type_end;
 
   t_regexpr_match match_fct;
+
+  struct _trace_lane* trace_lane;    // Lane recording the compilations, or NULL
 };
 
 // ====  PROCEDURE DECLARATIONS  ====
@@ -374,6 +400,7 @@ void     regexpr_reset (t_regexpr* expr);
 t_my_err regexpr_set   (t_regexpr* expr, t_symbol* search_sym);
 void     regexpr_free  (t_regexpr* expr);
 t_bool   regexpr_match (t_regexpr* expr, t_symbol* match_sym);
+t_bool   regexpr_match_str (t_regexpr* expr, const char* match_s);
 
 t_bool _regexpr_match_true  (t_regexpr* expr, t_symbol* match_sym);
 t_bool _regexpr_match_false (t_regexpr* expr, t_symbol* match_sym);
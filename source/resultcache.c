@@ -0,0 +1,131 @@
+#include "resultcache.h"
+
+// The results of the read-only commands are stored as they were output:
+// the posted lines and the recorded matches. The cache of a dictionary is
+// versioned instead of cleared when the dictionary is modified, so that
+// a notification does not have to free anything, and the stale entries are
+// overwritten by the next queries.
+
+// ====  RESULTCACHE  ====
+
+//******************************************************************************
+//  Create and allocate a new, empty, result cache.
+//
+//  @param dict_sym The name of the dictionary.
+//
+//  @return A pointer to the newly allocated structure, or NULL on failure.
+//
+t_resultcache* resultcache_new(t_symbol* dict_sym) {
+
+  t_resultcache* cache = (t_resultcache*)sysmem_newptr(sizeof(t_resultcache));
+  if (!cache) { return NULL; }
+
+  cache->dict_sym = dict_sym;
+  cache->dict_watched = NULL;
+  cache->version = 0;
+  cache->entry_cnt = 0;
+  cache->hit_cnt = 0;
+  cache->miss_cnt = 0;
+
+  return cache;
+}
+
+//******************************************************************************
+//  Free a result cache.
+//
+//  @param cache A pointer to the result cache.
+//
+//  Note: No need to check if the pointer argument is NULL.
+//
+void resultcache_free(t_resultcache* cache) {
+
+  if (!cache) { return; }
+
+  resultcache_clear(cache);
+  sysmem_freeptr(cache);
+}
+
+//******************************************************************************
+//  Free the stored results of a cache.
+//
+//  @param cache A pointer to the result cache.
+//
+void resultcache_clear(t_resultcache* cache) {
+
+  for (t_int32 ind = 0; ind < cache->entry_cnt; ind++) {
+    t_cache_entry* entry = cache->entry_arr + ind;
+    if (entry->out_buf) { sysmem_freeptr(entry->out_buf); }
+    if (entry->res_arr) { sysmem_freeptr(entry->res_arr); }
+  }
+
+  cache->entry_cnt = 0;
+}
+
+//******************************************************************************
+//  Find the result of a query, if it was stored for the current version of the dictionary.
+//
+//  @return A pointer to the entry, or NULL.
+//
+t_cache_entry* resultcache_find(t_resultcache* cache, t_symbol* query) {
+
+  for (t_int32 ind = cache->entry_cnt - 1; ind >= 0; ind--) {
+    t_cache_entry* entry = cache->entry_arr + ind;
+    if (entry->query != query) { continue; }
+    if (entry->version != cache->version) { break; }
+    cache->hit_cnt++;
+    return entry;
+  }
+
+  cache->miss_cnt++;
+  return NULL;
+}
+
+//******************************************************************************
+//  Store the result of a query for the current version of the dictionary.
+//  It replaces a previous result of the same query, or the oldest one if the cache is full.
+//
+//  @return ERR_NONE or ERR_ALLOC, in which case nothing is stored.
+//
+t_my_err resultcache_store(t_resultcache* cache, t_symbol* query, t_int32 count,
+    char* out_buf, t_int32 out_len, t_atom* res_arr, t_int32 res_len) {
+
+  char* out_copy = NULL;
+  t_atom* res_copy = NULL;
+
+  if (out_len) {
+    out_copy = (char*)sysmem_newptr(out_len);
+    if (!out_copy) { return ERR_ALLOC; }
+    sysmem_copyptr(out_buf, out_copy, out_len);
+  }
+
+  if (res_len) {
+    res_copy = (t_atom*)sysmem_newptr(res_len * sizeof(t_atom));
+    if (!res_copy) { if (out_copy) { sysmem_freeptr(out_copy); } return ERR_ALLOC; }
+    sysmem_copyptr(res_arr, res_copy, res_len * sizeof(t_atom));
+  }
+
+  // Drop the previous result of the query, or the oldest one
+  t_int32 ind = 0;
+  while ((ind < cache->entry_cnt) && (cache->entry_arr[ind].query != query)) { ind++; }
+  if ((ind == cache->entry_cnt) && (cache->entry_cnt == RESULTCACHE_ENTRY_MAX)) { ind = 0; }
+
+  if (ind < cache->entry_cnt) {
+    t_cache_entry* entry = cache->entry_arr + ind;
+    if (entry->out_buf) { sysmem_freeptr(entry->out_buf); }
+    if (entry->res_arr) { sysmem_freeptr(entry->res_arr); }
+    memmove(entry, entry + 1, (cache->entry_cnt - ind - 1) * sizeof(t_cache_entry));
+    cache->entry_cnt--;
+  }
+
+  // Then append the new one as the newest
+  t_cache_entry* entry = cache->entry_arr + cache->entry_cnt++;
+  entry->query = query;
+  entry->version = cache->version;
+  entry->count = count;
+  entry->out_buf = out_copy;
+  entry->out_len = out_len;
+  entry->res_arr = res_copy;
+  entry->res_len = res_len;
+
+  return ERR_NONE;
+}
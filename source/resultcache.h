@@ -0,0 +1,69 @@
+#ifndef YC_RESULTCACHE_H_
+#define YC_RESULTCACHE_H_
+
+// ========  HEADER FILE FOR THE RESULT CACHE  ========
+
+#include "ext.h"        // header file for all objects, should always be first
+#include "ext_obex.h"   // header file for all objects, required for new style Max object
+#include "z_dsp.h"      // header file for MSP objects, included here for t_double type
+
+#include "ext_dictionary.h"
+
+#include "regexpr.h"
+
+// ========  DEFINES  ========
+
+#define RESULTCACHE_ENTRY_MAX 32    // Maximum number of queries cached per dictionary
+
+// ========  STRUCTURES  ========
+
+//******************************************************************************
+//  The stored result of one query
+//
+typedef struct _cache_entry {
+
+  t_symbol* query;          // The command and its arguments, as one symbol
+  t_int32   version;        // The version of the dictionary the result was stored for
+  t_int32   count;
+
+  char*   out_buf;          // The posted lines, each one followed by '\0'
+  t_int32 out_len;
+
+  t_atom* res_arr;          // The matches recorded for list output
+  t_int32 res_len;
+
+} t_cache_entry;
+
+//******************************************************************************
+//  Results of the read-only queries on one dictionary, validated by a version
+//  incremented each time the dictionary is modified.
+//
+typedef struct _resultcache {
+
+  t_symbol*     dict_sym;     // The name of the dictionary
+  t_dictionary* dict_watched; // The dictionary the owner is attached to, or NULL
+  t_int32       version;
+
+  t_cache_entry entry_arr[RESULTCACHE_ENTRY_MAX];   // From the oldest to the newest
+  t_int32       entry_cnt;
+
+  t_int32 hit_cnt;
+  t_int32 miss_cnt;
+
+} t_resultcache;
+
+// ========  FUNCTION DECLARATIONS  ========
+
+t_resultcache* resultcache_new   (t_symbol* dict_sym);
+void           resultcache_free  (t_resultcache* cache);
+void           resultcache_clear (t_resultcache* cache);
+
+t_cache_entry* resultcache_find  (t_resultcache* cache, t_symbol* query);
+t_my_err       resultcache_store (t_resultcache* cache, t_symbol* query, t_int32 count,
+  char* out_buf, t_int32 out_len, t_atom* res_arr, t_int32 res_len);
+
+#define resultcache_bump(_cache) ((_cache)->version++)
+
+// ========  END OF HEADER FILE  ========
+
+#endif
@@ -0,0 +1,271 @@
+#include "snapshot.h"
+
+// The walk of a dictionary tree gets the keys of each dictionary, allocating
+// the key array, then looks up each entry in its hash table. A snapshot does
+// this once, and lays the tree out in traversal order as parallel arrays,
+// so that a query is a linear scan over the fields it tests: comparing key
+// pointers only reads the key array, a numeric filter the type and value
+// arrays. Like the key index, it holds pointers to the nested dictionaries,
+// so it has to be invalidated whenever the tree changes.
+
+// ====  SNAPSHOT  ====
+
+//******************************************************************************
+//  Create and allocate a new, invalid, snapshot.
+//
+//  @param dict_sym The name of the dictionary to mirror.
+//
+//  @return A pointer to the newly allocated structure, or NULL on failure.
+//
+t_snapshot* snapshot_new(t_symbol* dict_sym) {
+
+  t_snapshot* snap = (t_snapshot*)sysmem_newptr(sizeof(t_snapshot));
+  if (!snap) { return NULL; }
+
+  snap->dict_sym = dict_sym;
+  snap->dict = NULL;
+  snap->dict_watched = NULL;
+  snap->node_cnt = 0;
+  snap->node_max = 0;
+  snap->parent_arr = NULL;
+  snap->end_arr = NULL;
+  snap->key_arr = NULL;
+  snap->index_arr = NULL;
+  snap->depth_arr = NULL;
+  snap->type_arr = NULL;
+  snap->value_arr = NULL;
+  snap->build_cnt = 0;
+
+  return snap;
+}
+
+//******************************************************************************
+//  Free a snapshot.
+//
+//  @param snap A pointer to the snapshot.
+//
+//  Note: No need to check if the pointer argument is NULL.
+//
+void snapshot_free(t_snapshot* snap) {
+
+  if (!snap) { return; }
+
+  if (snap->parent_arr) { sysmem_freeptr(snap->parent_arr); }
+  if (snap->end_arr) { sysmem_freeptr(snap->end_arr); }
+  if (snap->key_arr) { sysmem_freeptr(snap->key_arr); }
+  if (snap->index_arr) { sysmem_freeptr(snap->index_arr); }
+  if (snap->depth_arr) { sysmem_freeptr(snap->depth_arr); }
+  if (snap->type_arr) { sysmem_freeptr(snap->type_arr); }
+  if (snap->value_arr) { sysmem_freeptr(snap->value_arr); }
+  sysmem_freeptr(snap);
+}
+
+//******************************************************************************
+//  Invalidate a snapshot. The allocations are kept for the next build.
+//
+//  @param snap A pointer to the snapshot.
+//
+void snapshot_invalidate(t_snapshot* snap) {
+
+  snap->dict = NULL;
+  snap->node_cnt = 0;
+}
+
+//******************************************************************************
+//  Grow one array of the snapshot.
+//
+//  @return ERR_NONE or ERR_ALLOC.
+//
+static t_my_err _snapshot_grow(void** arr, t_int32 max, t_int32 size) {
+
+  void* arr_new = (*arr) ? sysmem_resizeptr(*arr, max * size) : sysmem_newptr(max * size);
+  if (!arr_new) { return ERR_ALLOC; }
+
+  *arr = arr_new;
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  Add a node, growing all the arrays together if they are full.
+//
+//  @return The node, or -1 on failure.
+//
+static t_int32 _snapshot_add(t_snapshot* snap, t_int32 parent, t_symbol* key, t_int32 index, t_int32 depth, t_atom* value) {
+
+  if (snap->node_cnt == snap->node_max) {
+
+    t_int32 max = snap->node_max ? 2 * snap->node_max : 256;
+    if ((_snapshot_grow((void**)&snap->parent_arr, max, sizeof(t_int32)) != ERR_NONE)
+        || (_snapshot_grow((void**)&snap->end_arr, max, sizeof(t_int32)) != ERR_NONE)
+        || (_snapshot_grow((void**)&snap->key_arr, max, sizeof(t_symbol*)) != ERR_NONE)
+        || (_snapshot_grow((void**)&snap->index_arr, max, sizeof(t_int32)) != ERR_NONE)
+        || (_snapshot_grow((void**)&snap->depth_arr, max, sizeof(t_int32)) != ERR_NONE)
+        || (_snapshot_grow((void**)&snap->type_arr, max, sizeof(t_uint8)) != ERR_NONE)
+        || (_snapshot_grow((void**)&snap->value_arr, max, sizeof(t_snap_value)) != ERR_NONE)) {
+      return -1;
+    }
+
+    snap->node_max = max;
+  }
+
+  t_int32 node = snap->node_cnt++;
+  snap->parent_arr[node] = parent;
+  snap->end_arr[node] = node + 1;
+  snap->key_arr[node] = key;
+  snap->index_arr[node] = index;
+  snap->depth_arr[node] = depth;
+
+  long type = atom_gettype(value);
+  t_snap_value* payload = snap->value_arr + node;
+
+  if (type == A_LONG) { snap->type_arr[node] = SNAP_INT; payload->l = atom_getlong(value); }
+  else if (type == A_FLOAT) { snap->type_arr[node] = SNAP_FLOAT; payload->f = atom_getfloat(value); }
+  else if ((type == A_SYM) || atomisstring(value)) { snap->type_arr[node] = SNAP_SYM; payload->s = atom_getsym(value); }
+  else if (atomisdictionary(value)) { snap->type_arr[node] = SNAP_DICT; payload->o = atom_getobj(value); }
+  else if (atomisatomarray(value)) { snap->type_arr[node] = SNAP_ARRAY; payload->o = atom_getobj(value); }
+  else { snap->type_arr[node] = SNAP_OTHER; payload->o = NULL; }
+
+  return node;
+}
+
+static t_my_err _snapshot_build_value (t_snapshot* snap, t_int32 node, t_atom* value, t_int32 depth);
+
+//******************************************************************************
+//  Recursively add the entries of a dictionary, each one followed by its descendants.
+//
+static t_my_err _snapshot_build_dict(t_snapshot* snap, t_int32 parent, t_dictionary* dict, t_int32 depth) {
+
+  t_my_err err = ERR_NONE;
+  t_atom value[1];
+
+  long key_cnt = 0;
+  t_symbol** key_arr = NULL;
+  dictionary_getkeys(dict, &key_cnt, &key_arr);
+
+  for (t_int32 ind = 0; (ind < key_cnt) && (err == ERR_NONE); ind++) {
+
+    dictionary_getatom(dict, key_arr[ind], value);
+
+    t_int32 node = _snapshot_add(snap, parent, key_arr[ind], 0, depth, value);
+    err = (node < 0) ? ERR_ALLOC : _snapshot_build_value(snap, node, value, depth);
+  }
+
+  if (key_arr) { dictionary_freekeys(dict, key_cnt, key_arr); }
+
+  return err;
+}
+
+//******************************************************************************
+//  Recursively add the descendants of a node, if it is a dictionary or an array.
+//
+static t_my_err _snapshot_build_value(t_snapshot* snap, t_int32 node, t_atom* value, t_int32 depth) {
+
+  t_my_err err = ERR_NONE;
+
+  if (atomisdictionary(value)) {
+    err = _snapshot_build_dict(snap, node, (t_dictionary*)atom_getobj(value), depth + 1);
+  }
+
+  else if (atomisatomarray(value)) {
+
+    long array_len;
+    t_atom* atom_arr;
+    atomarray_getatoms((t_atomarray*)atom_getobj(value), &array_len, &atom_arr);
+
+    for (t_int32 ind = 0; (ind < array_len) && (err == ERR_NONE); ind++) {
+      t_int32 child = _snapshot_add(snap, node, NULL, ind, depth, atom_arr + ind);
+      err = (child < 0) ? ERR_ALLOC : _snapshot_build_value(snap, child, atom_arr + ind, depth);
+    }
+  }
+
+  snap->end_arr[node] = snap->node_cnt;
+
+  return err;
+}
+
+//******************************************************************************
+//  Build the snapshot with one walk of the dictionary tree.
+//
+//  @param snap A pointer to the snapshot.
+//  @param dict The dictionary registered under snap->dict_sym.
+//
+//  @return ERR_NONE, or ERR_ALLOC in which case the snapshot is invalid.
+//
+t_my_err snapshot_build(t_snapshot* snap, t_dictionary* dict) {
+
+  snapshot_invalidate(snap);
+
+  t_my_err err = _snapshot_build_dict(snap, -1, dict, 1);
+  if (err != ERR_NONE) { snapshot_invalidate(snap); return err; }
+
+  snap->dict = dict;
+  snap->build_cnt++;
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  Get the value of a node as an atom.
+//
+void snapshot_atom(t_snapshot* snap, t_int32 node, t_atom* value) {
+
+  t_snap_value* payload = snap->value_arr + node;
+
+  switch (snap->type_arr[node]) {
+  case SNAP_INT: atom_setlong(value, payload->l); break;
+  case SNAP_FLOAT: atom_setfloat(value, payload->f); break;
+  case SNAP_SYM: atom_setsym(value, payload->s); break;
+  case SNAP_DICT:
+  case SNAP_ARRAY: atom_setobj(value, payload->o); break;
+  default: atom_setsym(value, gensym("")); break;
+  }
+}
+
+//******************************************************************************
+//  Write the path of a node, as the traversal formats it:  name::presets::a::tracks[0]::gain
+//
+void snapshot_path(t_snapshot* snap, t_int32 node, char* path, t_int32 path_len_max) {
+
+  char str_tmp[16];
+
+  if (node < 0) { strncpy_zero(path, snap->dict_sym->s_name, path_len_max); return; }
+
+  snapshot_path(snap, snap->parent_arr[node], path, path_len_max);
+
+  if (snap->key_arr[node]) {
+    strncat_zero(path, PATH_SEP_S, path_len_max);
+    strncat_zero(path, snap->key_arr[node]->s_name, path_len_max);
+  }
+  else {
+    snprintf_zero(str_tmp, 16, "[%i]", snap->index_arr[node]);
+    strncat_zero(path, str_tmp, path_len_max);
+  }
+}
+
+//******************************************************************************
+//  Get the key of the entry holding a node, the node itself unless it is an array value.
+//
+t_symbol* snapshot_key(t_snapshot* snap, t_int32 node) {
+
+  while ((node >= 0) && !snap->key_arr[node]) { node = snap->parent_arr[node]; }
+
+  return (node >= 0) ? snap->key_arr[node] : gensym("");
+}
+
+//******************************************************************************
+//  Get the segments of the path of a node below the root: keys and array indexes.
+//
+//  @return The number of segments, or -1 if there are more than seg_max.
+//
+t_int32 snapshot_segments(t_snapshot* snap, t_int32 node, t_atom* seg_arr, t_int32 seg_max) {
+
+  t_int32 seg_cnt = 0;
+  for (t_int32 ind = node; ind >= 0; ind = snap->parent_arr[ind]) { seg_cnt++; }
+  if (seg_cnt > seg_max) { return -1; }
+
+  for (t_int32 ind = node, seg = seg_cnt - 1; ind >= 0; ind = snap->parent_arr[ind], seg--) {
+    if (snap->key_arr[ind]) { atom_setsym(seg_arr + seg, snap->key_arr[ind]); }
+    else { atom_setlong(seg_arr + seg, snap->index_arr[ind]); }
+  }
+
+  return seg_cnt;
+}
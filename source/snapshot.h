@@ -0,0 +1,88 @@
+#ifndef YC_SNAPSHOT_H_
+#define YC_SNAPSHOT_H_
+
+// ========  HEADER FILE FOR THE FLAT SNAPSHOT OF A DICTIONARY  ========
+
+#include "ext.h"        // header file for all objects, should always be first
+#include "ext_obex.h"   // header file for all objects, required for new style Max object
+#include "z_dsp.h"      // header file for MSP objects, included here for t_double type
+
+#include "ext_dictionary.h"
+
+#include "regexpr.h"
+#include "pathexpr.h"
+
+// ========  ENUM  ========
+
+//******************************************************************************
+//  The types of the values in a snapshot
+//
+typedef enum _snap_type {
+
+  SNAP_OTHER,
+  SNAP_INT,
+  SNAP_FLOAT,
+  SNAP_SYM,         // A symbol, or a string in an array
+  SNAP_DICT,
+  SNAP_ARRAY
+
+} t_snap_type;
+
+// ========  STRUCTURES  ========
+
+//******************************************************************************
+//  The payload of one value
+//
+typedef union _snap_value {
+
+  t_atom_long  l;
+  t_atom_float f;
+  t_symbol*    s;
+  t_object*    o;         // The dictionary or atomarray
+
+} t_snap_value;
+
+//******************************************************************************
+//  Flat mirror of a dictionary tree: one node per entry and array value,
+//  in traversal order, each array holding one field of all the nodes.
+//  The descendants of a node are the nodes from the next one up to its end.
+//
+typedef struct _snapshot {
+
+  t_symbol*     dict_sym;     // The name of the mirrored dictionary
+  t_dictionary* dict;         // The mirrored dictionary, NULL when the snapshot is invalid
+  t_dictionary* dict_watched; // The dictionary the owner is attached to, kept while the snapshot is invalid
+
+  t_int32 node_cnt;
+  t_int32 node_max;
+
+  t_int32*      parent_arr;   // The node of the dictionary or array holding the value, -1 for the root entries
+  t_int32*      end_arr;      // The node after the last descendant
+  t_symbol**    key_arr;      // The key, NULL for the array values
+  t_int32*      index_arr;    // The index of the value in its array
+  t_int32*      depth_arr;    // The number of dictionaries holding the value
+  t_uint8*      type_arr;     // From t_snap_type
+  t_snap_value* value_arr;
+
+  t_int32 build_cnt;          // The number of builds, for verbose output
+
+} t_snapshot;
+
+// ========  FUNCTION DECLARATIONS  ========
+
+t_snapshot* snapshot_new        (t_symbol* dict_sym);
+void        snapshot_free       (t_snapshot* snap);
+void        snapshot_invalidate (t_snapshot* snap);
+t_my_err    snapshot_build      (t_snapshot* snap, t_dictionary* dict);
+
+void snapshot_atom (t_snapshot* snap, t_int32 node, t_atom* value);
+void snapshot_path (t_snapshot* snap, t_int32 node, char* path, t_int32 path_len_max);
+
+t_symbol* snapshot_key (t_snapshot* snap, t_int32 node);
+t_int32   snapshot_segments (t_snapshot* snap, t_int32 node, t_atom* seg_arr, t_int32 seg_max);
+
+#define snapshot_is_valid(_snap)  ((_snap)->dict != NULL)
+
+// ========  END OF HEADER FILE  ========
+
+#endif
@@ -0,0 +1,236 @@
+#include "tracebuf.h"
+
+// The TRACE macros post through the console, which is far too slow to leave
+// on. The events here are a few stores into a ring owned by the thread
+// writing them, without lock nor allocation, so that the trace can stay on
+// while the patch runs, and be dumped once a command stalls. A parallel
+// traversal writes from one lane per thread of the pool.
+//
+// The dump reads a ring while its thread may be writing. The thread writes
+// the event, then the count: the events read before the count was last
+// read again, and not overwritten since, are the complete ones.
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TRACEBUF_FENCE() _ReadWriteBarrier()
+#else
+#define TRACEBUF_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+#define TRACEBUF_OUT_MAX 65536    // Size of the output buffer of a dump
+
+// ====  TRACEBUF  ====
+
+//******************************************************************************
+//  Create a new trace, with the lane of the thread running the commands.
+//
+//  @return A pointer to the newly allocated structure, or NULL on failure.
+//
+t_tracebuf* tracebuf_new(void) {
+
+  t_tracebuf* trace = (t_tracebuf*)sysmem_newptrclear(sizeof(t_tracebuf));
+  if (!trace) { return NULL; }
+
+  if (tracebuf_reserve(trace, 1) != ERR_NONE) { sysmem_freeptr(trace); return NULL; }
+
+  return trace;
+}
+
+//******************************************************************************
+//  Free a trace and its lanes.
+//
+void tracebuf_free(t_tracebuf* trace) {
+
+  for (t_int32 ind = 0; ind < trace->lane_cnt; ind++) { sysmem_freeptr(trace->lane_arr[ind].event_arr); }
+  sysmem_freeptr(trace);
+}
+
+//******************************************************************************
+//  Allocate the lanes up to a number, before the threads writing them are started.
+//  The lanes are kept, with their events, until the trace is freed.
+//
+//  @return ERR_NONE, or ERR_ALLOC if a lane could not be allocated.
+//
+t_my_err tracebuf_reserve(t_tracebuf* trace, t_int32 lane_cnt) {
+
+  lane_cnt = MIN(lane_cnt, TRACEBUF_LANE_MAX);
+
+  while (trace->lane_cnt < lane_cnt) {
+    t_trace_lane* lane = trace->lane_arr + trace->lane_cnt;
+    lane->event_arr = (t_trace_event*)sysmem_newptr(TRACEBUF_EVENT_MAX * sizeof(t_trace_event));
+    if (!lane->event_arr) { return ERR_ALLOC; }
+    lane->write_cnt = 0;
+    TRACEBUF_FENCE();    // A dump running meanwhile only reads the lanes counted
+    trace->lane_cnt++;
+  }
+
+  return ERR_NONE;
+}
+
+//******************************************************************************
+//  Get a lane of the trace.
+//
+//  @return A pointer to the lane, or NULL if it was not reserved.
+//
+t_trace_lane* tracebuf_lane(t_tracebuf* trace, t_int32 lane_ind) {
+
+  return (trace && (lane_ind < trace->lane_cnt)) ? trace->lane_arr + lane_ind : NULL;
+}
+
+//******************************************************************************
+//  Record an event, only ever called from the thread owning the lane.
+//
+//  @param phase 'B', 'E' or 'i'.
+//  @param cat The category of the event, a static string.
+//  @param name The name of the event, a static string or the name of a symbol.
+//  @param arg The dictionary, key or pattern concerned, or NULL.
+//
+void tracebuf_event(t_trace_lane* lane, char phase, const char* cat, const char* name, t_symbol* arg) {
+
+  t_uint64 write_cnt = lane->write_cnt;
+  t_trace_event* event = lane->event_arr + (write_cnt & (TRACEBUF_EVENT_MAX - 1));
+
+  event->time = systimer_gettime();
+  event->cat = cat;
+  event->name = name;
+  event->arg = arg;
+  event->phase = phase;
+
+  TRACEBUF_FENCE();
+  lane->write_cnt = write_cnt + 1;
+}
+
+// ====  TRACEBUF_WRITE  ====
+
+typedef struct _trace_out {
+
+  t_filehandle file;
+  char*        buf;
+  t_int32      len;
+  t_bool       is_failed;
+
+} t_trace_out;
+
+//******************************************************************************
+//  Write the buffered text to the file.
+//
+static void _tracebuf_flush(t_trace_out* out) {
+
+  t_ptr_size count = out->len;
+  if (!out->is_failed && ((sysfile_write(out->file, &count, out->buf) != MAX_ERR_NONE) || (count != (t_ptr_size)out->len))) {
+    out->is_failed = true;
+  }
+  out->len = 0;
+}
+
+//******************************************************************************
+//  Append a formatted text, shorter than 512 characters, to the output.
+//
+static void _tracebuf_printf(t_trace_out* out, const char* fmt, ...) {
+
+  if (out->len > TRACEBUF_OUT_MAX - 512) { _tracebuf_flush(out); }
+
+  va_list args;
+  va_start(args, fmt);
+  t_int32 len = (t_int32)vsnprintf(out->buf + out->len, TRACEBUF_OUT_MAX - out->len, fmt, args);
+  va_end(args);
+
+  out->len += MAX(0, MIN(len, TRACEBUF_OUT_MAX - out->len - 1));
+}
+
+//******************************************************************************
+//  Append a string as a JSON string, quoted and escaped.
+//
+static void _tracebuf_quote(t_trace_out* out, const char* s) {
+
+  if (out->len > TRACEBUF_OUT_MAX - 8) { _tracebuf_flush(out); }
+  out->buf[out->len++] = '"';
+
+  for ( ; *s; s++) {
+    if (out->len > TRACEBUF_OUT_MAX - 8) { _tracebuf_flush(out); }
+
+    unsigned char c = (unsigned char)*s;
+    if ((c == '"') || (c == '\\')) { out->buf[out->len++] = '\\'; out->buf[out->len++] = (char)c; }
+    else if (c < 0x20) { out->len += snprintf(out->buf + out->len, 8, "\\u%04x", c); }
+    else { out->buf[out->len++] = (char)c; }
+  }
+
+  if (out->len > TRACEBUF_OUT_MAX - 8) { _tracebuf_flush(out); }
+  out->buf[out->len++] = '"';
+}
+
+//******************************************************************************
+//  Write the events of all the lanes to a file in the Chrome trace format,
+//  which Perfetto and chrome://tracing open. Each lane is a thread, and the
+//  time stamps are those of systimer_gettime(), in microseconds.
+//  The trace can be written while a command is running.
+//
+//  @param event_cnt Set to the number of events written.
+//
+//  @return ERR_NONE, ERR_ALLOC, or ERR_MISC if the file could not be written.
+//
+t_my_err tracebuf_write(t_tracebuf* trace, t_filehandle file, t_int32* event_cnt) {
+
+  t_trace_out out;
+  out.file = file;
+  out.len = 0;
+  out.is_failed = false;
+  out.buf = (char*)sysmem_newptr(TRACEBUF_OUT_MAX);
+
+  t_trace_event* copy_arr = (t_trace_event*)sysmem_newptr(TRACEBUF_EVENT_MAX * sizeof(t_trace_event));
+
+  if (!out.buf || !copy_arr) {
+    if (out.buf) { sysmem_freeptr(out.buf); }
+    if (copy_arr) { sysmem_freeptr(copy_arr); }
+    return ERR_ALLOC;
+  }
+
+  *event_cnt = 0;
+
+  _tracebuf_printf(&out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+  for (t_int32 lane_ind = 0; lane_ind < trace->lane_cnt; lane_ind++) {
+
+    t_trace_lane* lane = trace->lane_arr + lane_ind;
+
+    _tracebuf_printf(&out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"%s %i\"}}",
+      lane_ind ? ",\n" : "", lane_ind, lane_ind ? "worker" : "commands", lane_ind);
+
+    // ==== Copy the events, then drop the ones the thread may have overwritten meanwhile
+    t_uint64 end = lane->write_cnt;
+    t_uint64 beg = (end > TRACEBUF_EVENT_MAX - 1) ? end - (TRACEBUF_EVENT_MAX - 1) : 0;
+    TRACEBUF_FENCE();
+    for (t_uint64 ind = beg; ind < end; ind++) {
+      copy_arr[ind - beg] = lane->event_arr[ind & (TRACEBUF_EVENT_MAX - 1)];
+    }
+
+    TRACEBUF_FENCE();
+    t_uint64 write_cnt = lane->write_cnt;
+    t_uint64 valid = (write_cnt > TRACEBUF_EVENT_MAX - 1) ? write_cnt - (TRACEBUF_EVENT_MAX - 1) : 0;
+
+    for (t_uint64 ind = MAX(beg, valid); ind < end; ind++) {
+
+      t_trace_event* event = copy_arr + (ind - beg);
+
+      _tracebuf_printf(&out, ",\n{\"ph\":\"%c\",\"pid\":1,\"tid\":%i,\"ts\":%.3f,\"cat\":\"%s\",\"name\":",
+        event->phase, lane_ind, event->time * 1000.0, event->cat);
+      _tracebuf_quote(&out, event->name);
+      if (event->phase == 'i') { _tracebuf_printf(&out, ",\"s\":\"t\""); }
+      if (event->arg) {
+        _tracebuf_printf(&out, ",\"args\":{\"arg\":");
+        _tracebuf_quote(&out, event->arg->s_name);
+        _tracebuf_printf(&out, "}");
+      }
+      _tracebuf_printf(&out, "}");
+      (*event_cnt)++;
+    }
+  }
+
+  _tracebuf_printf(&out, "\n]}\n");
+  _tracebuf_flush(&out);
+
+  sysmem_freeptr(copy_arr);
+  sysmem_freeptr(out.buf);
+
+  return out.is_failed ? ERR_MISC : ERR_NONE;
+}
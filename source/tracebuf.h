@@ -0,0 +1,69 @@
+#ifndef YC_TRACEBUF_H_
+#define YC_TRACEBUF_H_
+
+// ========  HEADER FILE FOR THE EVENT TRACE OF THE COMMANDS  ========
+
+#include "ext.h"        // header file for all objects, should always be first
+#include "ext_obex.h"   // header file for all objects, required for new style Max object
+#include "z_dsp.h"      // header file for MSP objects, included here for t_double type
+
+#include "ext_path.h"
+#include "ext_sysfile.h"
+
+#include "regexpr.h"
+
+// ========  DEFINES  ========
+
+#define TRACEBUF_LANE_MAX  64      // Maximum number of lanes, one per thread of a parallel traversal
+#define TRACEBUF_EVENT_MAX 4096    // Events kept per lane, the oldest being overwritten, a power of 2
+
+// Record an event if the lane is set, the lane being NULL when the trace is off
+#define TRACEBUF_EVENT(_lane, ...) do { if (_lane) { tracebuf_event((_lane), __VA_ARGS__); } } while (0)
+
+// ========  STRUCTURES  ========
+
+//******************************************************************************
+//  One event, with the phases of the Chrome trace format:
+//  'B' and 'E' for the beginning and the end of a span, 'i' for an instant.
+//
+typedef struct _trace_event {
+
+  double      time;         // From systimer_gettime(), in ms
+  const char* cat;          // Category, a static string
+  const char* name;         // A static string, or the name of a symbol
+  t_symbol*   arg;          // Dictionary, key or pattern concerned, or NULL
+  char        phase;
+
+} t_trace_event;
+
+//******************************************************************************
+//  Ring of events written by a single thread. The count is only written by
+//  that thread, after the event, so that a dump can read the ring while a
+//  command is running.
+//
+typedef struct _trace_lane {
+
+  t_trace_event*    event_arr;
+  volatile t_uint64 write_cnt;    // Events written since the lane was created
+
+} t_trace_lane;
+
+typedef struct _tracebuf {
+
+  t_trace_lane     lane_arr[TRACEBUF_LANE_MAX];
+  volatile t_int32 lane_cnt;      // Lanes allocated, lane 0 being the one of the thread running the command
+
+} t_tracebuf;
+
+// ========  FUNCTION DECLARATIONS  ========
+
+t_tracebuf*   tracebuf_new     (void);
+void          tracebuf_free    (t_tracebuf* trace);
+t_my_err      tracebuf_reserve (t_tracebuf* trace, t_int32 lane_cnt);
+t_trace_lane* tracebuf_lane    (t_tracebuf* trace, t_int32 lane_ind);
+void          tracebuf_event   (t_trace_lane* lane, char phase, const char* cat, const char* name, t_symbol* arg);
+t_my_err      tracebuf_write   (t_tracebuf* trace, t_filehandle file, t_int32* event_cnt);
+
+// ========  END OF HEADER FILE  ========
+
+#endif
@@ -0,0 +1,74 @@
+#include "walkstats.h"
+
+// The counters are plain increments in the traversal, so that they cost
+// next to nothing and are always on. They tell apart the three usual causes
+// of a slow command: the size of the tree (dictionaries, arrays and atoms),
+// the cost of the patterns (tries against hits), and the cost of the edits.
+
+// ====  WALKSTATS  ====
+
+//******************************************************************************
+//  Reset all the counters.
+//
+void walkstats_clear(t_walkstats* stats) {
+
+  stats->cmd_cnt = 0;
+  stats->dict_cnt = 0;
+  stats->array_cnt = 0;
+  stats->atom_cnt = 0;
+  stats->key_try_cnt = 0;
+  stats->key_hit_cnt = 0;
+  stats->val_try_cnt = 0;
+  stats->val_hit_cnt = 0;
+  stats->edit_cnt = 0;
+  stats->depth_max = 0;
+  stats->path_bytes = 0;
+  stats->time_ms = 0;
+}
+
+//******************************************************************************
+//  Add the counters of a traversal or of a command to others.
+//  The maximum depth is the maximum of both.
+//
+void walkstats_add(t_walkstats* stats, const t_walkstats* from) {
+
+  stats->cmd_cnt += from->cmd_cnt;
+  stats->dict_cnt += from->dict_cnt;
+  stats->array_cnt += from->array_cnt;
+  stats->atom_cnt += from->atom_cnt;
+  stats->key_try_cnt += from->key_try_cnt;
+  stats->key_hit_cnt += from->key_hit_cnt;
+  stats->val_try_cnt += from->val_try_cnt;
+  stats->val_hit_cnt += from->val_hit_cnt;
+  stats->edit_cnt += from->edit_cnt;
+  walkstats_depth(stats, from->depth_max);
+  stats->path_bytes += from->path_bytes;
+  stats->time_ms += from->time_ms;
+}
+
+//******************************************************************************
+//  Write the counters into a dictionary, replacing the previous values.
+//
+//  @return ERR_NONE, or ERR_ALLOC if an entry could not be written.
+//
+t_my_err walkstats_to_dict(const t_walkstats* stats, t_dictionary* dict) {
+
+  t_max_err err = MAX_ERR_NONE;
+
+  dictionary_clear(dict);
+
+  err |= dictionary_appendlong(dict, gensym("commands"), (t_atom_long)stats->cmd_cnt);
+  err |= dictionary_appendlong(dict, gensym("dicts"), (t_atom_long)stats->dict_cnt);
+  err |= dictionary_appendlong(dict, gensym("arrays"), (t_atom_long)stats->array_cnt);
+  err |= dictionary_appendlong(dict, gensym("atoms"), (t_atom_long)stats->atom_cnt);
+  err |= dictionary_appendlong(dict, gensym("key_tries"), (t_atom_long)stats->key_try_cnt);
+  err |= dictionary_appendlong(dict, gensym("key_hits"), (t_atom_long)stats->key_hit_cnt);
+  err |= dictionary_appendlong(dict, gensym("value_tries"), (t_atom_long)stats->val_try_cnt);
+  err |= dictionary_appendlong(dict, gensym("value_hits"), (t_atom_long)stats->val_hit_cnt);
+  err |= dictionary_appendlong(dict, gensym("edits"), (t_atom_long)stats->edit_cnt);
+  err |= dictionary_appendlong(dict, gensym("depth_max"), (t_atom_long)stats->depth_max);
+  err |= dictionary_appendlong(dict, gensym("path_bytes"), (t_atom_long)stats->path_bytes);
+  err |= dictionary_appendfloat(dict, gensym("time_ms"), stats->time_ms);
+
+  return (err == MAX_ERR_NONE) ? ERR_NONE : ERR_ALLOC;
+}
@@ -0,0 +1,51 @@
+#ifndef YC_WALKSTATS_H_
+#define YC_WALKSTATS_H_
+
+// ========  HEADER FILE FOR THE WORK COUNTERS OF THE COMMANDS  ========
+
+#include "ext.h"        // header file for all objects, should always be first
+#include "ext_obex.h"   // header file for all objects, required for new style Max object
+#include "z_dsp.h"      // header file for MSP objects, included here for t_double type
+
+#include "ext_dictionary.h"
+
+#include "regexpr.h"
+
+// ========  STRUCTURES  ========
+
+//******************************************************************************
+//  Work done by a command, or by all the commands since the last reset.
+//  Each traversal counts in its own, the tasks of a parallel traversal
+//  are added up at the end.
+//
+typedef struct _walkstats {
+
+  t_int64 cmd_cnt;        // Number of commands added up
+  t_int64 dict_cnt;       // Dictionaries entered
+  t_int64 array_cnt;      // Arrays entered
+  t_int64 atom_cnt;       // Entry values and array values visited
+
+  t_int64 key_try_cnt;    // Keys tested against the search key
+  t_int64 key_hit_cnt;
+  t_int64 val_try_cnt;    // Values tested against the search value
+  t_int64 val_hit_cnt;
+
+  t_int64 edit_cnt;       // Replacements, appends and deletions applied
+  t_int32 depth_max;      // Deepest dictionary or array entered, 0 for the root
+  t_int64 path_bytes;     // Bytes appended to the path of the traversal
+
+  double time_ms;         // Wall time, from the start of the command to its end
+
+} t_walkstats;
+
+// ========  FUNCTION DECLARATIONS  ========
+
+void     walkstats_clear   (t_walkstats* stats);
+void     walkstats_add     (t_walkstats* stats, const t_walkstats* from);
+t_my_err walkstats_to_dict (const t_walkstats* stats, t_dictionary* dict);
+
+#define walkstats_depth(_stats, _depth) do { if ((_depth) > (_stats)->depth_max) { (_stats)->depth_max = (_depth); } } while (0)
+
+// ========  END OF HEADER FILE  ========
+
+#endif
@@ -0,0 +1,132 @@
+#include "workpool.h"
+
+// The tasks are numbered and split into contiguous ranges, one per thread.
+// Each thread runs its own range from the front, and once it is empty
+// steals single tasks from the back of the other ranges. The threads are
+// started for one run and joined before returning, the calling thread
+// taking part as thread 0.
+
+// ====  WORKPOOL  ====
+
+typedef struct _workpool_worker {
+
+  t_workpool* pool;
+  t_int32     thread_ind;
+
+} t_workpool_worker;
+
+//******************************************************************************
+//  Take a task from the front of the own range.
+//
+//  @return The task index, or -1 if the range is empty.
+//
+static t_int32 _workpool_pop(t_workpool_deque* deque) {
+
+  t_int32 task_ind = -1;
+
+  systhread_mutex_lock(deque->mutex);
+  if (deque->front < deque->back) { task_ind = deque->front++; }
+  systhread_mutex_unlock(deque->mutex);
+
+  return task_ind;
+}
+
+//******************************************************************************
+//  Steal a task from the back of another range.
+//
+//  @return The task index, or -1 if the range is empty.
+//
+static t_int32 _workpool_steal(t_workpool_deque* deque) {
+
+  t_int32 task_ind = -1;
+
+  systhread_mutex_lock(deque->mutex);
+  if (deque->front < deque->back) { task_ind = --deque->back; }
+  systhread_mutex_unlock(deque->mutex);
+
+  return task_ind;
+}
+
+//******************************************************************************
+//  Thread loop: run the own tasks, then steal until all ranges are empty.
+//
+static void* _workpool_worker(t_workpool_worker* worker) {
+
+  t_workpool* pool = worker->pool;
+  t_int32 task_ind;
+
+  while ((task_ind = _workpool_pop(pool->deque_arr + worker->thread_ind)) != -1) {
+    pool->fct(pool->data, task_ind, worker->thread_ind);
+  }
+
+  // Go through the other threads, starting with the next one
+  for (t_int32 ind = 1; ind < pool->thread_cnt; ind++) {
+
+    t_workpool_deque* victim = pool->deque_arr + (worker->thread_ind + ind) % pool->thread_cnt;
+
+    while ((task_ind = _workpool_steal(victim)) != -1) {
+      ATOMIC_INCREMENT(&pool->steal_cnt);
+      pool->fct(pool->data, task_ind, worker->thread_ind);
+    }
+  }
+
+  if (worker->thread_ind) { systhread_exit(0); }
+  return NULL;
+}
+
+//******************************************************************************
+//  Run a set of tasks on a number of threads, and wait for all of them.
+//
+//  @param pool A pointer to the pool structure, used for the duration of the run.
+//  @param thread_cnt The number of threads, including the calling thread.
+//  @param task_cnt The number of tasks.
+//  @param fct The function running one task.
+//  @param data The data passed to the function.
+//
+//  @return ERR_NONE, or ERR_ALLOC if threads could not be created, in which case
+//    the remaining tasks are run on the calling thread.
+//
+t_my_err workpool_run(t_workpool* pool, t_int32 thread_cnt, t_int32 task_cnt, t_workpool_fct fct, void* data) {
+
+  t_my_err err = ERR_NONE;
+  t_systhread thread_arr[WORKPOOL_THREAD_MAX];
+  t_workpool_worker worker_arr[WORKPOOL_THREAD_MAX];
+
+  thread_cnt = MAX(1, MIN(thread_cnt, MIN(WORKPOOL_THREAD_MAX, task_cnt)));
+
+  pool->fct = fct;
+  pool->data = data;
+  pool->thread_cnt = thread_cnt;
+  pool->steal_cnt = 0;
+
+  // Split the tasks into contiguous ranges
+  for (t_int32 ind = 0; ind < thread_cnt; ind++) {
+    systhread_mutex_new(&pool->deque_arr[ind].mutex, SYSTHREAD_MUTEX_NORMAL);
+    pool->deque_arr[ind].front = (t_int32)(((t_atom_long)task_cnt * ind) / thread_cnt);
+    pool->deque_arr[ind].back = (t_int32)(((t_atom_long)task_cnt * (ind + 1)) / thread_cnt);
+    worker_arr[ind].pool = pool;
+    worker_arr[ind].thread_ind = ind;
+    thread_arr[ind] = NULL;
+  }
+
+  // Start the other threads, then work on the calling thread
+  for (t_int32 ind = 1; ind < thread_cnt; ind++) {
+    if (systhread_create((method)_workpool_worker, worker_arr + ind, 0, 0, 0, thread_arr + ind)) {
+      thread_arr[ind] = NULL;
+      err = ERR_ALLOC;
+    }
+  }
+
+  _workpool_worker(worker_arr);
+
+  // Wait for the other threads
+  for (t_int32 ind = 1; ind < thread_cnt; ind++) {
+    if (thread_arr[ind]) { systhread_join(thread_arr[ind], NULL); }
+  }
+
+  for (t_int32 ind = 0; ind < thread_cnt; ind++) {
+    systhread_mutex_free(pool->deque_arr[ind].mutex);
+  }
+
+  return err;
+}
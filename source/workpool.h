@@ -0,0 +1,57 @@
+#ifndef YC_WORKPOOL_H_
+#define YC_WORKPOOL_H_
+
+// ========  HEADER FILE FOR THE WORK STEALING THREAD POOL  ========
+
+#include "ext.h"        // header file for all objects, should always be first
+#include "ext_obex.h"   // header file for all objects, required for new style Max object
+#include "z_dsp.h"      // header file for MSP objects, included here for t_double type
+
+#include "ext_systhread.h"
+#include "ext_atomic.h"
+
+#include "regexpr.h"
+
+// ========  DEFINES  ========
+
+#define WORKPOOL_THREAD_MAX 64    // Maximum number of threads, including the calling thread
+
+// ========  STRUCTURES  ========
+
+//******************************************************************************
+//  Function running one task, called from any of the threads,
+//  with the index of that thread, 0 for the calling thread
+//
+typedef void (*t_workpool_fct)(void* data, t_int32 task_ind, t_int32 thread_ind);
+
+//******************************************************************************
+//  Range of task indexes owned by one thread.
+//  The owner takes tasks from the front, thieves take them from the back.
+//
+typedef struct _workpool_deque {
+
+  t_systhread_mutex mutex;
+  t_int32           front;
+  t_int32           back;     // One past the last task
+
+} t_workpool_deque;
+
+typedef struct _workpool {
+
+  t_workpool_fct fct;
+  void*          data;
+
+  t_int32          thread_cnt;
+  t_workpool_deque deque_arr[WORKPOOL_THREAD_MAX];
+
+  t_int32_atomic steal_cnt;   // Number of tasks stolen, for verbose output
+
+} t_workpool;
+
+// ========  FUNCTION DECLARATIONS  ========
+
+t_my_err workpool_run (t_workpool* pool, t_int32 thread_cnt, t_int32 task_cnt, t_workpool_fct fct, void* data);
+
+// ========  END OF HEADER FILE  ========
+
+#endif